@@ -1263,6 +1263,25 @@ kj::Array<jsg::Ref<api::WebSocket>> DurableObjectState::getWebSockets(
   return kj::Array<jsg::Ref<api::WebSocket>>();
 }
 
+uint DurableObjectState::broadcast(jsg::Lock& js,
+    kj::OneOf<kj::Array<byte>, kj::String> message,
+    jsg::Optional<BroadcastOptions> options) {
+  auto& a = KJ_REQUIRE_NONNULL(IoContext::current().getActor());
+  KJ_IF_SOME(manager, a.getHibernationManager()) {
+    kj::Maybe<kj::StringPtr> tag;
+    kj::ArrayPtr<jsg::Ref<api::WebSocket>> except;
+    KJ_IF_SOME(o, options) {
+      tag = o.tag.map([](kj::StringPtr t) { return t; });
+      KJ_IF_SOME(e, o.except) {
+        except = e;
+      }
+    }
+    return manager.broadcast(js, kj::mv(message), tag, except);
+  }
+  // No WebSockets have been accepted yet.
+  return 0;
+}
+
 void DurableObjectState::setWebSocketAutoResponse(
     jsg::Optional<jsg::Ref<WebSocketRequestResponsePair>> maybeReqResp) {
   auto& a = KJ_REQUIRE_NONNULL(IoContext::current().getActor());
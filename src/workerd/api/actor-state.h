@@ -679,6 +679,24 @@ class DurableObjectState: public jsg::Object {
   // Disconnected WebSockets are automatically removed from the list.
   kj::Array<jsg::Ref<api::WebSocket>> getWebSockets(jsg::Lock& js, jsg::Optional<kj::String> tag);
 
+  struct BroadcastOptions {
+    // Only send to accepted WebSockets with this tag.
+    jsg::Optional<kj::String> tag;
+
+    // WebSockets not to send to, e.g. the one the message came from.
+    jsg::Optional<kj::Array<jsg::Ref<api::WebSocket>>> except;
+
+    JSG_STRUCT(tag, except);
+    JSG_STRUCT_TS_OVERRIDE(DurableObjectBroadcastOptions);
+  };
+
+  // Sends a message to every open accepted WebSocket, or to those matching `options.tag`.
+  // Equivalent to calling send() on each WebSocket returned by getWebSockets(), except that
+  // hibernating WebSockets are not woken up. Returns the number of WebSockets sent to.
+  uint broadcast(jsg::Lock& js,
+      kj::OneOf<kj::Array<byte>, kj::String> message,
+      jsg::Optional<BroadcastOptions> options);
+
   // Sets an object-wide websocket auto response message for a specific
   // request string. All websockets belonging to the same object must
   // reply to the request with the matching response, then store the timestamp at which
@@ -744,6 +762,9 @@ class DurableObjectState: public jsg::Object {
     JSG_METHOD(blockConcurrencyWhile);
     JSG_METHOD(acceptWebSocket);
     JSG_METHOD(getWebSockets);
+    if (flags.getWorkerdExperimental()) {
+      JSG_METHOD(broadcast);
+    }
     JSG_METHOD(setWebSocketAutoResponse);
     JSG_METHOD(getWebSocketAutoResponse);
     JSG_METHOD(getWebSocketAutoResponseTimestamp);
@@ -820,6 +841,7 @@ class DurableObjectState: public jsg::Object {
   api::ActorState, api::DurableObjectState, api::DurableObjectTransaction,                         \
       api::DurableObjectStorage, api::DurableObjectState::AbortOptions,                            \
       api::DurableObjectState::ReadReplicationOptions,                                             \
+      api::DurableObjectState::BroadcastOptions,                                                   \
       api::DurableObjectStorage::TransactionOptions,                                               \
       api::DurableObjectStorageOperations::ListOptions,                                            \
       api::DurableObjectStorageOperations::GetOptions,                                             \
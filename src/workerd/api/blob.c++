@@ -13,19 +13,15 @@
 namespace workerd::api {
 
 namespace {
-// Concatenate an array of segments (parameter to Blob constructor).
-kj::Maybe<jsg::JsBufferSource> concat(jsg::Lock& js, jsg::Optional<Blob::Bits> maybeBits) {
-  auto bits = kj::mv(maybeBits).orDefault(nullptr);
-  if (bits.size() == 0) {
-    return kj::none;
-  }
-
+// Validates the parts of a Blob, recording the size of each in `cachedPartSizes`, and returns
+// their total size.
+size_t measureParts(
+    jsg::Lock& js, Blob::Bits& bits, kj::SmallArray<size_t, 8>& cachedPartSizes) {
   auto rejectResizable = FeatureFlags::get(js).getNoResizableArrayBufferInBlob();
   auto maxBlobSize = Worker::Isolate::from(js).getLimitEnforcer().getBlobSizeLimit();
   static constexpr int kMaxInt KJ_UNUSED = kj::maxValue;
   KJ_DASSERT(maxBlobSize <= kMaxInt, "Blob size limit exceeds int range");
   size_t size = 0;
-  kj::SmallArray<size_t, 8> cachedPartSizes(bits.size());
   size_t index = 0;
   for (auto& part: bits) {
     size_t partSize = 0;
@@ -41,7 +37,7 @@ kj::Maybe<jsg::JsBufferSource> concat(jsg::Lock& js, jsg::Optional<Blob::Bits> m
         partSize = text.asBytes().size();
       }
       KJ_CASE_ONEOF(blob, jsg::Ref<Blob>) {
-        partSize = blob->getData().size();
+        partSize = blob->getSize();
       }
     }
     cachedPartSizes[index++] = partSize;
@@ -65,7 +61,18 @@ kj::Maybe<jsg::JsBufferSource> concat(jsg::Lock& js, jsg::Optional<Blob::Bits> m
         kj::str("Blob size ", size + partSize, " exceeds limit ", maxBlobSize));
     size += partSize;
   }
+  return size;
+}
+
+// Concatenate an array of segments (parameter to Blob constructor).
+kj::Maybe<jsg::JsBufferSource> concat(jsg::Lock& js, jsg::Optional<Blob::Bits> maybeBits) {
+  auto bits = kj::mv(maybeBits).orDefault(nullptr);
+  if (bits.size() == 0) {
+    return kj::none;
+  }
 
+  kj::SmallArray<size_t, 8> cachedPartSizes(bits.size());
+  size_t size = measureParts(js, bits, cachedPartSizes);
   if (size == 0) {
     return kj::none;
   }
@@ -74,7 +81,7 @@ kj::Maybe<jsg::JsBufferSource> concat(jsg::Lock& js, jsg::Optional<Blob::Bits> m
 
   auto view = u8.asArrayPtr();
 
-  index = 0;
+  size_t index = 0;
   for (auto& part: bits) {
     KJ_SWITCH_ONEOF(part) {
       KJ_CASE_ONEOF(bytes, jsg::JsBufferSource) {
@@ -145,11 +152,12 @@ kj::String normalizeType(kj::String type) {
 
 }  // namespace
 
-Blob::Blob(kj::String type): ownData(Empty{}), data(nullptr), type(kj::mv(type)) {}
+Blob::Blob(kj::String type): ownData(Empty{}), data(nullptr), size(0), type(kj::mv(type)) {}
 
 Blob::Blob(jsg::Lock& js, jsg::JsBufferSource data, kj::String type)
     : ownData(data.addRef(js)),
       data(data.asArrayPtr()),
+      size(this->data.size()),
       type(kj::mv(type)) {
   if (FeatureFlags::get(js).getNoResizableArrayBufferInBlob()) {
     JSG_REQUIRE(
@@ -160,8 +168,125 @@ Blob::Blob(jsg::Lock& js, jsg::JsBufferSource data, kj::String type)
 Blob::Blob(jsg::Ref<Blob> parent, kj::ArrayPtr<const byte> data, kj::String type)
     : ownData(kj::mv(parent)),
       data(data),
+      size(data.size()),
       type(kj::mv(type)) {}
 
+Blob::Blob(jsg::Lock& js, Rope rope, kj::String type)
+    : ownData(kj::mv(rope)),
+      data(nullptr),
+      size(0),
+      type(kj::mv(type)) {
+  for (auto& segment: ownData.get<Rope>().segments) {
+    size += segment.data.size();
+  }
+}
+
+kj::Maybe<Blob::Rope> Blob::tryMakeRope(jsg::Lock& js, Bits& bits) {
+  bool hasBlob = false;
+  for (auto& part: bits) {
+    KJ_IF_SOME(blob, part.tryGet<jsg::Ref<Blob>>()) {
+      hasBlob = hasBlob || blob->size > 0;
+    }
+  }
+  if (!hasBlob) return kj::none;
+
+  kj::SmallArray<size_t, 8> cachedPartSizes(bits.size());
+  measureParts(js, bits, cachedPartSizes);
+
+  kj::Vector<Rope::Segment> segments(bits.size());
+  size_t ownedBytes = 0;
+  size_t index = 0;
+  while (index < bits.size()) {
+    KJ_IF_SOME(blob, bits[index].tryGet<jsg::Ref<Blob>>()) {
+      if (blob->size > 0) {
+        blob->appendSegmentsTo(segments, 0, blob->size);
+      }
+      ++index;
+      continue;
+    }
+
+    // Copy each run of parts that aren't Blobs into one array.
+    size_t runEnd = index;
+    size_t runSize = 0;
+    while (runEnd < bits.size() && !bits[runEnd].is<jsg::Ref<Blob>>()) {
+      runSize += cachedPartSizes[runEnd++];
+    }
+    auto bytes = kj::heapArray<byte>(runSize);
+    auto view = bytes.asPtr();
+    for (; index < runEnd; ++index) {
+      KJ_SWITCH_ONEOF(bits[index]) {
+        KJ_CASE_ONEOF(buffer, jsg::JsBufferSource) {
+          // As in concat(), a buffer resized since it was measured contributes at most its
+          // measured size.
+          size_t toCopy = kj::min(buffer.size(), cachedPartSizes[index]);
+          if (toCopy > 0) view.write(buffer.asArrayPtr().first(toCopy));
+        }
+        KJ_CASE_ONEOF(text, kj::String) {
+          if (text.size() > 0) view.write(text.asBytes());
+        }
+        KJ_CASE_ONEOF(blob, jsg::Ref<Blob>) {
+          KJ_UNREACHABLE;
+        }
+      }
+    }
+    size_t written = runSize - view.size();
+    if (written > 0) {
+      ownedBytes += runSize;
+      auto contents = bytes.first(written).asConst();
+      segments.add(Rope::Segment{kj::Array<const byte>(kj::mv(bytes)), contents});
+    }
+  }
+
+  return Rope{
+    .segments = segments.releaseAsArray(),
+    .flattened = kj::none,
+    .adjustment = js.getExternalMemoryAdjustment(ownedBytes),
+  };
+}
+
+void Blob::appendSegmentsTo(kj::Vector<Rope::Segment>& segments, size_t start, size_t end) {
+  KJ_SWITCH_ONEOF(ownData) {
+    KJ_CASE_ONEOF(_, Empty) {}
+    KJ_CASE_ONEOF(_, jsg::JsRef<jsg::JsBufferSource>) {
+      segments.add(Rope::Segment{JSG_THIS, data.slice(start, end)});
+    }
+    KJ_CASE_ONEOF(root, jsg::Ref<Blob>) {
+      segments.add(Rope::Segment{root.addRef(), data.slice(start, end)});
+    }
+    KJ_CASE_ONEOF(rope, Rope) {
+      size_t offset = 0;
+      for (auto& segment: rope.segments) {
+        size_t segmentStart = offset;
+        offset += segment.data.size();
+        if (offset <= start) continue;
+        if (segmentStart >= end) break;
+        auto piece = segment.data.slice(
+            kj::max(start, segmentStart) - segmentStart, kj::min(end, offset) - segmentStart);
+        KJ_SWITCH_ONEOF(segment.owner) {
+          KJ_CASE_ONEOF(owner, jsg::Ref<Blob>) {
+            segments.add(Rope::Segment{owner.addRef(), piece});
+          }
+          KJ_CASE_ONEOF(_, kj::Array<const byte>) {
+            // The array belongs to this rope, so keep this Blob alive rather than the array.
+            segments.add(Rope::Segment{JSG_THIS, piece});
+          }
+        }
+      }
+    }
+  }
+}
+
+void Blob::copyTo(kj::ArrayPtr<byte> out) const {
+  KJ_IF_SOME(rope, ownData.tryGet<Rope>()) {
+    for (auto& segment: rope.segments) {
+      out.write(segment.data);
+    }
+    KJ_ASSERT(out.size() == 0);
+  } else {
+    out.copyFrom(data);
+  }
+}
+
 jsg::Ref<Blob> Blob::constructor(
     jsg::Lock& js, jsg::Optional<Bits> bits, jsg::Optional<Options> options) {
   kj::String type;  // note: default value is intentionally empty string
@@ -179,6 +304,10 @@ jsg::Ref<Blob> Blob::constructor(
         if (parent->getSize() == 0) {
           return js.alloc<Blob>(kj::mv(type));
         }
+        if (parent->ownData.is<Rope>()) {
+          // A rope has no contiguous data to view, but its segments can be shared.
+          return js.alloc<Blob>(js, KJ_ASSERT_NONNULL(tryMakeRope(js, b)), kj::mv(type));
+        }
         auto ptr = parent->data;
         KJ_IF_SOME(root, parent->ownData.template tryGet<jsg::Ref<Blob>>()) {
           parent = root.addRef();
@@ -186,6 +315,10 @@ jsg::Ref<Blob> Blob::constructor(
         return js.alloc<Blob>(kj::mv(parent), ptr, kj::mv(type));
       }
     }
+
+    KJ_IF_SOME(rope, tryMakeRope(js, b)) {
+      return js.alloc<Blob>(js, kj::mv(rope), kj::mv(type));
+    }
   }
 
   KJ_IF_SOME(data, concat(js, kj::mv(bits))) {
@@ -195,6 +328,15 @@ jsg::Ref<Blob> Blob::constructor(
 }
 
 kj::ArrayPtr<const byte> Blob::getData() const {
+  KJ_IF_SOME(rope, ownData.tryGet<Rope>()) {
+    if (rope.flattened == kj::none && size > 0) {
+      auto flattened = kj::heapArray<byte>(size);
+      copyTo(flattened);
+      rope.adjustment.adjust(size);
+      data = flattened;
+      rope.flattened = kj::Array<const byte>(kj::mv(flattened));
+    }
+  }
   return data;
 }
 
@@ -204,26 +346,42 @@ jsg::Ref<Blob> Blob::slice(jsg::Lock& js,
     jsg::Optional<kj::String> type) {
 
   auto normalizedType = normalizeType(kj::mv(type).orDefault(nullptr));
-  if (data.size() == 0) {
+  if (size == 0) {
     // Blob is empty, there's nothing to slice.
     return js.alloc<Blob>(kj::mv(normalizedType));
   }
 
   int start = maybeStart.orDefault(0);
-  int end = maybeEnd.orDefault(data.size());
+  int end = maybeEnd.orDefault(size);
 
   if (start < 0) {
     // Negative value interpreted as offset from end.
-    start += data.size();
+    start += size;
   }
   if (end < 0) {
     // Negative value interpreted as offset from end.
-    end += data.size();
+    end += size;
   }
 
   // Clamp start and end to range.
-  start = kj::max(0, kj::min(start, static_cast<int>(data.size())));
-  end = kj::max(start, kj::min(end, static_cast<int>(data.size())));
+  start = kj::max(0, kj::min(start, static_cast<int>(size)));
+  end = kj::max(start, kj::min(end, static_cast<int>(size)));
+
+  if (ownData.is<Rope>()) {
+    if (start == end) {
+      return js.alloc<Blob>(kj::mv(normalizedType));
+    }
+    // Share the segments that overlap the slice rather than flattening.
+    kj::Vector<Rope::Segment> segments;
+    appendSegmentsTo(segments, start, end);
+    return js.alloc<Blob>(js,
+        Rope{
+          .segments = segments.releaseAsArray(),
+          .flattened = kj::none,
+          .adjustment = js.getExternalMemoryAdjustment(0),
+        },
+        kj::mv(normalizedType));
+  }
 
   // We run with KJ_IREQUIRE checks enabled in production, which will catch
   // out of bounds start/end ... but since we're clamping them above, this
@@ -251,24 +409,34 @@ jsg::Ref<Blob> Blob::slice(jsg::Lock& js,
     KJ_CASE_ONEOF(_, jsg::JsRef<jsg::JsBufferSource>) {
       return js.alloc<Blob>(JSG_THIS, slicedData, kj::mv(normalizedType));
     }
+    KJ_CASE_ONEOF(_, Rope) {
+      KJ_FAIL_ASSERT("Rope blob should have been handled before slicing the data");
+    }
   }
   KJ_UNREACHABLE;
 }
 
 jsg::Promise<jsg::JsRef<jsg::JsArrayBuffer>> Blob::arrayBuffer(jsg::Lock& js) {
   FeatureObserver::maybeRecordUse(FeatureObserver::Feature::BLOB_AS_ARRAY_BUFFER);
-  auto ret = jsg::JsArrayBuffer::create(js, data);
+  auto ret = jsg::JsArrayBuffer::create(js, size);
+  copyTo(ret.asArrayPtr());
   return js.resolvedPromise(ret.addRef(js));
 }
 
 jsg::Promise<jsg::JsRef<jsg::JsUint8Array>> Blob::bytes(jsg::Lock& js) {
   FeatureObserver::maybeRecordUse(FeatureObserver::Feature::BLOB_AS_ARRAY_BUFFER);
-  auto ret = jsg::JsUint8Array::create(js, data);
+  auto ret = jsg::JsUint8Array::create(js, size);
+  copyTo(ret.asArrayPtr());
   return js.resolvedPromise(ret.addRef(js));
 }
 
 jsg::Promise<jsg::JsRef<jsg::JsString>> Blob::text(jsg::Lock& js) {
   FeatureObserver::maybeRecordUse(FeatureObserver::Feature::BLOB_AS_TEXT);
+  if (ownData.is<Rope>()) {
+    auto chars = kj::heapArray<char>(size);
+    copyTo(chars.asBytes());
+    return js.resolvedPromise(js.str(chars.asPtr().asConst()).addRef(js));
+  }
   // Using js.str here instead of returning kj::String avoids an additional
   // intermediate allocation and copy of the string data.
   return js.resolvedPromise(js.str(data.asChars()).addRef(js));
@@ -276,6 +444,14 @@ jsg::Promise<jsg::JsRef<jsg::JsString>> Blob::text(jsg::Lock& js) {
 
 JsReadableStream Blob::stream(jsg::Lock& js) {
   FeatureObserver::maybeRecordUse(FeatureObserver::Feature::BLOB_AS_STREAM);
+  if (ownData.is<Rope>()) {
+    // Gather the segments straight into the stream's copy, without flattening the rope.
+    auto bytes = kj::heapArray<byte>(size);
+    copyTo(bytes);
+    auto ptr = bytes.asPtr();
+    return JsReadableStream::create(
+        js, IoContext::current(), newMemorySource(ptr, kj::heap(kj::mv(bytes))));
+  }
   // Pass no backing so that newMemorySource copies: our data is a V8 ArrayBuffer, and the
   // stream is read from the kj event loop where the isolate's MPK-protected sandbox pages
   // are unreadable.
@@ -304,6 +480,11 @@ File::File(jsg::Ref<Blob> parent,
       name(kj::mv(name)),
       lastModified(lastModified) {}
 
+File::File(jsg::Lock& js, Rope rope, kj::String name, kj::String type, double lastModified)
+    : Blob(js, kj::mv(rope), kj::mv(type)),
+      name(kj::mv(name)),
+      lastModified(lastModified) {}
+
 jsg::Ref<File> File::constructor(
     jsg::Lock& js, jsg::Optional<Bits> bits, kj::String name, jsg::Optional<Options> options) {
   kj::String type;  // note: default value is intentionally empty string
@@ -330,6 +511,11 @@ jsg::Ref<File> File::constructor(
         if (parent->getSize() == 0) {
           return js.alloc<File>(kj::mv(name), kj::mv(type), lastModified);
         }
+        if (parent->ownData.is<Rope>()) {
+          // A rope has no contiguous data to view, but its segments can be shared.
+          return js.alloc<File>(js, KJ_ASSERT_NONNULL(tryMakeRope(js, b)), kj::mv(name),
+              kj::mv(type), lastModified);
+        }
         auto ptr = parent->data;
         KJ_IF_SOME(root, parent->ownData.template tryGet<jsg::Ref<Blob>>()) {
           parent = root.addRef();
@@ -337,6 +523,10 @@ jsg::Ref<File> File::constructor(
         return js.alloc<File>(kj::mv(parent), ptr, kj::mv(name), kj::mv(type), lastModified);
       }
     }
+
+    KJ_IF_SOME(rope, tryMakeRope(js, b)) {
+      return js.alloc<File>(js, kj::mv(rope), kj::mv(name), kj::mv(type), lastModified);
+    }
   }
 
   KJ_IF_SOME(data, concat(js, kj::mv(bits))) {
@@ -350,8 +540,14 @@ void Blob::serialize(jsg::Lock& js, jsg::Serializer& serializer) {
   // structuredClone, we should find a way for the clones to
   // just share the same backend data to avoid the copy.
   serializer.writeLengthDelimited(type);
-  serializer.writeRawUint64(data.size());
-  serializer.writeRawBytes(data);
+  serializer.writeRawUint64(size);
+  KJ_IF_SOME(rope, ownData.tryGet<Rope>()) {
+    for (auto& segment: rope.segments) {
+      serializer.writeRawBytes(segment.data);
+    }
+  } else {
+    serializer.writeRawBytes(data);
+  }
 }
 
 jsg::Ref<Blob> Blob::deserialize(
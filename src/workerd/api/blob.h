@@ -16,12 +16,17 @@ class File;
 
 // An implementation of the Web Platform Standard Blob API
 class Blob: public jsg::Object {
+  struct Rope;
+
  public:
   // Creates an empty Blob
   Blob(kj::String type);
   Blob(jsg::Lock& js, jsg::JsBufferSource data, kj::String type);
   Blob(jsg::Ref<Blob> parent, kj::ArrayPtr<const byte> data, kj::String type);
+  Blob(jsg::Lock& js, Rope rope, kj::String type);
 
+  // Returns the contents as one contiguous buffer. A Blob assembled from other Blobs does not
+  // have one until this is first called, so prefer the JS API methods where possible.
   kj::ArrayPtr<const byte> getData() const KJ_LIFETIMEBOUND;
 
   // ---------------------------------------------------------------------------
@@ -41,7 +46,7 @@ class Blob: public jsg::Object {
       jsg::Lock& js, jsg::Optional<Bits> bits, jsg::Optional<Options> options);
 
   int getSize() const {
-    return data.size();
+    return size;
   }
   kj::StringPtr getType() const KJ_LIFETIMEBOUND {
     return type;
@@ -95,6 +100,21 @@ class Blob: public jsg::Object {
       KJ_CASE_ONEOF(data, jsg::Ref<Blob>) {
         tracker.trackField("ownData", data);
       }
+      KJ_CASE_ONEOF(rope, Rope) {
+        for (auto& segment: rope.segments) {
+          KJ_SWITCH_ONEOF(segment.owner) {
+            KJ_CASE_ONEOF(blob, jsg::Ref<Blob>) {
+              tracker.trackField("segment", blob);
+            }
+            KJ_CASE_ONEOF(bytes, kj::Array<const byte>) {
+              tracker.trackField("segment", bytes);
+            }
+          }
+        }
+        KJ_IF_SOME(flattened, rope.flattened) {
+          tracker.trackField("flattened", flattened);
+        }
+      }
     }
     tracker.trackField("type", type);
   }
@@ -103,8 +123,38 @@ class Blob: public jsg::Object {
   // Sentinel type for the case where the Blob is just ... empty.
   struct Empty {};
 
-  kj::OneOf<Empty, jsg::JsRef<jsg::JsBufferSource>, jsg::Ref<Blob>> ownData;
-  kj::ArrayPtr<const byte> data;
+  // The contents of a Blob built from several parts, at least one of which is a non-empty Blob.
+  // Rather than copying every part into one buffer up front, Blob parts are referenced and each
+  // run of other parts is copied into one array. arrayBuffer(), bytes(), text(), stream() and
+  // serialization all copy straight out of the segments; only getData() flattens them.
+  struct Rope {
+    struct Segment {
+      // Keeps `data` alive: either the Blob that owns it, or the array itself.
+      kj::OneOf<jsg::Ref<Blob>, kj::Array<const byte>> owner;
+      kj::ArrayPtr<const byte> data;
+    };
+    kj::Array<Segment> segments;
+
+    // Set by the first getData(). The segments are kept, since other ropes may point into them.
+    mutable kj::Maybe<kj::Array<const byte>> flattened;
+
+    // Accounts for the arrays owned by the segments and for `flattened`.
+    mutable jsg::ExternalMemoryAdjustment adjustment;
+  };
+
+  // Returns the contents of `bits` as a Rope, if they include a non-empty Blob.
+  static kj::Maybe<Rope> tryMakeRope(jsg::Lock& js, Bits& bits);
+
+  // Appends segments sharing bytes [start, end) of this Blob to `segments`.
+  void appendSegmentsTo(kj::Vector<Rope::Segment>& segments, size_t start, size_t end);
+
+  // Copies the contents into `out`, which must be getSize() bytes.
+  void copyTo(kj::ArrayPtr<byte> out) const;
+
+  kj::OneOf<Empty, jsg::JsRef<jsg::JsBufferSource>, jsg::Ref<Blob>, Rope> ownData;
+  // The contiguous contents. For a Rope, empty until getData() flattens it.
+  mutable kj::ArrayPtr<const byte> data;
+  size_t size;
   kj::String type;
 
   void visitForGc(jsg::GcVisitor& visitor) {
@@ -116,6 +166,13 @@ class Blob: public jsg::Object {
       KJ_CASE_ONEOF(b, jsg::Ref<Blob>) {
         visitor.visit(b);
       }
+      KJ_CASE_ONEOF(rope, Rope) {
+        for (auto& segment: rope.segments) {
+          KJ_IF_SOME(b, segment.owner.tryGet<jsg::Ref<Blob>>()) {
+            visitor.visit(b);
+          }
+        }
+      }
     }
   }
 
@@ -138,6 +195,7 @@ class File: public Blob {
       kj::String name,
       kj::String type,
       double lastModified);
+  File(jsg::Lock& js, Rope rope, kj::String name, kj::String type, double lastModified);
 
   struct Options {
     jsg::Optional<kj::String> type;
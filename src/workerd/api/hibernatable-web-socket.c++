@@ -21,6 +21,24 @@ void markHibernatableWebSocketReceive(IoContext& context) {
   context.getWorker().getIsolate().getLimitEnforcer().markPerfEvent("ws_received"_kjc);
 }
 
+kj::StringPtr eventTypeName(const HibernatableSocketParams& params) {
+  KJ_SWITCH_ONEOF(params.eventType) {
+    KJ_CASE_ONEOF(text, HibernatableSocketParams::Text) {
+      return "message"_kj;
+    }
+    KJ_CASE_ONEOF(data, HibernatableSocketParams::Data) {
+      return "message"_kj;
+    }
+    KJ_CASE_ONEOF(close, HibernatableSocketParams::Close) {
+      return "close"_kj;
+    }
+    KJ_CASE_ONEOF(error, HibernatableSocketParams::Error) {
+      return "error"_kj;
+    }
+  }
+  KJ_UNREACHABLE;
+}
+
 }  // namespace
 
 HibernatableWebSocketEvent::HibernatableWebSocketEvent(): ExtendableEvent("webSocketMessage") {};
@@ -91,13 +109,32 @@ kj::Promise<WorkerInterface::CustomEvent::Result> HibernatableWebSocketCustomEve
     a.setHibernationManager(kj::addRef(KJ_REQUIRE_NONNULL(manager)));
   }
 
-  auto eventParameters = consumeParams();
+  auto firstParameters = consumeParams();
+  auto deliver = [&](HibernatableSocketParams eventParameters, size_t index) {
+    kj::Maybe<Worker::VersionInfo> versionInfoCopy;
+    KJ_IF_SOME(v, versionInfo) {
+      versionInfoCopy = v.clone();
+    }
+
+    if (index > 0) {
+      // delivered() only topped up the actor's limits for the first message. Each following one
+      // gets a budget of its own, just as if it had been dispatched as a separate event.
+      context.getLimitEnforcer().topUpActor();
+    }
+
+    // Messages in a batch share one request, so give each its own span, making the individual
+    // deliveries visible in traces. A lone message is traced exactly as before.
+    kj::Maybe<TraceContext> traceContext;
+    if (followingParams.size() > 0) {
+      auto& t = traceContext.emplace(
+          context.makeUserTraceSpan("durable_object_websocket_event"_kjc));
+      t.setTag("websocket.event"_kjc, eventTypeName(eventParameters));
+      t.setTag("websocket.batch_index"_kjc, static_cast<int64_t>(index));
+    }
 
-  try {
-    co_await context.run(
-        [entrypointName = entrypointName, eventParameters = kj::mv(eventParameters),
-            versionInfo = kj::mv(versionInfo), props = kj::mv(props),
-            isDynamicDispatch](Worker::Lock& lock, IoContext& context) mutable {
+    return context.run([entrypointName = entrypointName, eventParameters = kj::mv(eventParameters),
+                           versionInfo = kj::mv(versionInfoCopy), props = props.clone(),
+                           isDynamicDispatch](Worker::Lock& lock, IoContext& context) mutable {
       KJ_SWITCH_ONEOF(eventParameters.eventType) {
         KJ_CASE_ONEOF(text, HibernatableSocketParams::Text) {
           markHibernatableWebSocketReceive(context);
@@ -129,15 +166,31 @@ kj::Promise<WorkerInterface::CustomEvent::Result> HibernatableWebSocketCustomEve
         }
         KJ_UNREACHABLE;
       }
+    }).attach(kj::mv(traceContext));
+  };
+
+  // A handler that fails only fails its own message. The rest of the batch is still delivered,
+  // just as if each message had been dispatched as a separate event.
+  auto deliverOrReport = [&](HibernatableSocketParams eventParameters, size_t index) {
+    return kj::evalNow([&]() {
+      return deliver(kj::mv(eventParameters), index);
+    }).catch_([&](kj::Exception&& e) {
+      if (auto desc = e.getDescription();
+          !jsg::isTunneledException(desc) && !jsg::isDoNotLogException(desc)) {
+        LOG_EXCEPTION("HibernatableWebSocketCustomEvent"_kj, e);
+      }
+      incomingRequest->getMetrics().reportFailure(e);
+      context.logUncaughtExceptionAsync(UncaughtExceptionSource::ASYNC_TASK, kj::mv(e));
+      outcome = EventOutcome::EXCEPTION;
     });
-  } catch (kj::Exception& e) {
-    if (auto desc = e.getDescription();
-        !jsg::isTunneledException(desc) && !jsg::isDoNotLogException(desc)) {
-      LOG_EXCEPTION("HibernatableWebSocketCustomEvent"_kj, e);
-    }
-    incomingRequest->getMetrics().reportFailure(e);
-    context.logUncaughtExceptionAsync(UncaughtExceptionSource::ASYNC_TASK, e.clone());
-    outcome = EventOutcome::EXCEPTION;
+  };
+
+  co_await deliverOrReport(kj::mv(firstParameters), 0);
+
+  // Each following event still gets a turn of its own, so that microtasks queued by one handler
+  // run before the next handler is called, just as if they had been dispatched separately.
+  for (auto i: kj::indices(followingParams)) {
+    co_await deliverOrReport(kj::mv(followingParams[i]), i + 1);
   }
 
   co_return Result{
@@ -153,6 +206,9 @@ kj::Promise<WorkerInterface::CustomEvent::Result> HibernatableWebSocketCustomEve
   auto req = dispatcher.castAs<rpc::HibernatableWebSocketEventDispatcher>()
                  .hibernatableWebSocketEventRequest();
 
+  KJ_REQUIRE(followingParams.size() == 0,
+      "batched hibernatable websocket events can only be delivered locally");
+
   KJ_IF_SOME(rpcParameters, params.tryGet<kj::Own<HibernationReader>>()) {
     req.setMessage(rpcParameters->getMessage());
   } else {
@@ -202,10 +258,13 @@ HibernatableWebSocketCustomEvent::HibernatableWebSocketCustomEvent(uint16_t type
     kj::Maybe<Worker::Actor::HibernationManager&> manager)
     : typeId(typeId),
       params(kj::mv(params)) {}
-HibernatableWebSocketCustomEvent::HibernatableWebSocketCustomEvent(
-    uint16_t typeId, HibernatableSocketParams params, Worker::Actor::HibernationManager& manager)
+HibernatableWebSocketCustomEvent::HibernatableWebSocketCustomEvent(uint16_t typeId,
+    HibernatableSocketParams params,
+    Worker::Actor::HibernationManager& manager,
+    kj::Array<HibernatableSocketParams> followingParams)
     : typeId(typeId),
       params(kj::mv(params)),
+      followingParams(kj::mv(followingParams)),
       manager(manager) {}
 
 // Try to extract event type from params if available
@@ -61,8 +61,12 @@ class HibernatableWebSocketCustomEvent final: public WorkerInterface::CustomEven
   HibernatableWebSocketCustomEvent(uint16_t typeId,
       kj::Own<HibernationReader> params,
       kj::Maybe<Worker::Actor::HibernationManager&> manager = kj::none);
-  HibernatableWebSocketCustomEvent(
-      uint16_t typeId, HibernatableSocketParams params, Worker::Actor::HibernationManager& manager);
+  // `followingParams` are further events for the same websocket, delivered in order after
+  // `params` as part of the same request. They can only be delivered locally, not over RPC.
+  HibernatableWebSocketCustomEvent(uint16_t typeId,
+      HibernatableSocketParams params,
+      Worker::Actor::HibernationManager& manager,
+      kj::Array<HibernatableSocketParams> followingParams = nullptr);
 
   kj::Promise<Result> run(kj::Own<IoContext_IncomingRequest> incomingRequest,
       kj::Maybe<kj::StringPtr> entrypointName,
@@ -96,6 +100,7 @@ class HibernatableWebSocketCustomEvent final: public WorkerInterface::CustomEven
 
   uint16_t typeId;
   kj::OneOf<HibernatableSocketParams, kj::Own<HibernationReader>> params;
+  kj::Array<HibernatableSocketParams> followingParams;
   kj::Maybe<uint32_t> timeoutMs;
   kj::Maybe<Worker::Actor::HibernationManager&> manager;
 };
@@ -331,3 +331,44 @@ export const depthTest = {
     console.log('Blob size:', blob.size);
   },
 };
+
+// Blobs built from other Blobs share their segments rather than copying; make sure every way of
+// reading them back sees the right bytes.
+export const blobsOfBlobs = {
+  async test() {
+    const a = new Blob(['abc', new Uint8Array([100, 101, 102])]);
+    const b = new Blob(['ghi']);
+    const rope = new Blob([a, '-', b.slice(1), new Uint8Array([33])]);
+    strictEqual(rope.size, 10);
+    strictEqual(await rope.text(), 'abcdef-hi!');
+    strictEqual(new TextDecoder().decode(await rope.arrayBuffer()), 'abcdef-hi!');
+    strictEqual(new TextDecoder().decode(await rope.bytes()), 'abcdef-hi!');
+    strictEqual(await new Response(rope.stream()).text(), 'abcdef-hi!');
+
+    // Slices spanning several segments.
+    strictEqual(await rope.slice(2, 9).text(), 'cdef-hi');
+    strictEqual(await rope.slice(-3).text(), 'hi!');
+    strictEqual(await rope.slice(4, 4).text(), '');
+
+    // Blobs of blobs of blobs.
+    const nested = new Blob([rope, rope.slice(6), rope]);
+    strictEqual(await nested.text(), 'abcdef-hi!-hi!abcdef-hi!');
+    strictEqual(await new Blob([nested]).text(), 'abcdef-hi!-hi!abcdef-hi!');
+    strictEqual(await new Blob([nested]).slice(8, 15).text(), 'i!-hi!a');
+
+    // Consumers that need contiguous data.
+    strictEqual(await new Response(nested).text(), 'abcdef-hi!-hi!abcdef-hi!');
+    strictEqual(await structuredClone(nested).text(), 'abcdef-hi!-hi!abcdef-hi!');
+
+    const file = new File([a, b], 'name.txt', { type: 'text/plain' });
+    strictEqual(file.name, 'name.txt');
+    strictEqual(await file.text(), 'abcdefghi');
+    strictEqual(await new File([file], 'copy.txt').text(), 'abcdefghi');
+
+    // Mutating a source buffer afterwards doesn't change the Blob.
+    const source = new Uint8Array([120, 121]);
+    const withBuffer = new Blob([b, source]);
+    source[0] = 0;
+    strictEqual(await withBuffer.text(), 'ghixy');
+  },
+};
@@ -35,6 +35,17 @@ class MyCounter extends RpcTarget {
     return this.i;
   }
 
+  // Returns true if the microtask queued by the previous call to this method already ran, i.e.
+  // calls delivered together still see a microtask checkpoint between them.
+  checkMicrotaskBoundary() {
+    let sawBoundary = !this.microtaskPending;
+    this.microtaskPending = true;
+    queueMicrotask(() => {
+      this.microtaskPending = false;
+    });
+    return sawBoundary;
+  }
+
   disposed = false;
 
   #disposedResolver;
@@ -572,6 +583,11 @@ class PostAbortCallTester extends RpcTarget {
     this.ctx.abort('test aborted by abort()');
   }
 
+  // Returns normally, but aborts at the next microtask checkpoint.
+  abortInMicrotask() {
+    queueMicrotask(() => this.ctx.abort('test aborted by abort()'));
+  }
+
   async failCriticalSection() {
     await this.ctx.blockConcurrencyWhile(() => {
       throw new Error('test broken critical section');
@@ -2229,6 +2245,32 @@ export let portAbortCall = {
   },
 };
 
+// Calls issued in the same turn may be delivered together under one isolate lock. If execution is
+// terminated part way through such a batch, every call in it must still settle.
+export let abortDuringBatchTest = {
+  async test(controller, env, ctx) {
+    for (let method of ['abort', 'abortInMicrotask']) {
+      let id = env.MyActor.newUniqueId();
+      let actor = env.MyActor.get(id);
+      let stub = await actor.makePostAbortCallTester();
+
+      let before = stub.ping();
+      let abortPromise = stub[method]();
+      let after = [stub.ping(), stub.ping()];
+
+      // The calls before the one that aborted may or may not have completed first, but nothing
+      // may hang.
+      await Promise.allSettled([before, abortPromise]);
+      for (let promise of after) {
+        await assert.rejects(promise, {
+          name: 'Error',
+          message: 'test aborted by abort()',
+        });
+      }
+    }
+  },
+};
+
 export class Greeter extends WorkerEntrypoint {
   async greet(name) {
     return `${this.ctx.props.greeting}, ${name}!`;
@@ -2305,6 +2347,27 @@ export let eOrderTest = {
   },
 };
 
+// Many calls issued in the same turn on one stub may be delivered under a single isolate lock.
+// Make sure they still run in order and each still gets its own microtask checkpoint.
+export let sameTurnCallsTest = {
+  async test(controller, env, ctx) {
+    let stub = await env.MyService.makeCounter(0);
+
+    let increments = [];
+    let boundaries = [];
+    for (let i = 0; i < 20; i++) {
+      increments.push(stub.increment(1));
+      boundaries.push(stub.checkMicrotaskBoundary());
+    }
+
+    assert.deepEqual(
+      await Promise.all(increments),
+      Array.from({ length: 20 }, (_, i) => i + 1)
+    );
+    assert.deepEqual(await Promise.all(boundaries), Array(20).fill(true));
+  },
+};
+
 // Regression test for AUTOVULN-CLOUDFLARE-WORKERD-297:
 // Unbounded JsRpcProperty parent chain causes native stack overflow
 // (SIGSEGV) on destruction. Building a deep chain of pipelined
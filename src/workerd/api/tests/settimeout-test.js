@@ -1,8 +1,9 @@
 // Copyright (c) 2026 Cloudflare, Inc.
 // Licensed under the Apache 2.0 license found in the LICENSE file or at:
 //     https://opensource.org/licenses/Apache-2.0
-import { ok } from 'node:assert';
+import { ok, deepStrictEqual } from 'node:assert';
 import timers from 'node:timers/promises';
+import { DurableObject } from 'cloudflare:workers';
 
 // Allow up to 10ms of jitter because the precise_timers compat flag
 // can introduce +/-3ms of variance in timer resolution, and coverage
@@ -58,3 +59,57 @@ export const accuracyAfterCpuWork = {
     );
   },
 };
+
+// Timeouts due at the same time run back to back, but each is still its own task: microtasks
+// queued by one run before the next, clearing a later one prevents it from running, and zero-delay
+// timeouts set by a callback wait for a later batch.
+export const sameDeadlineBatch = {
+  async test() {
+    const log = [];
+    const { promise, resolve } = Promise.withResolvers();
+    let cleared;
+    setTimeout(() => {
+      log.push('a');
+      queueMicrotask(() => log.push('a-microtask'));
+      clearTimeout(cleared);
+      setTimeout(() => {
+        log.push('d');
+        resolve();
+      }, 0);
+    }, 0);
+    setTimeout(() => log.push('b'), 0);
+    cleared = setTimeout(() => log.push('cleared'), 0);
+    setTimeout(() => log.push('c'), 0);
+    await promise;
+    deepStrictEqual(log, ['a', 'a-microtask', 'b', 'c', 'd']);
+  },
+};
+
+export class TimerActor extends DurableObject {
+  async fetch() {
+    const log = [];
+    const { promise, resolve } = Promise.withResolvers();
+    setTimeout(async () => {
+      log.push('a start');
+      // The read holds the input gate, so the timeout due at the same time must not run until it
+      // completes, even though it would otherwise run under the same lock as this one.
+      await this.ctx.storage.get('missing');
+      log.push('a end');
+    }, 0);
+    setTimeout(() => {
+      log.push('b');
+      resolve();
+    }, 0);
+    await promise;
+    return Response.json(log);
+  }
+}
+
+// In actors, batching timeouts due at the same time must not bypass the input gate.
+export const sameDeadlineInputGate = {
+  async test(ctrl, env) {
+    const stub = env.ns.get(env.ns.idFromName('timers'));
+    const response = await stub.fetch('http://example.com/');
+    deepStrictEqual(await response.json(), ['a start', 'a end', 'b']);
+  },
+};
@@ -39,7 +39,16 @@ export class DurableObjectExample {
     });
   }
 
-  webSocketMessage(ws) {
+  async webSocketMessage(ws, message) {
+    if (message === 'slow') {
+      // Messages arriving meanwhile are queued, and then delivered together in one event.
+      await scheduler.wait(100);
+    } else if (message === 'throw') {
+      throw new Error('webSocketMessage failed');
+    } else if (message.startsWith('echo:')) {
+      ws.send(message);
+      return;
+    }
     ws.send(`Hibernatable message from DO.`);
   }
 
@@ -90,6 +99,34 @@ export const test = {
       'Hibernatable close from DO'
     );
 
+    // A handler that throws on one message must not prevent the messages queued behind it from
+    // being delivered.
+    {
+      let req = await obj.fetch('http://example.com/hibernation', {
+        headers: {
+          Upgrade: 'websocket',
+        },
+      });
+      let ws = req.webSocket;
+      ws.accept();
+      let echoes = [];
+      let { promise, resolve } = Promise.withResolvers();
+      ws.addEventListener('message', (event) => {
+        if (event.data.startsWith('echo:')) {
+          echoes.push(event.data);
+          if (echoes.length == 2) resolve();
+        }
+      });
+
+      ws.send('slow');
+      ws.send('throw');
+      ws.send('echo:a');
+      ws.send('echo:b');
+      await promise;
+      assert.deepStrictEqual(echoes, ['echo:a', 'echo:b']);
+      ws.close(1000, 'bye from Worker!');
+    }
+
     // Test throwing behavior
     await assert.rejects(async () => {
       await obj.fetch('http://example.com/throw', {
@@ -1447,3 +1447,59 @@ testfunc = pkgmodule.testfunc
     }
   },
 };
+
+// Workers loaded with identical module bodies share one copy of each. Make sure every Worker still
+// sees its own modules correctly, including after the first one goes away.
+export let sharedModuleSources = {
+  async test(ctrl, env, ctx) {
+    let load = (greeting) =>
+      env.loader.load({
+        compatibilityDate: '2025-01-01',
+        mainModule: 'main.js',
+        modules: {
+          'main.js': `
+            import greeting from "greeting.txt";
+            import bytes from "bytes.bin";
+            export default {
+              greet(name) { return greeting + ", " + name + " " + new Uint8Array(bytes).length; }
+            }
+          `,
+          'greeting.txt': { text: greeting },
+          'bytes.bin': { data: new Uint8Array([1, 2, 3]) },
+        },
+      });
+
+    let first = load('Hello');
+    let second = load('Hello');
+    let third = load('Howdy');
+    assert.strictEqual(await first.getEntrypoint().greet('Alice'), 'Hello, Alice 3');
+    first = null;
+    assert.strictEqual(await second.getEntrypoint().greet('Bob'), 'Hello, Bob 3');
+    assert.strictEqual(await third.getEntrypoint().greet('Carol'), 'Howdy, Carol 3');
+  },
+};
+
+export let sharedCompiledCode = {
+  async test(ctrl, env, ctx) {
+    // Workers loaded with identical code share its compiled code, but never module state.
+    let workers = [1, 2, 3].map((i) =>
+      env.loader.load({
+        compatibilityDate: '2025-01-01',
+        mainModule: 'main.js',
+        modules: {
+          'main.js': `
+            let count = 0;
+            export default {
+              increment() { return ++count; }
+            }
+          `,
+        },
+      })
+    );
+
+    for (let worker of workers) {
+      assert.strictEqual(await worker.getEntrypoint().increment(), 1);
+      assert.strictEqual(await worker.getEntrypoint().increment(), 2);
+    }
+  },
+};
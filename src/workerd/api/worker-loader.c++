@@ -7,6 +7,8 @@
 #include <workerd/io/io-context.h>
 
 #include <capnp/message.h>
+#include <kj/map.h>
+#include <kj/mutex.h>
 #include <kj/vector.h>
 
 namespace workerd::api {
@@ -21,8 +23,60 @@ constexpr size_t MAX_DYNAMIC_WORKER_CODE_SIZE = 64 * 1024 * 1024;
 // roughly the paid Worker analog of 128 environment variables at 5 KB each
 constexpr size_t MAX_DYNAMIC_WORKER_ENV_SIZE = 1 * 1024 * 1024;
 
+// All live SharedModuleSources, keyed by their content. Intentionally leaked, since sources may be
+// released by other threads during shutdown.
+using SharedModuleSourceMap = kj::HashMap<kj::ArrayPtr<const byte>, const SharedModuleSource*>;
+kj::MutexGuarded<SharedModuleSourceMap>& getSharedModuleSources() {
+  static auto& sources = *new kj::MutexGuarded<SharedModuleSourceMap>();
+  return sources;
+}
+
 }  // namespace
 
+SharedModuleSource::SharedModuleSource(kj::ArrayPtr<const byte> contentParam)
+    : content(kj::heapArray<byte>(contentParam.size() + 1)) {
+  content.first(contentParam.size()).copyFrom(contentParam);
+  content.back() = '\0';
+}
+
+SharedModuleSource::~SharedModuleSource() noexcept(false) {
+  // The map may already hold a replacement with the same content, created after our refcount
+  // reached zero. Only remove the entry if it's ours.
+  auto lock = getSharedModuleSources().lockExclusive();
+  KJ_IF_SOME(entry, lock->findEntry(asBytes())) {
+    if (entry.value == this) {
+      lock->erase(entry);
+    }
+  }
+}
+
+kj::Own<const SharedModuleSource> SharedModuleSource::intern(kj::ArrayPtr<const byte> content) {
+  auto tryAddRef = [&](SharedModuleSourceMap& map) -> kj::Maybe<kj::Own<const SharedModuleSource>> {
+    KJ_IF_SOME(found, map.find(content)) {
+      return kj::atomicAddRefWeak(*found);
+    }
+    return kj::none;
+  };
+
+  KJ_IF_SOME(source, tryAddRef(*getSharedModuleSources().lockExclusive())) {
+    return kj::mv(source);
+  }
+
+  // Copy the content without holding the lock, since it may be large.
+  auto source = kj::atomicRefcounted<SharedModuleSource>(content);
+
+  auto lock = getSharedModuleSources().lockExclusive();
+  KJ_IF_SOME(other, tryAddRef(*lock)) {
+    // Another thread interned the same content meanwhile.
+    return kj::mv(other);
+  }
+  // Any existing entry belongs to a source that's being destroyed. Its key points into that
+  // source's content, so replace the whole entry rather than just the value.
+  lock->erase(content);
+  lock->insert(source->asBytes(), source.get());
+  return source;
+}
+
 jsg::Ref<Fetcher> WorkerStub::getEntrypoint(jsg::Lock& js,
     jsg::Optional<kj::Maybe<kj::String>> name,
     jsg::Optional<EntrypointOptions> options) {
@@ -230,7 +284,8 @@ DynamicWorkerSource WorkerLoader::toDynamicWorkerSource(jsg::Lock& js,
     .globalOutbound = kj::mv(globalOutbound),
     .tails = kj::mv(tailChannels),
     .streamingTails = kj::mv(streamingTailChannels),
-    .ownContent = ownCompatFlags.attach(kj::mv(code.modules), kj::mv(code.mainModule)),
+    .ownContent = ownCompatFlags.attach(
+        kj::mv(code.modules), kj::mv(code.mainModule), kj::mv(code.sharedSources)),
     .ownContentIsRpcResponse = false};
 }
 
@@ -251,20 +306,43 @@ Worker::Script::Source WorkerLoader::extractSource(jsg::Lock& js, WorkerCode& co
   JSG_REQUIRE(code.modules.fields.size() > 0, TypeError,
       "Dynamic Worker code must contain at least one module.");
 
+  // Replaces this load's copy of a module body with the shared one, so that only one copy is kept
+  // no matter how many Workers are loaded with the same code.
+  auto shareBytes = [&](kj::ArrayPtr<const byte> body) {
+    auto shared = SharedModuleSource::intern(body);
+    auto result = shared.get();
+    code.sharedSources.add(kj::mv(shared));
+    return result;
+  };
+  auto share = [&](kj::String& text) {
+    auto result = shareBytes(text.asBytes())->asString();
+    text = nullptr;
+    return result;
+  };
+  auto shareEsModule = [&](kj::String& text) {
+    auto shared = shareBytes(text.asBytes());
+    text = nullptr;
+    return Worker::Script::EsModule{
+      .body = shared->asString(),
+      .codeCache = shared->getCodeCache(),
+    };
+  };
+
   auto modules = KJ_MAP(entry, code.modules.fields) -> Worker::Script::Module {
     KJ_SWITCH_ONEOF(entry.value) {
-      KJ_CASE_ONEOF(text, kj::String) {
-        if (entry.name.endsWith(".py"_kj)) {
+      KJ_CASE_ONEOF(ownText, kj::String) {
+        if (entry.name.endsWith(".js"_kj)) {
           return {
             .name = entry.name,
-            .content = Worker::Script::PythonModule{.body = text},
+            .content = shareEsModule(ownText),
           };
         }
 
-        if (entry.name.endsWith(".js"_kj)) {
+        auto text = share(ownText);
+        if (entry.name.endsWith(".py"_kj)) {
           return {
             .name = entry.name,
-            .content = Worker::Script::EsModule{.body = text},
+            .content = Worker::Script::PythonModule{.body = text},
           };
         }
 
@@ -309,19 +387,21 @@ Worker::Script::Source WorkerLoader::extractSource(jsg::Lock& js, WorkerCode& co
         return {.name = entry.name, .content = [&]() -> Worker::Script::ModuleContent {
           KJ_IF_SOME(js, module.js) {
             // TODO: this might need typescript transpilation too.
-            return Worker::Script::EsModule{.body = js};
+            return shareEsModule(js);
           } else KJ_IF_SOME(cjs, module.cjs) {
-            return Worker::Script::CommonJsModule{.body = cjs};
+            return Worker::Script::CommonJsModule{.body = share(cjs)};
           } else KJ_IF_SOME(text, module.text) {
-            return Worker::Script::TextModule{.body = text};
+            return Worker::Script::TextModule{.body = share(text)};
           } else KJ_IF_SOME(data, module.data) {
             // The kj::Array<const byte> produced by jsg::asBytes() points into a V8
             // BackingStore. If the user passed a *resizable* ArrayBuffer they can call
             // resize(0) (or transfer/detach) after load() returns but before the child
             // isolate is compiled asynchronously, leaving us with a (ptr,len) into
-            // PROT_NONE pages. Copy now so the bytes survive until compileDataGlobal().
-            data = kj::heapArray<const kj::byte>(data.asPtr());
-            return Worker::Script::DataModule{.body = data};
+            // PROT_NONE pages. Sharing copies the bytes now, so they survive until
+            // compileDataGlobal().
+            auto body = shareBytes(data)->asBytes();
+            data = nullptr;
+            return Worker::Script::DataModule{.body = body};
           } else KJ_IF_SOME(json, module.json) {
             kj::StringPtr serialized =
                 module.serializedJson.emplace(js.serializeJson(kj::mv(json)));
@@ -330,13 +410,14 @@ Worker::Script::Source WorkerLoader::extractSource(jsg::Lock& js, WorkerCode& co
             module.json = kj::none;
             return Worker::Script::JsonModule{.body = serialized};
           } else KJ_IF_SOME(py, module.py) {
-            return Worker::Script::PythonModule{.body = py};
+            return Worker::Script::PythonModule{.body = share(py)};
           } else KJ_IF_SOME(wasm, module.wasm) {
             KJ_SWITCH_ONEOF(wasm) {
               KJ_CASE_ONEOF(bytes, kj::Array<const byte>) {
                 // Same as `data` above: copy out of the V8 BackingStore before going async.
-                bytes = kj::heapArray<const kj::byte>(bytes.asPtr());
-                return Worker::Script::WasmModule{.body = bytes};
+                auto body = shareBytes(bytes)->asBytes();
+                bytes = nullptr;
+                return Worker::Script::WasmModule{.body = body};
               }
               KJ_CASE_ONEOF(wasmModule, jsg::V8Ref<v8::WasmModuleObject>) {
                 // No copy needed here: the wire bytes are owned by the compiled module itself,
@@ -5,6 +5,7 @@
 #include <workerd/io/io-channels.h>
 #include <workerd/io/io-own.h>
 #include <workerd/io/worker.h>
+#include <workerd/jsg/modules.h>
 #include <workerd/jsg/setup.h>
 
 namespace workerd::api {
@@ -12,6 +13,37 @@ namespace workerd::api {
 class Fetcher;
 class DurableObjectClass;
 
+// An immutable module body shared by all dynamic Workers, in any isolate, whose code contains the
+// same bytes. Tenants commonly bundle the same frameworks, so this keeps one copy of each in
+// memory rather than one per loaded Worker.
+class SharedModuleSource final: public kj::AtomicRefcounted {
+ public:
+  explicit SharedModuleSource(kj::ArrayPtr<const byte> content);
+  ~SharedModuleSource() noexcept(false);
+  KJ_DISALLOW_COPY_AND_MOVE(SharedModuleSource);
+
+  // Returns the source with the given content, copying it only if no loaded Worker holds it yet.
+  static kj::Own<const SharedModuleSource> intern(kj::ArrayPtr<const byte> content);
+
+  kj::ArrayPtr<const byte> asBytes() const {
+    return content.first(content.size() - 1);
+  }
+  kj::StringPtr asString() const {
+    return kj::StringPtr(content.asChars().begin(), content.size() - 1);
+  }
+
+  // Shares the compiled code of the source between isolates when it is loaded as an ES module.
+  const jsg::EsModuleCodeCache& getCodeCache() const {
+    return codeCache;
+  }
+
+ private:
+  // The content plus a NUL terminator, so that it can be used as a string too.
+  kj::Array<byte> content;
+
+  jsg::EsModuleCodeCache codeCache;
+};
+
 // JS stub pointing to a remote Worker loaded using WorkerLoader. This is not a stub for a specific
 // entrypoint, but instead the entire Worker, allowing the caller to call any entrypoint (and
 // specify arbitrary props).
@@ -130,6 +162,10 @@ class WorkerLoader: public jsg::Object {
         tails,
         streamingTails);
 
+    // The shared copies of the module bodies, which the loaded Worker's source points into. Filled
+    // in by extractSource().
+    kj::Vector<kj::Own<const SharedModuleSource>> sharedSources;
+
     JSG_STRUCT_TS_OVERRIDE(WorkerLoaderWorkerCode {
       modules: Record<string, string | WebAssembly.Module | WorkerLoaderModule>;
     });
@@ -11,6 +11,7 @@
 #include <workerd/io/tracer.h>
 #include <workerd/jsg/ser.h>
 #include <workerd/util/autogate.h>
+#include <workerd/util/call-batcher.h>
 #include <workerd/util/completion-membrane.h>
 
 #include <capnp/membrane.h>
@@ -1108,23 +1109,26 @@ class JsRpcTargetBase: public rpc::JsRpcTarget::Server {
   JsRpcTargetBase(IoContext& ctx, MayOutliveIncomingRequest)
       : durableObjectId(getCurrentDurableObjectId()),
         enterIsolateAndCall(ctx.makeReentryCallback<IoContext::TOP_UP>(
-            [this](Worker::Lock& lock, IoContext& ctx, CallContext callContext) {
-              return callImpl(lock, ctx, callContext);
+            [this](Worker::Lock& lock, IoContext& ctx, kj::Maybe<CallContext> callContext) {
+              return callOrDispatchBatch(lock, ctx, kj::mv(callContext));
             })),
-        externalPusher(ctx.getExternalPusher()) {}
+        externalPusher(ctx.getExternalPusher()),
+        batcher([this]() { return enterIsolateAndCall(kj::none); }) {}
 
   // Constructor use by EntrypointJsRpcTarget, which is revoked and destroyed before the IoContext
   // can possibly be canceled. It can just use ctx.run().
   JsRpcTargetBase(IoContext& ctx, CantOutliveIncomingRequest)
       : durableObjectId(getCurrentDurableObjectId()),
-        enterIsolateAndCall([this, &ctx](CallContext callContext) {
+        enterIsolateAndCall([this, &ctx](kj::Maybe<CallContext> callContext) {
           // Note: No need to topUpActor() since this is the start of a top-level request, so the
           // actor will already have been topped up by IncomingRequest::delivered().
-          return ctx.run([this, callContext](Worker::Lock& lock, IoContext& ctx) mutable {
-            return callImpl(lock, ctx, callContext);
+          return ctx.run([this, callContext = kj::mv(callContext)](
+                             Worker::Lock& lock, IoContext& ctx) mutable {
+            return callOrDispatchBatch(lock, ctx, kj::mv(callContext));
           });
         }),
-        externalPusher(ctx.getExternalPusher()) {}
+        externalPusher(ctx.getExternalPusher()),
+        batcher([this]() { return enterIsolateAndCall(kj::none); }) {}
 
   struct EnvCtx {
     v8::Local<v8::Value> env;
@@ -1151,7 +1155,10 @@ class JsRpcTargetBase: public rpc::JsRpcTarget::Server {
     co_await kj::yield();
 
     // Try to execute the requested method.
-    co_return co_await enterIsolateAndCall(callContext).catch_([this](kj::Exception&& e) {
+    auto promise = util::Autogate::isEnabled(util::AutogateKey::JS_RPC_BATCHED_DISPATCH)
+        ? batcher.run(callContext)
+        : enterIsolateAndCall(callContext);
+    co_return co_await promise.catch_([this](kj::Exception&& e) {
       maybeAddDurableObjectId(
           e, durableObjectId.map([](const kj::String& id) { return id.asPtr(); }));
       if (jsg::isTunneledException(e.getDescription())) {
@@ -1190,14 +1197,65 @@ class JsRpcTargetBase: public rpc::JsRpcTarget::Server {
   kj::Maybe<kj::String> durableObjectId;
 
   // Function which enters the isolate lock and IoContext and then invokes callImpl(). Created
-  // using IoContext::makeReentryCallback().
-  kj::Function<kj::Promise<void>(CallContext callContext)> enterIsolateAndCall;
+  // using IoContext::makeReentryCallback(). If no CallContext is given, it instead drains
+  // `batcher`.
+  kj::Function<kj::Promise<void>(kj::Maybe<CallContext> callContext)> enterIsolateAndCall;
 
   kj::Rc<ExternalPusherImpl> externalPusher;
 
+  // Calls which arrived since the last time we took the isolate lock on behalf of this target.
+  // When the JS_RPC_BATCHED_DISPATCH autogate is enabled, every call that arrives before the lock
+  // is actually acquired is delivered under that single acquisition, so that e.g.
+  // `Promise.all(keys.map(k => stub.get(k)))` costs one lock (and one input lock, in actors)
+  // rather than N.
+  CallBatcher<CallContext> batcher;
+
   // Returns true if the given name cannot be used as a method on this type.
   virtual bool isReservedName(kj::StringPtr name) = 0;
 
+  kj::Promise<void> callOrDispatchBatch(
+      Worker::Lock& lock, IoContext& ctx, kj::Maybe<CallContext> callContext) {
+    KJ_IF_SOME(c, callContext) {
+      return callImpl(lock, ctx, c);
+    }
+
+    jsg::Lock& js = lock;
+    // If we throw out of here (e.g. because execution was terminated), the call being dispatched
+    // is rejected along with the rest of its batch.
+    batcher.drain([&](CallContext& call, bool first) -> kj::Promise<void> {
+      if (!first) {
+        // Each call used to get its own ctx.run(), which ends with a microtask checkpoint. Keep
+        // that behavior so that a method's synchronous continuations still run before the next
+        // method starts.
+        js.runMicrotasks();
+        if (js.v8Isolate->IsExecutionTerminating()) {
+          // Let runImpl() sort out why.
+          throw jsg::JsExceptionThrown();
+        }
+      }
+
+      // Errors are per-call: a method that throws synchronously must not fail the rest of the
+      // batch. This mirrors how runImpl() converts exceptions escaping a single call.
+      v8::TryCatch tryCatch(js.v8Isolate);
+      try {
+        return callImpl(lock, ctx, call);
+      } catch (jsg::JsExceptionThrown&) {
+        if (!tryCatch.CanContinue() || !tryCatch.HasCaught() || tryCatch.Exception().IsEmpty()) {
+          tryCatch.ReThrow();
+          throw;
+        }
+        auto jsException = tryCatch.Exception();
+        lock.logUncaughtException(UncaughtExceptionSource::INTERNAL, jsg::JsValue(jsException),
+            jsg::JsMessage(tryCatch.Message()));
+        return kj::Promise<void>(jsg::createTunneledException(js.v8Isolate, jsException));
+      } catch (kj::Exception& e) {
+        return kj::Promise<void>(kj::mv(e));
+      }
+    });
+
+    return kj::READY_NOW;
+  }
+
   kj::Promise<void> callImpl(Worker::Lock& lock, IoContext& ctx, CallContext callContext) {
     jsg::Lock& js = lock;
     auto params = callContext.getParams();
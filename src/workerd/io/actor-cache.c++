@@ -324,18 +324,43 @@ bool ActorCache::SharedLru::evictIfNeeded(Lock& lock) const {
       return current > options.hardLimit;
     }
 
-    Entry& entry = lock->front();
-    auto& cache = KJ_ASSERT_NONNULL(entry.maybeCache);
-    cache.removeEntry(lock, entry);
-    cache.evictEntry(lock, entry);
+    // `lastUse` values wrap around, so compare them by their difference.
+    auto usedAfter = [](uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) > 0; };
+
+    Entry* victim = nullptr;
+    Entry* requeue[EVICTION_WINDOW];
+    uint requeueCount = 0;
+    uint swept = 0;
+    for (auto& entry: *lock) {
+      if (victim == nullptr || usedAfter(victim->lastUse, entry.lastUse)) {
+        victim = &entry;
+      }
+      if (usedAfter(entry.lastUse, lastQueuedUse)) {
+        requeue[requeueCount++] = &entry;
+      }
+      if (++swept == EVICTION_WINDOW) break;
+    }
+
+    uint32_t newestQueued = lastQueuedUse;
+    for (auto entry: kj::arrayPtr(requeue, requeueCount)) {
+      if (entry != victim) {
+        lock->remove(*entry);
+        lock->add(*entry);
+        if (usedAfter(entry->lastUse, newestQueued)) newestQueued = entry->lastUse;
+      }
+    }
+    lastQueuedUse = newestQueued;
+
+    auto& cache = KJ_ASSERT_NONNULL(victim->maybeCache);
+    cache.removeEntry(lock, *victim);
+    cache.evictEntry(lock, *victim);
   }
 }
 
 void ActorCache::touchEntry(Lock& lock, Entry& entry) {
   if (entry.getSyncStatus() == EntrySyncStatus::CLEAN) {
     entry.isStale = false;
-    lock->remove(entry);
-    addToCleanList(lock, entry);
+    entry.lastUse = ++lru.useCounter;
   }
 
   // We only call `touchEntry` when the operation or the LRU has !noCache, so we want to cache this.
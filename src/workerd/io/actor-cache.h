@@ -502,6 +502,11 @@ class ActorCache final: public ActorCacheInterface {
     ~Entry() noexcept(false);
     KJ_DISALLOW_COPY_AND_MOVE(Entry);
 
+    // When the entry was last used, as a value of `SharedLru::useCounter`: set when the entry
+    // becomes CLEAN and whenever it's read from cache. Declared first so that it fits in
+    // AtomicRefcounted's tail padding rather than growing every entry.
+    uint32_t lastUse = 0;
+
     kj::Maybe<ActorCache&> maybeCache;
     const Key key;
 
@@ -834,6 +839,7 @@ class ActorCache final: public ActorCacheInterface {
   // This doesn't do much, but it makes it easier to track what's going on.
   void addToCleanList(Lock& listLock, Entry& entryRef) {
     entryRef.setClean();
+    entryRef.lastUse = lru.lastQueuedUse = ++lru.useCounter;
     listLock->add(entryRef);
   }
 
@@ -844,8 +850,8 @@ class ActorCache final: public ActorCacheInterface {
     dirtyList.add(entryRef);
   }
 
-  // Indicate that an entry was observed by a read operation and so should be moved to the end of
-  // the LRU queue.
+  // Indicate that an entry was observed by a read operation and so should be treated as recently
+  // used. This only updates the entry itself; it stays where it is in the clean list.
   void touchEntry(Lock& lock, Entry& entry);
 
   // TODO(soon) This function mostly belongs on the SharedLru, not the ActorCache. Notably,
@@ -1079,10 +1085,24 @@ class ActorCache::SharedLru {
  private:
   const Options options;
 
-  // List of clean values, across all caches, ordered from least-recently-used to
-  // most-recently-used.
+  // List of clean values, across all caches. Entries are appended when they become clean, but
+  // are not moved when they're read from cache -- that only updates `Entry::lastUse` -- so the
+  // list is only approximately ordered from least-recently-used to most-recently-used. This keeps
+  // cache hits from relinking entries, and so from writing to their neighbors, which usually
+  // belong to other actors. See evictIfNeeded() for how eviction makes up for it.
   kj::MutexGuarded<kj::List<Entry, &Entry::link>> cleanList;
 
+  // Source of `Entry::lastUse` values, protected by the `cleanList` lock. Wraps around, so values
+  // must be compared by their difference.
+  mutable uint32_t useCounter = 0;
+
+  // `lastUse` of the entry most recently appended to `cleanList`.
+  mutable uint32_t lastQueuedUse = 0;
+
+  // Number of entries at the front of `cleanList` that evictIfNeeded() considers for each
+  // eviction.
+  static constexpr uint EVICTION_WINDOW = 8;
+
   // Total byte size of everything that is cached, including dirty values that aren't in `cleanList`.
   mutable std::atomic<size_t> size = 0;
 
@@ -1093,6 +1113,11 @@ class ActorCache::SharedLru {
   // Evict cache entries as needed according to the cache limits. Returns true if the hard limit
   // is exceeded and nothing can be evicted, in which case the caller should fail out in the
   // appropriate way for the kind of operation being performed.
+  //
+  // Each eviction sweeps the first EVICTION_WINDOW entries of `cleanList`, which are the ones
+  // queued longest ago, and evicts whichever of them was least recently used. Entries in the
+  // window that were used after the newest entry was queued are moved to the back on the way, so
+  // that entries which keep being read don't keep being swept.
   bool evictIfNeeded(Lock& lock) const KJ_WARN_UNUSED_RESULT;
 
   friend class ActorCache;
@@ -3258,5 +3258,36 @@ KJ_TEST("ActorSqlite abandonAlarm returns kj::none when inAlarmHandler") {
   KJ_ASSERT(expectSync(test.getAlarm()) == oneMs);
 }
 
+KJ_TEST("database can be released after shutdown and reused by a new ActorSqlite") {
+  ActorSqliteTest test;
+
+  test.put("foo", "bar");
+  auto commitFulfiller = kj::mv(test.pollAndExpectCalls({"commit"})[0]);
+
+  // Not before shutdown, nor while a commit is still in flight.
+  KJ_ASSERT(test.actor.release() == kj::none);
+  test.actor.shutdown(kj::none);
+  KJ_ASSERT(test.actor.release() == kj::none);
+
+  commitFulfiller->fulfill();
+  test.pollAndExpectCalls({});
+
+  auto maybeWarm = test.actor.release();
+  auto& warm = KJ_ASSERT_NONNULL(maybeWarm);
+  KJ_ASSERT(warm.db.get() == &test.db);
+  KJ_ASSERT(test.actor.getSqliteDatabase() == kj::none);
+
+  ActorSqlite reused(kj::mv(warm), test.gate, KJ_BIND_METHOD(test, commitCallback), test.hooks);
+  KJ_ASSERT(KJ_ASSERT_NONNULL(expectSync(reused.get(kj::str("foo"), {}))) ==
+      kj::str("bar").asBytes());
+
+  // Writes through the new instance are committed through its own callback.
+  reused.put(kj::str("baz"), kj::heapArray(kj::str("qux").asBytes()), {}, nullptr);
+  test.pollAndExpectCalls({"commit"})[0]->fulfill();
+  test.pollAndExpectCalls({});
+  KJ_ASSERT(KJ_ASSERT_NONNULL(expectSync(reused.get(kj::str("baz"), {}))) ==
+      kj::str("qux").asBytes());
+}
+
 }  // namespace
 }  // namespace workerd
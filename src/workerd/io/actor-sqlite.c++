@@ -44,12 +44,25 @@ ActorSqlite::ActorSqlite(kj::Own<SqliteDatabase> dbParam,
     kj::Function<kj::Promise<void>(SpanParent)> commitCallback,
     Hooks& hooks,
     bool debugAlarmSyncParam)
-    : db(kj::mv(dbParam)),
+    : ActorSqlite(prepareDatabase(kj::mv(dbParam)),
+          outputGate,
+          kj::mv(commitCallback),
+          hooks,
+          debugAlarmSyncParam) {}
+
+ActorSqlite::ActorSqlite(WarmDatabase warm,
+    OutputGate& outputGate,
+    kj::Function<kj::Promise<void>(SpanParent)> commitCallback,
+    Hooks& hooks,
+    bool debugAlarmSyncParam)
+    : db(kj::mv(warm.db)),
       outputGate(outputGate),
       commitCallback(kj::mv(commitCallback)),
       hooks(hooks),
-      kv(*db),
-      metadata(*db),
+      ownKv(kj::mv(warm.kv)),
+      ownMetadata(kj::mv(warm.metadata)),
+      kv(*ownKv),
+      metadata(*ownMetadata),
       commitTasks(*this),
       blockTasks(*this),
       debugAlarmSync(debugAlarmSyncParam) {
@@ -64,6 +77,33 @@ ActorSqlite::ActorSqlite(kj::Own<SqliteDatabase> dbParam,
   alarmScheduledNoLaterThan = metadata.getAlarm();
 }
 
+ActorSqlite::WarmDatabase ActorSqlite::prepareDatabase(kj::Own<SqliteDatabase> db) {
+  auto kv = kj::heap<SqliteKv>(*db);
+  auto metadata = kj::heap<SqliteMetadata>(*db);
+  return {.db = kj::mv(db), .kv = kj::mv(kv), .metadata = kj::mv(metadata)};
+}
+
+kj::Maybe<ActorSqlite::WarmDatabase> ActorSqlite::release() {
+  if (!brokenByShutdown || db->observedCriticalError()) return kj::none;
+
+  // Anything still in flight belongs to this instance and would be lost with it.
+  if (!currentTxn.is<NoTxn>() || deleteAllCommitScheduled || pendingCommit != kj::none ||
+      !commitTasks.isEmpty() || !blockTasks.isEmpty() || inAlarmHandler || haveDeferredDelete ||
+      alarmLaterIsInFlight) {
+    return kj::none;
+  }
+
+  // The callbacks are bound to this object. The next owner installs its own.
+  db->onWrite([](bool) {});
+  db->onCriticalError([](kj::StringPtr, kj::Maybe<kj::Exception>) {});
+
+  return WarmDatabase{
+    .db = kj::mv(db),
+    .kv = kj::mv(ownKv),
+    .metadata = kj::mv(ownMetadata),
+  };
+}
+
 ActorSqlite::ImplicitTxn::ImplicitTxn(ActorSqlite& parent): parent(parent) {
   KJ_REQUIRE(parent.currentTxn.is<NoTxn>());
   parent.beginTxn.run();
@@ -710,12 +750,15 @@ kj::OneOf<ActorCacheOps::GetResultList, kj::Promise<ActorCacheOps::GetResultList
     kj::Array<Key> keys, ReadOptions options) {
   requireNotBroken();
 
-  kj::Vector<KeyValuePair> results;
-  for (auto& key: keys) {
-    kv.get(
-        key, [&](ValuePtr value) { results.add(KeyValuePair{kj::mv(key), kj::heapArray(value)}); });
-  }
-  std::sort(results.begin(), results.end(), [](auto& a, auto& b) { return a.key < b.key; });
+  // Sorting the keys first means SqliteKv reports matches in order, so the results need no
+  // further sorting.
+  std::sort(keys.begin(), keys.end());
+  auto keyPtrs = KJ_MAP(key, keys) -> KeyPtr { return key; };
+
+  kj::Vector<KeyValuePair> results(keys.size());
+  kv.get(keyPtrs, [&](KeyPtr key, ValuePtr value) {
+    results.add(KeyValuePair{kj::str(key), kj::heapArray(value)});
+  });
   return GetResultList(kj::mv(results));
 }
 
@@ -806,11 +849,8 @@ kj::OneOf<uint, kj::Promise<uint>> ActorSqlite::delete_(
   // Capture trace span for the output gate lock hold trace.
   currentCommitSpan = kj::mv(traceSpan);
 
-  uint count = 0;
-  for (auto& key: keys) {
-    count += kv.delete_(key, {.allowUnconfirmed = options.allowUnconfirmed});
-  }
-  return count;
+  auto keyPtrs = KJ_MAP(key, keys) -> KeyPtr { return key; };
+  return kv.delete_(keyPtrs, {.allowUnconfirmed = options.allowUnconfirmed});
 }
 
 kj::Maybe<kj::Promise<void>> ActorSqlite::setAlarm(
@@ -988,6 +1028,7 @@ void ActorSqlite::shutdown(kj::Maybe<const kj::Exception&> maybeException) {
     // background. Remember that these in-flight flushes may or may not be awaited by the worker,
     // but they still hold the output lock as long as `allowUnconfirmed` wasn't used.
     broken.emplace(kj::mv(exception));
+    brokenByShutdown = true;
 
     // We explicitly do not schedule a flush to break the output gate. This means that if a request
     // is ongoing after the actor cache is shutting down, the output gate is only broken if they
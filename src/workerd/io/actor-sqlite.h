@@ -64,6 +64,33 @@ class ActorSqlite final: public ActorCacheInterface, private kj::TaskSet::ErrorH
       Hooks& hooks = Hooks::getDefaultHooks(),
       bool debugAlarmSync = false);
 
+  // An open database together with the state ActorSqlite prepares against it. release() hands
+  // this over when an actor is evicted, so that the actor's next ActorSqlite can skip reopening
+  // the file and re-preparing its statements.
+  struct WarmDatabase {
+    kj::Own<SqliteDatabase> db;
+    kj::Own<SqliteKv> kv;
+    kj::Own<SqliteMetadata> metadata;
+  };
+
+  // Constructs ActorSqlite around a database previously returned by release(). Callbacks that
+  // were registered on the database before it was first passed to ActorSqlite, like afterReset(),
+  // remain in place.
+  explicit ActorSqlite(WarmDatabase warm,
+      OutputGate& outputGate,
+      kj::Function<kj::Promise<void>(SpanParent)> commitCallback,
+      Hooks& hooks = Hooks::getDefaultHooks(),
+      bool debugAlarmSync = false);
+
+  // Gives up the database so it can be reused by a later ActorSqlite for the same actor. This
+  // only succeeds after shutdown(), and only if nothing is in flight: no transaction is open, no
+  // commit or alarm update is pending, and the database has not seen a critical error. Otherwise,
+  // returns none and the database is closed when this object is destroyed, as usual.
+  //
+  // After a successful release(), the only thing that may be done with this object is to
+  // destroy it.
+  kj::Maybe<WarmDatabase> release();
+
   bool isCommitScheduled() {
     return !currentTxn.is<NoTxn>() || deleteAllCommitScheduled;
   }
@@ -88,6 +115,7 @@ class ActorSqlite final: public ActorCacheInterface, private kj::TaskSet::ErrorH
   void blockTransaction(kj::Promise<void> promise) override;
 
   kj::Maybe<SqliteDatabase&> getSqliteDatabase() override {
+    if (db.get() == nullptr) return kj::none;  // released
     return *db;
   }
 
@@ -141,8 +169,12 @@ class ActorSqlite final: public ActorCacheInterface, private kj::TaskSet::ErrorH
   OutputGate& outputGate;
   kj::Function<kj::Promise<void>(SpanParent)> commitCallback;
   Hooks& hooks;
-  SqliteKv kv;
-  SqliteMetadata metadata;
+
+  // Heap-allocated so that release() can hand them over along with `db`.
+  kj::Own<SqliteKv> ownKv;
+  kj::Own<SqliteMetadata> ownMetadata;
+  SqliteKv& kv;
+  SqliteMetadata& metadata;
 
   // Define a SqliteDatabase::Regulator that is similar to TRUSTED but turns certain SQLite errors
   // into application errors as appropriate when committing an implicit transaction.
@@ -157,6 +189,9 @@ class ActorSqlite final: public ActorCacheInterface, private kj::TaskSet::ErrorH
 
   kj::Maybe<kj::Exception> broken;
 
+  // True if `broken` was set by shutdown() rather than by a failure.
+  bool brokenByShutdown = false;
+
   struct NoTxn {};
 
   class ImplicitTxn {
@@ -368,6 +403,9 @@ class ActorSqlite final: public ActorCacheInterface, private kj::TaskSet::ErrorH
   // startPrecommitAlarmScheduling() and passed the state that it returned.
   kj::Promise<void> commitImpl(PrecommitAlarmState precommitAlarmState, SpanParent parentSpan);
 
+  // Prepares the state ActorSqlite keeps alongside a freshly opened database.
+  static WarmDatabase prepareDatabase(kj::Own<SqliteDatabase> db);
+
   void taskFailed(kj::Exception&& exception) override;
 
   void requireNotBroken();
@@ -44,6 +44,9 @@ struct DispatchStats {
   uint getWorkerCalls = 0;
   uint customEventCalls = 0;
   bool rejectCustomEvents = false;
+
+  // If set, customEvent() doesn't complete until this does, as if the actor were slow to start.
+  kj::Maybe<kj::ForkedPromise<void>> holdCustomEvents;
 };
 
 // Minimal WorkerInterface for tests. Returns success on customEvent (so the HM's
@@ -61,6 +64,10 @@ class StubWorkerInterface final: public WorkerInterface {
       return kj::Promise<WorkerInterface::CustomEvent::Result>(KJ_EXCEPTION(
           OVERLOADED, "jsg.Error: Durable Object is overloaded. Too many requests queued."));
     }
+    KJ_IF_SOME(hold, stats.holdCustomEvents) {
+      return hold.addBranch().then(
+          []() { return WorkerInterface::CustomEvent::Result{.outcome = EventOutcome::OK}; });
+    }
     return WorkerInterface::CustomEvent::Result{.outcome = EventOutcome::OK};
   }
 
@@ -245,6 +252,40 @@ KJ_TEST("HibernationManager: eyeball sends non-auto-response message → dispatc
   fixture.drainAndDestroy(kj::mv(request));
 }
 
+KJ_TEST("HibernationManager: messages received during a slow dispatch share one event") {
+  DispatchStats stats;
+  TestFixture fixture(stubLoopbackParams(stats, kj::str("eyeball-batch")));
+  auto hm = makeTestHm(fixture);
+  auto request = fixture.newIncomingRequest();
+  auto end1 = acceptNewWebSocket(fixture, *request, *hm);
+
+  auto paf = kj::newPromiseAndFulfiller<void>();
+  stats.holdCustomEvents = paf.promise.fork();
+  end1->send("first"_kj).wait(fixture.getWaitScope());
+  fixture.pollEventLoop();
+  KJ_ASSERT(stats.customEventCalls == 1, stats.customEventCalls);
+
+  // The HM keeps receiving while the first event is in flight, but doesn't dispatch yet.
+  end1->send("second"_kj).wait(fixture.getWaitScope());
+  end1->send("third"_kj).wait(fixture.getWaitScope());
+  fixture.pollEventLoop();
+  KJ_ASSERT(stats.customEventCalls == 1, stats.customEventCalls);
+
+  // Once the first event completes, both queued messages go out in a single event.
+  stats.holdCustomEvents = kj::none;
+  paf.fulfiller->fulfill();
+  fixture.pollEventLoop();
+  KJ_ASSERT(stats.customEventCalls == 2, stats.customEventCalls);
+
+  // A close that arrives with other messages is still dispatched as its own event.
+  end1->send("fourth"_kj).wait(fixture.getWaitScope());
+  end1->close(1000, "bye"_kj).wait(fixture.getWaitScope());
+  fixture.pollEventLoop();
+  KJ_ASSERT(stats.customEventCalls == 4, stats.customEventCalls);
+
+  fixture.drainAndDestroy(kj::mv(request));
+}
+
 KJ_TEST("HibernationManager: DO close sends close frame to eyeball") {
   DispatchStats stats;
   TestFixture fixture(stubLoopbackParams(stats, kj::str("do-close")));
@@ -1083,5 +1124,131 @@ KJ_TEST("HibernationManager: hibernated auto-response copies buffer before suspe
   fixture.drainAndDestroy(kj::mv(request));
 }
 
+// Broadcast `msg` from the DO side to the WebSockets with `tag` (or all of them if `tag` is
+// empty), skipping the one tagged `exceptTag` if given. Returns the number of recipients.
+uint broadcastFromDo(TestFixture& fixture,
+    IoContext::IncomingRequest& request,
+    Worker::Actor::HibernationManager& hm,
+    kj::StringPtr msg,
+    kj::StringPtr tag = ""_kj,
+    kj::StringPtr exceptTag = ""_kj) {
+  uint count = 0;
+  fixture.enterContext(request, [&](const TestFixture::Environment& env) {
+    auto& js = env.js;
+    kj::Vector<jsg::Ref<api::WebSocket>> except;
+    if (exceptTag.size() != 0) except = hm.getWebSockets(js, exceptTag);
+    count = hm.broadcast(js, kj::str(msg),
+        tag.size() == 0 ? kj::Maybe<kj::StringPtr>(kj::none) : tag, except.asPtr());
+  });
+  return count;
+}
+
+void expectMessage(TestFixture& fixture, kj::WebSocket& ws, kj::StringPtr expected) {
+  auto msg = ws.receive().wait(fixture.getWaitScope());
+  KJ_ASSERT(msg.is<kj::String>() && msg.get<kj::String>() == expected);
+}
+
+KJ_TEST("HibernationManager: broadcast reaches tagged WebSockets, active or hibernated") {
+  DispatchStats stats;
+  TestFixture fixture(stubLoopbackParams(stats, kj::str("broadcast")));
+  auto hm = makeTestHm(fixture, "ping"_kj, "pong"_kj);
+  auto request = fixture.newIncomingRequest();
+  auto aliceEnd = acceptNewWebSocket(fixture, *request, *hm, "room"_kj);
+  auto bobEnd = acceptNewWebSocket(fixture, *request, *hm, "room"_kj);
+  auto carolEnd = acceptNewWebSocket(fixture, *request, *hm, "lobby"_kj);
+
+  // Active: only the tagged WebSockets get the message.
+  KJ_EXPECT(broadcastFromDo(fixture, *request, *hm, "active"_kj, "room"_kj) == 2);
+  expectMessage(fixture, *aliceEnd, "active"_kj);
+  expectMessage(fixture, *bobEnd, "active"_kj);
+  auto carolReceive = carolEnd->receive();
+  fixture.pollEventLoop();
+  KJ_ASSERT(!carolReceive.poll(fixture.getWaitScope()), "carol should not have received anything");
+
+  // Hibernated: written directly to every WebSocket, interleaving correctly with auto-responses.
+  fixture.enterWorkerLock([&](Worker::Lock& lock) { hm->hibernateWebSockets(lock); });
+  KJ_EXPECT(broadcastFromDo(fixture, *request, *hm, "hibernated"_kj) == 3);
+  aliceEnd->send("ping"_kj).wait(fixture.getWaitScope());
+  expectMessage(fixture, *aliceEnd, "hibernated"_kj);
+  expectMessage(fixture, *aliceEnd, "pong"_kj);
+  expectMessage(fixture, *bobEnd, "hibernated"_kj);
+  auto msg = carolReceive.wait(fixture.getWaitScope());
+  KJ_ASSERT(msg.is<kj::String>() && msg.get<kj::String>() == "hibernated"_kj);
+
+  // `except` wakes up only the excluded WebSocket; the others still get the message.
+  KJ_EXPECT(broadcastFromDo(fixture, *request, *hm, "not-alice"_kj, "room"_kj, "room"_kj) == 0);
+  KJ_EXPECT(broadcastFromDo(fixture, *request, *hm, "not-carol"_kj, ""_kj, "lobby"_kj) == 2);
+  expectMessage(fixture, *aliceEnd, "not-carol"_kj);
+  expectMessage(fixture, *bobEnd, "not-carol"_kj);
+
+  KJ_EXPECT(stats.customEventCalls == 0, stats.customEventCalls);
+  fixture.drainAndDestroy(kj::mv(request));
+}
+
+KJ_TEST("HibernationManager: broadcast to hibernated WebSockets waits for the output gate") {
+  DispatchStats stats;
+  TestFixture fixture(stubLoopbackParams(stats, kj::str("broadcast-output-gate")));
+  auto hm = makeTestHm(fixture);
+  auto request = fixture.newIncomingRequest();
+  auto end1 = acceptNewWebSocket(fixture, *request, *hm);
+
+  fixture.enterWorkerLock([&](Worker::Lock& lock) { hm->hibernateWebSockets(lock); });
+
+  auto paf = kj::newPromiseAndFulfiller<void>();
+  auto blocker = fixture.getActor().getOutputGate().lockWhile(kj::mv(paf.promise), nullptr);
+
+  KJ_EXPECT(broadcastFromDo(fixture, *request, *hm, "gated"_kj) == 1);
+  auto receivePromise = end1->receive();
+  fixture.pollEventLoop();
+  KJ_ASSERT(!receivePromise.poll(fixture.getWaitScope()),
+      "message should not have arrived while output gate is locked");
+
+  paf.fulfiller->fulfill();
+  auto msg = receivePromise.wait(fixture.getWaitScope());
+  KJ_ASSERT(msg.is<kj::String>() && msg.get<kj::String>() == "gated"_kj);
+
+  blocker.wait(fixture.getWaitScope());
+  fixture.drainAndDestroy(kj::mv(request));
+}
+
+KJ_TEST("HibernationManager: broadcast disconnects a hibernated peer that stops reading") {
+  DispatchStats stats;
+  TestFixture fixture(stubLoopbackParams(stats, kj::str("broadcast-slow-peer")));
+  auto hm = makeTestHm(fixture);
+  auto request = fixture.newIncomingRequest();
+  auto slowEnd = acceptNewWebSocket(fixture, *request, *hm, "room"_kj);
+  auto fastEnd = acceptNewWebSocket(fixture, *request, *hm, "room"_kj);
+
+  fixture.enterWorkerLock([&](Worker::Lock& lock) { hm->hibernateWebSockets(lock); });
+
+  // A WebSocketPipe holds each send until the other end receives it, so the messages for the
+  // peer that never reads pile up until they pass the 16 MiB limit.
+  auto big = kj::heapString(1u << 20);
+  for (auto& c: big) c = 'x';
+  for (uint i = 0; i < 16; i++) {
+    KJ_EXPECT(broadcastFromDo(fixture, *request, *hm, big) == 2);
+    expectMessage(fixture, *fastEnd, big);
+  }
+  KJ_EXPECT(stats.customEventCalls == 0, stats.customEventCalls);
+
+  // The next message would go past the limit, so the slow peer is disconnected rather than sent
+  // it, and the read loop reports that like any other disconnect.
+  KJ_EXPECT(broadcastFromDo(fixture, *request, *hm, big) == 1);
+  expectMessage(fixture, *fastEnd, big);
+  fixture.pollEventLoop();
+  KJ_EXPECT(stats.customEventCalls == 1, stats.customEventCalls);
+  bool slowFailed = slowEnd->receive()
+                        .then([](kj::WebSocket::Message&&) { return false; },
+                            [](kj::Exception&&) { return true; })
+                        .wait(fixture.getWaitScope());
+  KJ_EXPECT(slowFailed, "slow peer should have been disconnected");
+
+  // Only the peer that kept up remains.
+  KJ_EXPECT(broadcastFromDo(fixture, *request, *hm, "after"_kj) == 1);
+  expectMessage(fixture, *fastEnd, "after"_kj);
+
+  fixture.drainAndDestroy(kj::mv(request));
+}
+
 }  // namespace
 }  // namespace workerd
@@ -26,6 +26,13 @@ kj::Vector<jsg::Ref<api::WebSocket>> HibernationManagerImpl::getWebSockets(
   KJ_UNIMPLEMENTED("HibernationManagerImpl::getWebSockets not yet implemented (EW-10817)");
 }
 
+uint HibernationManagerImpl::broadcast(jsg::Lock& js,
+    kj::OneOf<kj::Array<kj::byte>, kj::String> message,
+    kj::Maybe<kj::StringPtr> tag,
+    kj::ArrayPtr<jsg::Ref<api::WebSocket>> except) {
+  KJ_UNIMPLEMENTED("HibernationManagerImpl::broadcast not yet implemented (EW-10817)");
+}
+
 void HibernationManagerImpl::hibernateWebSockets(Worker::Lock& lock) {
   KJ_UNIMPLEMENTED("HibernationManagerImpl::hibernateWebSockets not yet implemented (EW-10817)");
 }
@@ -22,6 +22,10 @@ class HibernationManagerImpl final: public Worker::Actor::HibernationManager {
   void acceptWebSocket(jsg::Ref<api::WebSocket> ws, kj::ArrayPtr<kj::String> tags) override;
   kj::Vector<jsg::Ref<api::WebSocket>> getWebSockets(
       jsg::Lock& js, kj::Maybe<kj::StringPtr> tag) override;
+  uint broadcast(jsg::Lock& js,
+      kj::OneOf<kj::Array<kj::byte>, kj::String> message,
+      kj::Maybe<kj::StringPtr> tag,
+      kj::ArrayPtr<jsg::Ref<api::WebSocket>> except) override;
   void hibernateWebSockets(Worker::Lock& lock) override;
   void setWebSocketAutoResponse(
       kj::Maybe<kj::StringPtr> request, kj::Maybe<kj::StringPtr> response) override;
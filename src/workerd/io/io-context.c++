@@ -64,11 +64,15 @@ class IoContext::TimeoutManagerImpl final: public TimeoutManager {
         "TimeoutId Generator mismatch - using a generator from wrong ServiceWorkerGlobalScope");
 
     auto [id, it] = addState(generator, kj::mv(params));
+    KJ_ON_SCOPE_FAILURE({
+      // Something threw, erase the state.
+      if (it->second.scheduledAt == kj::none) timeouts.erase(it);
+    });
     setTimeoutImpl(context, it);
     return id;
   }
 
-  void clearTimeout(IoContext&, TimeoutId id) override;
+  void clearTimeout(IoContext& context, TimeoutId id) override;
 
   size_t getTimeoutCount() const override {
     return timeoutsStarted - timeoutsFinished;
@@ -84,8 +88,8 @@ class IoContext::TimeoutManagerImpl final: public TimeoutManager {
 
   void cancelAll() override {
     timerTask = nullptr;
-    timeouts.clear();
     timeoutTimes.clear();
+    timeouts.clear();
   }
 
  private:
@@ -95,8 +99,28 @@ class IoContext::TimeoutManagerImpl final: public TimeoutManager {
   };
   IdAndIterator addState(TimeoutId::Generator& generator, TimeoutParameters params);
 
+  // Schedules the timeout at `it` to fire `params.msDelay` from now.
   void setTimeoutImpl(IoContext& context, Iterator it);
 
+  // Removes `state` from `timeoutTimes`, if it's there.
+  void unschedule(IoContext& context, TimeoutState& state);
+
+  // Calls the timeout's callback, rescheduling it if it's an interval.
+  void runTimeout(Worker::Lock& lock, IoContext& context, Iterator it);
+
+  // Waits for the timeout at the front of `timeoutTimes`, runs everything due by then, and
+  // repeats until no timeouts are left.
+  kj::Promise<void> runTimers(IoContext& context);
+
+  // Runs the timeouts at the front of `timeoutTimes` that are due by `when`, all under a single
+  // acquisition of the isolate's async lock. In actors, a batch ends early if a callback leaves
+  // I/O holding the input gate closed. A callback's failure is reported, and doesn't end the
+  // batch.
+  kj::Promise<void> runDueTimeouts(IoContext& context, kj::Date when);
+
+  // Removes the timeout at the front of `timeoutTimes` without running it, if it's due by `when`.
+  void dropLeadTimeout(IoContext& context, kj::Date when);
+
   // A pair of a Date and a numeric ID, used as entry in timeoutTimes set, below.
   struct TimeoutTime {
     kj::Date when;
@@ -113,23 +137,24 @@ class IoContext::TimeoutManagerImpl final: public TimeoutManager {
   };
 
   // Tracks registered timeouts sorted by the next time the timeout is expected to fire.
-  //
-  // The associated fulfiller should be fulfilled when the time has been reached AND all previous
-  // timeouts have completed.
-  kj::TreeMap<TimeoutTime, kj::Own<kj::PromiseFulfiller<void>>> timeoutTimes;
+  kj::TreeMap<TimeoutTime, Iterator> timeoutTimes;
   uint timeoutTimesTiebreakerCounter = 0;
 
   uint timeoutsStarted = 0;
   uint timeoutsFinished = 0;
   Map timeouts;
 
-  // Promise that is waiting for the closest timeout, and will fulfill its fulfiller. We only ever
-  // actually wait on the next timeout in `timeoutTasks`, so that we can't fulfill timer callbacks
-  // out-of-order. This task gets replaced each time the lead timeout changes.
+  // True while `timerTask` is running timeouts, rather than waiting for the next one. It can't be
+  // replaced then, since the callbacks it's running may be the ones changing `timeoutTimes`.
+  bool dispatching = false;
+
+  // The runTimers() loop. We only ever wait on the first timeout in `timeoutTimes`, so that we
+  // can't run timer callbacks out-of-order. The loop is restarted each time the lead timeout
+  // changes while it's waiting.
   kj::Promise<void> timerTask = nullptr;
 
   // Must be called any time timeoutTimes.begin() changes.
-  void resetTimerTask(TimerChannel& timerChannel);
+  void resetTimerTask(IoContext& context);
 };
 
 class IoContext::TimeoutManagerImpl::TimeoutState {
@@ -146,7 +171,15 @@ class IoContext::TimeoutManagerImpl::TimeoutState {
   bool isCanceled = false;
   bool isRunning = false;
 
-  kj::Maybe<kj::Promise<void>> maybePromise;
+  // The following are set while the timeout is waiting in `timeoutTimes`.
+
+  kj::Maybe<TimeoutTime> scheduledAt;
+
+  // The critical section the timeout was set within, which its callback must run within too.
+  kj::Maybe<kj::Own<InputGate::CriticalSection>> criticalSection;
+
+  // Holds the IoContext's pending event or, for actors, completes a wait-until task.
+  kj::Own<void> completion;
 };
 
 IoContext::IoContext(ThreadContext& thread,
@@ -800,12 +833,10 @@ void IoContext::TimeoutManagerImpl::TimeoutState::cancel() {
     return;
   }
 
-  auto wasCanceled = isCanceled;
   isCanceled = true;
 
-  if (!isRunning && !wasCanceled) {
+  if (!isRunning) {
     params.function = kj::none;
-    maybePromise = kj::none;
   }
 
   ++manager.timeoutsFinished;
@@ -837,132 +868,220 @@ auto IoContext::TimeoutManagerImpl::addState(
 void IoContext::TimeoutManagerImpl::setTimeoutImpl(IoContext& context, Iterator it) {
   auto& state = it->second;
 
-  auto stateGuard = kj::defer([&]() {
-    if (state.maybePromise == kj::none) {
-      // Something threw, erase the state.
-      timeouts.erase(it);
+  // Schedule relative to Date.now() so the delay appears exact to the application.
+  auto when = context.now() + state.params.msDelay * kj::MILLISECONDS;
+  auto criticalSection = context.getCriticalSection();
+
+  // Outside of actors this doesn't allocate, since the pending event is shared by the whole
+  // IoContext.
+  kj::Own<void> completion;
+  if (context.actor == kj::none) {
+    completion = context.registerPendingEvent();
+  } else {
+    // Actors don't use pending events. Instead, add a wait-until task which resolves when this
+    // timer completes. This ensures that `IncomingRequest::drain()` waits until all timers finish.
+    auto paf = kj::newPromiseAndFulfiller<void>();
+    completion = kj::heap(
+        kj::defer([fulfiller = kj::mv(paf.fulfiller)]() mutable { fulfiller->fulfill(); }));
+    context.addWaitUntil(kj::mv(paf.promise));
+  }
+
+  TimeoutTime key{when, timeoutTimesTiebreakerCounter++};
+  timeoutTimes.insert(key, it);
+  state.scheduledAt = key;
+  state.criticalSection = kj::mv(criticalSection);
+  state.completion = kj::mv(completion);
+
+  if (timeoutTimes.begin()->key == key) {
+    resetTimerTask(context);
+  }
+}
+
+void IoContext::TimeoutManagerImpl::unschedule(IoContext& context, TimeoutState& state) {
+  KJ_IF_SOME(key, state.scheduledAt) {
+    bool isNext = timeoutTimes.begin()->key == key;
+    timeoutTimes.erase(key);
+    state.scheduledAt = kj::none;
+    state.criticalSection = kj::none;
+    state.completion = nullptr;
+    if (isNext) resetTimerTask(context);
+  }
+}
+
+void IoContext::TimeoutManagerImpl::runTimeout(
+    Worker::Lock& lock, IoContext& context, Iterator it) {
+  auto& state = it->second;
+
+  // The user's callback might throw, but we need to at least attempt to reschedule interval
+  // callbacks even if they throw. This deferred action takes care of that. Note that we don't
+  // let the exception escape before this runs, because runImpl() throws a fatal exception if a JS
+  // exception is thrown, which complicates our logic here.
+  kj::UnwindDetector unwindDetector;
+  KJ_DEFER(unwindDetector.catchExceptionsIfUnwinding([&] {
+    if (state.isCanceled) {
+      // The user's callback has called clearInterval(), nothing more to do.
+      return;
     }
-  });
 
-  auto paf = kj::newPromiseAndFulfiller<void>();
+    // If this is an interval task and the script has CPU time left, reschedule the task;
+    // otherwise leave the dead map entry for the caller to remove.
+    if (state.params.repeat && context.limitEnforcer->getLimitsExceeded() == kj::none) {
+      setTimeoutImpl(context, it);
+    }
+  }););
 
-  // Schedule relative to Date.now() so the delay appears exact to the application.
-  auto when = context.now() + state.params.msDelay * kj::MILLISECONDS;
-  // TODO(cleanup): The manual use of run() here (including carrying over the critical section) is
-  //   kind of ugly, but using awaitIo() doesn't work here because we need the ability to cancel
-  //   the timer, so we don't want to addTask() it, which awaitIo() does implicitly.
-  auto promise =
-      paf.promise.then([this, &context, it, cs = context.getCriticalSection()]() mutable {
-    return context.run([this, it](Worker::Lock& lock, IoContext& context) mutable {
-      auto& state = it->second;
-
-      auto stateGuard = kj::defer([&] {
-        if (state.maybePromise == kj::none) {
-          // At the end of this block, there was no new timeout, so we should remove the state.
-          // Note that this can happen from cancelTimeout or a non-repeating timeout.
-          timeouts.erase(it);
-        }
-      });
+  state.trigger(lock);
+}
 
-      if (state.isCanceled) {
-        // We've been canceled before running. Nothing more to do.
-        KJ_ASSERT(state.maybePromise == kj::none);
-        return;
+kj::Promise<void> IoContext::TimeoutManagerImpl::runTimers(IoContext& context) {
+  while (timeoutTimes.size() > 0) {
+    auto when = timeoutTimes.begin()->key.when;
+    co_await context.getIoChannelFactory().getTimer().atTime(when);
+
+    dispatching = true;
+    KJ_DEFER(dispatching = false);
+    try {
+      co_await runDueTimeouts(context, when);
+    } catch (...) {
+      // Each callback's failure is handled within the batch, so this is a failure to take the
+      // locks for it. As when each timeout took the locks separately, that costs the lead timeout
+      // its run, but not the timeouts behind it, which try again in the next batch.
+      auto exception = kj::getCaughtExceptionAsKj();
+      if (context.abortException == kj::none) {
+        dropLeadTimeout(context, when);
+        context.taskFailed(kj::mv(exception));
       }
+    }
 
-      KJ_IF_SOME(promise, state.maybePromise) {
-        // We could KJ_ASSERT_NONNULL(iter->second) instead if we are sure clearTimeout() couldn't
-        // race us. However, I'm not sure about that.
-
-        // First, move our timeout promise to the task set so it's safe to call clearInterval()
-        // inside the user's callback. We don't yet null out the Maybe<Promise>, because we need to
-        // be able to detect whether the user does call clearInterval(). We leave the actual map
-        // entry in place because this aids in reporting cross-request-context timeout cancellation
-        // errors to the user.
-        context.addTask(kj::mv(promise));
-
-        // Because Promise has an underspecified move ctor, we need to explicitly nullify the Maybe
-        // to indicate that we've consumed the promise.
-        state.maybePromise = kj::none;
-
-        // The user's callback might throw, but we need to at least attempt to reschedule interval
-        // callbacks even if they throw. This deferred action takes care of that. Note that we don't
-        // run the user's callback directly in this->run(), because that function throws a fatal
-        // exception if a JS exception is thrown, which complicates our logic here.
-        //
-        // TODO(perf): If we can guarantee that `timeout->second = nullptr` will never throw, it
-        //   might be worthwhile having an early-out path for non-interval timeouts.
-        kj::UnwindDetector unwindDetector;
-        KJ_DEFER(unwindDetector.catchExceptionsIfUnwinding([&] {
-          if (state.isCanceled) {
-            // The user's callback has called clearInterval(), nothing more to do.
-            KJ_ASSERT(state.maybePromise == kj::none);
-            return;
-          }
+    // Skip waiting on further timeouts if the context has been aborted, since there's no way
+    // their events can run anyway.
+    if (context.abortException != kj::none) co_return;
+  }
+}
 
-          // If this is an interval task and the script has CPU time left, reschedule the task;
-          // otherwise leave the dead map entry in place.
-          if (state.params.repeat && context.limitEnforcer->getLimitsExceeded() == kj::none) {
-            setTimeoutImpl(context, it);
-          }
-        }););
+kj::Promise<void> IoContext::TimeoutManagerImpl::runDueTimeouts(
+    IoContext& context, kj::Date when) {
+  // Returns the critical section a timeout must run within, or nullptr.
+  auto getCriticalSection = [](TimeoutState& state) -> InputGate::CriticalSection* {
+    KJ_IF_SOME(cs, state.criticalSection) {
+      return cs.get();
+    }
+    return nullptr;
+  };
+
+  // Callbacks may set new timeouts which are already due, e.g. with setTimeout(fn, 0). Those wait
+  // for the next batch, so that a callback rescheduling itself can't keep the lock forever.
+  auto tiebreakerLimit = timeoutTimesTiebreakerCounter;
+  auto isDue = [&](TimeoutTime key) {
+    return key.when <= when && key.tiebreaker < tiebreakerLimit;
+  };
+
+  // Take the same locks as IoContext::run() would for the lead timeout. Timeouts set within a
+  // different critical section than the lead timeout's are left for the next batch.
+  auto& lead = timeoutTimes.begin()->value->second;
+  auto criticalSection = getCriticalSection(lead);
+  kj::Maybe<kj::Own<InputGate::CriticalSection>> criticalSectionRef;
+  kj::Maybe<InputGate::Lock> inputLock;
+  if (criticalSection != nullptr) {
+    criticalSectionRef = kj::addRef(*criticalSection);
+    inputLock = co_await criticalSection->wait(context.getCurrentTraceSpan());
+  } else if (context.actor != kj::none) {
+    auto& actor = KJ_ASSERT_NONNULL(context.actor);
+    inputLock = co_await actor.getInputGate().wait(context.getCurrentTraceSpan());
+  }
+
+  KJ_IF_SOME(ex, context.abortException) {
+    kj::throwFatalException(ex.clone());
+  }
 
-        state.trigger(lock);
+  kj::Promise<Worker::AsyncLock> asyncLockPromise = nullptr;
+  KJ_IF_SOME(a, context.actor) {
+    asyncLockPromise = context.worker->takeAsyncLockWhenActorCacheReady(
+        context.now(), a, context.getMetrics());
+  } else {
+    asyncLockPromise = context.worker->takeAsyncLock(context.getMetrics());
+  }
+  auto asyncLock = co_await asyncLockPromise;
+
+  // Each callback still gets its own runImpl(), and so its own microtask checkpoint and error
+  // handling, exactly as if it had been run separately. Only the lock acquisition is shared.
+  while (timeoutTimes.size() > 0) {
+    // The rest of the batch can't run in an aborted context. runTimers() stops too.
+    if (context.abortException != kj::none) break;
+
+    auto& entry = *timeoutTimes.begin();
+    auto it = entry.value;
+    if (!isDue(entry.key) || getCriticalSection(it->second) != criticalSection) break;
+
+    unschedule(context, it->second);
+    KJ_DEFER({
+      if (it->second.scheduledAt == kj::none) {
+        // There was no new timeout, so we should remove the state. Note that this can happen from
+        // clearTimeout() or a non-repeating timeout.
+        timeouts.erase(it);
+      }
+    });
+
+    struct RunnableImpl: public Runnable {
+      TimeoutManagerImpl& manager;
+      IoContext& context;
+      Iterator it;
+
+      RunnableImpl(TimeoutManagerImpl& manager, IoContext& context, Iterator it)
+          : manager(manager),
+            context(context),
+            it(it) {}
+      void run(Worker::Lock& lock) override {
+        manager.runTimeout(lock, context, it);
       }
-    }, kj::mv(cs));
-  }, [](kj::Exception&&) {});
-
-  promise = promise.attach(context.registerPendingEvent());
-
-  // Add an entry to the timeoutTimes map, to track when the nearest timeout is. Arrange for it
-  // to be removed when the promise completes.
-  TimeoutTime timeoutTimesKey{when, timeoutTimesTiebreakerCounter++};
-  timeoutTimes.insert(timeoutTimesKey, kj::mv(paf.fulfiller));
-  auto deferredTimeoutTimeRemoval = kj::defer([this, &context, timeoutTimesKey]() {
-    // If the promise is being destroyed due to IoContext teardown then IoChannelFactory may
-    // no longer be available, but we can just skip starting a new timer in that case as it'd be
-    // canceled anyway. Similarly we should skip rescheduling if the context has been aborted since
-    // there's no way the events can run anyway (and we'll cause trouble if `cancelAll()` is being
-    // called in ~IoContext_IncomingRequest).
-    if (context.selfRef->isValid() && context.abortException == kj::none) {
-      bool isNext = timeoutTimes.begin()->key == timeoutTimesKey;
-      timeoutTimes.erase(timeoutTimesKey);
-      if (isNext) resetTimerTask(context.getIoChannelFactory().getTimer());
+    };
+    RunnableImpl runnable(*this, context, it);
+
+    auto callbackLock =
+        inputLock.map([&](InputGate::Lock& l) { return l.addRef(context.getCurrentTraceSpan()); });
+    KJ_IF_SOME(exception, kj::runCatchingExceptions([&]() {
+      context.runImpl(
+          runnable, asyncLock, kj::mv(callbackLock), Runnable::Exceptional(false));
+    })) {
+      // A timeout that throws mustn't keep the rest of the batch from running, just as it didn't
+      // stop them when each timeout ran as a task of its own. Report it as such a task's failure
+      // was reported.
+      context.taskFailed(kj::mv(exception));
     }
-  });
 
-  if (timeoutTimes.begin()->key == timeoutTimesKey) {
-    resetTimerTask(context.getIoChannelFactory().getTimer());
+    KJ_IF_SOME(l, inputLock) {
+      if (l.isShared()) {
+        // The callback started I/O which holds the input gate, such as a storage read. Nothing
+        // else may run until it completes, so the rest of the batch must wait on the gate again.
+        break;
+      }
+    }
   }
-  promise = promise.attach(kj::mv(deferredTimeoutTimeRemoval));
+}
 
-  if (context.actor != kj::none) {
-    // Add a wait-until task which resolves when this timer completes. This ensures that
-    // `IncomingRequest::drain()` waits until all timers finish.
-    auto paf = kj::newPromiseAndFulfiller<void>();
-    promise = promise.attach(
-        kj::defer([fulfiller = kj::mv(paf.fulfiller)]() mutable { fulfiller->fulfill(); }));
-    context.addWaitUntil(kj::mv(paf.promise));
-  }
+void IoContext::TimeoutManagerImpl::dropLeadTimeout(IoContext& context, kj::Date when) {
+  if (timeoutTimes.size() == 0) return;
+  auto& entry = *timeoutTimes.begin();
+  if (entry.key.when > when) return;
 
-  state.maybePromise = promise.eagerlyEvaluate(nullptr);
+  auto it = entry.value;
+  unschedule(context, it->second);
+  timeouts.erase(it);
 }
 
-void IoContext::TimeoutManagerImpl::resetTimerTask(TimerChannel& timerChannel) {
+void IoContext::TimeoutManagerImpl::resetTimerTask(IoContext& context) {
+  if (dispatching) {
+    // runTimers() picks up the new lead timeout once it's done with the current batch.
+    return;
+  }
+
   if (timeoutTimes.size() == 0) {
     // Not waiting for any timer, clear the existing timer task.
     timerTask = nullptr;
   } else {
-    // Wait for the first timer.
-    auto& entry = *timeoutTimes.begin();
-    timerTask = timerChannel.atTime(entry.key.when)
-                    .then([this, key = entry.key]() {
-      auto& newEntry = *timeoutTimes.begin();
-      KJ_ASSERT(newEntry.key == key,
-          "front of timeoutTimes changed without calling resetTimerTask(), we probably missed "
-          "a timeout!");
-      newEntry.value->fulfill();
-    }).eagerlyEvaluate([](kj::Exception&& e) { KJ_LOG(ERROR, e); });
+    // Like a failed IoContext::run(), a failure to run timeouts (e.g. because the context was
+    // aborted) is not reported here.
+    timerTask = runTimers(context).eagerlyEvaluate([](kj::Exception&&) {});
   }
 }
 
@@ -973,8 +1092,13 @@ void IoContext::TimeoutManagerImpl::clearTimeout(IoContext& context, TimeoutId t
     return;
   }
 
-  // Cancel the timeout.
-  timeout->second.cancel();
+  // Cancel the timeout. If its callback is running, runDueTimeouts() removes it once it's done.
+  auto& state = timeout->second;
+  state.cancel();
+  if (!state.isRunning) {
+    unschedule(context, state);
+    timeouts.erase(timeout);
+  }
 }
 
 TimeoutId IoContext::setTimeoutImpl(
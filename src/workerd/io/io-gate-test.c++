@@ -42,6 +42,24 @@ KJ_TEST("InputGate basics") {
   KJ_EXPECT(!gate.onBroken().poll(ws));
 }
 
+KJ_TEST("InputGate lock knows whether it is shared") {
+  kj::EventLoop loop;
+  kj::WaitScope ws(loop);
+
+  InputGate gate;
+
+  auto lock = gate.wait(nullptr).wait(ws);
+  KJ_EXPECT(!lock.isShared());
+
+  {
+    auto lock2 = lock.addRef(nullptr);
+    KJ_EXPECT(lock.isShared());
+    KJ_EXPECT(lock2.isShared());
+  }
+
+  KJ_EXPECT(!lock.isShared());
+}
+
 KJ_TEST("InputGate critical section") {
   kj::EventLoop loop;
   kj::WaitScope ws(loop);
@@ -144,6 +144,17 @@ bool InputGate::Lock::isFor(const InputGate& otherGate) const {
   return ptr == &otherGate;
 }
 
+bool InputGate::Lock::isShared() const {
+  // Like the constructor, count against the parent if our critical section has completed.
+  InputGate* countedGate = gate;
+  KJ_IF_SOME(c, cs) {
+    if (c.get()->state == CriticalSection::REPARENTED) {
+      countedGate = &c.get()->parentAsInputGate();
+    }
+  }
+  return countedGate->lockCount > 1;
+}
+
 InputGate::CriticalSection::CriticalSection(InputGate& parent) {
   isCriticalSection = true;
   if (parent.isCriticalSection) {
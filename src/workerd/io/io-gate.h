@@ -98,6 +98,10 @@ class InputGate {
 
     bool isFor(const InputGate& gate) const;
 
+    // Returns true if other `Lock`s are holding the gate closed along with this one, e.g. because
+    // I/O started while this lock was current is still outstanding.
+    bool isShared() const;
+
     inline bool operator==(const Lock& other) const {
       return gate == other.gate;
     }
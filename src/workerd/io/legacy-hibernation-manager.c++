@@ -67,17 +67,78 @@ jsg::Ref<api::WebSocket> LegacyHibernationManagerImpl::HibernatableWebSocket::
     package.maybeTags = getTags();
 
     // Now that we unhibernated the WebSocket, we can set the last received autoResponse timestamp
-    // that was stored in the corresponding HibernatableWebSocket. We also move autoResponsePromise
-    // from the hibernation manager to api::websocket to prevent possible ws.send races.
+    // that was stored in the corresponding HibernatableWebSocket. We also give the api::WebSocket
+    // a branch of `pendingSends` to prevent possible ws.send races.
     activeOrPackage
         .init<jsg::Ref<api::WebSocket>>(
             api::WebSocket::hibernatableFromNative(js, *KJ_REQUIRE_NONNULL(ws), kj::mv(package)))
-        ->setAutoResponseStatus(autoResponseTimestamp, kj::mv(autoResponsePromise));
-    autoResponsePromise = kj::READY_NOW;
+        ->setAutoResponseStatus(autoResponseTimestamp, pendingSends.addBranch());
   }
   return activeOrPackage.get<jsg::Ref<api::WebSocket>>().addRef();
 }
 
+namespace {
+
+// How many bytes of messages sent to a hibernating websocket may be waiting to be written before
+// we give up on the peer. A single message larger than this is still sent if nothing is waiting.
+constexpr size_t MAX_PENDING_SEND_BYTES = 16u << 20;
+
+}  // namespace
+
+kj::Maybe<kj::Promise<void>> LegacyHibernationManagerImpl::HibernatableWebSocket::
+    sendWhileHibernating(kj::Own<OutgoingMessage> message, kj::Promise<void> ready) {
+  auto& socket = *KJ_REQUIRE_NONNULL(ws);
+  if (sendsAborted) return kj::none;
+
+  auto size = message->size();
+  if (pendingSendBytes > 0 && pendingSendBytes + size > MAX_PENDING_SEND_BYTES) {
+    // The peer isn't keeping up, e.g. because it stopped reading while the actor broadcasts to
+    // it. Disconnect it rather than buffer for it indefinitely.
+    KJ_LOG(INFO, "aborting hibernatable websocket whose peer isn't reading", pendingSendBytes);
+    sendsAborted = true;
+    socket.abort();
+    return kj::none;
+  }
+  pendingSendBytes += size;
+
+  // An earlier send failing doesn't stop us from trying this one. If the connection is broken,
+  // this one will fail too.
+  auto previous = pendingSends.addBranch().catch_([](kj::Exception&&) {});
+  auto send = kj::joinPromises(kj::arr(kj::mv(previous), kj::mv(ready)))
+                  .then([&socket, message = kj::mv(message)]() mutable {
+    // kj::WebSocket::send() borrows the message's buffer until it completes.
+    auto promise = message->sendOn(socket);
+    return promise.attach(kj::mv(message));
+  }).attach(kj::defer([this, size]() { pendingSendBytes -= size; })).fork();
+  auto result = send.addBranch();
+  pendingSends = kj::mv(send);
+  return result;
+}
+
+kj::Promise<void> LegacyHibernationManagerImpl::OutgoingMessage::sendOn(kj::WebSocket& ws) const {
+  KJ_SWITCH_ONEOF(content) {
+    KJ_CASE_ONEOF(text, kj::String) {
+      return ws.send(text.asArray());
+    }
+    KJ_CASE_ONEOF(data, kj::Array<kj::byte>) {
+      return ws.send(data.asPtr());
+    }
+  }
+  KJ_UNREACHABLE;
+}
+
+size_t LegacyHibernationManagerImpl::OutgoingMessage::size() const {
+  KJ_SWITCH_ONEOF(content) {
+    KJ_CASE_ONEOF(text, kj::String) {
+      return text.size();
+    }
+    KJ_CASE_ONEOF(data, kj::Array<kj::byte>) {
+      return data.size();
+    }
+  }
+  KJ_UNREACHABLE;
+}
+
 LegacyHibernationManagerImpl::LegacyHibernationManagerImpl(
     kj::Own<Worker::Actor::Loopback> loopback, uint16_t hibernationEventType)
     : loopback(kj::mv(loopback)),
@@ -196,6 +257,85 @@ kj::Vector<jsg::Ref<api::WebSocket>> LegacyHibernationManagerImpl::getWebSockets
   return kj::mv(matches);
 }
 
+uint LegacyHibernationManagerImpl::broadcast(jsg::Lock& js,
+    kj::OneOf<kj::Array<kj::byte>, kj::String> message,
+    kj::Maybe<kj::StringPtr> maybeTag,
+    kj::ArrayPtr<jsg::Ref<api::WebSocket>> except) {
+  auto& context = IoContext::current();
+
+  KJ_IF_SOME(data, message.tryGet<kj::Array<kj::byte>>()) {
+    // `data` aliases a V8 BackingStore. Like api::WebSocket::send(), we copy it while we still
+    // hold the isolate lock; unlike it, we do so once for every recipient.
+    data = kj::heapArray(data.asPtr());
+  }
+  auto shared = kj::refcounted<OutgoingMessage>(kj::mv(message));
+
+  // Messages written directly to hibernating websockets must still wait for output locks, like
+  // those queued on an api::WebSocket. The gate belongs to the Actor, which may be torn down
+  // before a hibernating websocket's send gets to run, so the wait itself stays in the IoContext
+  // and only its outcome is passed on. If the gate breaks, the fulfiller is dropped and the sends
+  // waiting on it fail.
+  kj::Maybe<kj::ForkedPromise<void>> outputLock;
+  auto getOutputLock = [&]() -> kj::Promise<void> {
+    KJ_IF_SOME(lock, outputLock) {
+      return lock.addBranch();
+    }
+    KJ_IF_SOME(wait, context.waitForOutputLocksIfNecessary()) {
+      auto paf = kj::newPromiseAndFulfiller<void>();
+      context.addTask(wait.then([fulfiller = kj::mv(paf.fulfiller)]() mutable {
+        fulfiller->fulfill();
+      }).catch_([](kj::Exception&&) {}));
+      return outputLock.emplace(paf.promise.fork()).addBranch();
+    }
+    return outputLock.emplace(kj::Promise<void>(kj::READY_NOW).fork()).addBranch();
+  };
+
+  uint count = 0;
+  auto sendTo = [&](HibernatableWebSocket& hib) {
+    KJ_SWITCH_ONEOF(hib.activeOrPackage) {
+      KJ_CASE_ONEOF(active, jsg::Ref<api::WebSocket>) {
+        for (auto& excluded: except) {
+          if (excluded.get() == active.get()) return;
+        }
+        // Skip websockets that have sent or received a close message.
+        if (active->getReadyState() != api::WebSocket::READY_STATE_OPEN) return;
+        KJ_SWITCH_ONEOF(shared->content) {
+          KJ_CASE_ONEOF(text, kj::String) {
+            active->send(js, kj::str(text));
+          }
+          KJ_CASE_ONEOF(data, kj::Array<kj::byte>) {
+            // send() copies binary messages before returning, so it can borrow our copy.
+            active->send(js,
+                kj::Array<kj::byte>(data.begin(), data.size(), kj::NullArrayDisposer::instance));
+          }
+        }
+      }
+      KJ_CASE_ONEOF(package, api::WebSocket::HibernationPackage) {
+        // A hibernating websocket is never in `except`: the caller would hold a reference to it,
+        // and it would have been woken up.
+        if (package.closedOutgoingConnection || hib.ws == kj::none) return;
+        // The send runs on its own; `pendingSends` keeps it alive. A websocket that was
+        // disconnected for falling behind doesn't count as a recipient.
+        if (hib.sendWhileHibernating(kj::addRef(*shared), getOutputLock()) == kj::none) return;
+      }
+    }
+    ++count;
+  };
+
+  KJ_IF_SOME(tag, maybeTag) {
+    KJ_IF_SOME(item, tagToWs.find(tag)) {
+      for (auto& entry: *item->list) {
+        sendTo(KJ_REQUIRE_NONNULL(entry.hibWS));
+      }
+    }
+  } else {
+    for (auto& hib: allWs) {
+      sendTo(*hib);
+    }
+  }
+  return count;
+}
+
 void LegacyHibernationManagerImpl::setWebSocketAutoResponse(
     kj::Maybe<kj::StringPtr> request, kj::Maybe<kj::StringPtr> response) {
   KJ_IF_SOME(req, request) {
@@ -307,85 +447,227 @@ kj::Promise<void> LegacyHibernationManagerImpl::handleSocketTermination(
   }
 }
 
+namespace {
+
+// While an event is being delivered, we keep receiving on its websocket up to these limits, so
+// that whatever arrives in the meantime can be delivered along with the next event.
+constexpr size_t MAX_QUEUED_MESSAGES = 128;
+constexpr size_t MAX_QUEUED_BYTES = 1024 * 1024;
+
+size_t messageSize(const kj::WebSocket::Message& message) {
+  KJ_SWITCH_ONEOF(message) {
+    KJ_CASE_ONEOF(text, kj::String) {
+      return text.size();
+    }
+    KJ_CASE_ONEOF(data, kj::Array<kj::byte>) {
+      return data.size();
+    }
+    KJ_CASE_ONEOF(close, kj::WebSocket::Close) {
+      return close.reason.size();
+    }
+  }
+  KJ_UNREACHABLE;
+}
+
+}  // namespace
+
+struct LegacyHibernationManagerImpl::ReceiveQueue {
+  kj::Vector<kj::WebSocket::Message> messages;
+  size_t bytes = 0;
+
+  // Set once receiveLoop() has stopped, either after a close message or because receive() threw.
+  bool done = false;
+  kj::Maybe<kj::Exception> error;
+
+  // Fulfilled when there is something to deliver, or room to receive more, respectively.
+  kj::Maybe<kj::Own<kj::PromiseFulfiller<void>>> deliverReady;
+  kj::Maybe<kj::Own<kj::PromiseFulfiller<void>>> receiveReady;
+
+  bool isFull() const {
+    return messages.size() >= MAX_QUEUED_MESSAGES || bytes >= MAX_QUEUED_BYTES;
+  }
+
+  void push(kj::WebSocket::Message message) {
+    bytes += messageSize(message);
+    messages.add(kj::mv(message));
+    wake(deliverReady);
+  }
+
+  void finish(kj::Maybe<kj::Exception> exception) {
+    done = true;
+    error = kj::mv(exception);
+    wake(deliverReady);
+  }
+
+  kj::Array<kj::WebSocket::Message> takeAll() {
+    bytes = 0;
+    auto result = messages.releaseAsArray();
+    wake(receiveReady);
+    return result;
+  }
+
+  static kj::Promise<void> wait(kj::Maybe<kj::Own<kj::PromiseFulfiller<void>>>& slot) {
+    auto paf = kj::newPromiseAndFulfiller<void>();
+    slot = kj::mv(paf.fulfiller);
+    return kj::mv(paf.promise);
+  }
+
+  static void wake(kj::Maybe<kj::Own<kj::PromiseFulfiller<void>>>& slot) {
+    KJ_IF_SOME(fulfiller, slot) {
+      fulfiller->fulfill();
+    }
+    slot = kj::none;
+  }
+};
+
 kj::Promise<void> LegacyHibernationManagerImpl::readLoop(HibernatableWebSocket& hib) {
   // Like the api::WebSocket readLoop(), but we dispatch different types of events.
-  auto& ws = *KJ_REQUIRE_NONNULL(hib.ws);
+  //
+  // We keep receiving while an event is being delivered. Waking a hibernated actor takes a while,
+  // and when a burst of messages arrives in the meantime, they are all delivered as part of the
+  // next event rather than setting up a new request for each of them.
+  ReceiveQueue queue;
+  auto receiving = receiveLoop(hib, queue).eagerlyEvaluate(nullptr);
+
   while (true) {
-    kj::WebSocket::Message message = co_await ws.receive();
-    // Note that errors are handled by the callee of `readLoop`, since we throw from `receive()`.
-
-    auto skip = false;
-
-    // If we have a request != kj::none, we can compare it the received message. This also implies
-    // that we have a response set in autoResponsePair.
-    KJ_IF_SOME(req, autoResponsePair->request) {
-      KJ_SWITCH_ONEOF(message) {
-        KJ_CASE_ONEOF(text, kj::String) {
-          if (text == req) {
-            // If the received message matches the one set for auto-response, we must
-            // short-circuit readLoop, store the current timestamp and and automatically respond
-            // with the expected response.
-            TimerChannel& timerChannel = KJ_REQUIRE_NONNULL(timer);
-            // This should count as a new IO event, hence we should call syncTime
-            // otherwise the autoResponseTimestamp wouldn't be accurate.
-            timerChannel.syncTime();
-            // We should have set the timerChannel previously in the hibernation manager.
-            // If we haven't, we aren't able to get the current time.
-            hib.autoResponseTimestamp = timerChannel.now();
-            // We'll store the current timestamp in the HibernatableWebSocket to assure it gets
-            // stored even if the WebSocket is currently hibernating. In that scenario, the timestamp
-            // value will be loaded into the WebSocket during unhibernation.
-            // Copy autoResponsePair->response into a coroutine-local kj::String before either
-            // branch sends it. The hibernated branch's ws.send() borrows the underlying
-            // ArrayPtr across the co_await per kj::WebSocket::send()'s documented contract,
-            // and any concurrent JS call to state.setWebSocketAutoResponse() would reassign
-            // or clear autoResponsePair->response, freeing the buffer while the write is
-            // still in flight. The active branch's sendAutoResponse takes ownership of the
-            // kj::String anyway, so hoisting the copy serves both cases with a single
-            // allocation.
-            auto responseCopy = kj::str(KJ_REQUIRE_NONNULL(autoResponsePair->response));
-            KJ_SWITCH_ONEOF(hib.activeOrPackage) {
-              KJ_CASE_ONEOF(apiWs, jsg::Ref<api::WebSocket>) {
-                // If the actor is not hibernated/If the WebSocket is active, we need to update
-                // autoResponseTimestamp on the active websocket.
-                apiWs->setAutoResponseStatus(hib.autoResponseTimestamp, kj::READY_NOW);
-                // Since we had a request set, we must have and response that's sent back using the
-                // same websocket here. The sending of response is managed in web-socket to avoid
-                // possible racing problems with regular websocket messages.
-                co_await apiWs->sendAutoResponse(kj::mv(responseCopy), ws);
-              }
-              KJ_CASE_ONEOF(package, api::WebSocket::HibernationPackage) {
-                if (!package.closedOutgoingConnection) {
-                  // We need to store the autoResponsePromise because we may instantiate an api::websocket
-                  // If we do that, we have to provide it with the promise to avoid races. This can
-                  // happen if we have a websocket hibernating, that unhibernates and sends a
-                  // message while ws.send() for auto-response is also sending.
-                  auto p = ws.send(responseCopy.asArray()).fork();
-                  hib.autoResponsePromise = p.addBranch();
-                  co_await p;
-                  hib.autoResponsePromise = kj::READY_NOW;
+    while (queue.messages.empty()) {
+      if (queue.done) {
+        // Note that errors are handled by the callee of `readLoop`.
+        KJ_IF_SOME(e, queue.error) {
+          kj::throwFatalException(kj::mv(e));
+        }
+        co_return;
+      }
+      co_await ReceiveQueue::wait(queue.deliverReady);
+    }
+
+    auto messages = queue.takeAll();
+    auto count = messages.size();
+    bool gotClose = messages[count - 1].is<kj::WebSocket::Close>();
+    if (gotClose && count > 1) {
+      // The close gets an event of its own, as that is how it is described to tracing.
+      co_await deliverMessages(hib, messages.slice(0, count - 1));
+      co_await deliverMessages(hib, messages.slice(count - 1, count));
+    } else {
+      co_await deliverMessages(hib, messages);
+    }
+    if (gotClose) {
+      co_return;
+    }
+  }
+}
+
+kj::Promise<void> LegacyHibernationManagerImpl::receiveLoop(
+    HibernatableWebSocket& hib, ReceiveQueue& queue) {
+  auto& ws = *KJ_REQUIRE_NONNULL(hib.ws);
+  try {
+    while (true) {
+      // Don't read ahead without bound while the actor is busy; let the client feel backpressure.
+      while (queue.isFull()) {
+        co_await ReceiveQueue::wait(queue.receiveReady);
+      }
+
+      kj::WebSocket::Message message = co_await ws.receive();
+
+      auto skip = false;
+
+      // If we have a request != kj::none, we can compare it the received message. This also
+      // implies that we have a response set in autoResponsePair.
+      KJ_IF_SOME(req, autoResponsePair->request) {
+        KJ_SWITCH_ONEOF(message) {
+          KJ_CASE_ONEOF(text, kj::String) {
+            if (text == req) {
+              // If the received message matches the one set for auto-response, we must
+              // short-circuit readLoop, store the current timestamp and and automatically respond
+              // with the expected response.
+              TimerChannel& timerChannel = KJ_REQUIRE_NONNULL(timer);
+              // This should count as a new IO event, hence we should call syncTime
+              // otherwise the autoResponseTimestamp wouldn't be accurate.
+              timerChannel.syncTime();
+              // We should have set the timerChannel previously in the hibernation manager.
+              // If we haven't, we aren't able to get the current time.
+              hib.autoResponseTimestamp = timerChannel.now();
+              // We'll store the current timestamp in the HibernatableWebSocket to assure it
+              // gets stored even if the WebSocket is currently hibernating. In that scenario, the
+              // timestamp value will be loaded into the WebSocket during unhibernation.
+              // Copy autoResponsePair->response into a coroutine-local kj::String before either
+              // branch sends it. The hibernated branch's ws.send() borrows the underlying
+              // ArrayPtr across the co_await per kj::WebSocket::send()'s documented contract,
+              // and any concurrent JS call to state.setWebSocketAutoResponse() would reassign
+              // or clear autoResponsePair->response, freeing the buffer while the write is
+              // still in flight. The active branch's sendAutoResponse takes ownership of the
+              // kj::String anyway, so hoisting the copy serves both cases with a single
+              // allocation.
+              auto responseCopy = kj::str(KJ_REQUIRE_NONNULL(autoResponsePair->response));
+              KJ_SWITCH_ONEOF(hib.activeOrPackage) {
+                KJ_CASE_ONEOF(apiWs, jsg::Ref<api::WebSocket>) {
+                  // Messages sent while the websocket was hibernating may still be in flight.
+                  co_await hib.pendingSends.addBranch();
+                  // If the actor is not hibernated/If the WebSocket is active, we need to update
+                  // autoResponseTimestamp on the active websocket.
+                  apiWs->setAutoResponseStatus(hib.autoResponseTimestamp, kj::READY_NOW);
+                  // Since we had a request set, we must have and response that's sent back using
+                  // the same websocket here. The sending of response is managed in web-socket to
+                  // avoid possible racing problems with regular websocket messages.
+                  co_await apiWs->sendAutoResponse(kj::mv(responseCopy), ws);
+                }
+                KJ_CASE_ONEOF(package, api::WebSocket::HibernationPackage) {
+                  if (!package.closedOutgoingConnection) {
+                    // The response goes through `pendingSends` because we may instantiate an
+                    // api::websocket while it's sending, and because a broadcast may be sending
+                    // too. This can happen if we have a websocket hibernating, that unhibernates
+                    // and sends a message while ws.send() for auto-response is also sending.
+                    KJ_IF_SOME(send,
+                        hib.sendWhileHibernating(
+                            kj::refcounted<OutgoingMessage>(kj::mv(responseCopy)))) {
+                      co_await send;
+                    }
+                  }
                 }
               }
+              // If we've sent an auto response message, we should not unhibernate or deliver the
+              // received message to the actor
+              skip = true;
             }
-            // If we've sent an auto response message, we should not unhibernate or deliver the
-            // received message to the actor
-            skip = true;
           }
+          KJ_CASE_ONEOF_DEFAULT {}
         }
-        KJ_CASE_ONEOF_DEFAULT {}
+      }
+
+      if (skip) {
+        continue;
+      }
+
+      auto isClose = message.is<kj::WebSocket::Close>();
+      queue.push(kj::mv(message));
+      if (isClose) {
+        queue.finish(kj::none);
+        co_return;
       }
     }
+  } catch (...) {
+    queue.finish(kj::getCaughtExceptionAsKj());
+  }
+}
 
-    if (skip) {
-      continue;
+kj::Promise<void> LegacyHibernationManagerImpl::deliverMessages(
+    HibernatableWebSocket& hib, kj::ArrayPtr<kj::WebSocket::Message> messages) {
+  // The event handler claims the websocket separately for each message, so each gets its own ID.
+  kj::Vector<kj::String> eventWebSocketIds(messages.size());
+  KJ_DEFER({
+    for (auto& id: eventWebSocketIds) {
+      webSocketsForEventHandler.erase(id);
     }
+  });
 
+  // Build the event params depending on what type of message we got.
+  kj::Maybe<api::HibernatableSocketParams> firstParams;
+  kj::Vector<api::HibernatableSocketParams> followingParams(messages.size() - 1);
+  for (auto& message: messages) {
     auto websocketId = randomUUID(kj::none);
-    auto eventWebSocketId = kj::str(websocketId);
+    eventWebSocketIds.add(kj::str(websocketId));
     webSocketsForEventHandler.insert(kj::str(websocketId), &hib);
-    KJ_DEFER(webSocketsForEventHandler.erase(eventWebSocketId));
 
-    // Build the event params depending on what type of message we got.
     kj::Maybe<api::HibernatableSocketParams> maybeParams;
     KJ_SWITCH_ONEOF(message) {
       KJ_CASE_ONEOF(text, kj::String) {
@@ -404,22 +686,25 @@ kj::Promise<void> LegacyHibernationManagerImpl::readLoop(HibernatableWebSocket&
 
     auto params = kj::mv(KJ_REQUIRE_NONNULL(maybeParams));
     params.setTimeout(eventTimeoutMs);
-    auto isClose = params.isCloseEvent();
-    // Dispatch the event, restoring the trace context captured at acceptWebSocket time.
-    SpanParent userSpanParent = SpanParent(nullptr);
-    KJ_IF_SOME(ctx, hib.userSpanContext) {
-      userSpanParent = SpanParent::fromSpanContext(tracing::SpanContext::clone(ctx));
-    }
-    auto workerInterface = loopback->getWorker({
-      .userSpanParent = kj::mv(userSpanParent),
-    });
-    co_await workerInterface->customEvent(
-        kj::rc<api::HibernatableWebSocketCustomEvent>(hibernationEventType, kj::mv(params), *this)
-            .toOwn());
-    if (isClose) {
-      co_return;
+    if (firstParams == kj::none) {
+      firstParams = kj::mv(params);
+    } else {
+      followingParams.add(kj::mv(params));
     }
   }
+
+  // Dispatch the event, restoring the trace context captured at acceptWebSocket time.
+  SpanParent userSpanParent = SpanParent(nullptr);
+  KJ_IF_SOME(ctx, hib.userSpanContext) {
+    userSpanParent = SpanParent::fromSpanContext(tracing::SpanContext::clone(ctx));
+  }
+  auto workerInterface = loopback->getWorker({
+    .userSpanParent = kj::mv(userSpanParent),
+  });
+  co_await workerInterface->customEvent(
+      kj::rc<api::HibernatableWebSocketCustomEvent>(hibernationEventType,
+          kj::mv(KJ_REQUIRE_NONNULL(firstParams)), *this, followingParams.releaseAsArray())
+          .toOwn());
 }
 
 };  // namespace workerd
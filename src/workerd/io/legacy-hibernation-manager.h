@@ -33,6 +33,14 @@ class LegacyHibernationManagerImpl final: public Worker::Actor::HibernationManag
   kj::Vector<jsg::Ref<api::WebSocket>> getWebSockets(
       jsg::Lock& js, kj::Maybe<kj::StringPtr> tag) override;
 
+  // Sends a message to the websockets associated with the given tag, or to all of them. Active
+  // websockets queue it like any other send(), while hibernating ones are written to directly,
+  // all sharing one copy of the message, so that nothing needs to be woken up.
+  uint broadcast(jsg::Lock& js,
+      kj::OneOf<kj::Array<kj::byte>, kj::String> message,
+      kj::Maybe<kj::StringPtr> tag,
+      kj::ArrayPtr<jsg::Ref<api::WebSocket>> except) override;
+
   // Hibernates all the websockets held by the HibernationManager.
   // This converts our activeOrPackage from an api::WebSocket to a HibernationPackage.
   void hibernateWebSockets(Worker::Lock& lock) override;
@@ -57,6 +65,20 @@ class LegacyHibernationManagerImpl final: public Worker::Actor::HibernationManag
  private:
   class HibernatableWebSocket;
 
+  // A message sent directly on the kj::WebSocket of a hibernating websocket. A broadcast shares
+  // one of these between every websocket it goes to.
+  struct OutgoingMessage final: public kj::Refcounted {
+    kj::OneOf<kj::Array<kj::byte>, kj::String> content;
+
+    explicit OutgoingMessage(kj::OneOf<kj::Array<kj::byte>, kj::String> content)
+        : content(kj::mv(content)) {}
+
+    kj::Promise<void> sendOn(kj::WebSocket& ws) const;
+
+    // The number of bytes of content.
+    size_t size() const;
+  };
+
   kj::Promise<void> handleReadLoop(HibernatableWebSocket& refToHibernatable);
 
   // Each HibernatableWebSocket can have multiple tags, so we want to store a reference
@@ -101,6 +123,16 @@ class LegacyHibernationManagerImpl final: public Worker::Actor::HibernationManag
     // to the api::WebSocket.
     jsg::Ref<api::WebSocket> getActiveOrUnhibernate(jsg::Lock& js);
 
+    // Sends `message` directly on `ws` once `ready` resolves and every message previously sent
+    // this way has been written. The returned promise resolves once this one has been written.
+    //
+    // A peer that doesn't read what we send would otherwise have messages pile up here without
+    // bound. If `message` would take the bytes waiting to be written past a limit, `ws` is aborted
+    // instead, so that the read loop fails and reports the error, and this returns kj::none, as
+    // it does for every send after that.
+    kj::Maybe<kj::Promise<void>> sendWhileHibernating(
+        kj::Own<OutgoingMessage> message, kj::Promise<void> ready = kj::READY_NOW);
+
     kj::ListLink<HibernatableWebSocket> link;
 
     // An array of all the items/nodes that refer to this HibernatableWebSocket.
@@ -139,9 +171,16 @@ class LegacyHibernationManagerImpl final: public Worker::Actor::HibernationManag
     // Stores the last received autoResponseRequest timestamp.
     kj::Maybe<kj::Date> autoResponseTimestamp;
 
-    // Keeps track of the currently ongoing websocket auto-response send promise. This promise may
-    // be moved to api::websocket if an hibernating websocket unhibernates.
-    kj::Promise<void> autoResponsePromise = kj::READY_NOW;
+    // The size of the messages sent by sendWhileHibernating() that haven't been written yet.
+    size_t pendingSendBytes = 0;
+
+    // True once sendWhileHibernating() has aborted `ws` because the peer fell too far behind.
+    bool sendsAborted = false;
+
+    // Resolves once every message sent by sendWhileHibernating() -- auto-responses and broadcasts
+    // -- has been written. If the websocket unhibernates, the api::WebSocket gets a branch of this
+    // so that its own sends don't race with ours.
+    kj::ForkedPromise<void> pendingSends = kj::Promise<void>(kj::READY_NOW).fork();
 
     friend LegacyHibernationManagerImpl;
   };
@@ -158,9 +197,20 @@ class LegacyHibernationManagerImpl final: public Worker::Actor::HibernationManag
   kj::Promise<void> handleSocketTermination(
       HibernatableWebSocket& hib, kj::Maybe<kj::Exception>& maybeError) KJ_WARN_UNUSED_RESULT;
 
+  // Messages received on a websocket that haven't been delivered to the actor yet.
+  struct ReceiveQueue;
+
   // Like the api::WebSocket readLoop(), but we dispatch different types of events.
   kj::Promise<void> readLoop(HibernatableWebSocket& hib);
 
+  // Receives messages from `hib` into `queue`, answering auto-response requests on the way, until
+  // a close message arrives or receiving fails.
+  kj::Promise<void> receiveLoop(HibernatableWebSocket& hib, ReceiveQueue& queue);
+
+  // Dispatches a single event delivering `messages`, in order.
+  kj::Promise<void> deliverMessages(
+      HibernatableWebSocket& hib, kj::ArrayPtr<kj::WebSocket::Message> messages);
+
   // This struct is held by the `tagToWs` hashmap. The key is a StringPtr to tag, and the value
   // is this struct itself.
   struct TagCollection {
@@ -238,6 +238,10 @@ class IsolateObserver: public kj::AtomicRefcounted {
     virtual void locked() {}
     virtual void gcPrologue() {}
     virtual void gcEpilogue() {}
+
+    // Called with the lock held if the thread's event loop was held up for `duration` while the
+    // lock was held. See EventLoopStallDetector.
+    virtual void stalled(kj::Duration duration) {}
   };
 
   // Construct a LockTiming if config.reportScriptLockTiming is true, or if the
@@ -282,6 +286,9 @@ class IsolateObserver: public kj::AtomicRefcounted {
     void gcEpilogue() {
       KJ_IF_SOME(l, lockTiming) l.get()->gcEpilogue();
     }
+    void stalled(kj::Duration duration) {
+      KJ_IF_SOME(l, lockTiming) l.get()->stalled(duration);
+    }
 
    private:
     // The presence of `lockTiming` determines whether or not we need to record timing data. If
@@ -0,0 +1,245 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include <workerd/io/frankenvalue.h>
+#include <workerd/io/trace-stream.h>
+
+#include <capnp/compat/http-over-capnp.h>
+#include <kj/test.h>
+#include <kj/timer.h>
+
+namespace workerd::tracing {
+namespace {
+
+// What the fake tail worker has received: the number of events in each report() call.
+struct Received {
+  kj::Vector<uint> batches;
+
+  // If set, report() calls after the onset fail, as if the connection to the tail worker were lost.
+  bool failAfterOnset = false;
+};
+
+class FakeTailStreamTarget final: public rpc::TailStreamTarget::Server {
+ public:
+  FakeTailStreamTarget(Received& received): received(received) {}
+
+  kj::Promise<void> report(ReportContext context) override {
+    bool isOnset = received.batches.empty();
+    received.batches.add(context.getParams().getEvents().size());
+    if (received.failAfterOnset && !isOnset) {
+      return KJ_EXCEPTION(DISCONNECTED, "tail worker went away");
+    }
+    return kj::READY_NOW;
+  }
+
+ private:
+  Received& received;
+};
+
+class FakeEventDispatcher final: public rpc::EventDispatcher::Server {
+ public:
+  FakeEventDispatcher(Received& received): received(received) {}
+
+  kj::Promise<void> tailStreamSession(TailStreamSessionContext context) override {
+    auto results = context.getResults();
+    results.setTopLevel(kj::heap<FakeTailStreamTarget>(received));
+    results.setResult(EventOutcome::OK);
+    return kj::READY_NOW;
+  }
+
+ private:
+  Received& received;
+};
+
+// Delivers TailStreamCustomEvents over capnp to a FakeEventDispatcher.
+class FakeTailWorker final: public WorkerInterface {
+ public:
+  FakeTailWorker(Received& received)
+      : dispatcher(kj::heap<FakeEventDispatcher>(received)),
+        httpOverCapnpFactory(byteStreamFactory, headerTableBuilder),
+        headerTable(headerTableBuilder.build()) {}
+
+  kj::Promise<CustomEvent::Result> customEvent(kj::Own<CustomEvent> event) override {
+    auto promise = event->sendRpc(
+        httpOverCapnpFactory, byteStreamFactory, getUnsupportedFrankenvalueHandler(), dispatcher);
+    return promise.attach(kj::mv(event));
+  }
+
+  kj::Promise<void> request(kj::HttpMethod,
+      kj::StringPtr,
+      const kj::HttpHeaders&,
+      kj::AsyncInputStream&,
+      kj::HttpService::Response&) override {
+    KJ_UNIMPLEMENTED("FakeTailWorker::request not used");
+  }
+  kj::Promise<void> connect(kj::StringPtr,
+      const kj::HttpHeaders&,
+      kj::AsyncIoStream&,
+      ConnectResponse&,
+      kj::HttpConnectSettings) override {
+    KJ_UNIMPLEMENTED("FakeTailWorker::connect not used");
+  }
+  kj::Promise<void> prewarm(kj::StringPtr) override {
+    KJ_UNIMPLEMENTED("FakeTailWorker::prewarm not used");
+  }
+  kj::Promise<ScheduledResult> runScheduled(kj::Date, kj::StringPtr) override {
+    KJ_UNIMPLEMENTED("FakeTailWorker::runScheduled not used");
+  }
+  kj::Promise<AlarmResult> runAlarm(kj::Date, uint32_t) override {
+    KJ_UNIMPLEMENTED("FakeTailWorker::runAlarm not used");
+  }
+
+ private:
+  rpc::EventDispatcher::Client dispatcher;
+  capnp::ByteStreamFactory byteStreamFactory;
+  kj::HttpHeaderTable::Builder headerTableBuilder;
+  capnp::HttpOverCapnpFactory httpOverCapnpFactory;
+  kj::Own<kj::HttpHeaderTable> headerTable;
+};
+
+class CountingObserver final: public TailStreamObserver {
+ public:
+  void batchSent(uint eventCount, size_t estimatedBytes) override {
+    ++batchesSent;
+    eventsSent += eventCount;
+  }
+  void eventDropped() override {
+    ++eventsDropped;
+  }
+
+  uint batchesSent = 0;
+  uint eventsSent = 0;
+  uint eventsDropped = 0;
+};
+
+struct ErrorCollector final: public kj::TaskSet::ErrorHandler {
+  kj::Vector<kj::Exception> errors;
+
+  void taskFailed(kj::Exception&& exception) override {
+    errors.add(kj::mv(exception));
+  }
+};
+
+// Drives a TailStreamWriter that reports to one FakeTailWorker.
+struct TailStreamWriterTest {
+  kj::EventLoop loop;
+  kj::WaitScope ws{loop};
+  kj::TimerImpl timer{kj::origin<kj::TimePoint>()};
+  Received received;
+  kj::Own<CountingObserver> observer = kj::refcounted<CountingObserver>();
+  ErrorCollector errorCollector;
+  kj::TaskSet waitUntilTasks{errorCollector};
+  InvocationSpanContext context{TraceId(1, 2), TraceId(3, 4), SpanId(5), TraceFlags(0x01)};
+  kj::Own<TailStreamWriter> writer;
+
+  TailStreamWriterTest(TailStreamBatchOptions options) {
+    writer = kj::heap<TailStreamWriter>(kj::arr<kj::Own<WorkerInterface>>(
+                                            kj::heap<FakeTailWorker>(received)),
+        waitUntilTasks, timer, options, kj::addRef(*observer));
+  }
+
+  void reportOnset() {
+    FetchEventInfo fetchInfo(
+        kj::HttpMethod::GET, kj::str("https://example.com"), kj::str("{}"), nullptr);
+    writer->report(context,
+        Onset(SpanId(6), Onset::Info(kj::mv(fetchInfo)), Onset::WorkerInfo{}, nullptr),
+        kj::UNIX_EPOCH, 0);
+  }
+
+  void reportLog(size_t sizeHint) {
+    writer->report(context, Log(kj::UNIX_EPOCH, LogLevel::INFO, kj::str("hello")), kj::UNIX_EPOCH,
+        sizeHint);
+  }
+
+  void reportOutcome() {
+    writer->report(context, Outcome(EventOutcome::OK, 0 * kj::MILLISECONDS, 0 * kj::MILLISECONDS),
+        kj::UNIX_EPOCH, 0);
+  }
+};
+
+KJ_TEST("TailStreamWriter sends a batch once it reaches maxBatchBytes") {
+  TailStreamWriterTest test({.maxBatchBytes = 1000, .maxBatchDelay = 1 * kj::HOURS});
+
+  // The onset is sent by itself right away.
+  test.reportOnset();
+  test.ws.poll();
+  KJ_EXPECT(test.received.batches.asPtr() == kj::arr(1u).asPtr());
+
+  // Later events are held back while the batch is small...
+  test.reportLog(100);
+  test.reportLog(100);
+  test.ws.poll();
+  KJ_EXPECT(test.received.batches.size() == 1);
+
+  // ...and sent together as soon as it's big enough, without waiting for the delay.
+  test.reportLog(1000);
+  test.ws.poll();
+  KJ_EXPECT(test.received.batches.asPtr() == kj::arr(1u, 3u).asPtr());
+  KJ_EXPECT(test.observer->batchesSent == 1);
+  KJ_EXPECT(test.observer->eventsSent == 3);
+
+  // The outcome isn't held back either.
+  test.reportLog(100);
+  test.reportOutcome();
+  test.ws.poll();
+  KJ_EXPECT(test.received.batches.asPtr() == kj::arr(1u, 3u, 2u).asPtr());
+  KJ_EXPECT(test.errorCollector.errors.empty());
+}
+
+KJ_TEST("TailStreamWriter sends a batch once maxBatchDelay has elapsed") {
+  TailStreamWriterTest test({.maxBatchBytes = 1000, .maxBatchDelay = 10 * kj::MILLISECONDS});
+
+  test.reportOnset();
+  test.ws.poll();
+  KJ_EXPECT(test.received.batches.size() == 1);
+
+  test.reportLog(100);
+  test.ws.poll();
+  test.timer.advanceTo(test.timer.now() + 5 * kj::MILLISECONDS);
+  test.reportLog(100);
+  test.ws.poll();
+  KJ_EXPECT(test.received.batches.size() == 1);
+
+  // The delay counts from the first event of the batch.
+  test.timer.advanceTo(test.timer.now() + 5 * kj::MILLISECONDS);
+  test.ws.poll();
+  KJ_EXPECT(test.received.batches.asPtr() == kj::arr(1u, 2u).asPtr());
+  KJ_EXPECT(test.errorCollector.errors.empty());
+}
+
+KJ_TEST("TailStreamWriter without a delay batches events from the same turn") {
+  TailStreamWriterTest test({.maxBatchBytes = 1000});
+
+  test.reportOnset();
+  test.ws.poll();
+
+  test.reportLog(100);
+  test.reportLog(100);
+  test.ws.poll();
+  KJ_EXPECT(test.received.batches.asPtr() == kj::arr(1u, 2u).asPtr());
+  KJ_EXPECT(test.errorCollector.errors.empty());
+}
+
+KJ_TEST("TailStreamWriter stops sending after a report() fails") {
+  TailStreamWriterTest test({.maxBatchBytes = 1000});
+  test.received.failAfterOnset = true;
+
+  test.reportOnset();
+  test.ws.poll();
+  test.reportLog(100);
+  test.ws.poll();
+  KJ_EXPECT(test.received.batches.asPtr() == kj::arr(1u, 1u).asPtr());
+
+  // The failure reaches the waitUntil tasks, and the tail worker gets nothing more.
+  KJ_ASSERT(test.errorCollector.errors.size() == 1);
+  KJ_EXPECT(test.errorCollector.errors[0].getDescription() == "tail worker went away"_kj);
+
+  test.reportLog(100);
+  test.reportOutcome();
+  test.ws.poll();
+  KJ_EXPECT(test.received.batches.size() == 2);
+}
+
+}  // namespace
+}  // namespace workerd::tracing
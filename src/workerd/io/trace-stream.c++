@@ -1121,9 +1121,16 @@ kj::Promise<WorkerInterface::CustomEvent::Result> TailStreamCustomEvent::sendRpc
   }
 }
 
-TailStreamWriter::TailStreamWriter(Pending pending, kj::TaskSet& waitUntilTasks)
+TailStreamWriter::TailStreamWriter(Pending pending,
+    kj::TaskSet& waitUntilTasks,
+    kj::Maybe<kj::Timer&> timer,
+    TailStreamBatchOptions batchOptions,
+    kj::Maybe<kj::Own<TailStreamObserver>> observer)
     : inner(kj::mv(pending)),
-      waitUntilTasks(waitUntilTasks) {}
+      waitUntilTasks(waitUntilTasks),
+      timer(timer),
+      batchOptions(batchOptions),
+      observer(kj::mv(observer)) {}
 
 bool TailStreamWriter::reportImpl(TailEvent&& event, size_t sizeHint) {
   // In reportImpl, our inner state must be active.
@@ -1176,8 +1183,27 @@ bool TailStreamWriter::reportImpl(TailEvent&& event, size_t sizeHint) {
       // overhead. As long as this estimate is reasonably accurate, we won't need to check the
       // size again when serializing the message.
       active->queueSize += tailSerializationOverhead + sizeHint;
+
+      if (active->sending) {
+        KJ_IF_SOME(o, active->observer) {
+          o->eventBackpressured();
+        }
+      }
     } else {
       active->droppedEvents++;
+      KJ_IF_SOME(o, active->observer) {
+        o->eventDropped();
+      }
+    }
+
+    if (isClosing) {
+      active->closing = true;
+    }
+    KJ_IF_SOME(fulfiller, active->flushFulfiller) {
+      if (fulfiller->isWaiting() &&
+          (active->closing || active->queueSize >= active->batchOptions.maxBatchBytes)) {
+        fulfiller->fulfill();
+      }
     }
 
     if (!active->pumping) {
@@ -1196,6 +1222,10 @@ kj::Promise<void> TailStreamWriter::pump(kj::Own<Active> current) {
   current->pumping = true;
   KJ_DEFER(current->pumping = false);
 
+  // If the onset hasn't been sent yet, we don't hold anything back: the onset must go out
+  // immediately, and everything else will have queued up behind it by the time it returns.
+  bool holdBack = current->onsetSeen;
+
   try {
     if (!current->onsetSeen) {
       // Our first event... yay! Our first job here will be to dispatch
@@ -1226,16 +1256,31 @@ kj::Promise<void> TailStreamWriter::pump(kj::Own<Active> current) {
     }
 
     // If we got this far then we have a handler for all of our events.
+    //
+    // If the pump was idle, give the events reported right after this one a chance to share the
+    // same report() call. Events that queued up while a previous report() (including the onset)
+    // was in flight have already waited long enough, so they're sent right away.
+    if (holdBack && !current->closing &&
+        current->queueSize < current->batchOptions.maxBatchBytes) {
+      co_await waitForBatch(*current);
+    }
+
     // Deliver remaining streaming tail events in batches if possible.
     while (!current->queue.empty()) {
       auto builder = KJ_ASSERT_NONNULL(current->capability).reportRequest();
       auto eventsBuilder = builder.initEvents(current->queue.size());
       size_t n = 0;
 
+      KJ_IF_SOME(o, current->observer) {
+        o->batchSent(eventsBuilder.size(), current->queueSize);
+      }
+
       // We're synchronously draining the queue – reset its size.
       current->queueSize = 0;
       current->queue.drainTo([&](TailEvent&& event) { event.copyTo(eventsBuilder[n++]); });
 
+      current->sending = true;
+      KJ_DEFER(current->sending = false);
       auto result = co_await builder.send();
 
       // Note that although we cleared the current.queue above, it is
@@ -1263,15 +1308,34 @@ kj::Promise<void> TailStreamWriter::pump(kj::Own<Active> current) {
   }
 }
 
+kj::Promise<void> TailStreamWriter::waitForBatch(Active& current) {
+  auto paf = kj::newPromiseAndFulfiller<void>();
+  current.flushFulfiller = kj::mv(paf.fulfiller);
+  KJ_DEFER(current.flushFulfiller = kj::none);
+
+  auto delay = current.batchOptions.maxBatchDelay;
+  KJ_IF_SOME(t, current.timer) {
+    if (delay > 0 * kj::MILLISECONDS) {
+      co_return co_await kj::mv(paf.promise).exclusiveJoin(t.afterDelay(delay));
+    }
+  }
+  co_return co_await kj::mv(paf.promise).exclusiveJoin(kj::yield());
+}
+
 // If we are using streaming tail workers, initialize the mechanism that will deliver events
 // to that collection of tail workers.
 kj::Maybe<kj::Own<TailStreamWriter>> initializeTailStreamWriter(
-    kj::Array<kj::Own<WorkerInterface>> streamingTailWorkers, kj::TaskSet& waitUntilTasks) {
+    kj::Array<kj::Own<WorkerInterface>> streamingTailWorkers,
+    kj::TaskSet& waitUntilTasks,
+    kj::Maybe<kj::Timer&> timer,
+    TailStreamBatchOptions batchOptions,
+    kj::Maybe<kj::Own<TailStreamObserver>> observer) {
   if (streamingTailWorkers.size() == 0) {
     return kj::none;
   }
 
-  return kj::heap<TailStreamWriter>(kj::mv(streamingTailWorkers), waitUntilTasks);
+  return kj::heap<TailStreamWriter>(
+      kj::mv(streamingTailWorkers), waitUntilTasks, timer, batchOptions, kj::mv(observer));
 }
 
 void TailStreamWriter::report(const InvocationSpanContext& context,
@@ -1322,7 +1386,8 @@ void TailStreamWriter::report(const InvocationSpanContext& context,
       inner = kj::Vector<kj::Own<Active>>( KJ_MAP(wi, pending) {
         auto customEvent = kj::heap<TailStreamCustomEvent>();
         auto result = customEvent->getCap();
-        auto active = kj::refcounted<Active>(kj::mv(result));
+        auto active = kj::refcounted<Active>(kj::mv(result), timer, batchOptions,
+            observer.map([](kj::Own<TailStreamObserver>& o) { return kj::addRef(*o); }));
 
         // Attach the workerInterface and customEvent to the waitUntil tasks so that they stay alive
         // until tail worker operations including JS execution are complete, including returning the
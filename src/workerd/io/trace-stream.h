@@ -64,6 +64,36 @@ class TailStreamCustomEvent final: public WorkerInterface::CustomEvent {
   kj::Maybe<rpc::TailStreamTarget::Client> clientCap;
 };
 
+// Controls how TailStreamWriter coalesces events into report() calls. The onset event is always
+// sent on its own right away, and events that queue up while a report() is in flight are sent as
+// soon as it returns; these options only govern how long an otherwise idle writer holds back new
+// events in the hope of sending them together.
+struct TailStreamBatchOptions {
+  // Send as soon as the estimated size of the queued events reaches this many bytes.
+  size_t maxBatchBytes = 64 * 1024;
+
+  // Otherwise, send once this much time has passed since the first event of the batch was
+  // queued. If zero (or if the writer has no timer), only events reported within the same event
+  // loop turn -- typically, the same JavaScript execution -- are batched together.
+  kj::Duration maxBatchDelay = 0 * kj::MILLISECONDS;
+};
+
+// Receives delivery statistics from TailStreamWriter. All methods default to no-ops; embedders
+// may override them to surface the counts as metrics.
+class TailStreamObserver: public kj::Refcounted {
+ public:
+  virtual ~TailStreamObserver() noexcept(false) = default;
+
+  // A report() call carrying `eventCount` events was sent to a streaming tail worker.
+  virtual void batchSent(uint eventCount, size_t estimatedBytes) {}
+
+  // An event was dropped because the tail worker's queue was already at its size limit.
+  virtual void eventDropped() {}
+
+  // An event was queued while a previous report() to the same tail worker was still in flight.
+  virtual void eventBackpressured() {}
+};
+
 // A utility class that receives tracing events and generates/reports TailEvents.
 class TailStreamWriter final {
  public:
@@ -79,7 +109,11 @@ class TailStreamWriter final {
   // reported (the onset) we will arrange to acquire tailStream capabilities from each then use
   // those to report the initial onset.
   using Pending = kj::Array<kj::Own<WorkerInterface>>;
-  TailStreamWriter(Pending pending, kj::TaskSet& waitUntilTasks);
+  TailStreamWriter(Pending pending,
+      kj::TaskSet& waitUntilTasks,
+      kj::Maybe<kj::Timer&> timer = kj::none,
+      TailStreamBatchOptions batchOptions = {},
+      kj::Maybe<kj::Own<TailStreamObserver>> observer = kj::none);
   KJ_DISALLOW_COPY_AND_MOVE(TailStreamWriter);
 
   void report(const InvocationSpanContext& context,
@@ -97,6 +131,11 @@ class TailStreamWriter final {
     kj::Maybe<rpc::TailStreamTarget::Client> capability;
     bool pumping = false;
     bool onsetSeen = false;
+    // True while a report() call is in flight.
+    bool sending = false;
+    // True once the outcome event has been queued; nothing else will arrive, so don't hold the
+    // batch back any longer.
+    bool closing = false;
     // Estimated byte size of the queue, used to drop events to avoid excessive memory usage.
     size_t queueSize = 0;
     // The number of tail events we had to drop. We'll send a warning indicating this at the end of
@@ -104,15 +143,35 @@ class TailStreamWriter final {
     uint32_t droppedEvents = 0;
     workerd::util::Queue<TailEvent> queue;
 
-    Active(rpc::TailStreamTarget::Client capability): capability(kj::mv(capability)) {}
+    // Copied from the writer, since pump() may outlive it.
+    kj::Maybe<kj::Timer&> timer;
+    TailStreamBatchOptions batchOptions;
+    kj::Maybe<kj::Own<TailStreamObserver>> observer;
+
+    // Set while pump() is holding back a batch; fulfilled to send it early.
+    kj::Maybe<kj::Own<kj::PromiseFulfiller<void>>> flushFulfiller;
+
+    Active(rpc::TailStreamTarget::Client capability,
+        kj::Maybe<kj::Timer&> timer,
+        TailStreamBatchOptions batchOptions,
+        kj::Maybe<kj::Own<TailStreamObserver>> observer)
+        : capability(kj::mv(capability)),
+          timer(timer),
+          batchOptions(batchOptions),
+          observer(kj::mv(observer)) {}
   };
 
   struct Closed {};
 
   kj::OneOf<Pending, kj::Vector<kj::Own<Active>>, Closed> inner;
   kj::TaskSet& waitUntilTasks;
+  kj::Maybe<kj::Timer&> timer;
+  TailStreamBatchOptions batchOptions;
+  kj::Maybe<kj::Own<TailStreamObserver>> observer;
 
   static kj::Promise<void> pump(kj::Own<Active> current);
+  // Wait until the batch is full, the stream is closing, or the batch delay has elapsed.
+  static kj::Promise<void> waitForBatch(Active& current);
   // Report an event to the tail stream writer.
   // sizeHint: The approximate size of the event, in bytes.
   bool reportImpl(TailEvent&& event, size_t sizeHint);
@@ -123,6 +182,10 @@ class TailStreamWriter final {
 };
 
 kj::Maybe<kj::Own<tracing::TailStreamWriter>> initializeTailStreamWriter(
-    kj::Array<kj::Own<WorkerInterface>> streamingTailWorkers, kj::TaskSet& waitUntilTasks);
+    kj::Array<kj::Own<WorkerInterface>> streamingTailWorkers,
+    kj::TaskSet& waitUntilTasks,
+    kj::Maybe<kj::Timer&> timer = kj::none,
+    TailStreamBatchOptions batchOptions = {},
+    kj::Maybe<kj::Own<TailStreamObserver>> observer = kj::none);
 
 }  // namespace workerd::tracing
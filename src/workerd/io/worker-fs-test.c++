@@ -1,5 +1,7 @@
 #include "worker-fs.h"
 
+#include <workerd/tests/test-fixture.h>
+
 #include <kj/debug.h>
 #include <kj/test.h>
 
@@ -41,5 +43,169 @@ KJ_TEST("TmpDirStoreScope") {
   KJ_EXPECT(!TmpDirStoreScope::hasCurrent());
 }
 
+KJ_TEST("FileSpillPolicy") {
+  auto policy = kj::arc<FileSpillPolicy>(kj::newInMemoryDirectory(kj::nullClock()), 100);
+
+  {
+    FileSpillPolicy::Reservation a(policy.addRef(), 40);
+    FileSpillPolicy::Reservation b(policy.addRef(), 40);
+    KJ_EXPECT(policy->getMemoryUsed() == 80);
+
+    // Only growth that takes the total past the threshold should spill.
+    KJ_EXPECT(!a.wouldExceedThreshold(60));
+    KJ_EXPECT(a.wouldExceedThreshold(61));
+    KJ_EXPECT(!a.wouldExceedThreshold(10));
+
+    b.setNow(10);
+    KJ_EXPECT(policy->getMemoryUsed() == 50);
+    KJ_EXPECT(!a.wouldExceedThreshold(90));
+
+    // A moved-from reservation releases nothing.
+    FileSpillPolicy::Reservation c(kj::mv(a));
+    KJ_EXPECT(policy->getMemoryUsed() == 50);
+  }
+  KJ_EXPECT(policy->getMemoryUsed() == 0);
+
+  auto file = policy->createTemporary();
+  file->write(0, "hello"_kjb);
+  KJ_EXPECT(file->stat().size == 5);
+}
+
+// Reads back the whole contents of `file`.
+kj::Array<kj::byte> readAll(jsg::Lock& js, File& file) {
+  auto result = kj::heapArray<kj::byte>(file.stat(js).size);
+  KJ_ASSERT(file.read(js, 0, result) == result.size());
+  return result;
+}
+
+kj::Array<kj::byte> repeat(kj::byte value, size_t count) {
+  auto result = kj::heapArray<kj::byte>(count);
+  result.asPtr().fill(value);
+  return result;
+}
+
+KJ_TEST("FileSpillPolicy spills a growing file, which keeps working on disk") {
+  auto policy = kj::arc<FileSpillPolicy>(kj::newInMemoryDirectory(kj::nullClock()), 1000);
+  TestFixture fixture({.fileSpillPolicy = policy.addRef()});
+
+  fixture.runInIoContext([&](const TestFixture::Environment& env) {
+    auto& js = env.js;
+    auto file = File::newWritable(js);
+
+    KJ_ASSERT(file->write(js, 0, repeat('a', 600)).get<uint32_t>() == 600);
+    KJ_EXPECT(policy->getMemoryUsed() == 600);
+
+    // Growing the buffer further would take us past the threshold, so the file moves to disk and
+    // stops counting towards it.
+    KJ_ASSERT(file->write(js, 600, repeat('b', 600)).get<uint32_t>() == 600);
+    KJ_EXPECT(policy->getMemoryUsed() == 0);
+    KJ_EXPECT(file->stat(js).size == 1200);
+    {
+      auto contents = readAll(js, *file);
+      KJ_EXPECT(contents.first(600) == repeat('a', 600).asPtr());
+      KJ_EXPECT(contents.slice(600) == repeat('b', 600).asPtr());
+    }
+
+    // Reads past the end return nothing.
+    kj::byte buffer[10];
+    KJ_EXPECT(file->read(js, 1200, buffer) == 0);
+    KJ_EXPECT(file->read(js, 1195, buffer) == 5);
+
+    // Truncating and then extending zero-fills.
+    KJ_EXPECT(file->resize(js, 100) == kj::none);
+    KJ_EXPECT(file->stat(js).size == 100);
+    KJ_EXPECT(file->resize(js, 300) == kj::none);
+    {
+      auto contents = readAll(js, *file);
+      KJ_EXPECT(contents.first(100) == repeat('a', 100).asPtr());
+      KJ_EXPECT(contents.slice(100) == repeat(0, 200).asPtr());
+    }
+
+    // Writing past the end leaves a hole of zeros.
+    KJ_ASSERT(file->write(js, 400, repeat('d', 100)).get<uint32_t>() == 100);
+    {
+      auto contents = readAll(js, *file);
+      KJ_EXPECT(contents.size() == 500);
+      KJ_EXPECT(contents.slice(300, 400) == repeat(0, 100).asPtr());
+      KJ_EXPECT(contents.slice(400) == repeat('d', 100).asPtr());
+    }
+
+    // Filling, with zero or any other value.
+    KJ_EXPECT(file->fill(js, 'c', 200) == kj::none);
+    KJ_EXPECT(file->fill(js, 0, 450) == kj::none);
+    {
+      auto contents = readAll(js, *file);
+      KJ_EXPECT(contents.size() == 500);
+      KJ_EXPECT(contents.first(100) == repeat('a', 100).asPtr());
+      KJ_EXPECT(contents.slice(200, 450) == repeat('c', 250).asPtr());
+      KJ_EXPECT(contents.slice(450) == repeat(0, 50).asPtr());
+    }
+
+    // A clone is copied on disk, and is independent of the original.
+    auto cloneResult = file->clone(js);
+    auto copy = kj::mv(KJ_ASSERT_NONNULL(cloneResult.tryGet<kj::Rc<File>>()));
+    KJ_EXPECT(policy->getMemoryUsed() == 0);
+    KJ_EXPECT(readAll(js, *copy).asPtr() == readAll(js, *file).asPtr());
+    KJ_ASSERT(copy->write(js, 0, repeat('x', 10)).get<uint32_t>() == 10);
+    KJ_EXPECT(readAll(js, *file).first(10) == repeat('a', 10).asPtr());
+
+    // Replacing the contents of a spilled file keeps them on disk.
+    auto small = File::newWritable(js);
+    KJ_ASSERT(small->write(js, 0, repeat('e', 50)).get<uint32_t>() == 50);
+    KJ_EXPECT(policy->getMemoryUsed() == 50);
+    KJ_EXPECT(file->replace(js, small.addRef()) == kj::none);
+    KJ_EXPECT(policy->getMemoryUsed() == 50);
+    KJ_EXPECT(readAll(js, *file).asPtr() == repeat('e', 50).asPtr());
+  });
+
+  // Everything is released with the files.
+  KJ_EXPECT(policy->getMemoryUsed() == 0);
+}
+
+KJ_TEST("FileSpillPolicy counts replaced contents") {
+  auto policy = kj::arc<FileSpillPolicy>(kj::newInMemoryDirectory(kj::nullClock()), 1000);
+  TestFixture fixture({.fileSpillPolicy = policy.addRef()});
+
+  fixture.runInIoContext([&](const TestFixture::Environment& env) {
+    auto& js = env.js;
+
+    // Contents that still fit are kept in memory, and counted.
+    auto source = File::newWritable(js, 400);
+    KJ_EXPECT(policy->getMemoryUsed() == 400);
+    auto inMemory = File::newWritable(js);
+    KJ_EXPECT(inMemory->replace(js, source.addRef()) == kj::none);
+    KJ_EXPECT(policy->getMemoryUsed() == 800);
+    KJ_EXPECT(readAll(js, *inMemory).asPtr() == repeat(0, 400).asPtr());
+
+    // Contents that don't fit are moved to disk.
+    auto spilled = File::newWritable(js);
+    KJ_EXPECT(spilled->replace(js, source.addRef()) == kj::none);
+    KJ_EXPECT(policy->getMemoryUsed() == 800);
+    KJ_EXPECT(readAll(js, *spilled).asPtr() == repeat(0, 400).asPtr());
+  });
+
+  KJ_EXPECT(policy->getMemoryUsed() == 0);
+}
+
+KJ_TEST("FileSpillPolicy creates files larger than the threshold on disk") {
+  auto policy = kj::arc<FileSpillPolicy>(kj::newInMemoryDirectory(kj::nullClock()), 1000);
+  TestFixture fixture({.fileSpillPolicy = policy.addRef()});
+
+  fixture.runInIoContext([&](const TestFixture::Environment& env) {
+    auto& js = env.js;
+
+    auto file = File::newWritable(js, 2000);
+    KJ_EXPECT(policy->getMemoryUsed() == 0);
+    KJ_EXPECT(file->stat(js).size == 2000);
+    KJ_EXPECT(file->stat(js).writable);
+    KJ_EXPECT(readAll(js, *file).asPtr() == repeat(0, 2000).asPtr());
+
+    KJ_ASSERT(file->write(js, 1990, repeat('z', 20)).get<uint32_t>() == 20);
+    auto contents = readAll(js, *file);
+    KJ_EXPECT(contents.size() == 2010);
+    KJ_EXPECT(contents.slice(1990) == repeat('z', 20).asPtr());
+  });
+}
+
 }  // namespace
 }  // namespace workerd
@@ -660,6 +660,17 @@ class DirectoryBase final: public Directory {
   }
 };
 
+// Returns the FileSpillPolicy of the worker whose context is current, if it has one.
+kj::Maybe<kj::Arc<FileSpillPolicy>> tryGetFileSpillPolicy(jsg::Lock& js) {
+  if (!js.v8Isolate->InContext()) return kj::none;
+  KJ_IF_SOME(vfs,
+      jsg::getAlignedPointerFromEmbedderData<VirtualFileSystem>(
+          js.v8Context(), jsg::ContextPointerSlot::VIRTUAL_FILE_SYSTEM)) {
+    return vfs.getFileSpillPolicy();
+  }
+  return kj::none;
+}
+
 // The implementation of the File interface.
 class FileImpl final: public File {
  public:
@@ -680,6 +691,11 @@ class FileImpl final: public File {
       : ownedOrView(Owned(js, kj::mv(owned))),
         lastModified(kj::UNIX_EPOCH) {}
 
+  // Constructor used to create a writable file whose contents are on disk.
+  FileImpl(kj::Own<const kj::File> file, size_t size, kj::Arc<FileSpillPolicy> policy)
+      : ownedOrView(Spilled{kj::mv(file), size, kj::mv(policy)}),
+        lastModified(kj::UNIX_EPOCH) {}
+
   kj::Maybe<FsError> setLastModified(jsg::Lock& js, kj::Date date = kj::UNIX_EPOCH) override {
     if (isWritable()) {
       lastModified = date;
@@ -688,15 +704,26 @@ class FileImpl final: public File {
   }
 
   Stat stat(jsg::Lock& js) override {
+    size_t size;
+    KJ_IF_SOME(spilled, ownedOrView.tryGet<Spilled>()) {
+      size = spilled.size;
+    } else {
+      size = readableView().size();
+    }
     return Stat{
       .type = FsType::FILE,
-      .size = static_cast<uint32_t>(readableView().size()),
+      .size = static_cast<uint32_t>(size),
       .lastModified = lastModified,
       .writable = isWritable(),
     };
   }
 
   uint32_t read(jsg::Lock& js, uint32_t offset, kj::ArrayPtr<kj::byte> buffer) const override {
+    KJ_IF_SOME(spilled, ownedOrView.tryGet<Spilled>()) {
+      if (offset >= spilled.size || buffer.size() == 0) return 0;
+      auto amount = kj::min(buffer.size(), spilled.size - offset);
+      return spilled.file->read(offset, buffer.first(amount));
+    }
     auto data = readableView();
     if (offset >= data.size() || buffer.size() == 0) return 0;
     auto src = data.slice(offset);
@@ -725,12 +752,31 @@ class FileImpl final: public File {
       return FsError::READ_ONLY;
     }
 
-    if (end > writableView().size()) {
-      KJ_IF_SOME(err, resize(js, end)) {
-        return err;
+    KJ_IF_SOME(spilled, ownedOrView.tryGet<Spilled>()) {
+      // Writing past the end leaves a hole, which reads as zeros.
+      spilled.file->write(offset, buffer);
+      spilled.size = kj::max(spilled.size, end);
+      return static_cast<uint32_t>(buffer.size());
+    }
+
+    auto& owned = ownedOrView.get<Owned>();
+    if (end > owned.size) {
+      if (end > owned.data.size()) {
+        // Grow geometrically so that a file built up from many small appends is copied only
+        // O(log n) times rather than once per write.
+        auto capacity = kj::min(kj::max(end, owned.data.size() * 2), maxSize);
+        if (trySpill(owned, capacity)) {
+          return write(js, offset, buffer);
+        }
+        reserve(js, owned, capacity);
       }
+      // Any gap between the old end of file and the offset reads as zeros.
+      if (offset > owned.size) {
+        owned.data.slice(owned.size, offset).fill(0);
+      }
+      owned.size = end;
     }
-    writableView().slice(offset, end).copyFrom(buffer);
+    owned.data.slice(offset, end).copyFrom(buffer);
     return static_cast<uint32_t>(buffer.size());
   }
 
@@ -738,27 +784,36 @@ class FileImpl final: public File {
     if (!isWritable()) {
       return FsError::READ_ONLY;
     }
-    auto& owned = ownedOrView.get<Owned>();
-    if (size == owned.data.size()) return kj::none;  // Nothing to do.
-
     auto maxSize = Worker::Isolate::from(js).getLimitEnforcer().getBlobSizeLimit();
     if (size > maxSize) {
       return FsError::FILE_SIZE_LIMIT_EXCEEDED;
     }
 
-    auto newData = kj::heapArray<kj::byte>(size);
+    KJ_IF_SOME(spilled, ownedOrView.tryGet<Spilled>()) {
+      if (size != spilled.size) {
+        spilled.file->truncate(size);
+        spilled.size = size;
+      }
+      return kj::none;
+    }
 
-    if (size > owned.data.size()) {
-      // To grow the file, we need to allocate a new array, copy the old data over,
-      // and replace the original.
-      auto remaining = newData.asPtr();
-      remaining.write(owned.data);
-      remaining.fill(0);
-    } else {
-      newData.asPtr().copyFrom(owned.data.first(size));
+    auto& owned = ownedOrView.get<Owned>();
+    if (size == owned.size) return kj::none;  // Nothing to do.
+
+    if (size > owned.size) {
+      // An explicit resize states the intended size, so reserve exactly that.
+      if (size > owned.data.size()) {
+        if (trySpill(owned, size)) {
+          return resize(js, size);
+        }
+        reserve(js, owned, size);
+      }
+      owned.data.slice(owned.size, size).fill(0);
+    } else if (size < owned.data.size() / 4) {
+      // Give back the spare capacity once most of it is unused.
+      reserve(js, owned, size);
     }
-    owned.adjustment.setNow(js, newData.size());
-    owned.data = kj::mv(newData);
+    owned.size = size;
     return kj::none;
   }
 
@@ -766,6 +821,21 @@ class FileImpl final: public File {
     if (!isWritable()) {
       return FsError::READ_ONLY;
     }
+    KJ_IF_SOME(spilled, ownedOrView.tryGet<Spilled>()) {
+      size_t start = offset.orDefault(0);
+      if (start >= spilled.size) return kj::none;
+      if (value == 0) {
+        spilled.file->zero(start, spilled.size - start);
+        return kj::none;
+      }
+      kj::byte chunk[4096];
+      kj::arrayPtr(chunk).fill(value);
+      for (size_t pos = start; pos < spilled.size; pos += sizeof(chunk)) {
+        auto amount = kj::min(sizeof(chunk), spilled.size - pos);
+        spilled.file->write(pos, kj::arrayPtr(chunk).first(amount));
+      }
+      return kj::none;
+    }
     auto view = writableView();
     int actualOffset = offset.orDefault(0);
     if (actualOffset >= view.size() || view.size() == 0) return kj::none;
@@ -790,6 +860,10 @@ class FileImpl final: public File {
         tracker.trackField("owned", owned.data);
         return;
       }
+      KJ_CASE_ONEOF(spilled, Spilled) {
+        // The contents are on disk.
+        return;
+      }
       KJ_CASE_ONEOF(view, kj::ArrayPtr<const kj::byte>) {
         return;
       }
@@ -803,10 +877,20 @@ class FileImpl final: public File {
     auto maxSize = Worker::Isolate::from(js).getLimitEnforcer().getBlobSizeLimit();
     KJ_SWITCH_ONEOF(ownedOrView) {
       KJ_CASE_ONEOF(owned, Owned) {
-        if (owned.data.size() > maxSize) [[unlikely]] {
+        if (owned.size > maxSize) [[unlikely]] {
           return FsError::FILE_SIZE_LIMIT_EXCEEDED;
         }
-        kj::Rc<File> file = kj::rc<FileImpl>(js, kj::heapArray<kj::byte>(owned.data));
+        kj::Rc<File> file = kj::rc<FileImpl>(js, kj::heapArray<kj::byte>(owned.contents()));
+        return kj::mv(file);
+      }
+      KJ_CASE_ONEOF(spilled, Spilled) {
+        if (spilled.size > maxSize) [[unlikely]] {
+          return FsError::FILE_SIZE_LIMIT_EXCEEDED;
+        }
+        // Copy on disk rather than reading the contents back into memory.
+        auto copy = spilled.policy->createTemporary();
+        copy->copy(0, *spilled.file, 0, spilled.size);
+        kj::Rc<File> file = kj::rc<FileImpl>(kj::mv(copy), spilled.size, spilled.policy.addRef());
         return kj::mv(file);
       }
       KJ_CASE_ONEOF(view, kj::ArrayPtr<const kj::byte>) {
@@ -833,11 +917,24 @@ class FileImpl final: public File {
     }
 
     auto stat = file->stat(js);
+    KJ_IF_SOME(owned, ownedOrView.tryGet<Owned>()) {
+      if (trySpill(owned, stat.size)) {
+        return replace(js, kj::mv(file));
+      }
+    }
+
     auto buffer = kj::heapArray<kj::byte>(stat.size);
     file->read(js, 0, buffer.asPtr());
+    KJ_IF_SOME(spilled, ownedOrView.tryGet<Spilled>()) {
+      spilled.file->truncate(0);
+      spilled.file->write(0, buffer);
+      spilled.size = buffer.size();
+      lastModified = stat.lastModified;
+      return kj::none;
+    }
     auto& owned = ownedOrView.get<Owned>();
-    owned.adjustment.setNow(js, buffer.size());
-    owned.data = kj::mv(buffer);
+    owned.size = buffer.size();
+    setBuffer(js, owned, kj::mv(buffer));
     lastModified = stat.lastModified;
     return kj::none;
   }
@@ -865,28 +962,85 @@ class FileImpl final: public File {
 
  private:
   struct Owned {
+    // The allocated buffer. Only the first `size` bytes are file contents; the rest is spare
+    // capacity for appends, and is zeroed before it becomes part of the file.
     kj::Array<kj::byte> data;
+    size_t size;
+    // Tracks the whole buffer, including the spare capacity.
     jsg::ExternalMemoryAdjustment adjustment;
+    // Tracks the buffer against the worker's FileSpillPolicy, if it has one.
+    kj::Maybe<FileSpillPolicy::Reservation> spillReservation;
     Owned(jsg::Lock& js, kj::Array<kj::byte>&& data)
         : data(kj::mv(data)),
-          adjustment(js.getExternalMemoryAdjustment(this->data.size())) {}
+          size(this->data.size()),
+          adjustment(js.getExternalMemoryAdjustment(this->data.size())) {
+      KJ_IF_SOME(policy, tryGetFileSpillPolicy(js)) {
+        spillReservation.emplace(kj::mv(policy), this->data.size());
+      }
+    }
+
+    kj::ArrayPtr<kj::byte> contents() {
+      return data.first(size);
+    }
+  };
+  // A writable file whose contents were moved to an anonymous file on disk by the
+  // FileSpillPolicy. The disk file is deleted when this is destroyed.
+  struct Spilled {
+    kj::Own<const kj::File> file;
+    size_t size;
+    kj::Arc<FileSpillPolicy> policy;
   };
   // - Owned: writable, isolate-memory-tracked buffer (see Owned).
+  // - Spilled: writable, stored on disk (see Spilled).
   // - kj::ArrayPtr<const kj::byte>: read-only view into caller-owned memory.
   // - kj::Array<const kj::byte>: read-only buffer owned by this file.
-  // Only the Owned alternative is writable (see isWritable()).
-  kj::OneOf<Owned, kj::ArrayPtr<const kj::byte>, kj::Array<const kj::byte>> ownedOrView;
+  // Only the Owned and Spilled alternatives are writable (see isWritable()).
+  kj::OneOf<Owned, Spilled, kj::ArrayPtr<const kj::byte>, kj::Array<const kj::byte>> ownedOrView;
   kj::Date lastModified;
   mutable kj::Maybe<kj::String> maybeUniqueId;
   mutable kj::Maybe<jsg::ExternalMemoryAdjustment> maybeMemoryAdjustment;
 
   bool isWritable() const {
     // Our file is only writable if it owns the actual data buffer.
-    return ownedOrView.is<Owned>();
+    return ownedOrView.is<Owned>() || ownedOrView.is<Spilled>();
   }
 
   kj::ArrayPtr<kj::byte> writableView() {
-    return KJ_REQUIRE_NONNULL(ownedOrView.tryGet<Owned>()).data.asPtr();
+    return KJ_REQUIRE_NONNULL(ownedOrView.tryGet<Owned>()).contents();
+  }
+
+  // Reallocates the buffer of `owned` to hold `capacity` bytes, keeping the file contents that fit.
+  static void reserve(jsg::Lock& js, Owned& owned, size_t capacity) {
+    auto newData = kj::heapArray<kj::byte>(capacity);
+    owned.size = kj::min(owned.size, capacity);
+    newData.first(owned.size).copyFrom(owned.data.first(owned.size));
+    setBuffer(js, owned, kj::mv(newData));
+  }
+
+  // Replaces the buffer of `owned`, accounting for it against the isolate and the FileSpillPolicy.
+  static void setBuffer(jsg::Lock& js, Owned& owned, kj::Array<kj::byte> data) {
+    owned.adjustment.setNow(js, data.size());
+    KJ_IF_SOME(reservation, owned.spillReservation) {
+      reservation.setNow(data.size());
+    }
+    owned.data = kj::mv(data);
+  }
+
+  // If growing the buffer of `owned` to `capacity` bytes would take the worker's in-memory files
+  // over the spill threshold, moves the contents to disk instead and returns true.
+  bool trySpill(Owned& owned, size_t capacity) {
+    KJ_IF_SOME(reservation, owned.spillReservation) {
+      if (!reservation.wouldExceedThreshold(capacity)) return false;
+
+      auto policy = reservation.getPolicy();
+      auto file = policy->createTemporary();
+      file->write(0, owned.contents());
+      size_t size = owned.size;
+      // Destroying the Owned releases its memory adjustment and reservation.
+      ownedOrView = Spilled{kj::mv(file), size, kj::mv(policy)};
+      return true;
+    }
+    return false;
   }
 
   jsg::ExternalMemoryAdjustment& getAdjustment() {
@@ -899,7 +1053,10 @@ class FileImpl final: public File {
         return view;
       }
       KJ_CASE_ONEOF(owned, Owned) {
-        return owned.data.asPtr().asConst();
+        return owned.data.first(owned.size).asConst();
+      }
+      KJ_CASE_ONEOF(spilled, Spilled) {
+        KJ_FAIL_ASSERT("a spilled file has no in-memory view");
       }
       KJ_CASE_ONEOF(ownedView, kj::Array<const kj::byte>) {
         return ownedView.asPtr();
@@ -927,11 +1084,14 @@ class FdHandle final {
 
 class VirtualFileSystemImpl final: public VirtualFileSystem {
  public:
-  VirtualFileSystemImpl(
-      kj::Own<FsMap> fsMap, kj::Rc<Directory>&& root, kj::Own<VirtualFileSystem::Observer> observer)
+  VirtualFileSystemImpl(kj::Own<FsMap> fsMap,
+      kj::Rc<Directory>&& root,
+      kj::Own<VirtualFileSystem::Observer> observer,
+      kj::Maybe<kj::Arc<FileSpillPolicy>> spillPolicy)
       : fsMap(kj::mv(fsMap)),
         root(kj::mv(root)),
         observer(kj::mv(observer)),
+        spillPolicy(kj::mv(spillPolicy)),
         weakThis(
             kj::rc<WeakRef<VirtualFileSystemImpl>>(kj::Badge<VirtualFileSystemImpl>(), *this)) {}
 
@@ -957,6 +1117,13 @@ class VirtualFileSystemImpl final: public VirtualFileSystem {
     return fsMap->getDevRoot();
   }
 
+  kj::Maybe<kj::Arc<FileSpillPolicy>> getFileSpillPolicy() const override {
+    KJ_IF_SOME(policy, spillPolicy) {
+      return policy.addRef();
+    }
+    return kj::none;
+  }
+
   kj::OneOf<FsError, kj::Rc<OpenedFile>> openFd(
       jsg::Lock& js, const jsg::Url& url, OpenOptions opts = {}) const override {
 
@@ -1149,6 +1316,7 @@ class VirtualFileSystemImpl final: public VirtualFileSystem {
   kj::Own<FsMap> fsMap;
   mutable kj::Rc<Directory> root;
   kj::Own<VirtualFileSystem::Observer> observer;
+  kj::Maybe<kj::Arc<FileSpillPolicy>> spillPolicy;
   mutable kj::Rc<WeakRef<VirtualFileSystemImpl>> weakThis;
   friend class FdHandle;
 
@@ -1283,6 +1451,15 @@ kj::Rc<File> File::newWritable(jsg::Lock& js, kj::Maybe<uint32_t> size) {
   // We will cap the maximum size of the file.
   auto maxSize = Worker::Isolate::from(js).getLimitEnforcer().getBlobSizeLimit();
   auto actualSize = kj::min(size.orDefault(0), maxSize);
+  KJ_IF_SOME(policy, tryGetFileSpillPolicy(js)) {
+    if (actualSize > 0 && policy->wouldExceedThreshold(actualSize)) {
+      auto file = policy->createTemporary();
+      file->truncate(actualSize);
+      kj::Rc<File> result = kj::rc<FileImpl>(kj::mv(file), actualSize, kj::mv(policy));
+      result->countTowardsIsolateLimit(js);
+      return kj::mv(result);
+    }
+  }
   auto data = kj::heapArray<kj::byte>(actualSize);
   if (actualSize > 0) data.asPtr().fill(0);
   auto file = kj::rc<FileImpl>(js, kj::mv(data));
@@ -1298,20 +1475,59 @@ kj::Rc<File> File::newReadable(kj::Array<const kj::byte> data) {
   return kj::rc<FileImpl>(kj::mv(data));
 }
 
-kj::Own<VirtualFileSystem> newVirtualFileSystem(
-    kj::Own<FsMap> fsMap, kj::Rc<Directory>&& root, kj::Own<VirtualFileSystem::Observer> observer) {
-  return kj::heap<VirtualFileSystemImpl>(kj::mv(fsMap), kj::mv(root), kj::mv(observer));
+kj::Own<VirtualFileSystem> newVirtualFileSystem(kj::Own<FsMap> fsMap,
+    kj::Rc<Directory>&& root,
+    kj::Own<VirtualFileSystem::Observer> observer,
+    kj::Maybe<kj::Arc<FileSpillPolicy>> spillPolicy) {
+  return kj::heap<VirtualFileSystemImpl>(
+      kj::mv(fsMap), kj::mv(root), kj::mv(observer), kj::mv(spillPolicy));
 }
 
 kj::Own<VirtualFileSystem> newWorkerFileSystem(kj::Own<FsMap> fsMap,
     kj::Rc<Directory> bundleDirectory,
-    kj::Own<VirtualFileSystem::Observer> observer) {
+    kj::Own<VirtualFileSystem::Observer> observer,
+    kj::Maybe<kj::Arc<FileSpillPolicy>> spillPolicy) {
   // Our root directory is a read-only directory
   Directory::Builder builder;
   builder.addPath(fsMap->getBundlePath(), kj::mv(bundleDirectory));
   builder.addPath(fsMap->getTempPath(), getTmpDirectoryImpl());
   builder.addPath(fsMap->getDevPath(), getDevDirectory());
-  return newVirtualFileSystem(kj::mv(fsMap), builder.finish(), kj::mv(observer));
+  return newVirtualFileSystem(
+      kj::mv(fsMap), builder.finish(), kj::mv(observer), kj::mv(spillPolicy));
+}
+
+FileSpillPolicy::FileSpillPolicy(kj::Own<const kj::Directory> scratch, size_t memoryThreshold)
+    : scratch(kj::mv(scratch)),
+      memoryThreshold(memoryThreshold) {}
+
+kj::Own<const kj::File> FileSpillPolicy::createTemporary() const {
+  return scratch->createTemporary();
+}
+
+FileSpillPolicy::Reservation::Reservation(kj::Arc<FileSpillPolicy> policy, size_t bytes)
+    : policy(kj::mv(policy)),
+      bytes(bytes) {
+  this->policy->memoryUsed += bytes;
+}
+
+FileSpillPolicy::Reservation::Reservation(Reservation&& other)
+    : policy(kj::mv(other.policy)),
+      bytes(other.bytes) {
+  other.bytes = 0;
+}
+
+FileSpillPolicy::Reservation::~Reservation() noexcept(false) {
+  if (bytes > 0) policy->memoryUsed -= bytes;
+}
+
+void FileSpillPolicy::Reservation::setNow(size_t newBytes) {
+  policy->memoryUsed += newBytes;
+  policy->memoryUsed -= bytes;
+  bytes = newBytes;
+}
+
+bool FileSpillPolicy::Reservation::wouldExceedThreshold(size_t newBytes) const {
+  return newBytes > bytes && policy->wouldExceedThreshold(newBytes - bytes);
 }
 
 kj::Rc<Directory> getTmpDirectoryImpl() {
@@ -4,9 +4,12 @@
 #include <workerd/jsg/url.h>
 
 #include <kj/common.h>
+#include <kj/filesystem.h>
 #include <kj/refcount.h>
 #include <kj/time.h>
 
+#include <atomic>
+
 // Every worker instance will have its own root directory (/). In this root
 // directory we will have at least three special directories, the "bundle" root,
 // the "dev" root, and the "temp" root. More special directories can be added
@@ -274,11 +277,10 @@ class File: public kj::Refcounted {
   // filled with zeroes up to the given size, otherwise the file will be empty.
   // The contents of the file will be tracked and counted towards the isolate
   // external memory usage.
-  // If size is not given, the file will be empty. If the intent is to perform
-  // multiple writes to the file, it is recommended to specify a size up front
-  // or to resize the file as appropriate to account for the expected writes.
-  // This will avoid each individual write causing a reallocation of the
-  // internal buffer to accommodate the new data.
+  // If size is not given, the file will be empty. Writes past the end of the
+  // file grow the internal buffer geometrically, so appending is amortized
+  // linear, but if the final size is known it is still cheaper to specify it
+  // up front or to resize the file before writing.
   static kj::Rc<File> newWritable(
       jsg::Lock& js, kj::Maybe<uint32_t> size = kj::none) KJ_WARN_UNUSED_RESULT;
 
@@ -535,6 +537,55 @@ using FsNode = kj::OneOf<kj::Rc<File>, kj::Rc<Directory>, kj::Rc<SymbolicLink>>;
 using FsNodeWithError = kj::OneOf<FsError, kj::Rc<File>, kj::Rc<Directory>, kj::Rc<SymbolicLink>>;
 class FsMap;
 
+// Lets the writable files of a worker move their contents out of memory once, together, they
+// hold more than a threshold. A file that would grow the total past the threshold is moved to an
+// anonymous temporary file in a scratch directory on disk, and is read and written there from
+// then on. The disk file is deleted along with the File, so the lifetime of /tmp contents (see
+// TmpDirStoreScope) is unaffected.
+class FileSpillPolicy final: public kj::AtomicRefcounted {
+ public:
+  // Anonymous files are created in `scratch`. `memoryThreshold` is in bytes.
+  FileSpillPolicy(kj::Own<const kj::Directory> scratch, size_t memoryThreshold);
+
+  kj::Own<const kj::File> createTemporary() const KJ_WARN_UNUSED_RESULT;
+
+  size_t getMemoryUsed() const {
+    return memoryUsed;
+  }
+
+  // True if holding another `bytes` in memory would exceed the threshold.
+  bool wouldExceedThreshold(size_t bytes) const {
+    return memoryUsed + bytes > memoryThreshold;
+  }
+
+  // Counts the memory held by one in-memory file towards the threshold.
+  class Reservation {
+   public:
+    Reservation(kj::Arc<FileSpillPolicy> policy, size_t bytes);
+    Reservation(Reservation&& other);
+    KJ_DISALLOW_COPY(Reservation);
+    ~Reservation() noexcept(false);
+
+    void setNow(size_t newBytes);
+
+    // True if growing this reservation to `newBytes` would exceed the threshold.
+    bool wouldExceedThreshold(size_t newBytes) const;
+
+    kj::Arc<FileSpillPolicy> getPolicy() const {
+      return policy.addRef();
+    }
+
+   private:
+    kj::Arc<FileSpillPolicy> policy;
+    size_t bytes;
+  };
+
+ private:
+  kj::Own<const kj::Directory> scratch;
+  size_t memoryThreshold;
+  std::atomic<size_t> memoryUsed = 0;
+};
+
 // The virtual file system interface. This is the main entry point for accessing the vfs.
 // It is important to always destroy the VirtualFileSystem instance under the isolate lock.
 // The VFS holds a table of Refcounted objects (File, Directory, SymbolicLink) that can only
@@ -598,6 +649,11 @@ class VirtualFileSystem {
   virtual const jsg::Url& getTmpRoot() const KJ_WARN_UNUSED_RESULT = 0;
   virtual const jsg::Url& getDevRoot() const KJ_WARN_UNUSED_RESULT = 0;
 
+  // Returns the policy for moving writable files to disk, if this file system has one.
+  virtual kj::Maybe<kj::Arc<FileSpillPolicy>> getFileSpillPolicy() const KJ_WARN_UNUSED_RESULT {
+    return kj::none;
+  }
+
   // Get the current virtual file system for the current isolate lock.
   static const VirtualFileSystem& current(jsg::Lock&) KJ_WARN_UNUSED_RESULT;
 
@@ -699,8 +755,8 @@ class VirtualFileSystem {
 
 kj::Own<VirtualFileSystem> newVirtualFileSystem(kj::Own<FsMap> fsMap,
     kj::Rc<Directory>&& root,
-    kj::Own<VirtualFileSystem::Observer> observer = kj::heap<VirtualFileSystem::Observer>())
-    KJ_WARN_UNUSED_RESULT;
+    kj::Own<VirtualFileSystem::Observer> observer = kj::heap<VirtualFileSystem::Observer>(),
+    kj::Maybe<kj::Arc<FileSpillPolicy>> spillPolicy = kj::none) KJ_WARN_UNUSED_RESULT;
 
 // The FsMap is a configurable mapping of built-in "known" file system
 // paths to user-configurable locations. It is used to allow user-specified
@@ -805,11 +861,12 @@ class SymbolicLinkRecursionGuardScope final {
 // filesystem contains the worker's own bundled modules/files and a temporary
 // in-memory directory for the worker to use. The filesystem is not shared
 // between workers. The bundle delegate is a virtual directory delegate that
-// provides the directory structure for the worker's bundle.
+// provides the directory structure for the worker's bundle. If `spillPolicy` is given, the
+// worker's writable files move to disk as it directs.
 kj::Own<VirtualFileSystem> newWorkerFileSystem(kj::Own<FsMap> fsMap,
     kj::Rc<Directory> bundleDirectory,
-    kj::Own<VirtualFileSystem::Observer> observer = kj::heap<VirtualFileSystem::Observer>())
-    KJ_WARN_UNUSED_RESULT;
+    kj::Own<VirtualFileSystem::Observer> observer = kj::heap<VirtualFileSystem::Observer>(),
+    kj::Maybe<kj::Arc<FileSpillPolicy>> spillPolicy = kj::none) KJ_WARN_UNUSED_RESULT;
 
 // Exposed only for testing purposes.
 kj::Rc<Directory> getTmpDirectoryImpl() KJ_WARN_UNUSED_RESULT;
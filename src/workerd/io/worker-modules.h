@@ -364,6 +364,9 @@ kj::Maybe<jsg::ModuleRegistry::ModuleInfo> tryCompileLegacyModule(jsg::Lock& js,
               js, modules::legacy::compileJsonGlobal<JsgIsolate>(lock, content.body)));
     }
     KJ_CASE_ONEOF(content, Worker::Script::EsModule) {
+      KJ_IF_SOME(codeCache, content.codeCache) {
+        return jsg::ModuleRegistry::ModuleInfo(js, name, content.body, codeCache, observer);
+      }
       // TODO(soon): Make sure passing nullptr to compile cache is desired.
       return jsg::ModuleRegistry::ModuleInfo(js, name, content.body, nullptr /* compile cache */,
           jsg::ModuleInfoCompileOption::BUNDLE, observer);
@@ -15,6 +15,10 @@ using kj::byte;
 
 class DynamicEnvBuilder;
 
+namespace jsg {
+class EsModuleCodeCache;
+}  // namespace jsg
+
 // Represents the source code for a Worker.
 //
 // Typically the Worker's source is delivered in a capnp message structure. However, workerd vs.
@@ -38,6 +42,10 @@ struct WorkerSource {
     // Module::clone() relies on that invariant to re-point the cloned view at
     // the cloned buffer.
     kj::Maybe<::rust::String> ownBody;
+
+    // If the body is shared with other Workers (e.g. dynamic Workers loaded with identical code),
+    // a cache through which they share the module's compiled code. Must outlive the Script.
+    kj::Maybe<const jsg::EsModuleCodeCache&> codeCache;
   };
   struct CommonJsModule {
     kj::StringPtr body;
@@ -111,7 +119,8 @@ struct WorkerSource {
             KJ_DASSERT(content.body.begin() == own.data() && content.body.size() == own.size());
             ::rust::String ownCopy(own);
             kj::ArrayPtr<const char> bodyView(ownCopy.data(), ownCopy.size());
-            result.content = EsModule{.body = bodyView, .ownBody = kj::mv(ownCopy)};
+            result.content = EsModule{
+              .body = bodyView, .ownBody = kj::mv(ownCopy), .codeCache = content.codeCache};
           } else {
             result.content = content;
           }
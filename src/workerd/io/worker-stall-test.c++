@@ -0,0 +1,92 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+// Tests that isolate locks take the blame for event loop stalls. See EventLoopStallDetector.
+
+#include <workerd/io/observer.h>
+#include <workerd/tests/test-fixture.h>
+#include <workerd/util/event-loop-stall-detector.h>
+
+#include <kj/async-io.h>
+#include <kj/test.h>
+
+#include <atomic>
+
+namespace workerd {
+namespace {
+
+constexpr auto THRESHOLD = 50 * kj::MILLISECONDS;
+
+// Records the stalls reported through LockTiming::stalled().
+class StallObserver final: public IsolateObserver {
+ public:
+  kj::Maybe<kj::Own<LockTiming>> tryCreateLockTiming(
+      kj::OneOf<SpanParent, kj::Maybe<RequestObserver&>> parentOrRequest) const override {
+    return kj::Own<LockTiming>(kj::heap<Timing>(*this));
+  }
+
+  mutable std::atomic<uint> stallCount = 0;
+  mutable std::atomic<int64_t> stallMillis = 0;
+
+ private:
+  class Timing final: public LockTiming {
+   public:
+    Timing(const StallObserver& observer): observer(observer) {}
+
+    void stalled(kj::Duration duration) override {
+      ++observer.stallCount;
+      observer.stallMillis = duration / kj::MILLISECONDS;
+
+      // This runs on the thread holding the lock, from the interrupt requested by the stall
+      // detector, so it can tell the spinning script to stop.
+      auto& js = jsg::Lock::current();
+      js.withinHandleScope([&] { js.global().set(js, "stalled", js.boolean(true)); });
+    }
+
+   private:
+    const StallObserver& observer;
+  };
+};
+
+KJ_TEST("isolate lock is blamed for a stall caused by a busy-looping script") {
+  auto io = kj::setupAsyncIo();
+  auto observer = kj::atomicRefcounted<StallObserver>();
+  TestFixture fixture({
+    .waitScope = io.waitScope,
+    .mainModuleSource = R"(
+      export default {
+        async fetch(req) {
+          // Spins until the stall is reported, with a cap so that a broken detector fails the
+          // test rather than hanging it.
+          for (let i = 0; i < 1e10 && !globalThis.stalled; i++) {}
+          return new Response(globalThis.stalled ? "stalled" : "timed out");
+        }
+      }
+    )"_kj,
+    .isolateObserver = kj::Own<IsolateObserver>(kj::atomicAddRef(*observer)),
+  });
+
+  // Start watching only now, so that a slow isolate startup isn't reported too.
+  EventLoopStallDetector detector(io.provider->getTimer(), THRESHOLD);
+  auto task = detector.run().eagerlyEvaluate(nullptr);
+  io.provider->getTimer().afterDelay(THRESHOLD).wait(io.waitScope);
+
+  {
+    // Logged by reportStall(), from the interrupt.
+    KJ_EXPECT_LOG(WARNING, "event loop stall sample");
+
+    auto response = fixture.runRequest(kj::HttpMethod::GET, "http://example.com/", "");
+    KJ_EXPECT(response.statusCode == 200);
+    KJ_EXPECT(response.body == "stalled", response.body);
+  }
+
+  // Lock::stalled() was called on the detector's thread, and its interrupt reached the lock's
+  // LockTiming on the script's thread, exactly once for the one stall.
+  KJ_EXPECT(detector.getStallCount() == 1);
+  KJ_EXPECT(observer->stallCount == 1);
+  KJ_EXPECT(observer->stallMillis >= THRESHOLD / kj::MILLISECONDS, observer->stallMillis.load());
+}
+
+}  // namespace
+}  // namespace workerd
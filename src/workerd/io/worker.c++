@@ -30,6 +30,7 @@
 #include <workerd/util/autogate.h>
 #include <workerd/util/batch-queue.h>
 #include <workerd/util/color-util.h>
+#include <workerd/util/event-loop-stall-detector.h>
 #include <workerd/util/mimetype.h>
 #include <workerd/util/stream-utils.h>
 #include <workerd/util/thread-scopes.h>
@@ -535,6 +536,13 @@ struct Worker::Isolate::Impl {
   kj::Maybe<kj::Own<v8::CpuProfiler>> profiler;
   ActorCache::SharedLru actorCacheLru;
 
+  // Set by startContinuousProfiling(). Protected by the isolate lock.
+  struct ContinuousProfiler {
+    kj::Own<v8::CpuProfiler> profiler;
+    int samplingIntervalUs;
+  };
+  mutable kj::Maybe<ContinuousProfiler> continuousProfiler;
+
   // Used by JSG/Rust integration.
   ::rust::Box<::workerd::rust::jsg::Realm> realm;
 
@@ -556,11 +564,21 @@ struct Worker::Isolate::Impl {
   // their own thread has blocked waiting for the lock for a long time.
   mutable uint64_t lockSuccessCount = 0;
 
+  struct PendingStall {
+    // The Lock::lockNumber of the lock that was held during the stall.
+    uint64_t lockNumber;
+    kj::Duration duration;
+  };
+
+  // Set by Lock::stalled() for reportStallInterrupt() to pick up. Protected by its own mutex,
+  // since it is written from the stall detector's thread.
+  const kj::MutexGuarded<kj::Maybe<PendingStall>> pendingStall;
+
   // Wrapper around JsgWorkerIsolate::Lock and various RAII objects which help us report metrics,
   // measure instantaneous load, avoid spurious watchdog kills, and defer context destruction.
   //
   // Always use this wrapper in code which may face lock contention (that's mostly everywhere).
-  class Lock {
+  class Lock final: private EventLoopStallDetector::Activity {
 
    public:
     explicit Lock(
@@ -589,7 +607,7 @@ struct Worker::Isolate::Impl {
       WarnAboutIsolateLockScope::maybeWarn();
 
       // Increment the success count to expose forward progress to all threads.
-      __atomic_add_fetch(&impl.lockSuccessCount, 1, __ATOMIC_RELAXED);
+      lockNumber = __atomic_add_fetch(&impl.lockSuccessCount, 1, __ATOMIC_RELAXED);
       metrics.locked();
 
       // We record the current lock so our GC prologue/epilogue callbacks can report GC time via
@@ -607,6 +625,10 @@ struct Worker::Isolate::Impl {
       }
 
       currentApi = isolate.api.get();
+
+      // From here on, if the event loop stalls, the stall is blamed on this lock.
+      isolateId = isolate.getId();
+      stallScope.emplace(*this);
     }
     ~Lock() noexcept(false) {
       currentApi = oldCurrentApi;
@@ -661,6 +683,44 @@ struct Worker::Isolate::Impl {
       metrics.gcEpilogue();
     }
 
+    // Called from reportStallInterrupt() when V8 services the interrupt requested by stalled().
+    void reportStall(const PendingStall& stall) {
+      // If the stalled lock was released before any JavaScript ran again, the current stack
+      // wouldn't tell us anything about the stall.
+      if (stall.lockNumber != lockNumber) return;
+
+      auto duration = stall.duration;
+      metrics.stalled(duration);
+
+      KJ_IF_SOME(exception, kj::runCatchingExceptions([&]() {
+        kj::Vector<kj::String> stack;
+        lock->withinHandleScope([&] {
+          auto trace = v8::StackTrace::CurrentStackTrace(lock->v8Isolate, 10);
+          for (auto i: kj::zeroTo(trace->GetFrameCount())) {
+            auto frame = trace->GetFrame(lock->v8Isolate, i);
+            auto function = frame->GetFunctionName();
+            auto script = frame->GetScriptNameOrSourceURL();
+            stack.add(kj::str(function.IsEmpty() ? kj::str("<anonymous>") : kj::str(function),
+                " (", script.IsEmpty() ? kj::str("<unknown>") : kj::str(script), ':',
+                frame->GetLineNumber(), ':', frame->GetColumn(), ')'));
+          }
+        });
+
+        kj::String request = kj::str("(none)");
+        if (IoContext::hasCurrent()) {
+          auto& context = IoContext::current();
+          request = kj::str(context.getWorker().getScript().getId(), " trace ",
+              context.getInvocationSpanContext().getTraceId().toGoString(),
+              context.getActor() == kj::none ? "" : " (actor)");
+        }
+
+        KJ_LOG(WARNING, "event loop stall sample", isolateId, duration, request,
+            kj::strArray(stack, "\n"));
+      })) {
+        KJ_LOG(ERROR, "failed to report event loop stall", exception);
+      }
+    }
+
     // Call limitEnforcer.exitJs(), and also schedule to call limitEnforcer.reportMetrics()
     // later. Returns true if condemned. We take a mutable reference to it to make sure the caller
     // believes it has exclusive access.
@@ -670,6 +730,8 @@ struct Worker::Isolate::Impl {
     const Impl& impl;
     IsolateObserver::LockRecord metrics;
     ThreadProgressCounter progressCounter;
+    uint64_t lockNumber = 0;
+    kj::StringPtr isolateId;
     bool shouldReportIsolateMetrics = false;
     const Api* oldCurrentApi;
 
@@ -681,8 +743,37 @@ struct Worker::Isolate::Impl {
 
    public:
     kj::Own<jsg::Lock> lock;
+
+   private:
+    // Declared after `lock` so that the lock is no longer blamed for stalls once it is released.
+    kj::Maybe<EventLoopStallDetector::ActivityScope> stallScope;
+
+    // Called on the stall detector's thread. The JavaScript stack can only be inspected from the
+    // thread holding the lock, so this asks V8 to call reportStall() there the next time it checks
+    // for interrupts, i.e. right away if JavaScript is what's holding up the loop.
+    void stalled(kj::Duration duration) const override {
+      KJ_LOG(WARNING, "event loop stalled while holding isolate lock", isolateId, duration);
+      *impl.pendingStall.lockExclusive() = PendingStall{lockNumber, duration};
+      lock->v8Isolate->RequestInterrupt(&reportStallInterrupt, const_cast<Impl*>(&impl));
+    }
   };
 
+  static void reportStallInterrupt(v8::Isolate* isolate, void* data) {
+    auto& self = *static_cast<const Impl*>(data);
+    kj::Maybe<PendingStall> pending;
+    {
+      auto locked = self.pendingStall.lockExclusive();
+      pending = *locked;
+      *locked = kj::none;
+    }
+
+    KJ_IF_SOME(p, pending) {
+      KJ_IF_SOME(lock, self.currentLock) {
+        lock.reportStall(p);
+      }
+    }
+  }
+
   // Protected by v8::Locker -- if v8::Locker::IsLocked(isolate) is true, then it is safe to access
   // this variable.
   mutable kj::Maybe<Lock&> currentLock;
@@ -861,6 +952,58 @@ static void stopProfiling(jsg::Lock& js, v8::CpuProfiler& profiler, cdp::Command
   });
 }
 
+static constexpr kj::StringPtr CONTINUOUS_PROFILE_NAME = "Continuous Profile"_kj;
+
+static void startContinuousProfile(
+    jsg::Lock& js, v8::CpuProfiler& profiler, int samplingIntervalUs) {
+  js.withinHandleScope([&] {
+    v8::CpuProfilingOptions options(v8::kLeafNodeLineNumbers,
+        v8::CpuProfilingOptions::kNoSampleLimit, samplingIntervalUs);
+    profiler.StartProfiling(
+        jsg::v8StrIntern(js.v8Isolate, CONTINUOUS_PROFILE_NAME), kj::mv(options));
+  });
+}
+
+static kj::String describeFrame(const v8::CpuProfileNode& node) {
+  kj::StringPtr function = node.GetFunctionNameStr();
+  kj::StringPtr script = node.GetScriptResourceNameStr();
+  if (function.size() == 0) function = "(anonymous)"_kj;
+  if (script.size() == 0) return kj::str(function);
+  return kj::str(function, ' ', script, ':', node.GetLineNumber());
+}
+
+// Converts `profile` to the collapsed stack format described at
+// Worker::Isolate::takeContinuousProfile().
+static kj::String collapseProfile(const v8::CpuProfile& profile) {
+  struct Unvisited {
+    const v8::CpuProfileNode* node;
+    uint depth;
+  };
+  kj::Vector<Unvisited> unvisited;
+  kj::Vector<kj::String> stack;
+  kj::Vector<kj::String> lines;
+
+  // The root node doesn't represent a frame.
+  auto root = profile.GetTopDownRoot();
+  for (int i = 0; i < root->GetChildrenCount(); i++) {
+    unvisited.add(Unvisited{root->GetChild(i), 0});
+  }
+  while (!unvisited.empty()) {
+    auto next = unvisited.back();
+    unvisited.removeLast();
+
+    stack.truncate(next.depth);
+    stack.add(describeFrame(*next.node));
+    if (next.node->GetHitCount() > 0) {
+      lines.add(kj::str(kj::strArray(stack, ";"), ' ', next.node->GetHitCount(), '\n'));
+    }
+    for (int i = 0; i < next.node->GetChildrenCount(); i++) {
+      unvisited.add(Unvisited{next.node->GetChild(i), next.depth + 1});
+    }
+  }
+  return kj::strArray(lines, "");
+}
+
 }  // anonymous namespace
 
 struct Worker::Script::Impl {
@@ -2800,6 +2943,30 @@ void Worker::Isolate::runInLockScope(
   });
 }
 
+void Worker::Isolate::startContinuousProfiling(
+    jsg::Lock& js, kj::Duration samplingInterval) const {
+  KJ_REQUIRE(impl->continuousProfiler == kj::none, "continuous profiling already started");
+  auto& p = impl->continuousProfiler.emplace(Impl::ContinuousProfiler{
+    .profiler = kj::Own<v8::CpuProfiler>(
+        v8::CpuProfiler::New(js.v8Isolate, v8::kDebugNaming, v8::kLazyLogging),
+        CpuProfilerDisposer::instance),
+    .samplingIntervalUs = static_cast<int>(samplingInterval / kj::MICROSECONDS),
+  });
+  startContinuousProfile(js, *p.profiler, p.samplingIntervalUs);
+}
+
+kj::String Worker::Isolate::takeContinuousProfile(jsg::Lock& js) const {
+  auto& p = KJ_UNWRAP_OR(impl->continuousProfiler, return kj::str());
+  return js.withinHandleScope([&] {
+    auto profile =
+        p.profiler->StopProfiling(jsg::v8StrIntern(js.v8Isolate, CONTINUOUS_PROFILE_NAME));
+    startContinuousProfile(js, *p.profiler, p.samplingIntervalUs);
+    if (profile == nullptr) return kj::str();
+    KJ_DEFER(profile->Delete());
+    return collapseProfile(*profile);
+  });
+}
+
 kj::Promise<Worker::AsyncLock> Worker::Isolate::takeAsyncLockWithoutRequest(
     SpanParent parentSpan) const {
   auto lockTiming = getMetrics().tryCreateLockTiming(kj::mv(parentSpan));
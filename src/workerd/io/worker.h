@@ -494,6 +494,18 @@ class Worker::Isolate: public kj::AtomicRefcounted {
   // particular Worker instance.
   void runInLockScope(LockType lockType, kj::FunctionParam<void(jsg::Lock&)> callback) const;
 
+  // Starts sampling this isolate's JavaScript every `samplingInterval` with a CPU profiler of its
+  // own, independent of any inspector session, for continuous headless profiling. Note that V8
+  // runs a sampling thread for each profiler.
+  void startContinuousProfiling(jsg::Lock& js, kj::Duration samplingInterval) const;
+
+  // Returns the samples taken since continuous profiling started, or since the last call, as
+  // collapsed stacks: one line per stack, outermost frame first, frames separated by `;` and
+  // followed by a space and the number of samples. This is the "folded" format read by
+  // flamegraph.pl, speedscope, and similar tools. Returns an empty string if continuous profiling
+  // wasn't started.
+  kj::String takeContinuousProfile(jsg::Lock& js) const;
+
   bool isInspectorEnabled() const;
 
   // Returns the isolate's V8 inspector, if one exists. An inspector is created either because a
@@ -887,6 +899,13 @@ class Worker::Actor final: public kj::Refcounted {
     virtual void acceptWebSocket(jsg::Ref<api::WebSocket> ws, kj::ArrayPtr<kj::String> tags) = 0;
     virtual kj::Vector<jsg::Ref<api::WebSocket>> getWebSockets(
         jsg::Lock& js, kj::Maybe<kj::StringPtr> tag) = 0;
+    // Sends `message` to every open websocket with the given tag (or to all of them, if no tag is
+    // given) other than those in `except`, without waking hibernated ones. Returns the number of
+    // websockets the message was sent to.
+    virtual uint broadcast(jsg::Lock& js,
+        kj::OneOf<kj::Array<kj::byte>, kj::String> message,
+        kj::Maybe<kj::StringPtr> tag,
+        kj::ArrayPtr<jsg::Ref<api::WebSocket>> except) = 0;
     virtual void hibernateWebSockets(Worker::Lock& lock) = 0;
     virtual void setWebSocketAutoResponse(
         kj::Maybe<kj::StringPtr> request, kj::Maybe<kj::StringPtr> response) = 0;
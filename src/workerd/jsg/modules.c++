@@ -381,6 +381,7 @@ v8::Local<v8::Module> compileEsmModule(jsg::Lock& js,
     kj::StringPtr name,
     kj::ArrayPtr<const char> content,
     kj::ArrayPtr<const kj::byte> compileCache,
+    kj::Maybe<const EsModuleCodeCache&> codeCache,
     ModuleInfoCompileOption option,
     const CompilationObserver& observer) {
   // destroy the observer after compilation finished to indicate the end of the process.
@@ -408,6 +409,10 @@ v8::Local<v8::Module> compileEsmModule(jsg::Lock& js,
     contentStr = jsg::v8Str(js.v8Isolate, content);
   }
 
+  KJ_IF_SOME(cache, codeCache) {
+    return jsg::check(cache.compile(js, contentStr, origin, observer));
+  }
+
   if (compileCache.size() > 0 && compileCache.begin() != nullptr) {
     auto cached =
         std::make_unique<v8::ScriptCompiler::CachedData>(compileCache.begin(), compileCache.size());
@@ -447,7 +452,17 @@ ModuleRegistry::ModuleInfo::ModuleInfo(jsg::Lock& js,
     kj::ArrayPtr<const kj::byte> compileCache,
     ModuleInfoCompileOption flags,
     const CompilationObserver& observer)
-    : ModuleInfo(js, compileEsmModule(js, name, content, compileCache, flags, observer)) {}
+    : ModuleInfo(
+          js, compileEsmModule(js, name, content, compileCache, kj::none, flags, observer)) {}
+
+ModuleRegistry::ModuleInfo::ModuleInfo(jsg::Lock& js,
+    kj::StringPtr name,
+    kj::ArrayPtr<const char> content,
+    const EsModuleCodeCache& codeCache,
+    const CompilationObserver& observer)
+    : ModuleInfo(js,
+          compileEsmModule(
+              js, name, content, nullptr, codeCache, ModuleInfoCompileOption::BUNDLE, observer)) {}
 
 ModuleRegistry::ModuleInfo::ModuleInfo(jsg::Lock& js,
     kj::StringPtr name,
@@ -468,6 +483,72 @@ ModuleRegistry::CapnpModuleInfo::CapnpModuleInfo(
     : fileScope(kj::mv(fileScope)),
       topLevelDecls(kj::mv(topLevelDecls)) {}
 
+v8::MaybeLocal<v8::Module> EsModuleCodeCache::compile(jsg::Lock& js,
+    v8::Local<v8::String> content,
+    v8::ScriptOrigin& origin,
+    const CompilationObserver& observer) const {
+  // Compiling may take a while, so only hold the lock long enough to take a reference to the
+  // cached data.
+  kj::Maybe<kj::Arc<const SharedCachedData>> maybeShared;
+  {
+    auto lock = state.lockShared();
+    KJ_IF_SOME(cached, lock->cachedData) {
+      maybeShared = cached.addRef();
+    }
+  }
+
+  v8::MaybeLocal<v8::Module> result;
+  KJ_IF_SOME(shared, maybeShared) {
+    // V8 takes ownership of the CachedData instance, but not of the buffer it points at, which
+    // `shared` keeps alive.
+    auto data = new v8::ScriptCompiler::CachedData(
+        shared->data->data, shared->data->length, v8::ScriptCompiler::CachedData::BufferNotOwned);
+    v8::ScriptCompiler::Source source(content, origin, data);
+    result = v8::ScriptCompiler::CompileModule(
+        js.v8Isolate, &source, v8::ScriptCompiler::kConsumeCodeCache);
+    if (!data->rejected) {
+      observer.onCompileCacheFound(js.v8Isolate);
+      return result;
+    }
+
+    // V8 compiled the module from scratch instead. This should only happen if the isolates
+    // were configured differently.
+    LOG_WARNING_ONCE("NOSENTRY Shared cached data for an ESM module was rejected");
+    observer.onCompileCacheRejected(js.v8Isolate);
+
+    // Drop the stale data so that the next compile regenerates it, unless another isolate has
+    // already replaced it.
+    auto lock = state.lockExclusive();
+    KJ_IF_SOME(cached, lock->cachedData) {
+      if (&*cached == &*shared) lock->cachedData = kj::none;
+    }
+    return result;
+  }
+
+  bool produce = state.lockExclusive()->misses++ > 0;
+  v8::ScriptCompiler::Source source(content, origin);
+  result = v8::ScriptCompiler::CompileModule(js.v8Isolate, &source);
+
+  v8::Local<v8::Module> module;
+  if (produce && result.ToLocal(&module)) {
+    if (auto ptr = v8::ScriptCompiler::CreateCodeCache(module->GetUnboundModuleScript())) {
+      // Using the technically private kj::_::HeapDisposer to wrap the V8-allocated CachedData in
+      // a kj::Own, as modules-new.c++ does.
+      kj::Own<v8::ScriptCompiler::CachedData> cached(
+          ptr, kj::_::HeapDisposer<v8::ScriptCompiler::CachedData>::instance);
+      auto shared = kj::arc<SharedCachedData>(kj::mv(cached));
+      auto lock = state.lockExclusive();
+      if (lock->cachedData == kj::none) {
+        lock->cachedData = kj::mv(shared);
+        observer.onCompileCacheGenerated(js.v8Isolate);
+      }
+    } else {
+      observer.onCompileCacheGenerationFailed(js.v8Isolate);
+    }
+  }
+  return result;
+}
+
 v8::Local<v8::WasmModuleObject> compileWasmModule(
     jsg::Lock& js, kj::ArrayPtr<const uint8_t> code, const CompilationObserver& observer) {
   // destroy the observer after compilation finishes to indicate the end of the process.
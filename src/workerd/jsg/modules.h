@@ -14,6 +14,7 @@
 
 #include <kj/filesystem.h>
 #include <kj/map.h>
+#include <kj/mutex.h>
 
 namespace workerd::jsg {
 
@@ -55,6 +56,41 @@ enum class ModuleInfoCompileOption {
   BUILTIN,
 };
 
+// Compiled code cache for the source of a bundle ES module that may be compiled in many isolates,
+// e.g. by every dynamic Worker loaded with the same code. The owner of the source decides how long
+// the cache lives. The first isolate to compile the module pays full price; once the same source
+// is compiled again the second isolate serializes its compiled code here, and later isolates
+// consume that instead of parsing from scratch. Only the compiled code is shared: each isolate
+// still instantiates and evaluates the module, so no JS state crosses isolates.
+class EsModuleCodeCache {
+ public:
+  EsModuleCodeCache() = default;
+  KJ_DISALLOW_COPY_AND_MOVE(EsModuleCodeCache);
+
+  // Compiles `source` as a module, consuming or producing the cache as described above.
+  v8::MaybeLocal<v8::Module> compile(jsg::Lock& js,
+      v8::Local<v8::String> source,
+      v8::ScriptOrigin& origin,
+      const CompilationObserver& observer) const;
+
+ private:
+  // Isolates compile from the cached data without holding the lock, so it is refcounted to stay
+  // alive until every compile using it has finished, even if it is replaced meanwhile.
+  struct SharedCachedData: public kj::AtomicRefcounted {
+    explicit SharedCachedData(kj::Own<v8::ScriptCompiler::CachedData> data): data(kj::mv(data)) {}
+
+    kj::Own<v8::ScriptCompiler::CachedData> data;
+  };
+
+  struct State {
+    kj::Maybe<kj::Arc<const SharedCachedData>> cachedData;
+
+    // Number of compiles that found no cached data.
+    uint misses = 0;
+  };
+  kj::MutexGuarded<State> state;
+};
+
 v8::Local<v8::WasmModuleObject> compileWasmModule(
     jsg::Lock& js, kj::ArrayPtr<const uint8_t> code, const CompilationObserver& observer);
 
@@ -178,6 +214,13 @@ class ModuleRegistry {
         ModuleInfoCompileOption flags,
         const CompilationObserver& observer);
 
+    // Compiles a bundle ES module, sharing compiled code through `codeCache`.
+    ModuleInfo(jsg::Lock& js,
+        kj::StringPtr name,
+        kj::ArrayPtr<const char> content,
+        const EsModuleCodeCache& codeCache,
+        const CompilationObserver& observer);
+
     ModuleInfo(jsg::Lock& js,
         kj::StringPtr name,
         kj::Maybe<kj::ArrayPtr<const kj::StringPtr>> maybeExports,
@@ -2,7 +2,7 @@
 // Licensed under the Apache 2.0 license found in the LICENSE file or at:
 //     https://opensource.org/licenses/Apache-2.0
 
-// Tests for container-client JSON decoding.
+// Tests for container-client JSON decoding, and for DockerApiClient against a mock Docker API.
 //
 // These tests verify that JSON responses from the Docker API are decoded into
 // Cap'n Proto messages whose backing storage outlives the decode call. The
@@ -13,6 +13,9 @@
 
 #include "container-client.h"
 
+#include <kj/async-io.h>
+#include <kj/compat/http.h>
+#include <kj/encoding.h>
 #include <kj/test.h>
 
 namespace workerd::server {
@@ -303,5 +306,230 @@ KJ_TEST("ContainerCreateRequest omits empty container privileges") {
   KJ_EXPECT(decodedHostConfig.getSecurityOpt().size() == 0);
 }
 
+// A minimal stand-in for the Docker Engine API, listening on a loopback TCP port. Records each
+// request as "<METHOD> <url>" and counts accepted connections.
+class MockDockerDaemon final: public kj::HttpService, private kj::TaskSet::ErrorHandler {
+ public:
+  explicit MockDockerDaemon(kj::AsyncIoContext& io)
+      : listener(io.provider->getNetwork()
+                     .parseAddress("127.0.0.1", 0)
+                     .wait(io.waitScope)
+                     ->listen()),
+        server(io.provider->getTimer(), table, *this),
+        tasks(*this) {
+    tasks.add(acceptLoop());
+  }
+
+  kj::String getPath() {
+    return kj::str("127.0.0.1:", listener->getPort());
+  }
+
+  kj::Promise<void> request(kj::HttpMethod method,
+      kj::StringPtr url,
+      const kj::HttpHeaders& headers,
+      kj::AsyncInputStream& requestBody,
+      Response& response) override {
+    requests.add(kj::str(method, " ", url));
+    auto requestText = co_await requestBody.readAllText();
+
+    kj::uint status = 200;
+    kj::String body = kj::str("{}");
+    constexpr auto CREATE_PREFIX = "/containers/create?name="_kj;
+    constexpr auto RENAME_SUFFIX = "/rename?name="_kj;
+    if (url.startsWith(CREATE_PREFIX)) {
+      status = 201;
+      created.add(kj::str(url.slice(CREATE_PREFIX.size())));
+      live.add(kj::str(created.back()));
+      createBodies.add(kj::mv(requestText));
+      KJ_IF_SOME(f, onCreated) {
+        f->fulfill();
+        onCreated = kj::none;
+      }
+    } else if (url.startsWith("/containers/json")) {
+      body = kj::str("[",
+          kj::strArray(KJ_MAP(name, live) { return kj::str("{\"Id\":\"", name, "\"}"); }, ","),
+          "]");
+    } else if (method == kj::HttpMethod::DELETE && url.startsWith("/containers/")) {
+      auto end = KJ_ASSERT_NONNULL(url.findFirst('?'));
+      status = removeLive(url.slice("/containers/"_kj.size(), end)) ? 204 : 404;
+      body = kj::str();
+    } else KJ_IF_SOME(pos, url.find(RENAME_SUFFIX)) {
+      auto newName = url.slice(pos + RENAME_SUFFIX.size());
+      if (newName == "claimed") {
+        status = removeLive(url.slice("/containers/"_kj.size(), pos)) ? 204 : 404;
+        body = kj::str();
+      } else if (newName == "conflict") {
+        status = 409;
+      }
+    }
+
+    kj::HttpHeaders responseHeaders(table);
+    auto stream = response.send(status, "OK", responseHeaders, body.size());
+    co_await stream->write(body.asBytes());
+  }
+
+  kj::Vector<kj::String> requests;
+  kj::Vector<kj::String> created;
+  kj::Vector<kj::String> createBodies;
+  // Containers created under their original name, and neither removed nor renamed since.
+  kj::Vector<kj::String> live;
+  uint connections = 0;
+  kj::Maybe<kj::Own<kj::PromiseFulfiller<void>>> onCreated;
+
+ private:
+  bool removeLive(kj::StringPtr name) {
+    for (auto i: kj::indices(live)) {
+      if (live[i] == name) {
+        live.removeAt(i);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  kj::HttpHeaderTable table;
+  kj::Own<kj::ConnectionReceiver> listener;
+  kj::HttpServer server;
+  kj::TaskSet tasks;
+
+  kj::Promise<void> acceptLoop() {
+    for (;;) {
+      auto connection = co_await listener->accept();
+      ++connections;
+      tasks.add(server.listenHttp(kj::mv(connection)));
+    }
+  }
+
+  void taskFailed(kj::Exception&& exception) override {
+    KJ_LOG(ERROR, exception);
+  }
+};
+
+KJ_TEST("DockerApiClient reuses connections across requests") {
+  auto io = kj::setupAsyncIo();
+  MockDockerDaemon daemon(io);
+  auto client = kj::refcounted<DockerApiClient>(
+      io.provider->getTimer(), io.provider->getNetwork(), daemon.getPath());
+
+  for (auto i: kj::zeroTo(3)) {
+    auto endpoint = kj::str("/containers/c", i, "/json");
+    auto response =
+        client->request(kj::HttpMethod::GET, endpoint, kj::none, "application/json"_kj, 1024)
+            .wait(io.waitScope);
+    KJ_EXPECT(response->statusCode == 200);
+  }
+
+  KJ_EXPECT(daemon.requests.size() == 3);
+  KJ_EXPECT(daemon.connections == 1);
+}
+
+KJ_TEST("DockerApiClient coalesces identical in-flight GETs") {
+  auto io = kj::setupAsyncIo();
+  MockDockerDaemon daemon(io);
+  auto client = kj::refcounted<DockerApiClient>(
+      io.provider->getTimer(), io.provider->getNetwork(), daemon.getPath());
+
+  auto first = client->request(
+      kj::HttpMethod::GET, "/networks/bridge"_kj, kj::none, "application/json"_kj, 1024);
+  auto second = client->request(
+      kj::HttpMethod::GET, "/networks/bridge"_kj, kj::none, "application/json"_kj, 1024);
+  auto other = client->request(
+      kj::HttpMethod::GET, "/containers/c/json"_kj, kj::none, "application/json"_kj, 1024);
+
+  KJ_EXPECT(first.wait(io.waitScope)->statusCode == 200);
+  KJ_EXPECT(second.wait(io.waitScope)->statusCode == 200);
+  KJ_EXPECT(other.wait(io.waitScope)->statusCode == 200);
+  KJ_EXPECT(daemon.requests.size() == 2, daemon.requests);
+
+  // Once the first request has completed, the same GET goes to the daemon again.
+  client->request(kj::HttpMethod::GET, "/networks/bridge"_kj, kj::none, "application/json"_kj, 1024)
+      .wait(io.waitScope);
+  KJ_EXPECT(daemon.requests.size() == 3, daemon.requests);
+}
+
+KJ_TEST("DockerApiClient claims pre-created containers") {
+  auto io = kj::setupAsyncIo();
+  MockDockerDaemon daemon(io);
+  auto client = kj::refcounted<DockerApiClient>(io.provider->getTimer(),
+      io.provider->getNetwork(), daemon.getPath(), DockerApiClientOptions{.prewarmedSidecars = 1});
+
+  auto createRequest = R"({"Image":"sidecar"})"_kj;
+
+  // The pool starts out empty, but a miss fills it in the background.
+  KJ_EXPECT(!client->claimPrewarmedContainer(createRequest, "claimed"_kj).wait(io.waitScope));
+  client->onPrewarmPoolIdle().wait(io.waitScope);
+  KJ_ASSERT(daemon.created.size() == 1);
+  KJ_EXPECT(daemon.created[0].startsWith("workerd-prewarmed-"));
+  KJ_EXPECT(daemon.createBodies[0].contains("\"Image\":\"sidecar\""), daemon.createBodies[0]);
+  KJ_EXPECT(daemon.createBodies[0].contains("\"dev.workerd.prewarm-instance\":"),
+      daemon.createBodies[0]);
+
+  KJ_EXPECT(client->claimPrewarmedContainer(createRequest, "claimed"_kj).wait(io.waitScope));
+  auto rename = kj::str("POST /containers/", daemon.created[0], "/rename?name=claimed");
+  KJ_EXPECT(daemon.requests.back() == rename, daemon.requests);
+
+  // A pool for a different create request is tracked separately.
+  KJ_EXPECT(!client->claimPrewarmedContainer(R"({"Image":"other"})"_kj, "claimed"_kj)
+                 .wait(io.waitScope));
+}
+
+KJ_TEST("DockerApiClient keeps a pooled container when the claim fails for another reason") {
+  auto io = kj::setupAsyncIo();
+  MockDockerDaemon daemon(io);
+  auto client = kj::refcounted<DockerApiClient>(io.provider->getTimer(),
+      io.provider->getNetwork(), daemon.getPath(), DockerApiClientOptions{.prewarmedSidecars = 1});
+
+  auto createRequest = R"({"Image":"sidecar"})"_kj;
+  KJ_EXPECT(!client->claimPrewarmedContainer(createRequest, "claimed"_kj).wait(io.waitScope));
+  client->onPrewarmPoolIdle().wait(io.waitScope);
+  KJ_ASSERT(daemon.created.size() == 1);
+
+  // The target name is taken. That's not the pooled container's fault, so the caller falls back
+  // to creating its own while the pooled one stays put.
+  {
+    KJ_EXPECT_LOG(WARNING, "failed to claim prewarmed container");
+    KJ_EXPECT(
+        !client->claimPrewarmedContainer(createRequest, "conflict"_kj).wait(io.waitScope));
+  }
+  client->onPrewarmPoolIdle().wait(io.waitScope);
+  for (auto& request: daemon.requests) {
+    KJ_EXPECT(!request.startsWith("DELETE "), daemon.requests);
+  }
+  KJ_EXPECT(daemon.created.size() == 1);
+
+  KJ_EXPECT(client->claimPrewarmedContainer(createRequest, "claimed"_kj).wait(io.waitScope));
+  auto rename = kj::str("POST /containers/", daemon.created[0], "/rename?name=claimed");
+  KJ_EXPECT(daemon.requests.back() == rename, daemon.requests);
+}
+
+KJ_TEST("DockerApiClient removes its own pooled containers on drain") {
+  auto io = kj::setupAsyncIo();
+  MockDockerDaemon daemon(io);
+  auto client = kj::refcounted<DockerApiClient>(io.provider->getTimer(),
+      io.provider->getNetwork(), daemon.getPath(), DockerApiClientOptions{.prewarmedSidecars = 2});
+
+  auto createRequest = R"({"Image":"sidecar"})"_kj;
+  KJ_EXPECT(!client->claimPrewarmedContainer(createRequest, "claimed"_kj).wait(io.waitScope));
+  client->onPrewarmPoolIdle().wait(io.waitScope);
+  KJ_ASSERT(daemon.live.size() == 2);
+
+  client->drainPrewarmPool().wait(io.waitScope);
+  KJ_EXPECT(daemon.live.size() == 0, daemon.live);
+
+  // The listing is narrowed to this client's pool, not every "workerd-prewarmed-" container.
+  bool listedByLabel = false;
+  for (auto& request: daemon.requests) {
+    if (request.startsWith("GET /containers/json")) {
+      listedByLabel = request.contains(kj::encodeUriComponent("dev.workerd.prewarm-instance="));
+    }
+  }
+  KJ_EXPECT(listedByLabel, daemon.requests);
+
+  // A drained pool is neither claimed from nor refilled.
+  KJ_EXPECT(!client->claimPrewarmedContainer(createRequest, "claimed"_kj).wait(io.waitScope));
+  client->onPrewarmPoolIdle().wait(io.waitScope);
+  KJ_EXPECT(daemon.created.size() == 2);
+}
+
 }  // namespace
 }  // namespace workerd::server
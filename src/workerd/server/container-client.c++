@@ -45,6 +45,9 @@ namespace {
 
 constexpr uint16_t SIDECAR_INGRESS_PORT = 39001;
 
+// Egress port that pre-created sidecars are configured with until they're claimed.
+constexpr uint16_t PREWARMED_SIDECAR_EGRESS_PORT = 0;
+
 constexpr kj::StringPtr SIDECAR_DNS_SERVERS[] = {
   "1.1.1.1"_kj,
   "8.8.8.8"_kj,
@@ -56,7 +59,9 @@ constexpr uint64_t MAX_JSON_RESPONSE_SIZE = 16ULL * 1024 * 1024;
 constexpr kj::StringPtr SNAPSHOT_VOLUME_PREFIX = "workerd-snap-"_kj;
 constexpr kj::StringPtr SNAPSHOT_CLONE_VOLUME_PREFIX = "workerd-snap-clone-"_kj;
 constexpr kj::StringPtr CONTAINER_SNAPSHOT_IMAGE_PREFIX = "workerd-container-snap-"_kj;
+constexpr kj::StringPtr PREWARMED_CONTAINER_PREFIX = "workerd-prewarmed-"_kj;
 constexpr kj::StringPtr SNAPSHOT_VOLUME_CREATED_AT_LABEL = "dev.workerd.snapshot-created-at"_kj;
+constexpr kj::StringPtr PREWARM_INSTANCE_LABEL = "dev.workerd.prewarm-instance"_kj;
 constexpr size_t MAX_SNAPSHOT_IMAGE_ANCESTRY_DEPTH = 128;
 
 constexpr auto SNAPSHOT_STALE_AGE = 30 * kj::DAYS;
@@ -525,18 +530,19 @@ kj::Array<kj::byte> createTarWithFile(
   return tar;
 }
 
-// Shared Docker API HTTP helper. Connects to the Docker socket, sends a request with an
-// optional body, and reads the response as raw bytes.
-kj::Promise<DockerBinaryResponse> dockerApiRequestRaw(kj::Network& network,
-    kj::String dockerPath,
+// One-off HTTP helper. Connects to `address`, sends a request with an optional body, and reads
+// the response as raw bytes. Used for the sidecar's own HTTP API; requests to the Docker socket
+// go through DockerApiClient instead.
+kj::Promise<DockerBinaryResponse> httpRequestRaw(kj::Network& network,
+    kj::String address,
     kj::HttpMethod method,
     kj::String endpoint,
     kj::Maybe<kj::ArrayPtr<const kj::byte>> body,
     kj::StringPtr contentType,
     uint64_t maxResponseSize) {
   kj::HttpHeaderTable headerTable;
-  auto address = co_await network.parseAddress(dockerPath);
-  auto connection = co_await address->connect();
+  auto parsedAddress = co_await network.parseAddress(address);
+  auto connection = co_await parsedAddress->connect();
   auto httpClient = kj::newHttpClient(headerTable, *connection).attach(kj::mv(connection));
   kj::HttpHeaders headers(headerTable);
   headers.setPtr(kj::HttpHeaderId::HOST, "localhost");
@@ -562,8 +568,8 @@ kj::Promise<DockerBinaryResponse> dockerApiRequestRaw(kj::Network& network,
   }
 }
 
-kj::Promise<DockerResponse> dockerApiRequest(kj::Network& network,
-    kj::String dockerPath,
+kj::Promise<DockerResponse> httpJsonRequest(kj::Network& network,
+    kj::String address,
     kj::HttpMethod method,
     kj::String endpoint,
     kj::Maybe<kj::String> body = kj::none) {
@@ -571,13 +577,26 @@ kj::Promise<DockerResponse> dockerApiRequest(kj::Network& network,
   KJ_IF_SOME(b, body) {
     bodyBytes = b.asBytes();
   }
-  auto raw = co_await dockerApiRequestRaw(network, kj::mv(dockerPath), method, kj::mv(endpoint),
+  auto raw = co_await httpRequestRaw(network, kj::mv(address), method, kj::mv(endpoint),
       bodyBytes, "application/json"_kj, MAX_JSON_RESPONSE_SIZE);
   co_return DockerResponse{.statusCode = raw.statusCode, .body = kj::str(raw.body.asChars())};
 }
 
-kj::Promise<DockerBinaryResponse> dockerApiBinaryRequest(kj::Network& network,
-    kj::String dockerPath,
+kj::Promise<DockerResponse> dockerApiRequest(DockerApiClient& docker,
+    kj::HttpMethod method,
+    kj::String endpoint,
+    kj::Maybe<kj::String> body = kj::none) {
+  kj::Maybe<kj::ArrayPtr<const kj::byte>> bodyBytes;
+  KJ_IF_SOME(b, body) {
+    bodyBytes = b.asBytes();
+  }
+  auto response = co_await docker.request(
+      method, endpoint, bodyBytes, "application/json"_kj, MAX_JSON_RESPONSE_SIZE);
+  co_return DockerResponse{
+    .statusCode = response->statusCode, .body = kj::str(response->body.asChars())};
+}
+
+kj::Promise<DockerBinaryResponse> dockerApiBinaryRequest(DockerApiClient& docker,
     kj::HttpMethod method,
     kj::String endpoint,
     kj::Maybe<kj::Array<kj::byte>> body,
@@ -586,25 +605,29 @@ kj::Promise<DockerBinaryResponse> dockerApiBinaryRequest(kj::Network& network,
   KJ_IF_SOME(b, body) {
     bodyBytes = b.asPtr();
   }
-  co_return co_await dockerApiRequestRaw(network, kj::mv(dockerPath), method, kj::mv(endpoint),
-      bodyBytes, "application/x-tar"_kj, maxResponseSize);
+  auto response = co_await docker.request(
+      method, endpoint, bodyBytes, "application/x-tar"_kj, maxResponseSize);
+  // A coalesced GET response is shared with other callers, so only take its body if it's ours.
+  auto result = response->isShared() ? kj::heapArray<kj::byte>(response->body)
+                                     : kj::mv(response->body);
+  co_return DockerBinaryResponse{.statusCode = response->statusCode, .body = kj::mv(result)};
 }
 
-kj::Promise<void> deleteVolume(kj::Network& network, kj::String dockerPath, kj::String volumeName) {
+kj::Promise<void> deleteVolume(DockerApiClient& docker, kj::String volumeName) {
   auto response = co_await dockerApiRequest(
-      network, kj::mv(dockerPath), kj::HttpMethod::DELETE, kj::str("/volumes/", volumeName));
+      docker, kj::HttpMethod::DELETE, kj::str("/volumes/", volumeName));
   if (response.statusCode != 204 && response.statusCode != 404) {
     KJ_LOG(WARNING, "failed to delete volume", volumeName, response.statusCode, response.body);
   }
 }
 
 kj::Promise<void> deleteVolumes(
-    kj::Network& network, kj::String dockerPath, kj::Array<kj::String> snapshotCloneVolumes) {
+    DockerApiClient& docker, kj::Array<kj::String> snapshotCloneVolumes) {
   kj::Vector<kj::Promise<void>> volumeDeletes;
   volumeDeletes.reserve(snapshotCloneVolumes.size());
   for (auto& volumeName: snapshotCloneVolumes) {
     auto logName = kj::str(volumeName);
-    volumeDeletes.add(deleteVolume(network, kj::str(dockerPath), kj::mv(volumeName))
+    volumeDeletes.add(deleteVolume(docker, kj::mv(volumeName))
                           .catch_([logName = kj::mv(logName)](kj::Exception&& e) {
       KJ_LOG(WARNING, "failed to delete volume", logName, e);
     }));
@@ -613,10 +636,9 @@ kj::Promise<void> deleteVolumes(
 }
 
 kj::Promise<void> removeContainer(
-    kj::Network& network, kj::String dockerPath, kj::String containerName, bool wait = true) {
+    DockerApiClient& docker, kj::String containerName, bool wait = true) {
   auto endpoint = kj::str("/containers/", containerName, "?force=true");
-  auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::DELETE, kj::mv(endpoint));
+  auto response = co_await dockerApiRequest(docker, kj::HttpMethod::DELETE, kj::mv(endpoint));
   // 204 means the container was removed.
   // 404 means it was already gone.
   // 409 means removal is already in progress, which is fine for our teardown paths.
@@ -626,7 +648,7 @@ kj::Promise<void> removeContainer(
   // If removal succeeded or is already in progress, wait for Docker to report the container as
   // fully removed before proceeding with any follow-up cleanup like deleting mounted volumes.
   if (wait && (response.statusCode == 204 || response.statusCode == 409)) {
-    response = co_await dockerApiRequest(network, kj::mv(dockerPath), kj::HttpMethod::POST,
+    response = co_await dockerApiRequest(docker, kj::HttpMethod::POST,
         kj::str("/containers/", containerName, "/wait?condition=removed"));
     // 200 means Docker observed the removal. 404 means the container disappeared before the wait
     // request was processed, which is also fine.
@@ -873,7 +895,7 @@ kj::Maybe<int64_t> tryGetSnapshotCreatedAt(capnp::JsonValue::Reader labels) {
   return kj::none;
 }
 
-kj::Promise<void> warnAboutStaleSnapshotVolumes(kj::Network& network, kj::String dockerPath) {
+kj::Promise<void> warnAboutStaleSnapshotVolumes(kj::Own<DockerApiClient> docker) {
   capnp::JsonCodec codec;
   codec.handleByAnnotation<docker_api::Docker::VolumeListFilters>();
   capnp::MallocMessageBuilder filterMessage;
@@ -881,7 +903,7 @@ kj::Promise<void> warnAboutStaleSnapshotVolumes(kj::Network& network, kj::String
   auto names = filters.initName(1);
   names.set(0, SNAPSHOT_VOLUME_PREFIX);
 
-  auto response = co_await dockerApiRequest(network, kj::mv(dockerPath), kj::HttpMethod::GET,
+  auto response = co_await dockerApiRequest(*docker, kj::HttpMethod::GET,
       kj::str("/volumes?filters=", kj::encodeUriComponent(codec.encode(filters))));
   if (response.statusCode != 200) {
     co_return;
@@ -950,6 +972,54 @@ kj::String killTokenPidFile(kj::StringPtr killToken) {
   return kj::str("/tmp/.workerd-exec-", killToken, ".pid");
 }
 
+// Encodes the ContainerCreateRequest for a networking sidecar.
+kj::String encodeSidecarCreateRequest(
+    kj::StringPtr image, uint16_t egressPort, kj::StringPtr networkCidr, bool ipv6Enabled) {
+  capnp::JsonCodec codec;
+  codec.handleByAnnotation<docker_api::Docker::ContainerCreateRequest>();
+  capnp::MallocMessageBuilder message;
+  auto jsonRoot = message.initRoot<docker_api::Docker::ContainerCreateRequest>();
+  jsonRoot.setImage(image);
+
+  // determined by the number of flags we need to pass to proxy-everything
+  uint32_t cmdSize =
+      8;  // --http-egress-port <port> --http-ingress-address 0.0.0.0:<port> --docker-gateway-cidr <cidr> --dns-enabled --tls-intercept
+  if (!ipv6Enabled) cmdSize += 1;  // --disable-ipv6
+
+  auto cmd = jsonRoot.initCmd(cmdSize);
+  uint32_t idx = 0;
+  cmd.set(idx++, "--http-egress-port");
+  cmd.set(idx++, kj::str(egressPort));
+  cmd.set(idx++, "--http-ingress-address");
+  cmd.set(idx++, kj::str("0.0.0.0:", SIDECAR_INGRESS_PORT));
+  cmd.set(idx++, "--docker-gateway-cidr");
+  cmd.set(idx++, networkCidr);
+  cmd.set(idx++, "--dns-enabled");
+  cmd.set(idx++, "--tls-intercept");
+  if (!ipv6Enabled) {
+    cmd.set(idx++, "--disable-ipv6");
+  }
+
+  jsonRoot.initExposedPorts().setRaw(kj::str("{\"", SIDECAR_INGRESS_PORT, "/tcp\":{}}"));
+
+  auto hostConfig = jsonRoot.initHostConfig();
+  hostConfig.setPublishAllPorts(true);
+  hostConfig.setNetworkMode("bridge");
+  auto dns = hostConfig.initDns(kj::size(SIDECAR_DNS_SERVERS));
+  for (auto i: kj::indices(SIDECAR_DNS_SERVERS)) {
+    dns.set(i, SIDECAR_DNS_SERVERS[i]);
+  }
+
+  auto extraHosts = hostConfig.initExtraHosts(1);
+  extraHosts.set(0, "host.docker.internal:host-gateway"_kj);
+
+  // Sidecar needs NET_ADMIN capability for iptables/TPROXY
+  auto capAdd = hostConfig.initCapAdd(1);
+  capAdd.set(0, "NET_ADMIN");
+
+  return codec.encode(jsonRoot);
+}
+
 }  // namespace
 
 void configureContainerPrivileges(
@@ -986,6 +1056,248 @@ void configureContainerPrivileges(
   }
 }
 
+// =======================================================================================
+// DockerApiClient
+
+DockerApiClient::DockerApiClient(kj::Timer& timer,
+    kj::Network& network,
+    kj::String dockerPath,
+    DockerApiClientOptions options)
+    : timer(timer),
+      network(network),
+      dockerPath(kj::mv(dockerPath)),
+      options(options),
+      prewarmInstanceId(randomUUID(kj::none)),
+      tasks(*this) {}
+
+DockerApiClient::~DockerApiClient() noexcept(false) {}
+
+kj::Promise<void> DockerApiClient::ensureConnected() {
+  if (httpClient != kj::none) co_return;
+
+  auto parsedAddress = co_await network.parseAddress(dockerPath);
+
+  // A concurrent request may have gotten here first. Keep its client so that the connections it
+  // has pooled aren't thrown away.
+  if (httpClient == kj::none) {
+    httpClient = kj::newHttpClient(timer, headerTable, *parsedAddress);
+    address = kj::mv(parsedAddress);
+  }
+}
+
+kj::Promise<kj::Own<DockerApiClient::Response>> DockerApiClient::request(kj::HttpMethod method,
+    kj::StringPtr endpoint,
+    kj::Maybe<kj::ArrayPtr<const kj::byte>> body,
+    kj::StringPtr contentType,
+    uint64_t maxResponseSize) {
+  if (method != kj::HttpMethod::GET || body != kj::none) {
+    return sendRequest(method, kj::str(endpoint), body, contentType, maxResponseSize);
+  }
+
+  auto key = kj::str(maxResponseSize, ' ', endpoint);
+  KJ_IF_SOME(inflight, inflightGets.find(key)) {
+    return inflight.addBranch();
+  }
+
+  auto forked = sendRequest(method, kj::str(endpoint), kj::none, contentType, maxResponseSize)
+                    .fork();
+  auto result = forked.addBranch();
+  // The entry lives exactly as long as the first caller's branch. Later callers hold branches of
+  // their own, so the request keeps going for them even if the first caller cancels.
+  auto cleanup = kj::defer([this, key = kj::str(key)]() { inflightGets.erase(key); });
+  inflightGets.insert(kj::mv(key), kj::mv(forked));
+  return result.attach(kj::mv(cleanup));
+}
+
+kj::Promise<kj::Own<DockerApiClient::Response>> DockerApiClient::sendRequest(
+    kj::HttpMethod method,
+    kj::String endpoint,
+    kj::Maybe<kj::ArrayPtr<const kj::byte>> body,
+    kj::StringPtr contentType,
+    uint64_t maxResponseSize) {
+  co_await ensureConnected();
+  auto& client = *KJ_ASSERT_NONNULL(httpClient);
+
+  kj::HttpHeaders headers(headerTable);
+  headers.setPtr(kj::HttpHeaderId::HOST, "localhost");
+
+  // In both cases the body must be read to the end for the connection to go back into the pool.
+  KJ_IF_SOME(requestBody, body) {
+    headers.setPtr(kj::HttpHeaderId::CONTENT_TYPE, contentType);
+    headers.set(kj::HttpHeaderId::CONTENT_LENGTH, kj::str(requestBody.size()));
+
+    auto req = client.request(method, endpoint, headers, requestBody.size());
+    {
+      auto stream = kj::mv(req.body);
+      co_await stream->write(requestBody);
+    }
+    auto response = co_await req.response;
+    auto result = co_await response.body->readAllBytes(maxResponseSize);
+    co_return kj::refcounted<Response>(response.statusCode, kj::mv(result));
+  } else {
+    auto req = client.request(method, endpoint, headers);
+    { auto stream = kj::mv(req.body); }
+    auto response = co_await req.response;
+    auto result = co_await response.body->readAllBytes(maxResponseSize);
+    co_return kj::refcounted<Response>(response.statusCode, kj::mv(result));
+  }
+}
+
+kj::Promise<bool> DockerApiClient::claimPrewarmedContainer(
+    kj::StringPtr createRequestJson, kj::StringPtr name) {
+  if (options.prewarmedSidecars == 0 || prewarmDraining) co_return false;
+
+  auto key = kj::str(createRequestJson);
+  KJ_DEFER(refillPrewarmPool(key));
+
+  for (;;) {
+    kj::Maybe<kj::String> candidate;
+    KJ_IF_SOME(pool, prewarmPools.find(key)) {
+      if (!pool.containerNames.empty()) {
+        candidate = kj::mv(pool.containerNames.back());
+        pool.containerNames.removeLast();
+      }
+    }
+    if (candidate == kj::none) co_return false;
+    auto candidateName = KJ_ASSERT_NONNULL(kj::mv(candidate));
+
+    kj::Maybe<kj::Own<Response>> response;
+    kj::Maybe<kj::Exception> exception;
+    try {
+      response = co_await request(kj::HttpMethod::POST,
+          kj::str("/containers/", candidateName, "/rename?name=", name), kj::none,
+          "application/json"_kj, MAX_JSON_RESPONSE_SIZE);
+    } catch (...) {
+      exception = kj::getCaughtExceptionAsKj();
+    }
+
+    KJ_IF_SOME(r, response) {
+      if (r->statusCode == 204) {
+        co_return true;
+      } else if (r->statusCode == 404) {
+        // Someone else removed it. Try the next one.
+        KJ_LOG(WARNING, "prewarmed container disappeared", candidateName);
+        continue;
+      }
+      KJ_LOG(WARNING, "failed to claim prewarmed container", candidateName, r->statusCode,
+          r->body.asChars());
+    }
+    KJ_IF_SOME(e, exception) {
+      KJ_LOG(WARNING, "failed to claim prewarmed container", candidateName, e);
+    }
+
+    // Most likely `name` is taken or the daemon is struggling, neither of which is the pooled
+    // container's fault. Keep it for the next claim and let the caller create its own.
+    if (!prewarmDraining) {
+      KJ_IF_SOME(pool, prewarmPools.find(key)) {
+        pool.containerNames.add(kj::mv(candidateName));
+        co_return false;
+      }
+    }
+    tasks.add(removeContainer(*this, kj::mv(candidateName), false));
+    co_return false;
+  }
+}
+
+kj::Promise<void> DockerApiClient::drainPrewarmPool() {
+  if (prewarmDraining) co_return;
+  prewarmDraining = true;
+  prewarmPools.clear();
+
+  // Creates still in flight remove their own containers once they finish, so the listing below
+  // only has to catch the ones already pooled.
+  co_await removePrewarmedContainers();
+  co_await tasks.onEmpty();
+}
+
+void DockerApiClient::refillPrewarmPool(kj::StringPtr createRequestJson) {
+  if (prewarmDraining) return;
+  auto& pool = prewarmPools.findOrCreate(createRequestJson,
+      [&]() -> decltype(prewarmPools)::Entry { return {kj::str(createRequestJson), {}}; });
+  while (pool.containerNames.size() + pool.creating < options.prewarmedSidecars) {
+    ++pool.creating;
+    tasks.add(createPrewarmedContainer(kj::str(createRequestJson)));
+  }
+}
+
+kj::Promise<void> DockerApiClient::createPrewarmedContainer(kj::String createRequestJson) {
+  KJ_DEFER(KJ_IF_SOME(pool, prewarmPools.find(createRequestJson)) { --pool.creating; });
+
+  // Tag the container with this client's instance, so that removePrewarmedContainers() finds it
+  // without touching pools that belong to other processes.
+  auto message = decodeJsonResponse<docker_api::Docker::ContainerCreateRequest>(createRequestJson);
+  auto req = message->getRoot<docker_api::Docker::ContainerCreateRequest>();
+  {
+    auto oldLabels = req.disownLabels();
+    auto oldFields = oldLabels.getReader().isObject()
+        ? oldLabels.getReader().getObject()
+        : capnp::List<capnp::JsonValue::Field>::Reader();
+    auto labels = req.initLabels().initObject(oldFields.size() + 1);
+    for (auto i: kj::indices(oldFields)) {
+      labels[i].setName(oldFields[i].getName());
+      labels[i].setValue(oldFields[i].getValue());
+    }
+    labels[oldFields.size()].setName(PREWARM_INSTANCE_LABEL);
+    labels[oldFields.size()].initValue().setString(prewarmInstanceId);
+  }
+  capnp::JsonCodec codec;
+  codec.handleByAnnotation<docker_api::Docker::ContainerCreateRequest>();
+  auto body = codec.encode(req);
+
+  auto name = kj::str(PREWARMED_CONTAINER_PREFIX, randomUUID(kj::none));
+  auto response = co_await request(kj::HttpMethod::POST, kj::str("/containers/create?name=", name),
+      body.asBytes(), "application/json"_kj, MAX_JSON_RESPONSE_SIZE);
+  if (response->statusCode != 201) {
+    KJ_LOG(WARNING, "failed to create prewarmed container", response->statusCode,
+        response->body.asChars());
+    co_return;
+  }
+
+  if (prewarmDraining) {
+    co_await removeContainer(*this, kj::mv(name), false);
+    co_return;
+  }
+  KJ_IF_SOME(pool, prewarmPools.find(createRequestJson)) {
+    pool.containerNames.add(kj::mv(name));
+  }
+}
+
+kj::Promise<void> DockerApiClient::removePrewarmedContainers() {
+  // Claimed containers are renamed, so the name filter leaves them alone, and the label filter
+  // leaves alone the pools of other processes using the same daemon.
+  try {
+    capnp::JsonCodec codec;
+    codec.handleByAnnotation<docker_api::Docker::ContainerListFilters>();
+    capnp::MallocMessageBuilder filterMessage;
+    auto filters = filterMessage.initRoot<docker_api::Docker::ContainerListFilters>();
+    filters.initName(1).set(0, PREWARMED_CONTAINER_PREFIX);
+    filters.initLabel(1).set(0, kj::str(PREWARM_INSTANCE_LABEL, '=', prewarmInstanceId));
+
+    auto response = co_await dockerApiRequest(*this, kj::HttpMethod::GET,
+        kj::str("/containers/json?all=true&filters=",
+            kj::encodeUriComponent(codec.encode(filters))));
+    if (response.statusCode != 200) {
+      KJ_LOG(WARNING, "failed to list prewarmed containers", response.statusCode, response.body);
+      co_return;
+    }
+
+    auto message = decodeJsonResponse<docker_api::Docker::ContainerListResponse>(
+        kj::str("{\"Containers\":", response.body, "}"));
+    auto root = message->getRoot<docker_api::Docker::ContainerListResponse>();
+    kj::Vector<kj::Promise<void>> removals;
+    for (auto container: root.getContainers()) {
+      removals.add(removeContainer(*this, kj::str(container.getId()), false));
+    }
+    co_await kj::joinPromises(removals.releaseAsArray());
+  } catch (...) {
+    KJ_LOG(WARNING, "failed to remove prewarmed containers", kj::getCaughtExceptionAsKj());
+  }
+}
+
+void DockerApiClient::taskFailed(kj::Exception&& exception) {
+  KJ_LOG(WARNING, "prewarmed container pool task failed", exception);
+}
+
 // Represents a parsed egress mapping. IP/CIDR mappings match destination IPs,
 // while hostnameGlob mappings match either HTTP hostnames or TLS SNI depending on protocol.
 // Defined here (not in the header) to avoid pulling kj::OneOf, kj::CidrRange, and
@@ -1006,7 +1318,7 @@ struct ContainerClient::EgressState {
 ContainerClient::ContainerClient(capnp::ByteStreamFactory& byteStreamFactory,
     kj::Timer& timer,
     kj::Network& network,
-    kj::String dockerPath,
+    kj::Own<DockerApiClient> dockerApi,
     kj::String containerName,
     kj::String imageName,
     kj::String containerEgressInterceptorImage,
@@ -1018,7 +1330,7 @@ ContainerClient::ContainerClient(capnp::ByteStreamFactory& byteStreamFactory,
     : byteStreamFactory(byteStreamFactory),
       timer(timer),
       network(network),
-      dockerPath(kj::mv(dockerPath)),
+      dockerApi(kj::mv(dockerApi)),
       containerName(kj::encodeUriComponent(kj::str(containerName))),
       sidecarContainerName(kj::encodeUriComponent(kj::str(containerName, "-proxy"))),
       imageName(kj::mv(imageName)),
@@ -1030,7 +1342,7 @@ ContainerClient::ContainerClient(capnp::ByteStreamFactory& byteStreamFactory,
       channelTokenHandler(channelTokenHandler),
       egressState(kj::heap<EgressState>()) {
   if (!staleSnapshotVolumeCheckScheduled.exchange(true)) {
-    waitUntilTasks.add(warnAboutStaleSnapshotVolumes(network, kj::str(this->dockerPath))
+    waitUntilTasks.add(warnAboutStaleSnapshotVolumes(this->dockerApi->addRef())
                            .catch_([](kj::Exception&& e) {
       KJ_LOG(WARNING, "failed to inspect snapshot volumes for staleness", e);
     }));
@@ -1040,19 +1352,19 @@ ContainerClient::ContainerClient(capnp::ByteStreamFactory& byteStreamFactory,
 ContainerClient::~ContainerClient() noexcept(false) {
   stopEgressListener();
 
-  // Best-effort cleanup for both containers.
-  auto sidecarCleanup =
-      removeContainer(network, kj::str(dockerPath), kj::str(sidecarContainerName), false)
-          .catch_([](kj::Exception&&) {});
+  // Best-effort cleanup for both containers. The promises outlive us, so they hold their own
+  // reference to the DockerApiClient.
+  auto sidecarCleanup = removeContainer(*dockerApi, kj::str(sidecarContainerName), false)
+                            .catch_([](kj::Exception&&) {})
+                            .attach(dockerApi->addRef());
 
   // Also try to delete any cloned snapshot volumes.
   auto volumes = snapshotClones.releaseAsArray();
-  auto mainCleanup = removeContainer(network, kj::str(dockerPath), kj::str(containerName))
+  auto mainCleanup = removeContainer(*dockerApi, kj::str(containerName))
                          .catch_([](kj::Exception&&) {})
-                         .then([&network = network, dockerPath = kj::str(dockerPath),
-                                   volumes = kj::mv(volumes)]() mutable {
-    return deleteVolumes(network, kj::mv(dockerPath), kj::mv(volumes));
-  }).catch_([](kj::Exception&&) {});
+                         .then([&dockerApi = *dockerApi, volumes = kj::mv(volumes)]() mutable {
+    return deleteVolumes(dockerApi, kj::mv(volumes));
+  }).catch_([](kj::Exception&&) {}).attach(dockerApi->addRef());
 
   // Pass the joined cleanup promise to the callback. The callback wraps it with the
   // canceler (so a future client creation can cancel it), stores it so the next
@@ -1490,7 +1802,7 @@ class EgressHttpService final: public kj::HttpService {
 
 kj::Promise<ContainerClient::IPAMConfigResult> ContainerClient::getDockerBridgeIPAMConfig() {
   auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::GET, kj::str("/networks/bridge"));
+      *dockerApi, kj::HttpMethod::GET, kj::str("/networks/bridge"));
   if (response.statusCode == 200) {
     auto message = decodeJsonResponse<docker_api::Docker::NetworkInspectResponse>(response.body);
     auto jsonRoot = message->getRoot<docker_api::Docker::NetworkInspectResponse>();
@@ -1514,7 +1826,7 @@ kj::Promise<bool> ContainerClient::isDaemonIpv6Enabled() {
   // Inspect the default bridge network. When the Docker daemon has "ipv6": true in
   // daemon.json, the default bridge gets an IPv6 IPAM subnet entry (e.g. "fd00::/80").
   auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::GET, kj::str("/networks/bridge"));
+      *dockerApi, kj::HttpMethod::GET, kj::str("/networks/bridge"));
 
   if (response.statusCode != 200) {
     co_return false;
@@ -1575,29 +1887,13 @@ kj::Promise<void> ContainerClient::writeFileToContainer(kj::StringPtr container,
     kj::StringPtr dir,
     kj::StringPtr filename,
     kj::ArrayPtr<const kj::byte> content) {
-  kj::HttpHeaderTable table;
-  auto address = co_await network.parseAddress(kj::str(dockerPath));
-  auto connection = co_await address->connect();
-  auto httpClient = kj::newHttpClient(table, *connection).attach(kj::mv(connection));
-
   auto tar = createTarWithFile(filename, content);
 
-  kj::HttpHeaders headers(table);
-  headers.setPtr(kj::HttpHeaderId::HOST, "localhost");
-  headers.setPtr(kj::HttpHeaderId::CONTENT_TYPE, "application/x-tar");
-  headers.set(kj::HttpHeaderId::CONTENT_LENGTH, kj::str(tar.size()));
-
   auto endpoint = kj::str("/containers/", container, "/archive?path=", kj::encodeUriComponent(dir));
-  auto req = httpClient->request(kj::HttpMethod::PUT, endpoint, headers, tar.size());
-  {
-    auto body = kj::mv(req.body);
-    co_await body->write(tar.asBytes());
-  }
-
-  auto response = co_await req.response;
-  auto result = co_await response.body->readAllText();
+  auto response = co_await dockerApiBinaryRequest(
+      *dockerApi, kj::HttpMethod::PUT, kj::mv(endpoint), kj::mv(tar), MAX_JSON_RESPONSE_SIZE);
   JSG_REQUIRE(response.statusCode == 200, Error, "Failed to write file ", dir, "/", filename,
-      " to container [", response.statusCode, "] ", result);
+      " to container [", response.statusCode, "] ", response.body.asChars());
 }
 
 static constexpr kj::StringPtr cloudflareCaDir = "/etc"_kj;
@@ -1608,7 +1904,7 @@ kj::Promise<void> ContainerClient::readCACert() {
   auto ingressPort = KJ_REQUIRE_NONNULL(
       sidecarIngressHostPort, "Cannot read CA cert: sidecar ingress port not known");
 
-  auto response = co_await dockerApiRequest(
+  auto response = co_await httpJsonRequest(
       network, kj::str("127.0.0.1:", ingressPort), kj::HttpMethod::GET, kj::str("/ca"));
 
   JSG_REQUIRE(response.statusCode == 200, Error,
@@ -1639,8 +1935,7 @@ kj::Promise<void> ContainerClient::injectCACert() {
 kj::Promise<kj::Maybe<ContainerClient::InspectResponse>> ContainerClient::inspectContainer() {
   auto endpoint = kj::str("/containers/", containerName, "/json");
 
-  auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::GET, kj::mv(endpoint));
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::GET, kj::mv(endpoint));
   // We check if the container with the given name exist, and if it's not,
   // we simply return false while avoiding an unnecessary error.
   if (response.statusCode == 404) {
@@ -1676,8 +1971,7 @@ kj::Promise<kj::Maybe<ContainerClient::InspectResponse>> ContainerClient::inspec
 
 kj::Promise<kj::Maybe<ContainerClient::SidecarInspectResponse>> ContainerClient::inspectSidecar() {
   auto endpoint = kj::str("/containers/", sidecarContainerName, "/json");
-  auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::GET, kj::mv(endpoint));
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::GET, kj::mv(endpoint));
 
   if (response.statusCode == 404) {
     co_return kj::none;
@@ -1731,7 +2025,7 @@ kj::Promise<void> ContainerClient::updateSidecarEgressPort(
   jsonRoot.setPort(egressPort);
 
   auto body = codec.encode(jsonRoot);
-  auto response = co_await dockerApiRequest(network, kj::str("127.0.0.1:", ingressHostPort),
+  auto response = co_await httpJsonRequest(network, kj::str("127.0.0.1:", ingressHostPort),
       kj::HttpMethod::PUT, kj::str("/egress"), kj::mv(body));
 
   JSG_REQUIRE(response.statusCode >= 200 && response.statusCode < 300, Error,
@@ -1758,7 +2052,7 @@ kj::Promise<void> ContainerClient::updateSidecarEgressConfig(
   }
 
   auto body = codec.encode(jsonRoot);
-  auto response = co_await dockerApiRequest(network, kj::str("127.0.0.1:", ingressHostPort),
+  auto response = co_await httpJsonRequest(network, kj::str("127.0.0.1:", ingressHostPort),
       kj::HttpMethod::PUT, kj::str("/egress"), kj::mv(body));
 
   JSG_REQUIRE(response.statusCode >= 200 && response.statusCode < 300, Error,
@@ -1835,7 +2129,7 @@ kj::Promise<void> ContainerClient::createContainer(kj::StringPtr effectiveImage,
   }
   configureContainerPrivileges(hostConfig, privileges);
 
-  auto response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
       kj::str("/containers/create?name=", containerName), codec.encode(jsonRoot));
 
   // statusCode 409 refers to "conflict". Occurs when a container with the given name exists.
@@ -1845,9 +2139,9 @@ kj::Promise<void> ContainerClient::createContainer(kj::StringPtr effectiveImage,
   constexpr auto RETRY_DELAY = 100 * kj::MILLISECONDS;
 
   for (int attempt = 0; response.statusCode == 409 && attempt < MAX_RETRIES; ++attempt) {
-    co_await removeContainer(network, kj::str(dockerPath), kj::str(containerName));
+    co_await removeContainer(*dockerApi, kj::str(containerName));
     co_await timer.afterDelay(RETRY_DELAY);
-    response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+    response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
         kj::str("/containers/create?name=", containerName), codec.encode(jsonRoot));
   }
 
@@ -1911,7 +2205,7 @@ kj::Promise<kj::String> ContainerClient::createExec(capnp::List<capnp::Text>::Re
     request.setUser(params.getUser());
   }
 
-  auto response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
       kj::str("/containers/", containerName, "/exec"), codec.encode(request));
   JSG_REQUIRE(response.statusCode == 201, Error, "Creating Docker exec failed with [",
       response.statusCode, "] ", response.body);
@@ -1951,7 +2245,7 @@ kj::Promise<kj::Own<kj::AsyncIoStream>> ContainerClient::startExec(
   headers.set(kj::HttpHeaderId::CONTENT_LENGTH, kj::str(encodedBody.size()));
   kj::ArrayPtr<const kj::byte> encodedBodyBytes = encodedBody.asBytes();
 
-  auto response = co_await dockerApiStreamedRequest(network, kj::str(dockerPath),
+  auto response = co_await dockerApiStreamedRequest(network, kj::str(dockerApi->getPath()),
       kj::HttpMethod::POST, kj::str("/exec/", execId, "/start"), headers, encodedBodyBytes);
   if (response.statusCode != 101) {
     auto errorBodyBytes = co_await response.connection->readAllBytes(MAX_JSON_RESPONSE_SIZE);
@@ -1965,7 +2259,7 @@ kj::Promise<kj::Own<kj::AsyncIoStream>> ContainerClient::startExec(
 
 kj::Promise<void> ContainerClient::resizeExec(kj::StringPtr execId, uint16_t cols, uint16_t rows) {
   KJ_REQUIRE(cols > 0 && rows > 0, "PTY resize dimensions must be non-zero.");
-  auto response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
       kj::str("/exec/", execId, "/resize?h=", rows, "&w=", cols));
   JSG_REQUIRE(response.statusCode == 200 || response.statusCode == 201, Error,
       "Resizing Docker exec failed with [", response.statusCode, "] ", response.body);
@@ -1974,7 +2268,7 @@ kj::Promise<void> ContainerClient::resizeExec(kj::StringPtr execId, uint16_t col
 kj::Promise<ContainerClient::ExecInspectResponse> ContainerClient::inspectExec(
     kj::StringPtr execId) {
   auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::GET, kj::str("/exec/", execId, "/json"));
+      *dockerApi, kj::HttpMethod::GET, kj::str("/exec/", execId, "/json"));
   JSG_REQUIRE(response.statusCode == 200, Error, "Inspecting Docker exec failed with [",
       response.statusCode, "] ", response.body);
 
@@ -2006,7 +2300,7 @@ kj::Promise<void> ContainerClient::runSimpleExec(kj::ArrayPtr<const kj::String>
   }
 
   auto createResponse =
-      co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+      co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
           kj::str("/containers/", containerName, "/exec"), codec.encode(createRequest));
   JSG_REQUIRE(createResponse.statusCode == 201, Error, "Creating helper Docker exec failed with [",
       createResponse.statusCode, "] ", createResponse.body);
@@ -2023,7 +2317,7 @@ kj::Promise<void> ContainerClient::runSimpleExec(kj::ArrayPtr<const kj::String>
   startRequest.setDetach(true);
   startRequest.setTty(false);
 
-  auto startResponse = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+  auto startResponse = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
       kj::str("/exec/", execId, "/start"), startCodec.encode(startRequest));
   JSG_REQUIRE(startResponse.statusCode == 200, Error, "Starting helper Docker exec failed with [",
       startResponse.statusCode, "] ", startResponse.body);
@@ -2043,7 +2337,7 @@ kj::Promise<void> ContainerClient::startContainer() {
   auto endpoint = kj::str("/containers/", containerName, "/start");
   // We have to send an empty body since docker API will throw an error if we don't.
   auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::POST, kj::mv(endpoint), kj::str(""));
+      *dockerApi, kj::HttpMethod::POST, kj::mv(endpoint), kj::str(""));
   // statusCode 304 refers to "container already started"
   JSG_REQUIRE(response.statusCode != 304, Error, "Container already started");
   // statusCode 204 refers to "no error"
@@ -2052,8 +2346,7 @@ kj::Promise<void> ContainerClient::startContainer() {
 
 kj::Promise<void> ContainerClient::stopContainer() {
   auto endpoint = kj::str("/containers/", containerName, "/stop");
-  auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::POST, kj::mv(endpoint));
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST, kj::mv(endpoint));
   // statusCode 204 refers to "no error"
   // statusCode 304 refers to "container already stopped"
   // Both are fine to avoid when stop container is called.
@@ -2063,8 +2356,7 @@ kj::Promise<void> ContainerClient::stopContainer() {
 
 kj::Promise<void> ContainerClient::killContainer(uint32_t signal) {
   auto endpoint = kj::str("/containers/", containerName, "/kill?signal=", signalToString(signal));
-  auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::POST, kj::mv(endpoint));
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST, kj::mv(endpoint));
   // statusCode 409 refers to "container is not running"
   // We should not throw an error when the container is already not running.
   JSG_REQUIRE(response.statusCode == 204 || response.statusCode == 409, Error,
@@ -2075,61 +2367,27 @@ kj::Promise<void> ContainerClient::killContainer(uint32_t signal) {
 // No-op when the container does not exist.
 // Wait for the container to actually be stopped and removed when it exists.
 kj::Promise<void> ContainerClient::destroyContainer() {
-  co_await removeContainer(network, kj::str(dockerPath), kj::str(containerName));
-  co_await deleteVolumes(network, kj::str(dockerPath), snapshotClones.releaseAsArray());
+  co_await removeContainer(*dockerApi, kj::str(containerName));
+  co_await deleteVolumes(*dockerApi, snapshotClones.releaseAsArray());
 }
 
 // Creates the sidecar container that owns the shared network namespace.
 // The application container joins this namespace and all ingress/egress goes through it.
 kj::Promise<void> ContainerClient::createSidecarContainer(
-    uint16_t egressPort, kj::String networkCidr) {
-  // Equivalent to: docker run --cap-add=NET_ADMIN -p <random-host>:39001 ...
-  capnp::JsonCodec codec;
-  codec.handleByAnnotation<docker_api::Docker::ContainerCreateRequest>();
-  capnp::MallocMessageBuilder message;
-  auto jsonRoot = message.initRoot<docker_api::Docker::ContainerCreateRequest>();
-  jsonRoot.setImage(containerEgressInterceptorImage);
-
-  auto ipv6Enabled = co_await isDaemonIpv6Enabled();
-
-  // determined by the number of flags we need to pass to proxy-everything
-  uint32_t cmdSize =
-      8;  // --http-egress-port <port> --http-ingress-address 0.0.0.0:<port> --docker-gateway-cidr <cidr> --dns-enabled --tls-intercept
-  if (!ipv6Enabled) cmdSize += 1;  // --disable-ipv6
-
-  auto cmd = jsonRoot.initCmd(cmdSize);
-  uint32_t idx = 0;
-  cmd.set(idx++, "--http-egress-port");
-  cmd.set(idx++, kj::str(egressPort));
-  cmd.set(idx++, "--http-ingress-address");
-  cmd.set(idx++, kj::str("0.0.0.0:", SIDECAR_INGRESS_PORT));
-  cmd.set(idx++, "--docker-gateway-cidr");
-  cmd.set(idx++, networkCidr);
-  cmd.set(idx++, "--dns-enabled");
-  cmd.set(idx++, "--tls-intercept");
-  if (!ipv6Enabled) {
-    cmd.set(idx++, "--disable-ipv6");
-  }
-
-  jsonRoot.initExposedPorts().setRaw(kj::str("{\"", SIDECAR_INGRESS_PORT, "/tcp\":{}}"));
-
-  auto hostConfig = jsonRoot.initHostConfig();
-  hostConfig.setPublishAllPorts(true);
-  hostConfig.setNetworkMode("bridge");
-  auto dns = hostConfig.initDns(kj::size(SIDECAR_DNS_SERVERS));
-  for (auto i: kj::indices(SIDECAR_DNS_SERVERS)) {
-    dns.set(i, SIDECAR_DNS_SERVERS[i]);
+    uint16_t egressPort, kj::String networkCidr, bool ipv6Enabled) {
+  // Pre-created sidecars can't know which egress port they'll be used with, so they're created
+  // with a placeholder. ensureSidecarStarted() always pushes the real port with
+  // updateSidecarEgressConfig() before the sidecar carries any traffic.
+  auto prewarmedRequest = encodeSidecarCreateRequest(
+      containerEgressInterceptorImage, PREWARMED_SIDECAR_EGRESS_PORT, networkCidr, ipv6Enabled);
+  if (co_await dockerApi->claimPrewarmedContainer(prewarmedRequest, sidecarContainerName)) {
+    co_return;
   }
 
-  auto extraHosts = hostConfig.initExtraHosts(1);
-  extraHosts.set(0, "host.docker.internal:host-gateway"_kj);
-
-  // Sidecar needs NET_ADMIN capability for iptables/TPROXY
-  auto capAdd = hostConfig.initCapAdd(1);
-  capAdd.set(0, "NET_ADMIN");
-
-  auto response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
-      kj::str("/containers/create?name=", sidecarContainerName), codec.encode(jsonRoot));
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
+      kj::str("/containers/create?name=", sidecarContainerName),
+      encodeSidecarCreateRequest(
+          containerEgressInterceptorImage, egressPort, networkCidr, ipv6Enabled));
 
   if (response.statusCode == 409) {
     // Already created, nothing to do
@@ -2148,7 +2406,7 @@ kj::Promise<void> ContainerClient::createSidecarContainer(
 kj::Promise<void> ContainerClient::startSidecarContainer() {
   auto endpoint = kj::str("/containers/", sidecarContainerName, "/start");
   auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::POST, kj::mv(endpoint), kj::str(""));
+      *dockerApi, kj::HttpMethod::POST, kj::mv(endpoint), kj::str(""));
   // statusCode 304 refers to "container already started"
   // statusCode 204 refers to "request succeeded"
   JSG_REQUIRE(response.statusCode == 204 || response.statusCode == 304, Error,
@@ -2156,7 +2414,7 @@ kj::Promise<void> ContainerClient::startSidecarContainer() {
 }
 
 kj::Promise<void> ContainerClient::destroySidecarContainer() {
-  co_await removeContainer(network, kj::str(dockerPath), kj::str(sidecarContainerName));
+  co_await removeContainer(*dockerApi, kj::str(sidecarContainerName));
 }
 
 kj::Promise<void> ContainerClient::createVolume(kj::StringPtr volumeName) {
@@ -2169,7 +2427,7 @@ kj::Promise<void> ContainerClient::createVolume(kj::StringPtr volumeName) {
   labels[0].setName(SNAPSHOT_VOLUME_CREATED_AT_LABEL);
   labels[0].initValue().setString(currentSnapshotVolumeTimestamp());
 
-  auto response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
       kj::str("/volumes/create"), codec.encode(req));
   // Docker returns 201 for new volumes and 200 for existing ones.
   JSG_REQUIRE(response.statusCode == 201 || response.statusCode == 200, Error,
@@ -2179,7 +2437,7 @@ kj::Promise<void> ContainerClient::createVolume(kj::StringPtr volumeName) {
 
 kj::Promise<void> ContainerClient::deleteVolume(kj::String volumeName) {
   auto response = co_await dockerApiRequest(
-      network, kj::str(dockerPath), kj::HttpMethod::DELETE, kj::str("/volumes/", volumeName));
+      *dockerApi, kj::HttpMethod::DELETE, kj::str("/volumes/", volumeName));
   // 204 = deleted, 404 = not found (both are fine)
   JSG_REQUIRE(response.statusCode == 204 || response.statusCode == 404, Error,
       "Failed to delete Docker volume '", volumeName, "': ", response.statusCode, " ",
@@ -2187,7 +2445,7 @@ kj::Promise<void> ContainerClient::deleteVolume(kj::String volumeName) {
 }
 
 kj::Promise<void> ContainerClient::commitContainer(kj::StringPtr imageRef) {
-  auto response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
       kj::str("/commit?container=", containerName,
           "&pause=true&repo=", kj::encodeUriComponent(imageRef)),
       kj::str(""));
@@ -2197,7 +2455,7 @@ kj::Promise<void> ContainerClient::commitContainer(kj::StringPtr imageRef) {
 
 kj::Promise<ContainerClient::ImageInspectResponse> ContainerClient::inspectImage(
     kj::StringPtr imageRef) {
-  auto response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::GET,
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::GET,
       kj::str("/images/", kj::encodeUriComponent(imageRef), "/json"));
   JSG_REQUIRE(response.statusCode == 200, Error, "Failed to inspect Docker image '", imageRef,
       "': ", response.statusCode, " ", response.body);
@@ -2208,7 +2466,7 @@ kj::Promise<ContainerClient::ImageInspectResponse> ContainerClient::inspectImage
 }
 
 kj::Promise<void> ContainerClient::deleteImage(kj::String imageRef) {
-  auto response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::DELETE,
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::DELETE,
       kj::str("/images/", kj::encodeUriComponent(imageRef), "?noprune=true"));
   JSG_REQUIRE(response.statusCode == 200 || response.statusCode == 404, Error,
       "Failed to delete Docker image '", imageRef, "': ", response.statusCode, " ", response.body);
@@ -2226,7 +2484,7 @@ kj::Promise<kj::String> ContainerClient::createTempContainerWithVolume(
   auto binds = hostConfig.initBinds(1);
   binds.set(0, kj::str(volumeName, ":", mountPath));
 
-  auto response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
       kj::str("/containers/create"), codec.encode(jsonRoot));
   JSG_REQUIRE(response.statusCode == 201, Error, "Failed to create temp container for volume '",
       volumeName, "': ", response.statusCode, " ", response.body);
@@ -2265,8 +2523,8 @@ kj::Promise<void> ContainerClient::cloneSnapshot(SnapshotRestoreMount& snapshot)
   binds.set(0, kj::str(snapshot.sourceVolume, ":/src:ro"));
   binds.set(1, kj::str(snapshot.cloneVolume, ":/dst"));
 
-  auto createResponse = co_await dockerApiRequest(network, kj::str(dockerPath),
-      kj::HttpMethod::POST, kj::str("/containers/create"), codec.encode(jsonRoot));
+  auto createResponse = co_await dockerApiRequest(
+      *dockerApi, kj::HttpMethod::POST, kj::str("/containers/create"), codec.encode(jsonRoot));
   JSG_REQUIRE(createResponse.statusCode == 201, Error,
       "Failed to create snapshot clone helper container for volume '", snapshot.sourceVolume,
       "': ", createResponse.statusCode, " ", createResponse.body);
@@ -2282,13 +2540,13 @@ kj::Promise<void> ContainerClient::cloneSnapshot(SnapshotRestoreMount& snapshot)
     }).attach(addRef()));
   });
 
-  auto startResponse = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+  auto startResponse = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
       kj::str("/containers/", helperContainerId, "/start"), kj::str(""));
   JSG_REQUIRE(startResponse.statusCode == 204, Error,
       "Failed to start snapshot clone helper container '", helperContainerId,
       "': ", startResponse.statusCode, " ", startResponse.body);
 
-  auto waitResponse = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::POST,
+  auto waitResponse = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST,
       kj::str("/containers/", helperContainerId, "/wait?condition=not-running"));
   JSG_REQUIRE(waitResponse.statusCode == 200, Error,
       "Failed waiting for snapshot clone helper container '", helperContainerId,
@@ -2308,7 +2566,7 @@ kj::Promise<void> ContainerClient::cloneSnapshot(SnapshotRestoreMount& snapshot)
 }
 
 kj::Promise<void> ContainerClient::deleteTempContainer(kj::String tempContainerId) {
-  auto response = co_await dockerApiRequest(network, kj::str(dockerPath), kj::HttpMethod::DELETE,
+  auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::DELETE,
       kj::str("/containers/", tempContainerId, "?force=true"));
   // 204 = deleted, 404 = not found (both are fine).
   KJ_REQUIRE(response.statusCode == 204 || response.statusCode == 404,
@@ -2332,6 +2590,10 @@ kj::Promise<void> ContainerClient::status(StatusContext context) {
   co_await ready;
   KJ_DEFER(done->fulfill());
 
+  // The sidecar is only needed if the container turns out to be running, but inspecting both at
+  // once saves a round trip in that case.
+  auto sidecarPromise = inspectSidecar();
+
   bool isRunning = false;
   KJ_IF_SOME(info, co_await inspectContainer()) {
     isRunning = info.isRunning;
@@ -2347,7 +2609,7 @@ kj::Promise<void> ContainerClient::status(StatusContext context) {
     // If the sidecar container is already running (e.g. workerd restarted while
     // containers stayed up), recover its published ingress port, then configure
     // it to use our current egress listener port.
-    auto sidecar = KJ_REQUIRE_NONNULL(co_await inspectSidecar(),
+    auto sidecar = KJ_REQUIRE_NONNULL(co_await sidecarPromise,
         "Recovered running container without a running networking sidecar");
     containerSidecarStarted.store(true, std::memory_order_release);
     this->sidecarIngressHostPort = sidecar.ingressHostPort;
@@ -2480,7 +2742,7 @@ kj::Promise<void> ContainerClient::start(StartContext context) {
       auto sourceVolume = kj::str(SNAPSHOT_VOLUME_PREFIX, snapshotId);
 
       auto inspectResp = co_await dockerApiRequest(
-          network, kj::str(dockerPath), kj::HttpMethod::GET, kj::str("/volumes/", sourceVolume));
+          *dockerApi, kj::HttpMethod::GET, kj::str("/volumes/", sourceVolume));
       JSG_REQUIRE(inspectResp.statusCode == 200, Error, "Snapshot '", snapshotId,
           "' not found (volume '", sourceVolume, "' does not exist)");
 
@@ -2539,8 +2801,7 @@ kj::Promise<void> ContainerClient::monitor(MonitorContext context) {
 
   try {
     auto endpoint = kj::str("/containers/", containerName, "/wait");
-    auto response = co_await dockerApiRequest(
-        network, kj::str(dockerPath), kj::HttpMethod::POST, kj::mv(endpoint));
+    auto response = co_await dockerApiRequest(*dockerApi, kj::HttpMethod::POST, kj::mv(endpoint));
 
     JSG_REQUIRE(response.statusCode == 200, Error,
         "Monitoring container failed with: ", response.statusCode, " ", response.body);
@@ -2703,8 +2964,7 @@ kj::Promise<void> ContainerClient::snapshotDirectory(SnapshotDirectoryContext co
   // Append "/." to the path to get directory contents without the directory wrapper.
   // For dir == "/", this is just "/."; for others, e.g. "/app/data" → "/app/data/.".
   auto archivePath = dir == "/" ? kj::str("/.") : kj::str(dir, "/.");
-  auto tarResponse = co_await dockerApiBinaryRequest(network, kj::str(dockerPath),
-      kj::HttpMethod::GET,
+  auto tarResponse = co_await dockerApiBinaryRequest(*dockerApi, kj::HttpMethod::GET,
       kj::str("/containers/", containerName, "/archive?path=", kj::encodeUriComponent(archivePath)),
       kj::none, MAX_SNAPSHOT_TAR_SIZE);
 
@@ -2731,9 +2991,9 @@ kj::Promise<void> ContainerClient::snapshotDirectory(SnapshotDirectoryContext co
   auto tempId = co_await createTempContainerWithVolume(volumeName, "/mnt");
   KJ_DEFER(waitUntilTasks.add(deleteTempContainer(kj::str(tempId)).attach(addRef())));
 
-  auto putResponse = co_await dockerApiBinaryRequest(network, kj::str(dockerPath),
-      kj::HttpMethod::PUT, kj::str("/containers/", tempId, "/archive?path=/mnt"),
-      kj::mv(tarResponse.body), MAX_JSON_RESPONSE_SIZE);
+  auto putResponse = co_await dockerApiBinaryRequest(*dockerApi, kj::HttpMethod::PUT,
+      kj::str("/containers/", tempId, "/archive?path=/mnt"), kj::mv(tarResponse.body),
+      MAX_JSON_RESPONSE_SIZE);
   JSG_REQUIRE(putResponse.statusCode == 200, Error,
       "snapshotDirectory(): failed to store snapshot in volume '", volumeName,
       "': ", putResponse.statusCode);
@@ -2908,14 +3168,20 @@ kj::Promise<void> ContainerClient::ensureSidecarStarted() {
     co_return;
   }
 
+  // Look up the bridge network while the old sidecar is being destroyed. Both lookups hit the
+  // same endpoint, so DockerApiClient serves them with one round trip.
+  auto ipamPromise = getDockerBridgeIPAMConfig();
+  auto ipv6Promise = isDaemonIpv6Enabled();
+
   // We need to call destroy here, it's mandatory that this is a fresh sidecar
   // start. Maybe we lost track of it on a previous workerd restart.
   co_await destroySidecarContainer();
 
   KJ_ON_SCOPE_FAILURE(containerSidecarStarted.store(false, std::memory_order_release));
 
-  auto ipamConfig = co_await getDockerBridgeIPAMConfig();
-  co_await createSidecarContainer(egressListenerPort, kj::mv(ipamConfig.subnet));
+  auto ipamConfig = co_await ipamPromise;
+  auto ipv6Enabled = co_await ipv6Promise;
+  co_await createSidecarContainer(egressListenerPort, kj::mv(ipamConfig.subnet), ipv6Enabled);
   co_await startSidecarContainer();
 
   auto sidecar = KJ_REQUIRE_NONNULL(co_await inspectSidecar(), "started sidecar not running");
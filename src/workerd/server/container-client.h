@@ -21,6 +21,7 @@
 #include <kj/map.h>
 #include <kj/refcount.h>
 #include <kj/string.h>
+#include <kj/vector.h>
 
 #include <atomic>
 
@@ -71,6 +72,128 @@ void configureContainerPrivileges(
     docker_api::Docker::ContainerCreateRequest::HostConfig::Builder hostConfig,
     const ContainerPrivileges& privileges);
 
+struct DockerApiClientOptions {
+  // Number of networking sidecar containers to keep created (but not started) ahead of time, so
+  // that a container's first start() can claim one instead of waiting on Docker to create it.
+  // Zero disables the pool.
+  uint prewarmedSidecars = 0;
+};
+
+// Client for the Docker Engine API listening at a particular socket, shared by every
+// ContainerClient talking to that socket.
+//
+// Requests are sent over a pool of keep-alive connections instead of a fresh connection per
+// call. Identical GET requests that are in flight at the same time (e.g. inspecting the same
+// container from status() and inspect()) share a single round trip.
+//
+// Also maintains the optional pool of pre-created sidecar containers; see
+// claimPrewarmedContainer().
+class DockerApiClient final: public kj::Refcounted, private kj::TaskSet::ErrorHandler {
+ public:
+  DockerApiClient(kj::Timer& timer,
+      kj::Network& network,
+      kj::String dockerPath,
+      DockerApiClientOptions options = DockerApiClientOptions());
+  ~DockerApiClient() noexcept(false);
+
+  kj::StringPtr getPath() const {
+    return dockerPath;
+  }
+  kj::Network& getNetwork() {
+    return network;
+  }
+
+  struct Response final: public kj::Refcounted {
+    Response(kj::uint statusCode, kj::Array<kj::byte> body)
+        : statusCode(statusCode),
+          body(kj::mv(body)) {}
+
+    kj::uint statusCode;
+    kj::Array<kj::byte> body;
+
+    kj::Own<Response> addRef() {
+      return kj::addRef(*this);
+    }
+  };
+
+  // Sends a request and reads the whole response body, which must not exceed maxResponseSize.
+  // GET requests without a body are coalesced with an identical in-flight request, if any, in
+  // which case the returned Response is shared and must not be modified.
+  kj::Promise<kj::Own<Response>> request(kj::HttpMethod method,
+      kj::StringPtr endpoint,
+      kj::Maybe<kj::ArrayPtr<const kj::byte>> body,
+      kj::StringPtr contentType,
+      uint64_t maxResponseSize);
+
+  const DockerApiClientOptions& getOptions() const {
+    return options;
+  }
+
+  // Tries to claim a pre-created, stopped container from the pool of containers created from
+  // `createRequestJson` (an encoded ContainerCreateRequest), renaming it to `name`. Returns false
+  // if the pool is disabled, currently empty, or the rename failed for a reason other than the
+  // pooled container having gone away, in which case the caller should create a container itself.
+  // Either way, the pool for this request is topped up in the background, so a request that misses
+  // now will usually hit next time.
+  kj::Promise<bool> claimPrewarmedContainer(kj::StringPtr createRequestJson, kj::StringPtr name);
+
+  // Stops refilling the pool, and removes every container this client has pooled. Called when the
+  // server starts draining.
+  kj::Promise<void> drainPrewarmPool();
+
+  // Resolves once no pool refills or removals are in flight. For tests.
+  kj::Promise<void> onPrewarmPoolIdle() {
+    return tasks.onEmpty();
+  }
+
+  kj::Own<DockerApiClient> addRef() {
+    return kj::addRef(*this);
+  }
+
+ private:
+  kj::Timer& timer;
+  kj::Network& network;
+  kj::String dockerPath;
+  DockerApiClientOptions options;
+  kj::HttpHeaderTable headerTable;
+
+  // Resolved lazily on first use, since parseAddress() is async.
+  kj::Maybe<kj::Own<kj::NetworkAddress>> address;
+  kj::Maybe<kj::Own<kj::HttpClient>> httpClient;
+
+  // In-flight coalesced GET requests, keyed by endpoint.
+  kj::HashMap<kj::String, kj::ForkedPromise<kj::Own<Response>>> inflightGets;
+
+  struct PrewarmPool {
+    // Names of created-but-unclaimed containers.
+    kj::Vector<kj::String> containerNames;
+    // Number of creates in flight, so concurrent refills don't overshoot.
+    uint creating = 0;
+  };
+  kj::HashMap<kj::String, PrewarmPool> prewarmPools;
+
+  // Identifies the containers pooled by this client, so that removing them leaves alone the pools
+  // of other processes sharing the same daemon.
+  kj::String prewarmInstanceId;
+
+  // Set by drainPrewarmPool().
+  bool prewarmDraining = false;
+
+  kj::TaskSet tasks;
+
+  kj::Promise<void> ensureConnected();
+  kj::Promise<kj::Own<Response>> sendRequest(kj::HttpMethod method,
+      kj::String endpoint,
+      kj::Maybe<kj::ArrayPtr<const kj::byte>> body,
+      kj::StringPtr contentType,
+      uint64_t maxResponseSize);
+  kj::Promise<void> removePrewarmedContainers();
+  void refillPrewarmPool(kj::StringPtr createRequestJson);
+  kj::Promise<void> createPrewarmedContainer(kj::String createRequestJson);
+
+  void taskFailed(kj::Exception&& exception) override;
+};
+
 // Docker-based implementation that implements the rpc::Container::Server interface
 // so it can be used as a rpc::Container::Client via kj::heap<ContainerClient>().
 // This allows the Container JSG class to use Docker directly without knowing
@@ -84,7 +207,7 @@ class ContainerClient final: public rpc::Container::Server, public kj::Refcounte
   ContainerClient(capnp::ByteStreamFactory& byteStreamFactory,
       kj::Timer& timer,
       kj::Network& network,
-      kj::String dockerPath,
+      kj::Own<DockerApiClient> dockerApi,
       kj::String containerName,
       kj::String imageName,
       kj::String containerEgressInterceptorImage,
@@ -121,7 +244,7 @@ class ContainerClient final: public rpc::Container::Server, public kj::Refcounte
   kj::HttpHeaderTable headerTable;
   kj::Timer& timer;
   kj::Network& network;
-  kj::String dockerPath;
+  kj::Own<DockerApiClient> dockerApi;
   kj::String containerName;
   kj::String sidecarContainerName;
   kj::String imageName;
@@ -226,7 +349,8 @@ class ContainerClient final: public rpc::Container::Server, public kj::Refcounte
   // Sidecar container management (for egress proxy)
   // Inspect the sidecar container to retrieve the port to ingress to
   kj::Promise<kj::Maybe<SidecarInspectResponse>> inspectSidecar();
-  kj::Promise<void> createSidecarContainer(uint16_t egressPort, kj::String networkCidr);
+  kj::Promise<void> createSidecarContainer(
+      uint16_t egressPort, kj::String networkCidr, bool ipv6Enabled);
   kj::Promise<void> startSidecarContainer();
   kj::Promise<void> destroySidecarContainer();
   kj::Promise<void> monitorSidecarContainer();
@@ -0,0 +1,110 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "cpu-profile-exporter.h"
+
+#include <workerd/tests/test-fixture.h>
+
+#include <kj/async-io.h>
+#include <kj/test.h>
+
+namespace workerd::server {
+namespace {
+
+constexpr auto PERIOD = 10 * kj::SECONDS;
+
+// Returns the number of samples recorded for stacks whose innermost frame is `function`, checking
+// along the way that `profile` is in the collapsed stack format.
+uint countLeafSamples(kj::StringPtr profile, kj::StringPtr function) {
+  auto prefix = kj::str(function, ' ');
+  uint total = 0;
+  while (profile.size() > 0) {
+    auto eol = KJ_ASSERT_NONNULL(profile.findFirst('\n'), "unterminated line", profile);
+    auto line = kj::str(profile.first(eol));
+    profile = profile.slice(eol + 1);
+
+    auto space = KJ_ASSERT_NONNULL(line.findLast(' '), line);
+    auto count = KJ_ASSERT_NONNULL(line.slice(space + 1).tryParseAs<uint>(), line);
+    KJ_EXPECT(count > 0, line);
+
+    auto stack = kj::str(line.first(space));
+    kj::StringPtr leaf = stack;
+    KJ_IF_SOME(semicolon, stack.findLast(';')) {
+      leaf = stack.slice(semicolon + 1);
+    }
+    if (leaf == function || leaf.startsWith(prefix)) {
+      total += count;
+    }
+  }
+  return total;
+}
+
+KJ_TEST("CPU profile exporter writes the samples of a busy script") {
+  auto io = kj::setupAsyncIo();
+  TestFixture fixture({
+    .waitScope = io.waitScope,
+    .mainModuleSource = R"(
+      function busy() {
+        let x = 0;
+        for (let i = 0; i < 2e8; i++) { x = (x + i) % 1000003; }
+        return x;
+      }
+      export default {
+        async fetch(req) {
+          return new Response(String(busy()));
+        }
+      }
+    )"_kj,
+  });
+
+  const Worker::Isolate* isolate = nullptr;
+  fixture.enterWorkerLockSynchronously(
+      [&](Worker::Lock& lock) { isolate = &lock.getWorker().getIsolate(); });
+
+  auto directory = kj::newInMemoryDirectory(kj::nullClock());
+  kj::TimerImpl timer(kj::origin<kj::TimePoint>());
+  CpuProfileExporter exporter(directory->clone(), timer,
+      {
+        .samplingInterval = 100 * kj::MICROSECONDS,
+        .period = PERIOD,
+      });
+
+  // The name isn't usable as a file name as it is.
+  exporter.addIsolate("my worker/v1"_kj, *isolate);
+  auto task = exporter.run().eagerlyEvaluate(nullptr);
+
+  auto response = fixture.runRequest(kj::HttpMethod::GET, "http://example.com/", "");
+  KJ_EXPECT(response.statusCode == 200);
+
+  // Nothing is written until the period has passed.
+  fixture.pollEventLoop();
+  KJ_EXPECT(directory->listNames().size() == 0);
+
+  timer.advanceTo(timer.now() + PERIOD);
+  fixture.pollEventLoop();
+
+  auto names = directory->listNames();
+  KJ_ASSERT(names.size() == 1, kj::strArray(names, ", "));
+  auto& name = names[0];
+  KJ_EXPECT(name.startsWith("my_worker_v1."), name);
+  KJ_EXPECT(name.endsWith(".folded"), name);
+
+  auto profile = directory->openFile(kj::Path({name}))->readAllText();
+  auto busySamples = countLeafSamples(profile, "busy");
+  KJ_EXPECT(busySamples > 0, profile);
+
+  // Taking the profile restarted it, so later periods don't repeat the busy script's samples. (A
+  // period ending within the same second appends to the same file.)
+  timer.advanceTo(timer.now() + PERIOD);
+  fixture.pollEventLoop();
+  uint laterBusySamples = 0;
+  for (auto& next: directory->listNames()) {
+    laterBusySamples +=
+        countLeafSamples(directory->openFile(kj::Path({next}))->readAllText(), "busy");
+  }
+  KJ_EXPECT(laterBusySamples == busySamples, laterBusySamples, busySamples);
+}
+
+}  // namespace
+}  // namespace workerd::server
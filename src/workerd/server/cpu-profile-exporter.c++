@@ -0,0 +1,93 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "cpu-profile-exporter.h"
+
+#include <kj/debug.h>
+
+namespace workerd::server {
+
+namespace {
+
+// Isolate names come from the config or from dynamically-loaded code, so they may contain
+// characters which don't belong in a file name.
+kj::String toFileName(kj::StringPtr name) {
+  auto result = kj::heapString(name);
+  for (auto& c: result) {
+    if (!(('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') ||
+            c == '-' || c == '_' || c == '.')) {
+      c = '_';
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+CpuProfileExporter::CpuProfileExporter(
+    kj::Own<const kj::Directory> directory, kj::Timer& timer, Options options)
+    : directory(kj::mv(directory)),
+      timer(timer),
+      options(options) {}
+
+void CpuProfileExporter::addIsolate(kj::StringPtr name, const Worker::Isolate& isolate) {
+  isolate.runInLockScope(Worker::Lock::TakeSynchronously(kj::none), [&](jsg::Lock& js) {
+    isolate.startContinuousProfiling(js, options.samplingInterval);
+  });
+  isolates.add(Profiled{
+    .fileNamePrefix = toFileName(name),
+    .isolate = isolate.getWeakRef(),
+  });
+}
+
+kj::Promise<void> CpuProfileExporter::run() {
+  for (;;) {
+    co_await timer.afterDelay(options.period);
+    co_await exportProfiles();
+  }
+}
+
+kj::Promise<void> CpuProfileExporter::exportProfiles() {
+  auto time = (kj::systemCoarseCalendarClock().now() - kj::UNIX_EPOCH) / kj::SECONDS;
+
+  // `isolates` may grow while we wait for locks, so index it rather than holding references.
+  size_t i = 0;
+  while (i < isolates.size()) {
+    auto isolate = KJ_UNWRAP_OR(isolates[i].isolate->tryAddStrongRef(), {
+      // The isolate has been destroyed.
+      isolates[i] = kj::mv(isolates.back());
+      isolates.removeLast();
+      continue;
+    });
+
+    auto name = kj::str(isolates[i].fileNamePrefix, '.', time, ".folded");
+
+    // A failure to profile one isolate mustn't stop the others from being profiled, nor escape to
+    // the server, where it would be fatal.
+    kj::Maybe<kj::String> maybeProfile;
+    try {
+      auto asyncLock = co_await isolate->takeAsyncLockWithoutRequest(nullptr);
+      isolate->runInLockScope(
+          asyncLock, [&](jsg::Lock& js) { maybeProfile = isolate->takeContinuousProfile(js); });
+    } catch (...) {
+      KJ_LOG(ERROR, "failed to collect CPU profile", name, kj::getCaughtExceptionAsKj());
+    }
+
+    KJ_IF_SOME(profile, maybeProfile) {
+      if (profile.size() > 0) {
+        // Appending rather than creating the file means that isolates with the same name
+        // aggregate into one profile rather than overwriting each other's.
+        KJ_IF_SOME(exception, kj::runCatchingExceptions([&]() {
+          directory->appendFile(kj::Path({name}), kj::WriteMode::CREATE | kj::WriteMode::MODIFY)
+              ->write(profile.asBytes());
+        })) {
+          KJ_LOG(ERROR, "failed to write CPU profile", name, exception);
+        }
+      }
+    }
+    ++i;
+  }
+}
+
+}  // namespace workerd::server
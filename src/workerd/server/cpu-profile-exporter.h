@@ -0,0 +1,57 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#pragma once
+
+#include <workerd/io/worker.h>
+
+#include <kj/filesystem.h>
+#include <kj/timer.h>
+#include <kj/vector.h>
+
+namespace workerd::server {
+
+// Profiles the JavaScript of every isolate continuously, without an inspector, and periodically
+// writes each isolate's profile to a directory, so that hot code can be found in a long-running
+// process without attaching DevTools.
+//
+// Each period, every isolate with samples gets a file named `<isolate>.<unix time>.folded`,
+// holding collapsed stacks (see Worker::Isolate::takeContinuousProfile()). Concatenating files
+// aggregates them, e.g. across periods or processes, before rendering a flame graph.
+class CpuProfileExporter {
+ public:
+  struct Options {
+    // How often V8 samples each isolate's stack.
+    kj::Duration samplingInterval;
+
+    // How often profiles are written.
+    kj::Duration period;
+  };
+
+  CpuProfileExporter(kj::Own<const kj::Directory> directory, kj::Timer& timer, Options options);
+  KJ_DISALLOW_COPY_AND_MOVE(CpuProfileExporter);
+
+  // Starts profiling `isolate`, which is included in every period's profiles until it is
+  // destroyed. Must not be called while the isolate is locked.
+  void addIsolate(kj::StringPtr name, const Worker::Isolate& isolate);
+
+  // Writes profiles every period. Never completes.
+  kj::Promise<void> run();
+
+ private:
+  struct Profiled {
+    kj::String fileNamePrefix;
+    kj::Own<const Worker::Isolate::WeakIsolateRef> isolate;
+  };
+
+  kj::Own<const kj::Directory> directory;
+  kj::Timer& timer;
+  Options options;
+  kj::Vector<Profiled> isolates;
+
+  // Collects every isolate's profile and writes those that have samples.
+  kj::Promise<void> exportProfiles();
+};
+
+}  // namespace workerd::server
@@ -0,0 +1,81 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "limit-enforcer-impl.h"
+
+#include <kj/test.h>
+
+#include <atomic>
+
+namespace workerd::server {
+namespace {
+
+struct FakeTarget final: public CpuLimitWatchdog::Target {
+  std::atomic_uint fireCount = 0;
+
+  void cpuLimitExceeded() override {
+    ++fireCount;
+  }
+};
+
+// Burns CPU on the calling thread until `target` fires or `maxCpuTime` has been used.
+void spinUntilFired(FakeTarget& target, kj::Duration maxCpuTime) {
+  ThreadCpuClock clock;
+  auto start = clock.now();
+  while (target.fireCount == 0 && clock.now() - start < maxCpuTime) {
+  }
+}
+
+KJ_TEST("CpuLimitWatchdog fires once a scope's thread exceeds its budget") {
+  auto watchdog = kj::refcounted<CpuLimitWatchdog>();
+  FakeTarget target;
+
+  {
+    CpuLimitWatchdog::Scope scope(*watchdog, 20 * kj::MILLISECONDS, target);
+    spinUntilFired(target, 10 * kj::SECONDS);
+    KJ_EXPECT(scope.getCpuTime() >= 20 * kj::MILLISECONDS);
+  }
+
+  KJ_EXPECT(target.fireCount == 1);
+}
+
+KJ_TEST("CpuLimitWatchdog does not fire for a scope within its budget") {
+  auto watchdog = kj::refcounted<CpuLimitWatchdog>();
+  FakeTarget target;
+
+  {
+    CpuLimitWatchdog::Scope scope(*watchdog, 10 * kj::SECONDS, target);
+    spinUntilFired(target, 20 * kj::MILLISECONDS);
+  }
+
+  KJ_EXPECT(target.fireCount == 0);
+}
+
+KJ_TEST("CpuLimitWatchdog tracks several scopes with different budgets") {
+  auto watchdog = kj::refcounted<CpuLimitWatchdog>();
+  FakeTarget generous;
+  FakeTarget strict;
+
+  {
+    // Register the generous scope first so that the watchdog is already sleeping on its long
+    // budget when the strict one arrives.
+    CpuLimitWatchdog::Scope outer(*watchdog, 10 * kj::SECONDS, generous);
+    CpuLimitWatchdog::Scope inner(*watchdog, 20 * kj::MILLISECONDS, strict);
+    spinUntilFired(strict, 10 * kj::SECONDS);
+  }
+
+  KJ_EXPECT(strict.fireCount == 1);
+  KJ_EXPECT(generous.fireCount == 0);
+}
+
+KJ_TEST("WorkerLimits defaults enforce nothing") {
+  WorkerLimits limits;
+  KJ_EXPECT(!limits.hasRequestLimits());
+
+  limits.cpuTime = 50 * kj::MILLISECONDS;
+  KJ_EXPECT(limits.hasRequestLimits());
+}
+
+}  // namespace
+}  // namespace workerd::server
@@ -0,0 +1,433 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "limit-enforcer-impl.h"
+
+#include <workerd/io/actor-cache.h>
+#include <workerd/io/worker.h>
+#include <workerd/jsg/exception.h>
+#include <workerd/util/exception.h>
+
+#include <kj/debug.h>
+
+#include <atomic>
+
+#if __linux__
+#include <pthread.h>
+#include <time.h>
+#endif
+
+namespace workerd::server {
+
+namespace {
+
+// When V8 is about to run out of heap, we raise its limit by this much (or a quarter of the
+// configured limit, if larger) so that the terminated JavaScript can unwind without V8 crashing
+// the process.
+constexpr size_t HEAP_LIMIT_SLACK = 16ull << 20;  // 16 MiB
+
+kj::Exception makeLimitException(EventOutcome outcome) {
+  switch (outcome) {
+    case EventOutcome::EXCEEDED_CPU: {
+      auto e = JSG_KJ_EXCEPTION(OVERLOADED, Error, "Worker exceeded CPU time limit.");
+      e.setDetail(CPU_LIMIT_DETAIL_ID, kj::heapArray<kj::byte>(0));
+      return e;
+    }
+    case EventOutcome::EXCEEDED_MEMORY: {
+      auto e = JSG_KJ_EXCEPTION(OVERLOADED, Error, "Worker exceeded memory limit.");
+      e.setDetail(MEMORY_LIMIT_DETAIL_ID, kj::heapArray<kj::byte>(0));
+      return e;
+    }
+    default:
+      break;
+  }
+  KJ_FAIL_ASSERT("not a resource limit outcome");
+}
+
+}  // namespace
+
+// =======================================================================================
+// ThreadCpuClock
+
+#if __linux__
+
+ThreadCpuClock::ThreadCpuClock() {
+  int error = pthread_getcpuclockid(pthread_self(), &clockId);
+  KJ_REQUIRE(error == 0, "pthread_getcpuclockid() failed", error);
+}
+
+kj::Duration ThreadCpuClock::now() const {
+  struct timespec ts;
+  KJ_SYSCALL(clock_gettime(clockId, &ts));
+  return ts.tv_sec * kj::SECONDS + ts.tv_nsec * kj::NANOSECONDS;
+}
+
+#else
+
+ThreadCpuClock::ThreadCpuClock() {}
+
+kj::Duration ThreadCpuClock::now() const {
+  return kj::systemPreciseMonotonicClock().now() - kj::origin<kj::TimePoint>();
+}
+
+#endif
+
+// =======================================================================================
+// CpuLimitWatchdog
+
+CpuLimitWatchdog::Scope::Scope(CpuLimitWatchdog& watchdog, kj::Duration budget, Target& target)
+    : watchdog(watchdog),
+      budget(budget),
+      target(target),
+      startTime(clock.now()) {
+  auto lock = watchdog.state.lockExclusive();
+  lock->scopes.add(this);
+  ++lock->generation;
+}
+
+CpuLimitWatchdog::Scope::~Scope() noexcept(false) {
+  auto lock = watchdog.state.lockExclusive();
+  auto& scopes = lock->scopes;
+  for (auto i: kj::indices(scopes)) {
+    if (scopes[i] == this) {
+      scopes[i] = scopes.back();
+      scopes.removeLast();
+      break;
+    }
+  }
+}
+
+CpuLimitWatchdog::CpuLimitWatchdog(): thread([this]() { run(); }) {}
+
+CpuLimitWatchdog::~CpuLimitWatchdog() noexcept(false) {
+  // The kj::Thread destructor (which runs after this body) will join the thread.
+  auto lock = state.lockExclusive();
+  lock->shutdown = true;
+}
+
+void CpuLimitWatchdog::run() {
+  uint64_t seenGeneration = 0;
+  kj::Maybe<kj::Duration> timeout;
+  for (;;) {
+    // Sleep until the soonest any scope could exceed its budget, or until a new scope is added
+    // (it might have a smaller budget than the ones we are already waiting on).
+    bool shutdown = state.when(
+        [&](const State& s) { return s.shutdown || s.generation != seenGeneration; },
+        [&](State& s) {
+      if (s.shutdown) return true;
+      seenGeneration = s.generation;
+      timeout = checkScopes(s);
+      return false;
+    },
+        timeout);
+    if (shutdown) return;
+  }
+}
+
+kj::Maybe<kj::Duration> CpuLimitWatchdog::checkScopes(State& state) {
+  kj::Maybe<kj::Duration> result;
+  for (auto scope: state.scopes) {
+    if (scope->fired) continue;
+
+    auto used = scope->getCpuTime();
+    if (used >= scope->budget) {
+      scope->fired = true;
+      scope->target.cpuLimitExceeded();
+      continue;
+    }
+
+    // A thread can't consume CPU time faster than real time passes, so this scope cannot exceed
+    // its budget before `remaining` has elapsed.
+    auto remaining = scope->budget - used;
+    KJ_IF_SOME(r, result) {
+      if (remaining < r) result = remaining;
+    } else {
+      result = remaining;
+    }
+  }
+  return result;
+}
+
+// =======================================================================================
+// IsolateLimitEnforcerImpl
+
+v8::Isolate::CreateParams IsolateLimitEnforcerImpl::getCreateParams() {
+  v8::Isolate::CreateParams params;
+  if (heapHardLimit > 0) {
+    params.constraints.ConfigureDefaultsFromHeapSize(0, heapHardLimit);
+  }
+  return params;
+}
+
+void IsolateLimitEnforcerImpl::customizeIsolate(v8::Isolate* isolate) {
+  this->isolate = isolate;
+  if (heapHardLimit > 0) {
+    isolate->AddNearHeapLimitCallback(&nearHeapLimit, this);
+
+    // Once the terminated code's garbage has been collected, go back to the configured limit
+    // rather than keeping the headroom granted by nearHeapLimit().
+    isolate->AutomaticallyRestoreInitialHeapLimit();
+  }
+}
+
+ActorCacheSharedLruOptions IsolateLimitEnforcerImpl::getActorCacheLruOptions() {
+  // TODO(someday): Make this configurable?
+  return {.softLimit = 16 * (1ull << 20),  // 16 MiB
+    .hardLimit = 128 * (1ull << 20),       // 128 MiB
+    .staleTimeout = 30 * kj::SECONDS,
+    .dirtyListByteLimit = 8 * (1ull << 20),  // 8 MiB
+    .maxKeysPerRpc = 128,
+
+    // For now, we use `neverFlush` to implement in-memory-only actors.
+    // See WorkerService::getActor().
+    .neverFlush = true};
+}
+
+kj::Own<void> IsolateLimitEnforcerImpl::enterStartupJs(
+    jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>& limitErrorOrTime) const {
+  return enterStartupScope(limitErrorOrTime);
+}
+
+kj::Own<void> IsolateLimitEnforcerImpl::enterStartupPython(
+    jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>& limitErrorOrTime) const {
+  return enterStartupScope(limitErrorOrTime);
+}
+
+kj::Own<void> IsolateLimitEnforcerImpl::enterDynamicImportJs(
+    jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>& limitErrorOrTime) const {
+  return enterStartupScope(limitErrorOrTime);
+}
+
+kj::Own<void> IsolateLimitEnforcerImpl::enterLoggingJs(
+    jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>&) const {
+  return {};
+}
+
+kj::Own<void> IsolateLimitEnforcerImpl::enterInspectorJs(
+    jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>&) const {
+  return {};
+}
+
+kj::Own<void> IsolateLimitEnforcerImpl::enterStartupScope(
+    kj::OneOf<kj::Exception, kj::Duration>& limitErrorOrTime) const {
+  if (heapHardLimit == 0) return {};
+
+  return kj::heap(kj::defer([this, &limitErrorOrTime, wasExceeded = heapLimitExceeded]() {
+    if (heapLimitExceeded && !wasExceeded) {
+      limitErrorOrTime = makeLimitException(EventOutcome::EXCEEDED_MEMORY);
+    }
+  }));
+}
+
+bool IsolateLimitEnforcerImpl::exitJs(jsg::Lock& lock) const {
+  if (heapLimitExceeded) {
+    // The JavaScript that blew through the limit has been terminated. Collect its garbage now so
+    // that the next event doesn't start out over the limit.
+    lock.v8Isolate->LowMemoryNotification();
+
+    v8::HeapStatistics stats;
+    lock.v8Isolate->GetHeapStatistics(&stats);
+    if (stats.used_heap_size() < heapHardLimit) {
+      heapLimitExceeded = false;
+    }
+  }
+
+  // workerd never replaces isolates, so there's no point condemning one.
+  return false;
+}
+
+size_t IsolateLimitEnforcerImpl::nearHeapLimit(
+    void* data, size_t currentHeapLimit, size_t initialHeapLimit) {
+  auto& self = *static_cast<IsolateLimitEnforcerImpl*>(data);
+  if (!self.heapLimitExceeded) {
+    KJ_LOG(WARNING, "Worker exceeded its heap limit; terminating JavaScript execution.",
+        initialHeapLimit);
+    self.heapLimitExceeded = true;
+  }
+  self.isolate->TerminateExecution();
+
+  // If we return the current limit, V8 will crash the process with an out-of-memory error.
+  return currentHeapLimit + kj::max(initialHeapLimit / 4, HEAP_LIMIT_SLACK);
+}
+
+// =======================================================================================
+// RequestLimitEnforcer
+
+namespace {
+
+class RequestLimitEnforcer final: public LimitEnforcer, private CpuLimitWatchdog::Target {
+ public:
+  RequestLimitEnforcer(kj::Own<LimitEnforcer> inner,
+      const WorkerLimits& limits,
+      kj::Maybe<CpuLimitWatchdog&> watchdog)
+      : inner(kj::mv(inner)),
+        limits(limits),
+        watchdog(watchdog) {
+    KJ_REQUIRE(limits.cpuTime == kj::none || watchdog != kj::none);
+    auto paf = kj::newPromiseAndFulfiller<void>();
+    limitsExceededPromise = paf.promise.fork();
+    limitsExceededFulfiller = kj::mv(paf.fulfiller);
+  }
+
+  kj::Own<void> enterJs(jsg::Lock& lock, IoContext& context) override {
+    return kj::heap<JsScope>(*this, lock);
+  }
+  void topUpActor() override {
+    // Each event delivered to an actor gets a fresh CPU budget.
+    cpuTimeUsed = 0 * kj::SECONDS;
+    inner->topUpActor();
+  }
+  void newSubrequest(bool isInHouse) override {
+    inner->newSubrequest(isInHouse);
+  }
+  void newKvRequest(KvOpType op) override {
+    inner->newKvRequest(op);
+  }
+  void newAnalyticsEngineRequest() override {
+    inner->newAnalyticsEngineRequest();
+  }
+  kj::Promise<void> limitDrain() override {
+    return inner->limitDrain();
+  }
+  kj::Promise<void> limitScheduled() override {
+    return inner->limitScheduled();
+  }
+  kj::Duration getAlarmLimit() override {
+    return inner->getAlarmLimit();
+  }
+  size_t getBufferingLimit() override {
+    return inner->getBufferingLimit();
+  }
+  kj::Maybe<EventOutcome> getLimitsExceeded() override {
+    return exceeded;
+  }
+  kj::Promise<void> onLimitsExceeded() override {
+    return limitsExceededPromise.addBranch();
+  }
+  void setCpuLimitNearlyExceededCallback(kj::Function<void(void)> cb) override {
+    inner->setCpuLimitNearlyExceededCallback(kj::mv(cb));
+  }
+  void requireLimitsNotExceeded() override {
+    KJ_IF_SOME(outcome, exceeded) {
+      kj::throwFatalException(makeLimitException(outcome));
+    }
+  }
+  void reportMetrics(RequestObserver& requestMetrics) override {
+    inner->reportMetrics(requestMetrics);
+  }
+  kj::Duration consumeTimeElapsedForPeriodicLogging() override {
+    return inner->consumeTimeElapsedForPeriodicLogging();
+  }
+  size_t getSqliteMemoryUsage() const override {
+    return inner->getSqliteMemoryUsage();
+  }
+
+ private:
+  class JsScope;
+
+  kj::Own<LimitEnforcer> inner;
+  WorkerLimits limits;
+  kj::Maybe<CpuLimitWatchdog&> watchdog;
+
+  // CPU time spent in JavaScript by this event so far, not counting the current JsScope.
+  kj::Duration cpuTimeUsed = 0 * kj::SECONDS;
+
+  // Used heap size right after the last GC forced to check WorkerLimits::heapSoftLimit.
+  size_t heapAfterForcedGc = 0;
+
+  kj::Maybe<EventOutcome> exceeded;
+  kj::ForkedPromise<void> limitsExceededPromise = nullptr;
+  kj::Own<kj::PromiseFulfiller<void>> limitsExceededFulfiller;
+
+  // The isolate currently executing this request's JavaScript, if it is being timed. Written only
+  // while no watchdog scope is registered; read by the watchdog thread.
+  v8::Isolate* timedIsolate = nullptr;
+
+  // Set on the watchdog thread when the CPU budget runs out.
+  std::atomic_bool cpuLimitFired = false;
+
+  void cpuLimitExceeded() override {
+    cpuLimitFired = true;
+    timedIsolate->TerminateExecution();
+  }
+
+  void limitExceeded(EventOutcome outcome) {
+    if (exceeded != kj::none) return;
+    exceeded = outcome;
+    limitsExceededFulfiller->reject(makeLimitException(outcome));
+  }
+};
+
+class RequestLimitEnforcer::JsScope {
+ public:
+  JsScope(RequestLimitEnforcer& enforcer, jsg::Lock& lock)
+      : enforcer(enforcer),
+        lock(lock),
+        isolateEnforcer(Worker::Isolate::from(lock).getLimitEnforcer()),
+        heapExceededOnEntry(isolateEnforcer.hasExcessivelyExceededHeapLimit()) {
+    KJ_IF_SOME(budget, enforcer.limits.cpuTime) {
+      enforcer.timedIsolate = lock.v8Isolate;
+      cpuScope.emplace(
+          KJ_ASSERT_NONNULL(enforcer.watchdog), budget - enforcer.cpuTimeUsed, enforcer);
+    }
+  }
+
+  ~JsScope() noexcept(false) {
+    KJ_IF_SOME(scope, cpuScope) {
+      enforcer.cpuTimeUsed += scope.getCpuTime();
+
+      // After this, the watchdog will no longer touch the isolate.
+      cpuScope = kj::none;
+      enforcer.timedIsolate = nullptr;
+
+      if (enforcer.cpuLimitFired.exchange(false)) {
+        // If the JavaScript finished just as the watchdog fired, the termination is still pending
+        // and would otherwise abort whatever runs next on this isolate.
+        lock.v8Isolate->CancelTerminateExecution();
+        enforcer.limitExceeded(EventOutcome::EXCEEDED_CPU);
+      } else if (enforcer.cpuTimeUsed >= KJ_ASSERT_NONNULL(enforcer.limits.cpuTime)) {
+        // Ran out of budget but finished before the watchdog noticed.
+        enforcer.limitExceeded(EventOutcome::EXCEEDED_CPU);
+      }
+    }
+
+    if (!heapExceededOnEntry && isolateEnforcer.hasExcessivelyExceededHeapLimit()) {
+      enforcer.limitExceeded(EventOutcome::EXCEEDED_MEMORY);
+    } else if (enforcer.limits.heapSoftLimit > 0 && enforcer.exceeded == kj::none) {
+      auto softLimit = enforcer.limits.heapSoftLimit;
+      v8::HeapStatistics stats;
+      lock.v8Isolate->GetHeapStatistics(&stats);
+      if (stats.used_heap_size() > softLimit &&
+          stats.used_heap_size() >= enforcer.heapAfterForcedGc + softLimit / 4) {
+        // Much of that may be garbage. Only fail the event if a full GC doesn't bring the heap
+        // back under the limit. A full GC is expensive, and a worker hovering near the limit
+        // would otherwise get one on every exit from JavaScript, so after one that succeeds we
+        // wait for the heap to grow by another quarter of the limit before forcing the next.
+        lock.v8Isolate->LowMemoryNotification();
+        lock.v8Isolate->GetHeapStatistics(&stats);
+        enforcer.heapAfterForcedGc = stats.used_heap_size();
+        if (stats.used_heap_size() > softLimit) {
+          enforcer.limitExceeded(EventOutcome::EXCEEDED_MEMORY);
+        }
+      }
+    }
+  }
+
+ private:
+  RequestLimitEnforcer& enforcer;
+  jsg::Lock& lock;
+  const IsolateLimitEnforcer& isolateEnforcer;
+  bool heapExceededOnEntry;
+  kj::Maybe<CpuLimitWatchdog::Scope> cpuScope;
+};
+
+}  // namespace
+
+kj::Own<LimitEnforcer> newRequestLimitEnforcer(kj::Own<LimitEnforcer> inner,
+    const WorkerLimits& limits,
+    kj::Maybe<CpuLimitWatchdog&> watchdog) {
+  return kj::heap<RequestLimitEnforcer>(kj::mv(inner), limits, watchdog);
+}
+
+}  // namespace workerd::server
@@ -0,0 +1,184 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#pragma once
+
+#include <workerd/io/limit-enforcer.h>
+
+#include <kj/mutex.h>
+#include <kj/refcount.h>
+#include <kj/thread.h>
+#include <kj/time.h>
+#include <kj/vector.h>
+
+namespace workerd::server {
+
+// Resource limits for a Worker, from `Worker.limits` in the config. The defaults enforce nothing.
+struct WorkerLimits {
+  // CPU time that a single event may spend executing JavaScript.
+  kj::Maybe<kj::Duration> cpuTime;
+
+  // If the isolate's heap is still larger than this after a full GC at the end of a JavaScript
+  // execution, the event that was running fails with EXCEEDED_MEMORY. After a GC that succeeds,
+  // the next one waits for the heap to grow by another quarter of the limit. 0 means no limit.
+  size_t heapSoftLimit = 0;
+
+  // The isolate's V8 heap limit. When the heap approaches it, the running JavaScript is
+  // terminated and the event fails with EXCEEDED_MEMORY. 0 means no limit.
+  size_t heapHardLimit = 0;
+
+  // Memory that the Worker's writable files may hold before they are moved to disk. 0 means they
+  // always stay in memory. Unlike the other limits, this isn't enforced per request.
+  size_t tmpMemoryLimit = 0;
+
+  // True if a per-request LimitEnforcer is needed to apply these limits.
+  bool hasRequestLimits() const {
+    return cpuTime != kj::none || heapSoftLimit > 0 || heapHardLimit > 0;
+  }
+};
+
+// Reads the CPU time consumed by one particular thread. Unlike the monotonic clock, this doesn't
+// advance while the thread is descheduled, so a busy machine doesn't eat into a Worker's budget.
+// On platforms without per-thread CPU clocks, this falls back to the monotonic clock.
+class ThreadCpuClock {
+ public:
+  // Measures the calling thread.
+  ThreadCpuClock();
+
+  // May be called from any thread.
+  kj::Duration now() const;
+
+ private:
+#if __linux__
+  clockid_t clockId;
+#endif
+};
+
+// Background thread that terminates JavaScript which has run past its CPU budget.
+//
+// A Scope is created each time a request enters JavaScript and destroyed when it leaves. While
+// the scope exists, the watchdog periodically reads the CPU clock of the thread that created it,
+// and once the thread has used more than the scope's budget, it calls `Target::cpuLimitExceeded()`
+// on the watchdog thread. A single watchdog serves any number of isolates and threads.
+class CpuLimitWatchdog final: public kj::Refcounted {
+ public:
+  class Target {
+   public:
+    // Called on the watchdog thread, at most once per Scope, while the Scope is still alive (the
+    // Scope's destructor waits for the call to return). Must be thread-safe; typically this calls
+    // `v8::Isolate::TerminateExecution()`, which is.
+    virtual void cpuLimitExceeded() = 0;
+  };
+
+  class Scope {
+   public:
+    Scope(CpuLimitWatchdog& watchdog, kj::Duration budget, Target& target);
+    ~Scope() noexcept(false);
+    KJ_DISALLOW_COPY_AND_MOVE(Scope);
+
+    // CPU time used by this scope's thread since the scope was created.
+    kj::Duration getCpuTime() const {
+      return clock.now() - startTime;
+    }
+
+   private:
+    CpuLimitWatchdog& watchdog;
+    kj::Duration budget;
+    Target& target;
+    ThreadCpuClock clock;
+    kj::Duration startTime;
+
+    // Protected by the watchdog's mutex.
+    bool fired = false;
+
+    friend class CpuLimitWatchdog;
+  };
+
+  CpuLimitWatchdog();
+  ~CpuLimitWatchdog() noexcept(false);
+  KJ_DISALLOW_COPY_AND_MOVE(CpuLimitWatchdog);
+
+ private:
+  struct State {
+    kj::Vector<Scope*> scopes;
+
+    // Incremented whenever a scope is added, so the thread knows to recompute its sleep time.
+    uint64_t generation = 0;
+
+    bool shutdown = false;
+  };
+
+  kj::MutexGuarded<State> state;
+
+  // Declared last so that it is joined before `state` is destroyed.
+  kj::Thread thread;
+
+  void run();
+
+  // Fires every scope that has exceeded its budget and returns how long the thread may sleep
+  // before another one could, or kj::none if there are no armed scopes.
+  static kj::Maybe<kj::Duration> checkScopes(State& state);
+};
+
+// IsolateLimitEnforcer used by workerd. Only the heap limit, if any, is enforced.
+class IsolateLimitEnforcerImpl final: public IsolateLimitEnforcer {
+ public:
+  explicit IsolateLimitEnforcerImpl(size_t heapHardLimit = 0): heapHardLimit(heapHardLimit) {}
+
+  v8::Isolate::CreateParams getCreateParams() override;
+  void customizeIsolate(v8::Isolate* isolate) override;
+  ActorCacheSharedLruOptions getActorCacheLruOptions() override;
+
+  kj::Own<void> enterStartupJs(
+      jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>& limitErrorOrTime) const override;
+  kj::Own<void> enterStartupPython(
+      jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>& limitErrorOrTime) const override;
+  kj::Own<void> enterDynamicImportJs(
+      jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>& limitErrorOrTime) const override;
+  kj::Own<void> enterLoggingJs(
+      jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>& limitErrorOrTime) const override;
+  kj::Own<void> enterInspectorJs(
+      jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>& limitErrorOrTime) const override;
+
+  void completedRequest(kj::StringPtr id) const override {}
+  bool exitJs(jsg::Lock& lock) const override;
+  void reportMetrics(IsolateObserver& isolateMetrics) const override {}
+
+  kj::Maybe<size_t> checkPbkdfIterations(jsg::Lock& lock, size_t iterations) const override {
+    // No limit on the number of iterations in workerd
+    return kj::none;
+  }
+
+  bool hasExcessivelyExceededHeapLimit() const override {
+    return heapLimitExceeded;
+  }
+
+  const TrackedWasmInstanceList& getTrackedWasmInstances() const override {
+    return trackedWasmInstances;
+  }
+
+ private:
+  size_t heapHardLimit;
+  v8::Isolate* isolate = nullptr;
+  TrackedWasmInstanceList trackedWasmInstances;
+
+  // Set by the near-heap-limit callback and cleared by exitJs() once the heap is back under the
+  // limit. Only accessed under the isolate lock.
+  mutable bool heapLimitExceeded = false;
+
+  static size_t nearHeapLimit(void* data, size_t currentHeapLimit, size_t initialHeapLimit);
+
+  // Returns a scope which, when dropped, reports a heap limit hit during startup in
+  // `limitErrorOrTime`.
+  kj::Own<void> enterStartupScope(kj::OneOf<kj::Exception, kj::Duration>& limitErrorOrTime) const;
+};
+
+// Wraps `inner` -- a LimitEnforcer that enforces no limits of its own -- in one that applies the
+// CPU and heap limits in `limits` to a single request. `watchdog` is required if `limits.cpuTime`
+// is set.
+kj::Own<LimitEnforcer> newRequestLimitEnforcer(kj::Own<LimitEnforcer> inner,
+    const WorkerLimits& limits,
+    kj::Maybe<CpuLimitWatchdog&> watchdog);
+
+}  // namespace workerd::server
@@ -6762,6 +6762,107 @@ service hello: Uncaught TypeError: Main module must be an ES module.
 )");
 }
 
+KJ_TEST("Server: cached typescript failure reports the same diagnostics") {
+  // Stripped modules are cached per process, so the second server loads this from the cache.
+  for (auto i KJ_UNUSED: kj::zeroTo(2)) {
+    TestServer test(singleWorker(R"((
+      compatibilityDate = "2025-08-01",
+      compatibilityFlags = ["typescript_strip_types"],
+      modules = [
+        ( name = "main.ts",
+          esModule =
+            `enum Cached { A, B }
+            `export default {
+            `  async fetch(request): Promise<Response> {
+            `    return new Response("Hello from typescript");
+            `  }
+            `} satisfies ExportedHandler<Env>;
+        )
+      ]
+    ))"_kj));
+    test.server.allowExperimental();
+
+    test.expectErrors(R"(service hello: Error transpiling main.ts : Unsupported syntax
+    TypeScript enum is not supported in strip-only mode
+service hello: Uncaught TypeError: Main module must be an ES module.
+)");
+  }
+}
+
+// Builds a worker whose TypeScript modules total more than MIN_PARALLEL_STRIP_BYTES if `padding`
+// is large, so that extractSource() strips them in parallel, or less if it is small, so that they
+// are stripped one by one. Every module mentions `padding`, so that bundles with different padding
+// don't share strip-types cache entries. `extraModules` is added to the module list.
+kj::String typescriptBundle(size_t padding, kj::StringPtr extraModules = ""_kj) {
+  return singleWorker(kj::str(R"((
+    compatibilityDate = "2025-08-01",
+    compatibilityFlags = ["typescript_strip_types"],
+    modules = [
+      ( name = "main.ts",
+        esModule =
+          `// )"_kj, padding, R"(
+          `import { greeting } from "greeting.ts";
+          `import { size } from "padding.ts";
+          `export default {
+          `  async fetch(request): Promise<Response> {
+          `    return new Response(greeting("typescript") + " " + (size satisfies number));
+          `  }
+          `} satisfies ExportedHandler<Env>;
+      ),
+      ( name = "greeting.ts",
+        esModule =
+          `// )"_kj, padding, R"(
+          `export function greeting(name: string): string {
+          `  return "Hello from " + name;
+          `}
+      ),
+      ( name = "padding.ts",
+        esModule =
+          `// )"_kj,
+      kj::repeat('x', padding), R"(
+          `export const size: number = )"_kj,
+      padding, R"(;
+      ),
+      )"_kj,
+      extraModules, R"(
+    ]
+  ))"_kj));
+}
+
+KJ_TEST("Server: typescript stripped in parallel matches stripping serially") {
+  for (size_t padding: {16 * 1024, 80 * 1024}) {
+    TestServer test(typescriptBundle(padding));
+    test.server.allowExperimental();
+    test.start();
+    auto conn = test.connect("test-addr");
+    conn.httpGet200("/", kj::str("Hello from typescript ", padding));
+  }
+}
+
+KJ_TEST("Server: typescript stripped in parallel reports the same errors as serially") {
+  for (size_t padding: {16 * 1024, 80 * 1024}) {
+    // The failures are reported in module order, however the modules are stripped. Their content
+    // differs between iterations so that neither is served from the strip-types cache.
+    TestServer test(typescriptBundle(padding, kj::str(R"(
+      ( name = "bad1.ts",
+        esModule =
+          `enum First)"_kj, padding, R"( { A, B }
+      ),
+      ( name = "bad2.ts",
+        esModule =
+          `enum Second)"_kj, padding, R"( { A, B }
+      ),
+    )"_kj)));
+    test.server.allowExperimental();
+
+    test.expectErrors(R"(service hello: Error transpiling bad1.ts : Unsupported syntax
+    TypeScript enum is not supported in strip-only mode
+service hello: Error transpiling bad2.ts : Unsupported syntax
+    TypeScript enum is not supported in strip-only mode
+)");
+  }
+}
+
 #endif  // __linux__
 
 // Helper types for V8 serialization in tests
@@ -7861,5 +7962,190 @@ MF-Access-Blob: {"app_aud":"valid-aud","jwt_claims":"not-an-object"}
   }
 }
 
+// =======================================================================================
+// Test Worker.limits
+
+KJ_TEST("Server: an event over its CPU limit fails with exceededCpu") {
+  TestServer test(R"((
+    services = [
+      ( name = "hello",
+        worker = (
+          compatibilityDate = "2024-11-01",
+          modules = [
+            ( name = "main.js",
+              esModule =
+                `export default {
+                `  async fetch(req, env, ctx) {
+                `    if (new URL(req.url).pathname == "/spin") {
+                `      for (;;) {}
+                `    }
+                `    return new Response("OK");
+                `  }
+                `}
+            )
+          ],
+          limits = (cpuMillis = 50),
+          tails = ["tail"],
+        )
+      ),
+      ( name = "tail",
+        worker = (
+          compatibilityDate = "2024-11-01",
+          modules = [
+            ( name = "main.js",
+              esModule =
+                `export default {
+                `  async tail(req, env, ctx) {
+                `    await fetch("http://tail/" + req[0].outcome);
+                `  }
+                `}
+            )
+          ],
+        )
+      ),
+    ],
+    sockets = [
+      ( name = "main",
+        address = "test-addr",
+        service = "hello"
+      )
+    ]
+  ))"_kj);
+
+  test.start();
+
+  {
+    KJ_EXPECT_LOG(ERROR, "Worker exceeded CPU time limit.");
+    auto conn = test.connect("test-addr");
+    conn.sendHttpGet("/spin");
+    conn.recv(R"(
+      HTTP/1.1 500 Internal Server Error
+      Connection: close
+      Content-Length: 21
+
+      Internal Server Error)"_blockquote);
+
+    auto subreq = test.receiveInternetSubrequest("tail");
+    subreq.recv(R"(
+      GET /exceededCpu HTTP/1.1
+      Host: tail
+
+    )"_blockquote);
+    subreq.send(R"(
+      HTTP/1.1 200 OK
+      Content-Length: 0
+
+    )"_blockquote);
+  }
+
+  // The isolate survives, and the next event gets to run.
+  auto conn = test.connect("test-addr");
+  conn.httpGet200("/", "OK");
+
+  auto subreq = test.receiveInternetSubrequest("tail");
+  subreq.recv(R"(
+    GET /ok HTTP/1.1
+    Host: tail
+
+  )"_blockquote);
+  subreq.send(R"(
+    HTTP/1.1 200 OK
+    Content-Length: 0
+
+  )"_blockquote);
+}
+
+KJ_TEST("Server: an event over the heap limit fails with exceededMemory") {
+  TestServer test(R"((
+    services = [
+      ( name = "hello",
+        worker = (
+          compatibilityDate = "2024-11-01",
+          modules = [
+            ( name = "main.js",
+              esModule =
+                `export default {
+                `  async fetch(req, env, ctx) {
+                `    if (new URL(req.url).pathname == "/grow") {
+                `      const chunks = [];
+                `      for (;;) chunks.push(new Array(1 << 16).fill(chunks.length));
+                `    }
+                `    return new Response("OK");
+                `  }
+                `}
+            )
+          ],
+          limits = (heapHardLimitMb = 64),
+          tails = ["tail"],
+        )
+      ),
+      ( name = "tail",
+        worker = (
+          compatibilityDate = "2024-11-01",
+          modules = [
+            ( name = "main.js",
+              esModule =
+                `export default {
+                `  async tail(req, env, ctx) {
+                `    await fetch("http://tail/" + req[0].outcome);
+                `  }
+                `}
+            )
+          ],
+        )
+      ),
+    ],
+    sockets = [
+      ( name = "main",
+        address = "test-addr",
+        service = "hello"
+      )
+    ]
+  ))"_kj);
+
+  test.start();
+
+  {
+    KJ_EXPECT_LOG(WARNING, "Worker exceeded its heap limit");
+    KJ_EXPECT_LOG(ERROR, "Worker exceeded memory limit.");
+    auto conn = test.connect("test-addr");
+    conn.sendHttpGet("/grow");
+    conn.recv(R"(
+      HTTP/1.1 500 Internal Server Error
+      Connection: close
+      Content-Length: 21
+
+      Internal Server Error)"_blockquote);
+
+    auto subreq = test.receiveInternetSubrequest("tail");
+    subreq.recv(R"(
+      GET /exceededMemory HTTP/1.1
+      Host: tail
+
+    )"_blockquote);
+    subreq.send(R"(
+      HTTP/1.1 200 OK
+      Content-Length: 0
+
+    )"_blockquote);
+  }
+
+  // The isolate survives, and the next event gets to run.
+  auto conn = test.connect("test-addr");
+  conn.httpGet200("/", "OK");
+
+  auto subreq = test.receiveInternetSubrequest("tail");
+  subreq.recv(R"(
+    GET /ok HTTP/1.1
+    Host: tail
+
+  )"_blockquote);
+  subreq.send(R"(
+    HTTP/1.1 200 OK
+    Content-Length: 0
+
+  )"_blockquote);
+}
+
 }  // namespace
 }  // namespace workerd::server
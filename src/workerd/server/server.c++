@@ -6,7 +6,10 @@
 
 #include "alarm-scheduler.h"
 #include "container-client.h"
+#include "limit-enforcer-impl.h"
 #include "pyodide.h"
+#include "sqlite-group-commit.h"
+#include "web-socket-compression.h"
 #include "workerd-api.h"
 
 #include <workerd/api/actor-state.h>
@@ -32,11 +35,14 @@
 #include <workerd/io/worker-interface.h>
 #include <workerd/io/worker.h>
 #include <workerd/server/actor-id-impl.h>
+#include <workerd/server/cpu-profile-exporter.h>
 #include <workerd/server/facet-tree-index.h>
 #include <workerd/server/fallback-service.h>
+#include <workerd/util/event-loop-stall-detector.h>
 #include <workerd/util/exception.h>
 #include <workerd/util/http-util.h>
 #include <workerd/util/mimetype.h>
+#include <workerd/util/sqlite-page-cache.h>
 #include <workerd/util/stream-utils.h>
 #include <workerd/util/strings.h>
 #include <workerd/util/use-perfetto-categories.h>
@@ -221,6 +227,12 @@ static inline kj::Own<T> fakeOwn(T& ref) {
 
 // =======================================================================================
 
+void Server::enableTraceSnapshots(TraceSnapshotOptions options) {
+  traceSnapshotter = kj::heap<TraceSnapshotter>(monotonicClock, kj::mv(options));
+}
+
+// =======================================================================================
+
 Server::Server(kj::Filesystem& fs,
     kj::Timer& timer,
     const kj::MonotonicClock& monotonicClock,
@@ -356,6 +368,16 @@ Server::~Server() noexcept {
 
 // =======================================================================================
 
+namespace {
+
+// How a Worker's Durable Object databases are synced when it uses `groupCommit` durability.
+struct ActorStorageGroupCommit {
+  SqliteGroupCommitter& committer;
+  kj::Duration window;
+};
+
+}  // namespace
+
 class Server::ActorNamespace final {
  public:
   friend class Server;
@@ -367,7 +389,7 @@ class Server::ActorNamespace final {
       capnp::ByteStreamFactory& byteStreamFactory,
       ChannelTokenHandler& channelTokenHandler,
       kj::Network& dockerNetwork,
-      kj::Maybe<kj::StringPtr> dockerPath,
+      kj::Maybe<DockerApiClient&> dockerApiClient,
       kj::Maybe<kj::StringPtr> containerEgressInterceptorImage,
       kj::TaskSet& waitUntilTasks,
       Persistent selfTokensArePersistent)
@@ -378,16 +400,18 @@ class Server::ActorNamespace final {
         byteStreamFactory(byteStreamFactory),
         channelTokenHandler(channelTokenHandler),
         dockerNetwork(dockerNetwork),
-        dockerPath(dockerPath),
+        dockerApiClient(dockerApiClient),
         containerEgressInterceptorImage(containerEgressInterceptorImage),
         waitUntilTasks(waitUntilTasks),
         selfTokensArePersistent(selfTokensArePersistent) {}
 
-  void link(kj::Maybe<const kj::Directory&> serviceActorStorage) {
+  void link(kj::Maybe<const kj::Directory&> serviceActorStorage,
+      kj::Maybe<ActorStorageGroupCommit> groupCommit) {
     KJ_IF_SOME(dir, serviceActorStorage) {
       KJ_IF_SOME(d, config.tryGet<Durable>()) {
-        this->actorStorage.emplace(
+        auto& as = this->actorStorage.emplace(
             dir.openSubdir(kj::Path({d.uniqueKey}), kj::WriteMode::CREATE | kj::WriteMode::MODIFY));
+        as.groupCommit = groupCommit;
       }
     }
 
@@ -522,6 +546,8 @@ class Server::ActorNamespace final {
       // Shutdown the tracker so we don't use active/inactive hooks anymore.
       tracker->shutdown();
 
+      dropWarmDatabase();
+
       for (auto& facet: facets) {
         facet.value->abort(kj::none);
       }
@@ -693,6 +719,7 @@ class Server::ActorNamespace final {
       tracker->shutdown();
       actor = kj::none;
       containerClient = kj::none;
+      dropWarmDatabase();
 
       KJ_IF_SOME(r, reason) {
         brokenReason = r.clone();
@@ -710,9 +737,23 @@ class Server::ActorNamespace final {
             kj::runCatchingExceptions([&]() { db.reset(); });
           }
         }
+      } else KJ_IF_SOME(warm, warmDatabase) {
+        kj::runCatchingExceptions([&]() { warm.db->reset(); });
       }
     }
 
+    // Closes the database kept open since the actor was last evicted, if any.
+    void dropWarmDatabase() {
+      if (warmDatabase != kj::none) {
+        ns.warmDatabases.remove(*this);
+        ns.warmDatabaseBytes -= warmDatabaseBytes;
+        warmDatabase = kj::none;
+      }
+    }
+
+    // Link in ActorNamespace::warmDatabases, while `warmDatabase` is set.
+    kj::ListLink<ActorContainer> warmDatabaseLink;
+
     kj::Own<ActorContainer> getFacetContainer(
         kj::String childKey, kj::Function<kj::Promise<StartInfo>()> getStartInfo) {
       auto makeContainer = [&]() {
@@ -853,6 +894,11 @@ class Server::ActorNamespace final {
     // ID of this facet. Initialized when getFacetId() is first called.
     kj::Maybe<uint> facetId;
 
+    // The database of the last evicted instance of this actor, kept open so that the next one
+    // can skip reopening it. Bounded across the namespace; see ActorNamespace::warmDatabases.
+    kj::Maybe<ActorSqlite::WarmDatabase> warmDatabase;
+    size_t warmDatabaseBytes = 0;
+
     ActorMap facets;
 
     // Get the facet ID for this facet. The root facet always has ID zero, but all other facets
@@ -1069,6 +1115,7 @@ class Server::ActorNamespace final {
               asyncLock, [&](Worker::Lock& lock) { m->hibernateWebSockets(lock); });
         }
         a->shutdown(0, KJ_EXCEPTION(DISCONNECTED, "broken.dropped; Actor freed due to inactivity"));
+        keepWarmDatabase(*a);
       }
       // Destroy the last strong Worker::Actor reference.
       actor = kj::none;
@@ -1138,6 +1185,10 @@ class Server::ActorNamespace final {
       // to trigger it.
       onBrokenTask = kj::none;
 
+      KJ_IF_SOME(a, actor) {
+        keepWarmDatabase(*a);
+      }
+
       // Destroy the last strong Worker::Actor reference.
       actor = kj::none;
 
@@ -1223,6 +1274,24 @@ class Server::ActorNamespace final {
       }
     }
 
+    // Called on eviction, after shutting down `a` and just before destroying it. If `a` uses
+    // SQLite storage that can be handed over cleanly, keeps its database open for the actor's next
+    // instance.
+    void keepWarmDatabase(Worker::Actor& a) {
+      // If anything else still holds the actor, its storage won't be destroyed along with our
+      // reference.
+      if (a.isShared()) return;
+
+      auto& cache = KJ_UNWRAP_OR(a.getPersistent(), return);
+      auto& sqlite = KJ_UNWRAP_OR(kj::tryDowncast<ActorSqlite>(cache), return);
+      KJ_IF_SOME(warm, sqlite.release()) {
+        dropWarmDatabase();
+        warmDatabaseBytes = warm.db->getSqliteMemoryBytes();
+        warmDatabase = kj::mv(warm);
+        ns.addWarmDatabase(*this, warmDatabaseBytes);
+      }
+    }
+
     void start(kj::Own<ActorClass>& actorClass, Worker::Actor::Id& id) {
       KJ_REQUIRE(actor == nullptr);
 
@@ -1261,16 +1330,46 @@ class Server::ActorNamespace final {
             }
 
             uint selfId = getFacetId();
+
+            kj::Function<kj::Promise<void>(SpanParent)> commitCallback =
+                [](SpanParent) -> kj::Promise<void> { return kj::READY_NOW; };
+            KJ_IF_SOME(gc, as.groupCommit) {
+              commitCallback = [&gc, &dir = *as.directory,
+                                   walPath = getSqlitePathForId(selfId, "-wal")](
+                                   SpanParent) -> kj::Promise<void> {
+                return gc.committer.sync(dir, walPath.clone(), gc.window);
+              };
+            }
+
+            KJ_IF_SOME(warm, warmDatabase) {
+              // The last instance of this actor left its database open. It's already set up,
+              // including the afterReset() callback below.
+              auto sqlite = kj::heap<ActorSqlite>(
+                  kj::mv(warm), outputGate, kj::mv(commitCallback), *sqliteHooks);
+              dropWarmDatabase();
+              return kj::mv(sqlite).attach(kj::mv(sqliteHooks));
+            }
+
             auto path = getSqlitePathForId(selfId);
             auto db = kj::heap<SqliteDatabase>(
                 as.vfs, kj::mv(path), kj::WriteMode::CREATE | kj::WriteMode::MODIFY);
 
             // Before we do anything, make sure the database is in WAL mode. We also need to
             // do this after reset() is used, so register a callback for that.
-            db->run("PRAGMA journal_mode=WAL;");
-
-            db->afterReset([this, &dir = *as.directory, selfId](SqliteDatabase& db) {
+            //
+            // With group commit, SQLite doesn't sync the WAL on commit; the commit callback above
+            // has it synced along with other databases' instead.
+            bool groupCommit = as.groupCommit != kj::none;
+            auto setPragmas = [groupCommit](SqliteDatabase& db) {
               db.run("PRAGMA journal_mode=WAL;");
+              if (groupCommit) {
+                db.run("PRAGMA synchronous=NORMAL;");
+              }
+            };
+            setPragmas(*db);
+
+            db->afterReset([this, &dir = *as.directory, selfId, setPragmas](SqliteDatabase& db) {
+              setPragmas(db);
 
               // reset() is used when the app called deleteAll(), in which case we also want to
               // delete all child facets.
@@ -1283,8 +1382,8 @@ class Server::ActorNamespace final {
               deleteDescendantStorage(dir, selfId);
             });
 
-            return kj::heap<ActorSqlite>(kj::mv(db), outputGate,
-                [](SpanParent) -> kj::Promise<void> { return kj::READY_NOW; }, *sqliteHooks)
+            return kj::heap<ActorSqlite>(
+                kj::mv(db), outputGate, kj::mv(commitCallback), *sqliteHooks)
                 .attach(kj::mv(sqliteHooks));
           } else {
             // Create an ActorCache backed by a fake, empty storage. Elsewhere, we configure
@@ -1422,8 +1521,8 @@ class Server::ActorNamespace final {
     }
 
     // No existing container in the map, create a new one
-    auto& dockerPathRef = KJ_ASSERT_NONNULL(
-        dockerPath, "dockerPath must be defined to enable containers on this Durable Object.");
+    auto& dockerApi = KJ_ASSERT_NONNULL(dockerApiClient,
+        "dockerPath must be defined to enable containers on this Durable Object.");
 
     // Grab a branch of any pending cleanup from a previous ContainerClient for this
     // container. If it exists, pass it to the container client so it knows that it has to sync.
@@ -1471,7 +1570,7 @@ class Server::ActorNamespace final {
     };
 
     auto client = kj::refcounted<ContainerClient>(byteStreamFactory, timer, dockerNetwork,
-        kj::str(dockerPathRef), kj::str(containerId), kj::str(imageName),
+        dockerApi.addRef(), kj::str(containerId), kj::str(imageName),
         kj::str(KJ_ASSERT_NONNULL(containerEgressInterceptorImage,
             "containerEgressInterceptorImage must be configured for containers.")),
         waitUntilTasks, kj::mv(previousCleanup), kj::mv(cleanupCallback), channelTokenHandler,
@@ -1534,6 +1633,9 @@ class Server::ActorNamespace final {
     kj::Own<const kj::Directory> directory;
     SqliteDatabase::Vfs vfs;
 
+    // Set if the Worker uses `groupCommit` durability.
+    kj::Maybe<ActorStorageGroupCommit> groupCommit;
+
     ActorStorage(kj::Own<const kj::Directory> directoryParam)
         : directory(kj::mv(directoryParam)),
           vfs(*directory) {}
@@ -1544,6 +1646,26 @@ class Server::ActorNamespace final {
   kj::Maybe<ActorStorage> actorStorage;
   kj::Maybe<kj::Own<AlarmScheduler>> ownAlarmScheduler;
 
+  // Limits on the databases kept open for evicted actors (see ActorContainer::warmDatabase), by
+  // count and by SQLite memory held. When either is exceeded, the databases of the actors evicted
+  // longest ago are closed first.
+  static constexpr size_t MAX_WARM_DATABASES = 64;
+  static constexpr size_t MAX_WARM_DATABASE_BYTES = 64 * 1024 * 1024;
+
+  // Actors holding a warm database, from least to most recently evicted. Declared before `actors`
+  // so it outlives every ActorContainer.
+  kj::List<ActorContainer, &ActorContainer::warmDatabaseLink> warmDatabases;
+  size_t warmDatabaseBytes = 0;
+
+  void addWarmDatabase(ActorContainer& container, size_t bytes) {
+    warmDatabases.add(container);
+    warmDatabaseBytes += bytes;
+    while (warmDatabases.size() > MAX_WARM_DATABASES ||
+        warmDatabaseBytes > MAX_WARM_DATABASE_BYTES) {
+      warmDatabases.front().dropWarmDatabase();
+    }
+  }
+
   // Tracks the canceler and cleanup promise for a Docker container's lifecycle cleanup.
   // Useful to await on async calls of a ContainerClient destructor when the new
   // one appears before they've been resolved.
@@ -1581,7 +1703,7 @@ class Server::ActorNamespace final {
   capnp::ByteStreamFactory& byteStreamFactory;
   ChannelTokenHandler& channelTokenHandler;
   kj::Network& dockerNetwork;
-  kj::Maybe<kj::StringPtr> dockerPath;
+  kj::Maybe<DockerApiClient&> dockerApiClient;
   kj::Maybe<kj::StringPtr> containerEgressInterceptorImage;
   kj::TaskSet& waitUntilTasks;
 
@@ -1848,6 +1970,17 @@ class Server::HttpRewriter {
     if (httpOptions.hasCapnpConnectHost()) {
       capnpConnectHost = httpOptions.getCapnpConnectHost();
     }
+    if (httpOptions.hasWebSocketCompression()) {
+      auto config = httpOptions.getWebSocketCompression();
+      webSocketCompression = kj::refcounted<WebSocketCompressionPolicy>(
+          WebSocketCompressionPolicy::Limits{
+            .maxCompressedConnections = config.getMaxCompressedConnections(),
+            .serverMaxWindowBits = config.getServerMaxWindowBits(),
+            .clientMaxWindowBits = config.getClientMaxWindowBits(),
+            .serverNoContextTakeover = config.getServerNoContextTakeover(),
+            .clientNoContextTakeover = config.getClientNoContextTakeover(),
+          });
+    }
   }
 
   bool hasCfBlobHeader() {
@@ -1928,13 +2061,26 @@ class Server::HttpRewriter {
   }
 
   bool needsRewriteResponse() {
-    return !responseInjector.empty();
+    return !responseInjector.empty() || webSocketCompression != kj::none;
   }
 
   void rewriteResponse(kj::HttpHeaders& headers) {
     responseInjector.apply(headers);
   }
 
+  // Rewrites the response headers and accepts a WebSocket from a client whose request had the
+  // given `Sec-WebSocket-Extensions` header.
+  kj::Own<kj::WebSocket> acceptWebSocket(kj::HttpService::Response& response,
+      const kj::HttpHeaders& headers,
+      kj::Maybe<kj::StringPtr> extensionOffer) {
+    auto rewrite = headers.cloneShallow();
+    rewriteResponse(rewrite);
+    KJ_IF_SOME(policy, webSocketCompression) {
+      return policy->acceptWebSocket(response, rewrite, extensionOffer);
+    }
+    return response.acceptWebSocket(rewrite);
+  }
+
   kj::Maybe<kj::StringPtr> getCapnpConnectHost() {
     return capnpConnectHost;
   }
@@ -1944,6 +2090,7 @@ class Server::HttpRewriter {
   kj::Maybe<kj::HttpHeaderId> forwardedProtoHeader;
   kj::Maybe<kj::HttpHeaderId> cfBlobHeader;
   kj::Maybe<kj::StringPtr> capnpConnectHost;
+  kj::Maybe<kj::Own<WebSocketCompressionPolicy>> webSocketCompression;
 
   class HeaderInjector {
    public:
@@ -3060,10 +3207,28 @@ void Server::InspectorServiceIsolateRegistrar::registerIsolate(
 namespace {
 class RequestObserverWithTracer final: public RequestObserver, public WorkerInterface {
  public:
-  RequestObserverWithTracer(kj::Maybe<kj::Own<WorkerTracer>> tracer, kj::TaskSet& waitUntilTasks)
-      : tracer(kj::mv(tracer)) {}
+  RequestObserverWithTracer(kj::Maybe<kj::Own<WorkerTracer>> tracer,
+      kj::TaskSet& waitUntilTasks,
+      kj::Maybe<TraceSnapshotter&> traceSnapshotter = kj::none)
+      : tracer(kj::mv(tracer)) {
+    KJ_IF_SOME(snapshotter, traceSnapshotter) {
+      KJ_IF_SOME(threshold, snapshotter.getSlowRequestThreshold()) {
+        slowRequest = SlowRequestCheck{
+          .snapshotter = snapshotter,
+          .threshold = threshold,
+          .startTime = snapshotter.getClock().now(),
+        };
+      }
+    }
+  }
 
   ~RequestObserverWithTracer() noexcept(false) {
+    KJ_IF_SOME(check, slowRequest) {
+      if (check.snapshotter.getClock().now() - check.startTime > check.threshold) {
+        check.snapshotter.trigger("slow-request"_kj);
+      }
+    }
+
     KJ_IF_SOME(t, tracer) {
       // for a more precise end time, set the end timestamp now, if available
       KJ_IF_SOME(ioContext, IoContext::tryCurrent()) {
@@ -3196,6 +3361,13 @@ class RequestObserverWithTracer final: public RequestObserver, public WorkerInte
   kj::Maybe<kj::Own<WorkerTracer>> tracer;
   kj::Maybe<WorkerInterface&> inner;
   EventOutcome outcome = EventOutcome::OK;
+
+  struct SlowRequestCheck {
+    TraceSnapshotter& snapshotter;
+    kj::Duration threshold;
+    kj::TimePoint startTime;
+  };
+  kj::Maybe<SlowRequestCheck> slowRequest;
 };
 
 class SequentialSpanSubmitter final: public SpanSubmitter {
@@ -3244,78 +3416,6 @@ class SequentialSpanSubmitter final: public SpanSubmitter {
   kj::EntropySource& entropySource;
 };
 
-// IsolateLimitEnforcer that enforces no limits.
-class NullIsolateLimitEnforcer final: public IsolateLimitEnforcer {
- public:
-  v8::Isolate::CreateParams getCreateParams() override {
-    return {};
-  }
-
-  void customizeIsolate(v8::Isolate* isolate) override {}
-
-  ActorCacheSharedLruOptions getActorCacheLruOptions() override {
-    // TODO(someday): Make this configurable?
-    return {.softLimit = 16 * (1ull << 20),  // 16 MiB
-      .hardLimit = 128 * (1ull << 20),       // 128 MiB
-      .staleTimeout = 30 * kj::SECONDS,
-      .dirtyListByteLimit = 8 * (1ull << 20),  // 8 MiB
-      .maxKeysPerRpc = 128,
-
-      // For now, we use `neverFlush` to implement in-memory-only actors.
-      // See WorkerService::getActor().
-      .neverFlush = true};
-  }
-
-  kj::Own<void> enterStartupJs(
-      jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>&) const override {
-    return {};
-  }
-
-  kj::Own<void> enterStartupPython(
-      jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>&) const override {
-    return {};
-  }
-
-  kj::Own<void> enterDynamicImportJs(
-      jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>&) const override {
-    return {};
-  }
-
-  kj::Own<void> enterLoggingJs(
-      jsg::Lock& lock, kj::OneOf<kj::Exception, kj::Duration>&) const override {
-    return {};
-  }
-
-  kj::Own<void> enterInspectorJs(
-      jsg::Lock& loc, kj::OneOf<kj::Exception, kj::Duration>&) const override {
-    return {};
-  }
-
-  void completedRequest(kj::StringPtr id) const override {}
-
-  bool exitJs(jsg::Lock& lock) const override {
-    return false;
-  }
-
-  void reportMetrics(IsolateObserver& isolateMetrics) const override {}
-
-  kj::Maybe<size_t> checkPbkdfIterations(jsg::Lock& lock, size_t iterations) const override {
-    // No limit on the number of iterations in workerd
-    return kj::none;
-  }
-
-  bool hasExcessivelyExceededHeapLimit() const override {
-    return false;
-  }
-
-  const TrackedWasmInstanceList& getTrackedWasmInstances() const override {
-    return trackedWasmInstances;
-  }
-
- private:
-  TrackedWasmInstanceList trackedWasmInstances;
-};
-
 }  // namespace
 
 // Shared ErrorReporter base implemnetation. The logic to collect entrypoint information is the
@@ -3403,6 +3503,7 @@ class Server::WorkerService final: public Service,
     kj::Array<kj::Own<IoChannelFactory::RpcChannel>> rpc;
     kj::Maybe<kj::Own<IoChannelFactory::SubrequestChannel>> cache;
     kj::Maybe<const kj::Directory&> actorStorage;
+    kj::Maybe<ActorStorageGroupCommit> actorStorageGroupCommit;
     kj::Array<kj::Own<IoChannelFactory::SubrequestChannel>> tails;
     kj::Array<kj::Own<IoChannelFactory::SubrequestChannel>> streamingTails;
     kj::Array<kj::Rc<WorkerLoaderNamespace>> workerLoaders;
@@ -3425,11 +3526,15 @@ class Server::WorkerService final: public Service,
       LinkCallback linkCallback,
       AbortActorsCallback abortActorsCallback,
       DeleteActorsCallback deleteActorsCallback,
-      kj::Maybe<kj::String> dockerPathParam,
+      kj::Maybe<kj::Own<DockerApiClient>> dockerApiClientParam,
       kj::Maybe<kj::String> containerEgressInterceptorImageParam,
       bool isDynamic,
       kj::Maybe<kj::Function<void()>> abortIsolateCallback = kj::none,
-      kj::Maybe<kj::String> accessBlobHeaderNameParam = kj::none)
+      kj::Maybe<kj::String> accessBlobHeaderNameParam = kj::none,
+      kj::Maybe<TraceSnapshotter&> traceSnapshotter = kj::none,
+      WorkerLimits limits = {},
+      kj::Maybe<kj::Own<CpuLimitWatchdog>> cpuLimitWatchdog = kj::none,
+      tracing::TailStreamBatchOptions streamingTailBatchOptions = {})
       : channelTokenHandler(channelTokenHandler),
         serviceName(serviceName),
         threadContext(threadContext),
@@ -3442,11 +3547,16 @@ class Server::WorkerService final: public Service,
         waitUntilTasks(*this),
         abortActorsCallback(kj::mv(abortActorsCallback)),
         deleteActorsCallback(kj::mv(deleteActorsCallback)),
-        dockerPath(kj::mv(dockerPathParam)),
+        dockerApiClient(kj::mv(dockerApiClientParam)),
         containerEgressInterceptorImage(kj::mv(containerEgressInterceptorImageParam)),
         isDynamic(isDynamic),
         abortIsolateCallback(kj::mv(abortIsolateCallback)),
-        accessBlobHeaderName(kj::mv(accessBlobHeaderNameParam)) {}
+        accessBlobHeaderName(kj::mv(accessBlobHeaderNameParam)),
+        traceSnapshotter(traceSnapshotter),
+        limits(limits),
+        cpuLimitWatchdog(kj::mv(cpuLimitWatchdog)),
+        streamingTailBatchOptions(streamingTailBatchOptions),
+        streamingTailObserver(kj::refcounted<StreamingTailObserver>(serviceName)) {}
 
   // Call immediately after the constructor to set up `actorNamespaces`. This can't happen during
   // the constructor itself since it sets up cyclic references, which will throw an exception if
@@ -3469,7 +3579,8 @@ class Server::WorkerService final: public Service,
       auto actorClass = kj::refcounted<ActorClassImpl>(*this, entry.key, Frankenvalue());
       auto ns = kj::heap<ActorNamespace>(kj::mv(actorClass), entry.value,
           kj::systemPreciseCalendarClock(), threadContext.getUnsafeTimer(),
-          threadContext.getByteStreamFactory(), channelTokenHandler, network, dockerPath,
+          threadContext.getByteStreamFactory(), channelTokenHandler, network,
+          dockerApiClient.map([](kj::Own<DockerApiClient>& c) -> DockerApiClient& { return *c; }),
           containerEgressInterceptorImage, waitUntilTasks, selfTokensArePersistent());
       KJ_IF_SOME(d, entry.value.tryGet<Durable>()) {
         actorNamespacesByUniqueKey.insert(d.uniqueKey, ns.get());
@@ -3603,7 +3714,7 @@ class Server::WorkerService final: public Service,
     auto linked = callback(*this, errorReporter);
 
     for (auto& ns: actorNamespaces) {
-      ns.value->link(linked.actorStorage);
+      ns.value->link(linked.actorStorage, linked.actorStorageGroupCommit);
     }
 
     ioChannels = kj::mv(linked);
@@ -3883,7 +3994,8 @@ class Server::WorkerService final: public Service,
         }
       }
       auto tailStreamWriter = tracing::initializeTailStreamWriter(
-          streamingTailWorkers.releaseAsArray(), waitUntilTasks);
+          streamingTailWorkers.releaseAsArray(), waitUntilTasks, threadContext.getUnsafeTimer(),
+          streamingTailBatchOptions, kj::addRef(*streamingTailObserver));
       auto trace = kj::refcounted<Trace>(kj::none /* stableId */, kj::none /* scriptName */,
           kj::none /* scriptVersion */, kj::none /* dispatchNamespace */, kj::none /* scriptId */,
           nullptr /* scriptTags */, mapCopyString(entrypointName), executionModel,
@@ -3919,8 +4031,8 @@ class Server::WorkerService final: public Service,
             traceFlags));
       });
     }
-    kj::Own<RequestObserver> observer =
-        kj::refcounted<RequestObserverWithTracer>(mapAddRef(workerTracer), waitUntilTasks);
+    kj::Own<RequestObserver> observer = kj::refcounted<RequestObserverWithTracer>(
+        mapAddRef(workerTracer), waitUntilTasks, traceSnapshotter);
 
     kj::Maybe<tracing::InvocationSpanContext> triggerContext;
     KJ_IF_SOME(ctx, metadata.userSpanParent.toSpanContext()) {
@@ -3930,9 +4042,18 @@ class Server::WorkerService final: public Service,
       }
     }
 
+    // WorkerService itself enforces no limits; if any are configured, wrap it in a per-request
+    // enforcer.
+    kj::Own<LimitEnforcer> limitEnforcer =
+        kj::attachRef(static_cast<LimitEnforcer&>(*this), kj::addRef(*this));
+    if (limits.hasRequestLimits()) {
+      limitEnforcer = newRequestLimitEnforcer(kj::mv(limitEnforcer), limits,
+          cpuLimitWatchdog.map(
+              [](kj::Own<CpuLimitWatchdog>& w) -> CpuLimitWatchdog& { return *w; }));
+    }
+
     return newWorkerEntrypoint(threadContext, kj::atomicAddRef(*worker), entrypointName.clone(),
-        kj::mv(props), kj::mv(actor),
-        kj::attachRef(static_cast<LimitEnforcer&>(*this), kj::addRef(*this)),
+        kj::mv(props), kj::mv(actor), kj::mv(limitEnforcer),
         {},  // ioContextDependency
         addRefToThis(), kj::mv(observer), waitUntilTasks,
         true,                  // tunnelExceptions
@@ -4183,12 +4304,36 @@ class Server::WorkerService final: public Service,
   kj::TaskSet waitUntilTasks;
   AbortActorsCallback abortActorsCallback;
   DeleteActorsCallback deleteActorsCallback;
-  kj::Maybe<kj::String> dockerPath;
+  kj::Maybe<kj::Own<DockerApiClient>> dockerApiClient;
   kj::Maybe<kj::String> containerEgressInterceptorImage;
   bool isDynamic;
   kj::Maybe<kj::Function<void()>> abortIsolateCallback;
   kj::Maybe<kj::String> accessBlobHeaderName;
   kj::Maybe<kj::uint> accessBindingServiceChannel;
+  kj::Maybe<TraceSnapshotter&> traceSnapshotter;
+  WorkerLimits limits;
+  kj::Maybe<kj::Own<CpuLimitWatchdog>> cpuLimitWatchdog;
+  tracing::TailStreamBatchOptions streamingTailBatchOptions;
+
+  // Warns the first time a streaming tail worker falls so far behind that this Worker's events
+  // have to be dropped. The tail worker itself only learns of this at the end of each stream.
+  class StreamingTailObserver final: public tracing::TailStreamObserver {
+   public:
+    StreamingTailObserver(kj::Maybe<kj::StringPtr> serviceName): serviceName(serviceName) {}
+
+    void eventDropped() override {
+      if (!warned) {
+        warned = true;
+        KJ_LOG(WARNING, "streaming tail workers are not keeping up; dropping tail events",
+            serviceName.orDefault("(dynamic)"_kj));
+      }
+    }
+
+   private:
+    kj::Maybe<kj::StringPtr> serviceName;
+    bool warned = false;
+  };
+  kj::Own<StreamingTailObserver> streamingTailObserver;
 
   // ---------------------------------------------------------------------------
   // implements kj::TaskSet::ErrorHandler
@@ -5083,6 +5228,16 @@ struct Server::WorkerDef {
 
   // ServiceDesignator for the access binding worker. Resolved during linkCallback.
   kj::Maybe<config::ServiceDesignator::Reader> accessBindingServiceDesignator;
+
+  // CPU and heap limits, from Worker.limits in the config. Dynamic workers are unlimited.
+  WorkerLimits limits;
+
+  // From Worker.streamingTailBatching in the config.
+  tracing::TailStreamBatchOptions streamingTailBatchOptions;
+
+  // If the Worker's Durable Objects use `groupCommit` durability, the longest a write may wait
+  // for its group to be synced.
+  kj::Maybe<kj::Duration> actorStorageGroupCommitWindow;
 };
 
 class Server::WorkerLoaderNamespace: public kj::Refcounted, private kj::TaskSet::ErrorHandler {
@@ -5626,6 +5781,46 @@ kj::Promise<kj::Own<Server::Service>> Server::makeWorker(kj::StringPtr name,
     if (!conf.hasAccessBindingService()) return kj::none;
     return conf.getAccessBindingService();
   }(),
+
+    .limits = [&]() -> WorkerLimits {
+    WorkerLimits result;
+    if (!conf.hasLimits()) return result;
+    auto limits = conf.getLimits();
+    if (limits.getCpuMillis() > 0) {
+      result.cpuTime = limits.getCpuMillis() * kj::MILLISECONDS;
+    }
+    result.heapSoftLimit = size_t(limits.getHeapSoftLimitMb()) << 20;
+    result.heapHardLimit = size_t(limits.getHeapHardLimitMb()) << 20;
+    result.tmpMemoryLimit = size_t(limits.getTmpMemoryMb()) << 20;
+    if (result.heapSoftLimit > 0 && result.heapHardLimit > 0 &&
+        result.heapSoftLimit > result.heapHardLimit) {
+      errorReporter.addError(kj::str("Worker \"", name,
+          "\" has a heapSoftLimitMb greater than its heapHardLimitMb."));
+    }
+    return result;
+  }(),
+
+    .streamingTailBatchOptions = [&]() -> tracing::TailStreamBatchOptions {
+    auto batching = conf.getStreamingTailBatching();
+    return {
+      .maxBatchBytes = batching.getMaxBatchBytes(),
+      .maxBatchDelay = batching.getMaxBatchDelayMillis() * kj::MILLISECONDS,
+    };
+  }(),
+
+    .actorStorageGroupCommitWindow = [&]() -> kj::Maybe<kj::Duration> {
+    auto durability = conf.getDurableObjectDurability();
+    switch (durability.which()) {
+      case config::Worker::DurableObjectDurability::PER_DATABASE:
+        return kj::none;
+      case config::Worker::DurableObjectDurability::GROUP_COMMIT:
+        return durability.getGroupCommit().getWindowMicros() * kj::MICROSECONDS;
+    }
+    errorReporter.addError(kj::str("Worker \"", name,
+        "\" has unrecognized durableObjectDurability. Was the config compiled with a "
+        "newer version of the schema?"));
+    return kj::none;
+  }(),
   };
 
   co_return co_await makeWorkerImpl(name, kj::mv(def), extensions, errorReporter);
@@ -5639,15 +5834,28 @@ kj::Promise<kj::Own<Server::WorkerService>> Server::makeWorkerImpl(kj::StringPtr
   co_await preloadPython(name, def, errorReporter);
 
   auto jsgobserver = kj::atomicRefcounted<JsgIsolateObserver>();
-  auto observer = kj::atomicRefcounted<IsolateObserver>();
-  auto limitEnforcer = kj::refcounted<NullIsolateLimitEnforcer>();
+  kj::Own<IsolateObserver> observer = kj::atomicRefcounted<IsolateObserver>();
+  KJ_IF_SOME(snapshotter, traceSnapshotter) {
+    KJ_IF_SOME(threshold, snapshotter->getSlowLockWaitThreshold()) {
+      observer = kj::atomicRefcounted<SlowLockWaitObserver>(*snapshotter, threshold);
+    }
+  }
+  auto limitEnforcer = kj::refcounted<IsolateLimitEnforcerImpl>(def.limits.heapHardLimit);
 
   // Create the FsMap that will be used to map known file system
   // roots to configurable locations.
   // TODO(node-fs): This is set up to allow users to configure the "mount"
   // points for known roots but we currently do not expose that in the
   // config. So for now this just uses the defaults.
-  auto workerFs = newWorkerFileSystem(kj::heap<FsMap>(), getBundleDirectory(def.source));
+  kj::Maybe<kj::Arc<FileSpillPolicy>> spillPolicy;
+  if (def.limits.tmpMemoryLimit > 0) {
+    const char* tmpdir = getenv("TMPDIR");
+    auto scratchPath = fs.getCurrentPath().evalNative(tmpdir == nullptr ? "/tmp" : tmpdir);
+    spillPolicy = kj::arc<FileSpillPolicy>(
+        fs.getRoot().openSubdir(scratchPath, kj::WriteMode::MODIFY), def.limits.tmpMemoryLimit);
+  }
+  auto workerFs = newWorkerFileSystem(kj::heap<FsMap>(), getBundleDirectory(def.source),
+      kj::heap<VirtualFileSystem::Observer>(), kj::mv(spillPolicy));
 
   // Note: Python workers do not support the new module registry;
   // isNewModuleRegistryEnabled() returns false for them regardless of the
@@ -5723,6 +5931,10 @@ kj::Promise<kj::Own<Server::WorkerService>> Server::makeWorkerImpl(kj::StringPtr
     isolateRegistrar->registerIsolate(name, isolate.get());
   }
 
+  KJ_IF_SOME(exporter, cpuProfileExporter) {
+    exporter->addIsolate(name, *isolate);
+  }
+
   if (!usingNewModuleRegistry) {
     KJ_IF_SOME(moduleFallback, def.moduleFallback) {
       KJ_REQUIRE(experimental,
@@ -5871,6 +6083,8 @@ kj::Promise<kj::Own<Server::WorkerService>> Server::makeWorkerImpl(kj::StringPtr
   // extracted beforehand.
   auto abortIsolateCallback = kj::mv(def.abortIsolateCallback);
   auto accessBlobHeaderName = kj::mv(def.accessBlobHeaderName);
+  auto limits = def.limits;
+  auto streamingTailBatchOptions = def.streamingTailBatchOptions;
 
   auto linkCallback = [this, def = kj::mv(def), totalActorChannels](WorkerService& workerService,
                           Worker::ValidationErrorReporter& errorReporter) mutable {
@@ -5990,6 +6204,18 @@ kj::Promise<kj::Own<Server::WorkerService>> Server::makeWorkerImpl(kj::StringPtr
         KJ_IF_SOME(diskSvc, kj::tryDowncast<DiskDirectoryService>(*svc)) {
           KJ_IF_SOME(dir, diskSvc.getWritable()) {
             result.actorStorage = dir;
+
+            KJ_IF_SOME(window, def.actorStorageGroupCommitWindow) {
+              // One committer serves every Worker, so that all of the thread's Durable Objects
+              // can share groups.
+              if (sqliteGroupCommitter == kj::none) {
+                sqliteGroupCommitter = kj::heap<SqliteGroupCommitter>(timer);
+              }
+              result.actorStorageGroupCommit = ActorStorageGroupCommit{
+                .committer = *KJ_ASSERT_NONNULL(sqliteGroupCommitter),
+                .window = window,
+              };
+            }
           } else {
             errorReporter.addError(
                 kj::str("durableObjectStorage config refers to the disk service \"", diskName,
@@ -6033,7 +6259,7 @@ kj::Promise<kj::Own<Server::WorkerService>> Server::makeWorkerImpl(kj::StringPtr
     return result;
   };
 
-  kj::Maybe<kj::String> dockerPath = kj::none;
+  kj::Maybe<kj::Own<DockerApiClient>> dockerApiClient = kj::none;
   kj::Maybe<kj::String> containerEgressInterceptorImage = kj::none;
   switch (def.containerEngineConf.which()) {
     case config::Worker::ContainerEngine::NONE:
@@ -6041,7 +6267,23 @@ kj::Promise<kj::Own<Server::WorkerService>> Server::makeWorkerImpl(kj::StringPtr
       break;
     case config::Worker::ContainerEngine::LOCAL_DOCKER: {
       auto dockerConf = def.containerEngineConf.getLocalDocker();
-      dockerPath = kj::str(dockerConf.getSocketPath());
+      kj::StringPtr socketPath = dockerConf.getSocketPath();
+      auto& client = dockerApiClients.findOrCreate(
+          socketPath, [&]() -> decltype(dockerApiClients)::Entry {
+        return {kj::str(socketPath),
+          kj::refcounted<DockerApiClient>(globalContext->threadContext.getUnsafeTimer(), network,
+              kj::str(socketPath),
+              DockerApiClientOptions{.prewarmedSidecars = dockerConf.getPrewarmedSidecars()})};
+      });
+      // The pool belongs to the socket's client, so every worker sharing the socket must agree
+      // on its size.
+      auto poolSize = client->getOptions().prewarmedSidecars;
+      if (poolSize != dockerConf.getPrewarmedSidecars()) {
+        errorReporter.addError(kj::str("Worker \"", name, "\" sets prewarmedSidecars to ",
+            dockerConf.getPrewarmedSidecars(), " for Docker socket \"", socketPath,
+            "\", but another worker using the same socket sets it to ", poolSize, "."));
+      }
+      dockerApiClient = client->addRef();
       if (dockerConf.hasContainerEgressInterceptorImage()) {
         containerEgressInterceptorImage = kj::str(dockerConf.getContainerEgressInterceptorImage());
       }
@@ -6052,13 +6294,24 @@ kj::Promise<kj::Own<Server::WorkerService>> Server::makeWorkerImpl(kj::StringPtr
   kj::Maybe<kj::StringPtr> serviceName;
   if (!def.isDynamic) serviceName = name;
 
+  kj::Maybe<kj::Own<CpuLimitWatchdog>> workerCpuLimitWatchdog;
+  if (limits.cpuTime != kj::none) {
+    // One watchdog thread serves every Worker that has a CPU limit.
+    if (cpuLimitWatchdog == kj::none) {
+      cpuLimitWatchdog = kj::refcounted<CpuLimitWatchdog>();
+    }
+    workerCpuLimitWatchdog = kj::addRef(*KJ_ASSERT_NONNULL(cpuLimitWatchdog));
+  }
+
   auto result = kj::refcounted<WorkerService>(channelTokenHandler, serviceName,
       globalContext->threadContext, monotonicClock, kj::mv(worker),
       kj::mv(errorReporter.defaultEntrypoint), kj::mv(errorReporter.namedEntrypoints),
       kj::mv(errorReporter.actorClasses), kj::mv(linkCallback),
       KJ_BIND_METHOD(*this, abortAllActors), KJ_BIND_METHOD(*this, deleteAllActors),
-      kj::mv(dockerPath), kj::mv(containerEgressInterceptorImage), def.isDynamic,
-      kj::mv(abortIsolateCallback), kj::mv(accessBlobHeaderName));
+      kj::mv(dockerApiClient), kj::mv(containerEgressInterceptorImage), def.isDynamic,
+      kj::mv(abortIsolateCallback), kj::mv(accessBlobHeaderName),
+      traceSnapshotter.map([](kj::Own<TraceSnapshotter>& t) -> TraceSnapshotter& { return *t; }),
+      limits, kj::mv(workerCpuLimitWatchdog), streamingTailBatchOptions);
   result->initActorNamespaces(def.localActorConfigs, actorNamespacesByUniqueKey, network);
   co_return result;
 }
@@ -6497,9 +6750,12 @@ class Server::HttpListener final: public kj::Refcounted {
 
     class ResponseWrapper final: public kj::HttpService::Response {
      public:
-      ResponseWrapper(kj::HttpService::Response& inner, HttpRewriter& rewriter)
+      ResponseWrapper(kj::HttpService::Response& inner,
+          HttpRewriter& rewriter,
+          kj::Maybe<kj::StringPtr> extensionOffer)
           : inner(inner),
-            rewriter(rewriter) {}
+            rewriter(rewriter),
+            extensionOffer(extensionOffer) {}
 
       kj::Own<kj::AsyncOutputStream> send(uint statusCode,
           kj::StringPtr statusText,
@@ -6513,14 +6769,15 @@ class Server::HttpListener final: public kj::Refcounted {
 
       kj::Own<kj::WebSocket> acceptWebSocket(const kj::HttpHeaders& headers) override {
         TRACE_EVENT("workerd", "ResponseWrapper::acceptWebSocket()");
-        auto rewrite = headers.cloneShallow();
-        rewriter.rewriteResponse(rewrite);
-        return inner.acceptWebSocket(rewrite);
+        return rewriter.acceptWebSocket(inner, headers, extensionOffer);
       }
 
      private:
       kj::HttpService::Response& inner;
       HttpRewriter& rewriter;
+
+      // The client's `Sec-WebSocket-Extensions` request header, if any.
+      kj::Maybe<kj::StringPtr> extensionOffer;
     };
 
     // ---------------------------------------------------------------------------
@@ -6538,7 +6795,8 @@ class Server::HttpListener final: public kj::Refcounted {
       Response* wrappedResponse = &response;
       kj::Own<ResponseWrapper> ownResponse;
       if (parent.rewriter->needsRewriteResponse()) {
-        wrappedResponse = ownResponse = kj::heap<ResponseWrapper>(response, *parent.rewriter);
+        wrappedResponse = ownResponse = kj::heap<ResponseWrapper>(
+            response, *parent.rewriter, headers.get(kj::HttpHeaderId::SEC_WEBSOCKET_EXTENSIONS));
       }
 
       if (parent.rewriter->needsRewriteRequest() || cfBlobJson != kj::none) {
@@ -6763,6 +7021,17 @@ class Server::WorkerdDebugPortImpl final: public rpc::WorkerdDebugPort::Server {
     return kj::READY_NOW;
   }
 
+  kj::Promise<void> snapshotTrace(SnapshotTraceContext context) override {
+    bool triggered = false;
+    KJ_IF_SOME(snapshotter, srv.traceSnapshotter) {
+      kj::StringPtr reason = context.getParams().getReason();
+      if (reason.size() == 0) reason = "debug-port"_kj;
+      triggered = snapshotter->trigger(reason);
+    }
+    context.initResults(capnp::MessageSize{2, 0}).setTriggered(triggered);
+    return kj::READY_NOW;
+  }
+
  private:
   workerd::server::Server& srv;
   capnp::HttpOverCapnpFactory& httpOverCapnpFactory;
@@ -6812,6 +7081,12 @@ kj::Promise<void> Server::handleDrain(kj::Promise<void> drainWhen) {
     // doc comment, we instead add the promise to `tasks` to be safe.
     tasks.add(httpServer.httpServer.drain());
   }
+
+  // Remove pooled containers now, while the event loop is still running. drainPrewarmPool()
+  // never throws.
+  for (auto& client: dockerApiClients) {
+    tasks.add(client.value->drainPrewarmPool());
+  }
 }
 
 kj::Promise<void> Server::run(
@@ -6935,6 +7210,39 @@ kj::Promise<void> Server::startServices(jsg::V8System& v8System,
   // Configure services
   TRACE_EVENT("workerd", "startServices");
 
+  if (config.getEventLoopStallThresholdMs() > 0) {
+    auto& detector = *eventLoopStallDetector.emplace(kj::heap<EventLoopStallDetector>(
+        timer, config.getEventLoopStallThresholdMs() * kj::MILLISECONDS));
+    tasks.add(detector.run());
+  }
+
+  if (config.hasCpuProfiling()) {
+    auto conf = config.getCpuProfiling();
+    auto path = fs.getCurrentPath().evalNative(conf.getDirectory());
+    if (conf.getSamplingIntervalUs() == 0) {
+      reportConfigError(kj::str("cpuProfiling.samplingIntervalUs must be greater than zero."));
+    } else if (conf.getPeriodSeconds() == 0) {
+      reportConfigError(kj::str("cpuProfiling.periodSeconds must be greater than zero."));
+    } else KJ_IF_SOME(dir, fs.getRoot().tryOpenSubdir(kj::mv(path), kj::WriteMode::MODIFY)) {
+      auto& exporter = *cpuProfileExporter.emplace(kj::heap<CpuProfileExporter>(kj::mv(dir), timer,
+          CpuProfileExporter::Options{
+            .samplingInterval = conf.getSamplingIntervalUs() * kj::MICROSECONDS,
+            .period = conf.getPeriodSeconds() * kj::SECONDS,
+          }));
+      tasks.add(exporter.run());
+    } else {
+      reportConfigError(kj::str("CPU profiling directory not found: ", conf.getDirectory()));
+    }
+  }
+
+  if (config.getSqlitePageCacheMb() > 0) {
+    // This must happen before any SQLite database is opened, which is why it's done first.
+    if (!installSqliteGlobalPageCache(size_t(config.getSqlitePageCacheMb()) << 20)) {
+      reportConfigWarning(kj::str("sqlitePageCacheMb is ignored because SQLite was already "
+                                  "initialized with its default page cache."));
+    }
+  }
+
   // First pass: Extract actor namespace configs.
   for (auto serviceConf: config.getServices()) {
     kj::StringPtr name = serviceConf.getName();
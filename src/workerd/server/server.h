@@ -5,6 +5,7 @@
 #pragma once
 
 #include "channel-token.h"
+#include "trace-snapshotter.h"
 
 #include <workerd/api/memory-cache.h>
 #include <workerd/api/pyodide/pyodide.h>
@@ -21,6 +22,10 @@ namespace kj {
 class TlsContext;
 }
 
+namespace workerd {
+class EventLoopStallDetector;
+}
+
 namespace workerd::jsg {
 class V8System;
 }
@@ -29,6 +34,11 @@ namespace workerd::server {
 
 using api::pyodide::PythonConfig;
 
+class DockerApiClient;
+class CpuLimitWatchdog;
+class CpuProfileExporter;
+class SqliteGroupCommitter;
+
 // Implements the single-tenant Workers Runtime server / CLI.
 //
 // The purpose of this class is to implement the core logic independently of the CLI itself,
@@ -72,6 +82,11 @@ class Server final: private kj::TaskSet::ErrorHandler, private ChannelTokenHandl
   void enableDebugPort(kj::String addr) {
     debugPortOverride = kj::mv(addr);
   }
+
+  // Configures when to snapshot an always-on, in-memory trace buffer (e.g. a perfetto ring
+  // buffer), so that rare stalls can be examined after the fact.
+  using TraceSnapshotOptions = server::TraceSnapshotOptions;
+  void enableTraceSnapshots(TraceSnapshotOptions options);
   void setPackageDiskCacheRoot(kj::Maybe<kj::Own<const kj::Directory>>&& dir) {
     pythonConfig.packageDiskCacheRoot = kj::mv(dir);
   }
@@ -177,6 +192,26 @@ class Server final: private kj::TaskSet::ErrorHandler, private ChannelTokenHandl
   kj::Maybe<kj::Own<InspectorServiceIsolateRegistrar>> inspectorIsolateRegistrar;
   kj::Maybe<kj::Own<kj::FdOutputStream>> controlOverride;
   kj::Maybe<kj::String> debugPortOverride;
+  kj::Maybe<kj::Own<TraceSnapshotter>> traceSnapshotter;
+
+  // Docker API clients, keyed by socket path, shared by all workers using that socket so that
+  // they share one connection pool.
+  kj::HashMap<kj::String, kj::Own<DockerApiClient>> dockerApiClients;
+
+  // Terminates JavaScript that runs past its Worker's CPU limit. Created when the first Worker
+  // with a CPU limit is constructed.
+  kj::Maybe<kj::Own<CpuLimitWatchdog>> cpuLimitWatchdog;
+
+  // Syncs the databases of Durable Objects whose Worker uses `groupCommit` durability. Created
+  // when first needed. Must outlive `services`.
+  kj::Maybe<kj::Own<SqliteGroupCommitter>> sqliteGroupCommitter;
+
+  // Set if `eventLoopStallThresholdMs` is configured. Declared before `tasks`, which runs its
+  // heartbeat.
+  kj::Maybe<kj::Own<EventLoopStallDetector>> eventLoopStallDetector;
+
+  // Set if `cpuProfiling` is configured. Declared before `tasks`, which runs its export loop.
+  kj::Maybe<kj::Own<CpuProfileExporter>> cpuProfileExporter;
 
   struct GlobalContext;
   // General context needed to construct workers. Initialized early in run().
@@ -0,0 +1,79 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "sqlite-group-commit.h"
+
+#include <kj/test.h>
+
+namespace workerd::server {
+namespace {
+
+struct TestContext {
+  kj::EventLoop loop;
+  kj::WaitScope ws{loop};
+  kj::TimerImpl timer{kj::origin<kj::TimePoint>()};
+  kj::Own<const kj::Directory> dir = kj::newInMemoryDirectory(kj::nullClock());
+  SqliteGroupCommitter committer{timer};
+
+  void advance(kj::Duration duration) {
+    timer.advanceTo(timer.now() + duration);
+    ws.poll();
+  }
+};
+
+KJ_TEST("SqliteGroupCommitter syncs requests within a window as one group") {
+  TestContext ctx;
+  ctx.dir->openFile(kj::Path({"a.sqlite-wal"}), kj::WriteMode::CREATE);
+  ctx.dir->openFile(kj::Path({"b.sqlite-wal"}), kj::WriteMode::CREATE);
+
+  auto a1 = ctx.committer.sync(*ctx.dir, kj::Path({"a.sqlite-wal"}), 10 * kj::MILLISECONDS);
+  ctx.advance(4 * kj::MILLISECONDS);
+  auto b = ctx.committer.sync(*ctx.dir, kj::Path({"b.sqlite-wal"}), 10 * kj::MILLISECONDS);
+  auto a2 = ctx.committer.sync(*ctx.dir, kj::Path({"a.sqlite-wal"}), 10 * kj::MILLISECONDS);
+
+  // A file that doesn't exist yet has nothing to sync, but still joins the group.
+  auto c = ctx.committer.sync(*ctx.dir, kj::Path({"c.sqlite-wal"}), 10 * kj::MILLISECONDS);
+
+  ctx.advance(5 * kj::MILLISECONDS);
+  KJ_EXPECT(!a1.poll(ctx.ws));
+  KJ_EXPECT(ctx.committer.getGroupCount() == 0);
+
+  // The first request's window has elapsed, so the whole group is synced, including requests
+  // whose own windows haven't elapsed yet.
+  ctx.advance(1 * kj::MILLISECONDS);
+  KJ_EXPECT(ctx.committer.getGroupCount() == 1);
+  KJ_EXPECT(a1.poll(ctx.ws));
+  KJ_EXPECT(a2.poll(ctx.ws));
+  KJ_EXPECT(b.poll(ctx.ws));
+  KJ_EXPECT(c.poll(ctx.ws));
+  a1.wait(ctx.ws);
+  a2.wait(ctx.ws);
+  b.wait(ctx.ws);
+  c.wait(ctx.ws);
+
+  // Nothing else was pending, so no further group is synced.
+  ctx.advance(10 * kj::MILLISECONDS);
+  KJ_EXPECT(ctx.committer.getGroupCount() == 1);
+}
+
+KJ_TEST("SqliteGroupCommitter flushes early for a request with a shorter window") {
+  TestContext ctx;
+
+  auto slow = ctx.committer.sync(*ctx.dir, kj::Path({"a.sqlite-wal"}), 100 * kj::MILLISECONDS);
+  auto fast = ctx.committer.sync(*ctx.dir, kj::Path({"b.sqlite-wal"}), 1 * kj::MILLISECONDS);
+
+  ctx.advance(1 * kj::MILLISECONDS);
+  KJ_EXPECT(ctx.committer.getGroupCount() == 1);
+  slow.wait(ctx.ws);
+  fast.wait(ctx.ws);
+
+  // A later request starts a new group.
+  auto next = ctx.committer.sync(*ctx.dir, kj::Path({"a.sqlite-wal"}), 0 * kj::MILLISECONDS);
+  ctx.advance(0 * kj::MILLISECONDS);
+  next.wait(ctx.ws);
+  KJ_EXPECT(ctx.committer.getGroupCount() == 2);
+}
+
+}  // namespace
+}  // namespace workerd::server
@@ -0,0 +1,78 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "sqlite-group-commit.h"
+
+#include <kj/debug.h>
+
+#include <algorithm>
+
+namespace workerd::server {
+
+SqliteGroupCommitter::SqliteGroupCommitter(kj::Timer& timer): timer(timer), flushTasks(*this) {}
+
+SqliteGroupCommitter::~SqliteGroupCommitter() noexcept(false) {}
+
+kj::Promise<void> SqliteGroupCommitter::sync(
+    const kj::Directory& dir, kj::Path path, kj::Duration window) {
+  auto pathStr = path.toString();
+  auto& file = pending.findOrCreate(FileKey{&dir, kj::str(pathStr)},
+      [&]() -> decltype(pending)::Entry {
+    return {FileKey{&dir, kj::mv(pathStr)}, PendingFile{.path = kj::mv(path)}};
+  });
+
+  auto paf = kj::newPromiseAndFulfiller<void>();
+  file.waiters.add(kj::mv(paf.fulfiller));
+
+  auto deadline = timer.now() + window;
+  bool needFlush = true;
+  KJ_IF_SOME(scheduled, nextFlush) {
+    needFlush = deadline < scheduled;
+  }
+  if (needFlush) {
+    nextFlush = deadline;
+    flushTasks.add(timer.atTime(deadline).then([this]() { flush(); }));
+  }
+
+  return kj::mv(paf.promise);
+}
+
+void SqliteGroupCommitter::flush() {
+  nextFlush = kj::none;
+  if (pending.size() == 0) return;
+
+  auto group = kj::mv(pending);
+  pending.clear();
+  ++groupCount;
+
+  // Each directory is synced once per group, after its files, so that a newly created WAL file
+  // can be found after a crash.
+  kj::Vector<const kj::Directory*> syncedDirs;
+  for (auto& entry: group) {
+    auto& dir = *entry.key.dir;
+    KJ_IF_SOME(exception, kj::runCatchingExceptions([&]() {
+      KJ_IF_SOME(file, dir.tryOpenFile(entry.value.path)) {
+        file->datasync();
+      }
+      if (std::find(syncedDirs.begin(), syncedDirs.end(), &dir) == syncedDirs.end()) {
+        dir.sync();
+        syncedDirs.add(&dir);
+      }
+    })) {
+      for (auto& waiter: entry.value.waiters) {
+        waiter->reject(kj::cp(exception));
+      }
+    } else {
+      for (auto& waiter: entry.value.waiters) {
+        waiter->fulfill();
+      }
+    }
+  }
+}
+
+void SqliteGroupCommitter::taskFailed(kj::Exception&& exception) {
+  KJ_LOG(ERROR, "SQLite group commit flush failed", exception);
+}
+
+}  // namespace workerd::server
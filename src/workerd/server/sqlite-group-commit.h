@@ -0,0 +1,83 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#pragma once
+
+#include <kj/async.h>
+#include <kj/filesystem.h>
+#include <kj/map.h>
+#include <kj/timer.h>
+
+namespace workerd::server {
+
+// Makes writes to many SQLite databases durable with one round of syncs per group, rather than
+// one sync per transaction per database.
+//
+// Databases using this run with `PRAGMA synchronous=NORMAL`, under which SQLite in WAL mode never
+// syncs on commit (it still syncs around checkpoints, which keeps the database itself consistent).
+// After each commit, the database's WAL file is passed to sync(). Requests arriving within a
+// short window of each other are collected into a group, each file in the group is synced once,
+// and then all of the group's promises resolve. ActorSqlite's output gate waits on that promise,
+// so nothing a Durable Object sends after a write is visible to the world until the write would
+// survive a crash.
+//
+// Syncs are performed on the event loop thread, like SQLite's own.
+class SqliteGroupCommitter final: private kj::TaskSet::ErrorHandler {
+ public:
+  explicit SqliteGroupCommitter(kj::Timer& timer);
+  ~SqliteGroupCommitter() noexcept(false);
+  KJ_DISALLOW_COPY_AND_MOVE(SqliteGroupCommitter);
+
+  // Returns a promise that resolves once everything written so far to the file at `path` in
+  // `dir` is on stable storage. The sync happens no later than `window` from now, together with
+  // those of every other file with a sync pending at that time. If the file doesn't exist, only
+  // the directory is synced.
+  //
+  // `dir` must remain valid until the returned promise settles.
+  kj::Promise<void> sync(const kj::Directory& dir, kj::Path path, kj::Duration window);
+
+  // Number of groups synced so far. For testing.
+  uint64_t getGroupCount() const {
+    return groupCount;
+  }
+
+ private:
+  struct FileKey {
+    const kj::Directory* dir;
+    kj::String path;
+
+    bool operator==(const FileKey& other) const {
+      return dir == other.dir && path == other.path;
+    }
+    uint hashCode() const {
+      return kj::hashCode(reinterpret_cast<uintptr_t>(dir), path);
+    }
+  };
+
+  struct PendingFile {
+    kj::Path path;
+    kj::Vector<kj::Own<kj::PromiseFulfiller<void>>> waiters;
+  };
+
+  kj::Timer& timer;
+
+  // Files with syncs requested since the last group was synced.
+  kj::HashMap<FileKey, PendingFile> pending;
+
+  // The earliest time at which a flush is scheduled, if any. A request whose window ends sooner
+  // schedules another flush. Flushes scheduled for later still fire, and sync whatever is pending
+  // at that time, which is never later than it was requested.
+  kj::Maybe<kj::TimePoint> nextFlush;
+
+  uint64_t groupCount = 0;
+
+  kj::TaskSet flushTasks;
+
+  // Syncs every pending file and settles the promises waiting on them.
+  void flush();
+
+  void taskFailed(kj::Exception&& exception) override;
+};
+
+}  // namespace workerd::server
@@ -0,0 +1,109 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "trace-snapshotter.h"
+
+#include <kj/test.h>
+#include <kj/thread.h>
+#include <kj/vector.h>
+
+namespace workerd::server {
+namespace {
+
+class FakeClock final: public kj::MonotonicClock {
+ public:
+  kj::TimePoint now() const override {
+    return time;
+  }
+
+  void advance(kj::Duration d) {
+    time += d;
+  }
+
+ private:
+  kj::TimePoint time = kj::origin<kj::TimePoint>() + 1000 * kj::SECONDS;
+};
+
+struct SnapshotterTest {
+  kj::EventLoop loop;
+  kj::WaitScope ws{loop};
+  FakeClock clock;
+  kj::Vector<kj::String> snapshots;
+  TraceSnapshotter snapshotter;
+
+  SnapshotterTest(kj::Maybe<kj::Duration> slowLockWaitThreshold = kj::none)
+      : snapshotter(clock,
+            TraceSnapshotOptions{
+              .snapshot = [this](kj::StringPtr reason) { snapshots.add(kj::str(reason)); },
+              .slowLockWaitThreshold = slowLockWaitThreshold,
+              .minInterval = 10 * kj::SECONDS,
+            }) {}
+};
+
+KJ_TEST("TraceSnapshotter takes snapshots at most once per minInterval") {
+  SnapshotterTest test;
+
+  KJ_EXPECT(test.snapshotter.trigger("first"));
+
+  // The snapshot is taken later, on the event loop.
+  KJ_EXPECT(test.snapshots.empty());
+  test.ws.poll();
+  KJ_ASSERT(test.snapshots.size() == 1);
+  KJ_EXPECT(test.snapshots[0] == "first");
+
+  test.clock.advance(9 * kj::SECONDS);
+  KJ_EXPECT(!test.snapshotter.trigger("too-soon"));
+
+  // A rejected trigger doesn't restart the interval.
+  test.clock.advance(1 * kj::SECONDS);
+  KJ_EXPECT(test.snapshotter.trigger("second"));
+  KJ_EXPECT(!test.snapshotter.trigger("same-time"));
+
+  test.ws.poll();
+  KJ_ASSERT(test.snapshots.size() == 2);
+  KJ_EXPECT(test.snapshots[1] == "second");
+}
+
+KJ_TEST("SlowLockWaitObserver snapshots only lock waits over the threshold") {
+  SnapshotterTest test(100 * kj::MILLISECONDS);
+  SlowLockWaitObserver observer(test.snapshotter, 100 * kj::MILLISECONDS);
+
+  auto waitForLock = [&](kj::Duration wait) {
+    auto timing = KJ_ASSERT_NONNULL(observer.tryCreateLockTiming(kj::Maybe<RequestObserver&>()));
+    timing->start();
+    test.clock.advance(wait);
+    timing->locked();
+    test.ws.poll();
+  };
+
+  waitForLock(100 * kj::MILLISECONDS);
+  KJ_EXPECT(test.snapshots.empty());
+
+  waitForLock(101 * kj::MILLISECONDS);
+  KJ_ASSERT(test.snapshots.size() == 1);
+  KJ_EXPECT(test.snapshots[0] == "slow-lock-wait");
+
+  // Still subject to the snapshotter's rate limit.
+  waitForLock(1 * kj::SECONDS);
+  KJ_EXPECT(test.snapshots.size() == 1);
+
+  test.clock.advance(10 * kj::SECONDS);
+  waitForLock(1 * kj::SECONDS);
+  KJ_EXPECT(test.snapshots.size() == 2);
+}
+
+KJ_TEST("SlowLockWaitObserver ignores locks taken on other threads") {
+  SnapshotterTest test(100 * kj::MILLISECONDS);
+  SlowLockWaitObserver observer(test.snapshotter, 100 * kj::MILLISECONDS);
+
+  // E.g. the inspector's thread. Its timing would call trigger() from the wrong thread.
+  kj::Thread([&]() {
+    KJ_EXPECT(observer.tryCreateLockTiming(kj::Maybe<RequestObserver&>()) == kj::none);
+  });
+
+  KJ_EXPECT(observer.tryCreateLockTiming(kj::Maybe<RequestObserver&>()) != kj::none);
+}
+
+}  // namespace
+}  // namespace workerd::server
@@ -0,0 +1,66 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "trace-snapshotter.h"
+
+#include <workerd/util/use-perfetto-categories.h>
+
+#include <kj/debug.h>
+
+namespace workerd::server {
+
+TraceSnapshotter::TraceSnapshotter(const kj::MonotonicClock& clock, TraceSnapshotOptions options)
+    : clock(clock),
+      options(kj::mv(options)),
+      tasks(*this) {}
+
+bool TraceSnapshotter::trigger(kj::StringPtr reason) {
+  KJ_REQUIRE(isOwnThread(), "TraceSnapshotter::trigger() called from another thread");
+
+  auto now = clock.now();
+  KJ_IF_SOME(last, lastSnapshot) {
+    if (now - last < options.minInterval) return false;
+  }
+  lastSnapshot = now;
+
+  tasks.add(kj::evalLater([this, reason = kj::str(reason)]() {
+    TRACE_EVENT("workerd", "TraceSnapshotter::snapshot()");
+    KJ_LOG(INFO, "writing trace snapshot", reason);
+    options.snapshot(reason);
+  }));
+  return true;
+}
+
+void TraceSnapshotter::taskFailed(kj::Exception&& exception) {
+  KJ_LOG(ERROR, "failed to write trace snapshot", exception);
+}
+
+class SlowLockWaitObserver::Timing final: public LockTiming {
+ public:
+  Timing(const SlowLockWaitObserver& observer): observer(observer) {}
+
+  void start() override {
+    startTime = observer.snapshotter.getClock().now();
+  }
+  void locked() override {
+    KJ_IF_SOME(s, startTime) {
+      if (observer.snapshotter.getClock().now() - s > observer.threshold) {
+        observer.snapshotter.trigger("slow-lock-wait"_kj);
+      }
+    }
+  }
+
+ private:
+  const SlowLockWaitObserver& observer;
+  kj::Maybe<kj::TimePoint> startTime;
+};
+
+kj::Maybe<kj::Own<IsolateObserver::LockTiming>> SlowLockWaitObserver::tryCreateLockTiming(
+    kj::OneOf<SpanParent, kj::Maybe<RequestObserver&>> parentOrRequest) const {
+  // The timing reports from whichever thread takes the lock, and trigger() isn't thread-safe.
+  if (!snapshotter.isOwnThread()) return kj::none;
+  return kj::Own<LockTiming>(kj::heap<Timing>(*this));
+}
+
+}  // namespace workerd::server
@@ -0,0 +1,93 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#pragma once
+
+#include <workerd/io/observer.h>
+
+#include <kj/async.h>
+#include <kj/function.h>
+#include <kj/time.h>
+
+#include <thread>
+
+namespace workerd::server {
+
+// Configures when to snapshot an always-on, in-memory trace buffer (e.g. a perfetto ring
+// buffer), so that rare stalls can be examined after the fact.
+struct TraceSnapshotOptions {
+  // Writes out the buffer. `reason` is a short identifier of what triggered the snapshot, e.g.
+  // "slow-request". Always called on the server's thread, from the event loop.
+  kj::Function<void(kj::StringPtr reason)> snapshot;
+
+  // Snapshot after any request that takes longer than this to complete.
+  kj::Maybe<kj::Duration> slowRequestThreshold;
+
+  // Snapshot after any isolate lock that takes longer than this to acquire.
+  kj::Maybe<kj::Duration> slowLockWaitThreshold;
+
+  // Snapshots are taken at most this often; triggers arriving sooner are ignored. (The debug
+  // port's snapshotTrace() is subject to this too.)
+  kj::Duration minInterval = 10 * kj::SECONDS;
+};
+
+// Implements Server::enableTraceSnapshots(): decides when the always-on trace buffer is worth
+// writing out. All timing is measured with `clock`, so that tests can control it.
+class TraceSnapshotter final: private kj::TaskSet::ErrorHandler {
+ public:
+  TraceSnapshotter(const kj::MonotonicClock& clock, TraceSnapshotOptions options);
+
+  kj::Maybe<kj::Duration> getSlowRequestThreshold() const {
+    return options.slowRequestThreshold;
+  }
+  kj::Maybe<kj::Duration> getSlowLockWaitThreshold() const {
+    return options.slowLockWaitThreshold;
+  }
+  const kj::MonotonicClock& getClock() const {
+    return clock;
+  }
+
+  // Requests a snapshot. Returns false if one was taken too recently. The snapshot itself is
+  // deferred to a later turn of the event loop, so that it doesn't happen while the caller is
+  // holding an isolate lock or in the middle of tearing down a request.
+  //
+  // Must be called on the thread that created the snapshotter, since that's whose event loop the
+  // snapshot is deferred to.
+  bool trigger(kj::StringPtr reason);
+
+  bool isOwnThread() const {
+    return std::this_thread::get_id() == thread;
+  }
+
+ private:
+  const kj::MonotonicClock& clock;
+  TraceSnapshotOptions options;
+  std::thread::id thread = std::this_thread::get_id();
+  kj::Maybe<kj::TimePoint> lastSnapshot;
+  kj::TaskSet tasks;
+
+  void taskFailed(kj::Exception&& exception) override;
+};
+
+// IsolateObserver used when TraceSnapshotOptions::slowLockWaitThreshold is set. Triggers a
+// snapshot whenever acquiring an isolate lock takes longer than `threshold`. Only locks taken on
+// the snapshotter's own thread are timed; others, such as those taken by the inspector's thread,
+// are ignored.
+class SlowLockWaitObserver final: public IsolateObserver {
+ public:
+  SlowLockWaitObserver(TraceSnapshotter& snapshotter, kj::Duration threshold)
+      : snapshotter(snapshotter),
+        threshold(threshold) {}
+
+  kj::Maybe<kj::Own<LockTiming>> tryCreateLockTiming(
+      kj::OneOf<SpanParent, kj::Maybe<RequestObserver&>> parentOrRequest) const override;
+
+ private:
+  TraceSnapshotter& snapshotter;
+  kj::Duration threshold;
+
+  class Timing;
+};
+
+}  // namespace workerd::server
@@ -0,0 +1,122 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "web-socket-compression.h"
+
+#include <kj/test.h>
+
+namespace workerd::server {
+namespace {
+
+// Returns the rewritten agreement, or "(unchanged)".
+kj::String limit(WebSocketCompressionPolicy::Limits limits,
+    kj::StringPtr agreement,
+    kj::Maybe<kj::StringPtr> offer = kj::none) {
+  auto policy = kj::refcounted<WebSocketCompressionPolicy>(limits);
+  KJ_IF_SOME(result, policy->limitAgreement(agreement, offer)) {
+    return kj::mv(result);
+  }
+  return kj::str("(unchanged)");
+}
+
+KJ_TEST("WebSocketCompressionPolicy adds context takeover parameters") {
+  KJ_EXPECT(limit({.serverNoContextTakeover = true}, "permessage-deflate") ==
+      "permessage-deflate; server_no_context_takeover"_kj);
+  KJ_EXPECT(limit({.serverNoContextTakeover = true, .clientNoContextTakeover = true},
+                "permessage-deflate; client_no_context_takeover") ==
+      "permessage-deflate; server_no_context_takeover; client_no_context_takeover"_kj);
+  KJ_EXPECT(limit({}, "PerMessage-Deflate ;  server_no_context_takeover") ==
+      "permessage-deflate; server_no_context_takeover"_kj);
+}
+
+KJ_TEST("WebSocketCompressionPolicy lowers window sizes only as far as the offer allows") {
+  // Already agreed: lowered to the limit, never raised.
+  KJ_EXPECT(limit({.serverMaxWindowBits = 10}, "permessage-deflate; server_max_window_bits=12") ==
+      "permessage-deflate; server_max_window_bits=10"_kj);
+  KJ_EXPECT(limit({.serverMaxWindowBits = 10}, "permessage-deflate; server_max_window_bits=9") ==
+      "permessage-deflate; server_max_window_bits=9"_kj);
+
+  // Not agreed, and not offered: RFC 7692 doesn't allow adding it.
+  KJ_EXPECT(limit({.serverMaxWindowBits = 10}, "permessage-deflate", "permessage-deflate"_kj) ==
+      "permessage-deflate"_kj);
+
+  // Not agreed, but offered: added, respecting the offered value.
+  KJ_EXPECT(limit({.clientMaxWindowBits = 10}, "permessage-deflate",
+                "permessage-deflate; client_max_window_bits"_kj) ==
+      "permessage-deflate; client_max_window_bits=10"_kj);
+  KJ_EXPECT(limit({.serverMaxWindowBits = 12}, "permessage-deflate",
+                "x-webkit-deflate-frame, permessage-deflate; server_max_window_bits=\"11\""_kj) ==
+      "permessage-deflate; server_max_window_bits=11"_kj);
+
+  // A window of 8 bits can't be used for compressing.
+  KJ_EXPECT(limit({.serverMaxWindowBits = 8}, "permessage-deflate; server_max_window_bits=15") ==
+      "permessage-deflate; server_max_window_bits=9"_kj);
+}
+
+KJ_TEST("WebSocketCompressionPolicy leaves unrecognized agreements alone") {
+  KJ_EXPECT(
+      limit({.serverNoContextTakeover = true}, "x-webkit-deflate-frame") == "(unchanged)"_kj);
+  KJ_EXPECT(limit({.serverNoContextTakeover = true}, "permessage-deflate, permessage-deflate") ==
+      "(unchanged)"_kj);
+  KJ_EXPECT(limit({.serverNoContextTakeover = true}, "permessage-deflate; foo=bar") ==
+      "(unchanged)"_kj);
+  KJ_EXPECT(limit({.serverNoContextTakeover = true},
+                "permessage-deflate; server_max_window_bits=16") == "(unchanged)"_kj);
+}
+
+class MockResponse final: public kj::HttpService::Response {
+ public:
+  kj::Own<kj::AsyncOutputStream> send(uint statusCode,
+      kj::StringPtr statusText,
+      const kj::HttpHeaders& headers,
+      kj::Maybe<uint64_t> expectedBodySize = kj::none) override {
+    KJ_UNIMPLEMENTED("MockResponse::send not used");
+  }
+
+  kj::Own<kj::WebSocket> acceptWebSocket(const kj::HttpHeaders& headers) override {
+    extensions = kj::str(headers.get(kj::HttpHeaderId::SEC_WEBSOCKET_EXTENSIONS).orDefault(""));
+    auto pipe = kj::newWebSocketPipe();
+    return kj::mv(pipe.ends[0]);
+  }
+
+  // The agreed extensions, or empty if none.
+  kj::String extensions;
+};
+
+KJ_TEST("WebSocketCompressionPolicy limits the number of compressed connections") {
+  kj::EventLoop loop;
+  kj::WaitScope waitScope(loop);
+  kj::HttpHeaderTable table;
+
+  auto policy = kj::refcounted<WebSocketCompressionPolicy>(
+      WebSocketCompressionPolicy::Limits{.maxCompressedConnections = 2});
+
+  // Accepts a WebSocket whose app agreed to compression, or not, and returns the extensions the
+  // client would see.
+  kj::Vector<kj::Own<kj::WebSocket>> open;
+  auto accept = [&](bool compressed) {
+    kj::HttpHeaders headers(table);
+    if (compressed) headers.set(kj::HttpHeaderId::SEC_WEBSOCKET_EXTENSIONS, "permessage-deflate");
+    MockResponse response;
+    open.add(policy->acceptWebSocket(response, headers, "permessage-deflate"_kj));
+    return kj::mv(response.extensions);
+  };
+
+  KJ_EXPECT(accept(true) == "permessage-deflate"_kj);
+  KJ_EXPECT(accept(false) == ""_kj);
+  KJ_EXPECT(accept(true) == "permessage-deflate"_kj);
+  KJ_EXPECT(policy->getCompressedConnectionCount() == 2);
+
+  // Over the limit: accepted without compression.
+  KJ_EXPECT(accept(true) == ""_kj);
+  KJ_EXPECT(policy->getCompressedConnectionCount() == 2);
+
+  // Closing a compressed connection makes room for another.
+  open[0] = nullptr;
+  KJ_EXPECT(policy->getCompressedConnectionCount() == 1);
+  KJ_EXPECT(accept(true) == "permessage-deflate"_kj);
+}
+
+}  // namespace
+}  // namespace workerd::server
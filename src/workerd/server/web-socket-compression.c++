@@ -0,0 +1,176 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "web-socket-compression.h"
+
+#include <workerd/util/strings.h>
+
+#include <kj/debug.h>
+#include <kj/vector.h>
+
+namespace workerd::server {
+
+namespace {
+
+constexpr uint MAX_WINDOW_BITS = 15;
+
+// Splits `text` at each `delimiter`, trimming whitespace from the parts.
+kj::Vector<kj::ArrayPtr<const char>> split(kj::ArrayPtr<const char> text, char delimiter) {
+  kj::Vector<kj::ArrayPtr<const char>> parts;
+  size_t start = 0;
+  for (auto i: kj::indices(text)) {
+    if (text[i] == delimiter) {
+      parts.add(trimLeadingAndTrailingWhitespace(text.slice(start, i)));
+      start = i + 1;
+    }
+  }
+  parts.add(trimLeadingAndTrailingWhitespace(text.slice(start, text.size())));
+  return parts;
+}
+
+struct Parameter {
+  kj::ArrayPtr<const char> name;
+  kj::Maybe<kj::ArrayPtr<const char>> value;
+};
+
+Parameter parseParameter(kj::ArrayPtr<const char> text) {
+  for (auto i: kj::indices(text)) {
+    if (text[i] == '=') {
+      auto value = trimLeadingAndTrailingWhitespace(text.slice(i + 1, text.size()));
+      if (value.size() >= 2 && value[0] == '"' && value[value.size() - 1] == '"') {
+        value = value.slice(1, value.size() - 1);
+      }
+      return {trimLeadingAndTrailingWhitespace(text.slice(0, i)), value};
+    }
+  }
+  return {text, kj::none};
+}
+
+bool isPermessageDeflate(kj::ArrayPtr<const char> name) {
+  return toLower(name) == "permessage-deflate"_kj;
+}
+
+// Parses a window bits value. A missing value, allowed for client_max_window_bits, means the
+// largest window.
+kj::Maybe<uint> parseWindowBits(kj::Maybe<kj::ArrayPtr<const char>> value) {
+  KJ_IF_SOME(v, value) {
+    if (v.size() == 1 && v[0] >= '8' && v[0] <= '9') return v[0] - '0';
+    if (v.size() == 2 && v[0] == '1' && v[1] >= '0' && v[1] <= '5') return 10 + v[1] - '0';
+    return kj::none;
+  }
+  return MAX_WINDOW_BITS;
+}
+
+// Returns the window bits parameter `name` of the first permessage-deflate offer in `offer` that
+// has it, or kj::none if none do.
+kj::Maybe<uint> findOfferedWindowBits(kj::Maybe<kj::StringPtr> offer, kj::StringPtr name) {
+  KJ_IF_SOME(o, offer) {
+    for (auto extension: split(o, ',')) {
+      auto parts = split(extension, ';');
+      if (!isPermessageDeflate(parts[0])) continue;
+      for (auto part: parts.asPtr().slice(1, parts.size())) {
+        auto param = parseParameter(part);
+        if (param.name == name.asArray()) return parseWindowBits(param.value);
+      }
+    }
+  }
+  return kj::none;
+}
+
+// Lowers `agreed` to `limit`. If nothing was agreed, the window can only be limited if the client
+// offered the parameter, and not beyond what it offered.
+kj::Maybe<uint> limitWindowBits(kj::Maybe<uint> agreed, uint limit, kj::Maybe<uint> offered) {
+  if (limit >= MAX_WINDOW_BITS) return agreed;
+  KJ_IF_SOME(bits, agreed) {
+    return kj::min(bits, limit);
+  }
+  KJ_IF_SOME(bits, offered) {
+    return kj::min(bits, limit);
+  }
+  return kj::none;
+}
+
+}  // namespace
+
+WebSocketCompressionPolicy::WebSocketCompressionPolicy(Limits limits): limits(limits) {
+  // zlib silently turns a window of 8 bits into 9 when compressing, which would exceed what we
+  // agreed to, so 9 is the smallest window we compress with.
+  this->limits.serverMaxWindowBits = kj::max(9u, kj::min(limits.serverMaxWindowBits, 15u));
+  this->limits.clientMaxWindowBits = kj::max(8u, kj::min(limits.clientMaxWindowBits, 15u));
+}
+
+kj::Own<kj::WebSocket> WebSocketCompressionPolicy::acceptWebSocket(
+    kj::HttpService::Response& response,
+    kj::HttpHeaders& headers,
+    kj::Maybe<kj::StringPtr> offer) {
+  auto agreement = KJ_UNWRAP_OR(headers.get(kj::HttpHeaderId::SEC_WEBSOCKET_EXTENSIONS),
+      { return response.acceptWebSocket(headers); });
+
+  if (limits.maxCompressedConnections != 0 &&
+      compressedConnections >= limits.maxCompressedConnections) {
+    // Responding without any extension is always allowed, and disables compression.
+    headers.unset(kj::HttpHeaderId::SEC_WEBSOCKET_EXTENSIONS);
+    return response.acceptWebSocket(headers);
+  }
+
+  KJ_IF_SOME(limited, limitAgreement(agreement, offer)) {
+    headers.set(kj::HttpHeaderId::SEC_WEBSOCKET_EXTENSIONS, kj::mv(limited));
+  }
+
+  auto ws = response.acceptWebSocket(headers);
+  ++compressedConnections;
+  return ws.attach(kj::defer([self = kj::addRef(*this)]() { --self->compressedConnections; }));
+}
+
+kj::Maybe<kj::String> WebSocketCompressionPolicy::limitAgreement(
+    kj::StringPtr agreement, kj::Maybe<kj::StringPtr> offer) {
+  // A response agrees to at most one extension configuration. Leave anything else for KJ to
+  // reject.
+  if (agreement.findFirst(',') != kj::none) return kj::none;
+
+  auto parts = split(agreement, ';');
+  if (!isPermessageDeflate(parts[0])) return kj::none;
+
+  bool serverNoContextTakeover = limits.serverNoContextTakeover;
+  bool clientNoContextTakeover = limits.clientNoContextTakeover;
+  kj::Maybe<uint> serverMaxWindowBits;
+  kj::Maybe<uint> clientMaxWindowBits;
+  for (auto part: parts.asPtr().slice(1, parts.size())) {
+    auto param = parseParameter(part);
+    if (param.name == "server_no_context_takeover"_kj.asArray()) {
+      serverNoContextTakeover = true;
+    } else if (param.name == "client_no_context_takeover"_kj.asArray()) {
+      clientNoContextTakeover = true;
+    } else if (param.name == "server_max_window_bits"_kj.asArray() && param.value != kj::none) {
+      serverMaxWindowBits = KJ_UNWRAP_OR_RETURN(parseWindowBits(param.value), kj::none);
+    } else if (param.name == "client_max_window_bits"_kj.asArray()) {
+      clientMaxWindowBits = KJ_UNWRAP_OR_RETURN(parseWindowBits(param.value), kj::none);
+    } else {
+      return kj::none;
+    }
+  }
+
+  serverMaxWindowBits = limitWindowBits(serverMaxWindowBits, limits.serverMaxWindowBits,
+      findOfferedWindowBits(offer, "server_max_window_bits"_kj));
+  clientMaxWindowBits = limitWindowBits(clientMaxWindowBits, limits.clientMaxWindowBits,
+      findOfferedWindowBits(offer, "client_max_window_bits"_kj));
+
+  kj::Vector<kj::String> result;
+  result.add(kj::str("permessage-deflate"));
+  if (serverNoContextTakeover) {
+    result.add(kj::str("server_no_context_takeover"));
+  }
+  if (clientNoContextTakeover) {
+    result.add(kj::str("client_no_context_takeover"));
+  }
+  KJ_IF_SOME(bits, serverMaxWindowBits) {
+    result.add(kj::str("server_max_window_bits=", bits));
+  }
+  KJ_IF_SOME(bits, clientMaxWindowBits) {
+    result.add(kj::str("client_max_window_bits=", bits));
+  }
+  return kj::strArray(result, "; ");
+}
+
+}  // namespace workerd::server
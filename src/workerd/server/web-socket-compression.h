@@ -0,0 +1,59 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#pragma once
+
+#include <kj/compat/http.h>
+#include <kj/refcount.h>
+
+namespace workerd::server {
+
+// Applies a server-wide policy to the permessage-deflate extension (RFC 7692) agreed for
+// WebSockets accepted from clients.
+//
+// Workers choose whether to compress (see the `web_socket_compression` compatibility flag), and
+// KJ implements the compression, allocating zlib state for each compressed connection. This
+// class sits between the two: it rewrites the `Sec-WebSocket-Extensions` header the application
+// responded with before KJ sees it, tightening the parameters and refusing compression outright
+// once too many compressed connections are open.
+class WebSocketCompressionPolicy final: public kj::Refcounted {
+ public:
+  struct Limits {
+    // If non-zero, the most WebSockets that may use compression at once. Further WebSockets are
+    // accepted uncompressed.
+    uint maxCompressedConnections = 0;
+
+    // Upper bounds on the LZ77 window sizes, as a base-2 logarithm between 8 and 15. Per RFC 7692
+    // each can only be lowered if the client's offer mentions the corresponding parameter.
+    uint serverMaxWindowBits = 15;
+    uint clientMaxWindowBits = 15;
+
+    // Ask for each message to be compressed independently of the previous ones.
+    bool serverNoContextTakeover = false;
+    bool clientNoContextTakeover = false;
+  };
+
+  explicit WebSocketCompressionPolicy(Limits limits);
+
+  // Accepts a WebSocket through `response`, first applying the policy to the extension agreement
+  // in `headers`. `offer` is the `Sec-WebSocket-Extensions` header of the client's request.
+  kj::Own<kj::WebSocket> acceptWebSocket(kj::HttpService::Response& response,
+      kj::HttpHeaders& headers,
+      kj::Maybe<kj::StringPtr> offer);
+
+  // Returns `agreement` with the limits applied, or kj::none if it should be sent unchanged
+  // because it isn't a single permessage-deflate agreement this understands.
+  kj::Maybe<kj::String> limitAgreement(kj::StringPtr agreement, kj::Maybe<kj::StringPtr> offer);
+
+  // Number of currently open WebSockets accepted with compression.
+  uint getCompressedConnectionCount() const {
+    return compressedConnections;
+  }
+
+ private:
+  Limits limits;
+  uint compressedConnections = 0;
+};
+
+}  // namespace workerd::server
@@ -67,6 +67,7 @@
 #include <workerd/util/use-perfetto-categories.h>
 
 #include <kj-rs/kj-rs.h>
+#include <openssl/sha.h>
 #include <pyodide/generated/pyodide_extra.capnp.h>
 #include <pyodide/python-entrypoint.embed.h>
 
@@ -74,6 +75,13 @@
 #include <kj/compat/http.h>
 #include <kj/compat/tls.h>
 #include <kj/compat/url.h>
+#include <kj/encoding.h>
+#include <kj/list.h>
+#include <kj/mutex.h>
+#include <kj/thread.h>
+
+#include <atomic>
+#include <thread>
 
 using namespace kj_rs;
 
@@ -360,6 +368,293 @@ const jsg::IsolateObserver& WorkerdApi::getObserver() const {
 
 void WorkerdApi::setIsolateObserver(IsolateObserver&) {};
 
+#ifdef WORKERD_USE_TRANSPILER
+namespace {
+
+// Below this many bytes of ES modules, stripping types isn't worth starting threads for.
+constexpr size_t MIN_PARALLEL_STRIP_BYTES = 64 * 1024;
+constexpr uint MAX_STRIP_THREADS = 8;
+
+// Caches the result of stripping types, keyed by a SHA-256 of the module's name and content, so
+// that identical TypeScript shared between services, or loaded again through the fallback
+// service, is only transpiled once per process. Failures are cached too, with their diagnostics.
+//
+// Hits are copied out of the cache, because each module keeps its own copy of its code. To bound
+// that duplication the cache is small, and evicts whatever was least recently used.
+class StripTypesCache {
+ public:
+  rust::transpiler::Output strip(kj::StringPtr name, kj::ArrayPtr<const kj::byte> body) const;
+
+ private:
+  static constexpr size_t MAX_BYTES = 16 << 20;
+
+  struct Entry {
+    Entry(kj::String key, rust::transpiler::Output output, size_t size)
+        : key(kj::mv(key)),
+          output(kj::mv(output)),
+          size(size) {}
+
+    kj::String key;
+    rust::transpiler::Output output;
+    size_t size;
+    kj::ListLink<Entry> link;
+  };
+
+  struct State {
+    // Keys point into the entries they map to.
+    kj::HashMap<kj::StringPtr, kj::Own<Entry>> entries;
+
+    // Ordered from least to most recently used.
+    kj::List<Entry, &Entry::link> lru;
+
+    size_t bytes = 0;
+
+    ~State() noexcept(false) {
+      while (!lru.empty()) lru.remove(lru.front());
+    }
+  };
+  kj::MutexGuarded<State> state;
+};
+
+rust::transpiler::Output StripTypesCache::strip(
+    kj::StringPtr name, kj::ArrayPtr<const kj::byte> body) const {
+  // The name is part of the key because it determines how the module is parsed, and appears in
+  // diagnostics.
+  kj::byte digest[SHA256_DIGEST_LENGTH];
+  SHA256_CTX ctx;
+  SHA256_Init(&ctx);
+  SHA256_Update(&ctx, name.cStr(), name.size() + 1);
+  SHA256_Update(&ctx, body.begin(), body.size());
+  SHA256_Final(digest, &ctx);
+  auto key = kj::encodeHex(kj::ArrayPtr<const kj::byte>(digest));
+
+  {
+    // Even a hit updates the LRU order, so it needs an exclusive lock. It's held only long enough
+    // to copy the output.
+    auto lock = state.lockExclusive();
+    KJ_IF_SOME(entry, lock->entries.find(key)) {
+      lock->lru.remove(*entry);
+      lock->lru.add(*entry);
+      return entry->output;
+    }
+  }
+
+  // value comes from capnp so it is a valid utf-8
+  auto output = rust::transpiler::ts_strip(name.as<RustUncheckedUtf8>(), body.as<Rust>());
+
+  size_t size = output.code.size() + output.error.size();
+  for (auto& diag: output.diagnostics) {
+    size += diag.message.size();
+  }
+  if (size > MAX_BYTES) return output;
+
+  auto lock = state.lockExclusive();
+  if (lock->entries.find(key) != kj::none) {
+    // Another thread stripped the same module meanwhile.
+    return output;
+  }
+  while (lock->bytes + size > MAX_BYTES) {
+    auto& oldest = lock->lru.front();
+    lock->lru.remove(oldest);
+    lock->bytes -= oldest.size;
+    // Erasing destroys `oldest`, which owns the key, so copy it out first.
+    auto oldestKey = kj::str(oldest.key);
+    lock->entries.erase(oldestKey);
+  }
+  auto entry = kj::heap<Entry>(kj::mv(key), output, size);
+  lock->lru.add(*entry);
+  lock->bytes += size;
+  kj::StringPtr entryKey = entry->key;
+  lock->entries.insert(entryKey, kj::mv(entry));
+  return output;
+}
+
+const StripTypesCache& getStripTypesCache() {
+  static const StripTypesCache cache;
+  return cache;
+}
+
+// Converts the result of stripping types from the module `name` to its content, reporting any
+// error.
+Worker::Script::ModuleContent fromStripOutput(kj::StringPtr name,
+    rust::transpiler::Output output,
+    kj::Maybe<Worker::ValidationErrorReporter&> errorReporter) {
+  if (output.success) {
+    return Worker::Script::EsModule{
+      .body = ::kj::from<Rust>(output.code), .ownBody = kj::mv(output.code)};
+  }
+
+  auto description = kj::str("Error transpiling ", name, " : ", output.error);
+  for (auto& diag: output.diagnostics) {
+    description = kj::str(description, "\n    ", diag.message);
+  }
+  KJ_IF_SOME(reporter, errorReporter) {
+    reporter.addError(kj::mv(description));
+    return Worker::Script::TextModule{""};
+  } else {
+    KJ_FAIL_REQUIRE(description);
+  }
+}
+
+// Threads which stripTypesInParallel() spreads its work over. They're started the first time
+// they're needed and then kept for the life of the process, since extractSource() runs for every
+// Worker in the config, and again for every dynamically-loaded Worker.
+class StripTypesPool {
+ public:
+  ~StripTypesPool() noexcept(false);
+
+  // Calls `work` on the calling thread and on up to `helpers` pool threads at once, and returns
+  // once all of the calls have returned. Pool threads may be busy with another caller's work, so
+  // `work` must be able to finish everything by itself.
+  void run(uint helpers, kj::FunctionParam<void()> work);
+
+ private:
+  struct Job {
+    kj::FunctionParam<void()>& work;
+
+    // Number of pool threads currently calling `work`.
+    uint running = 0;
+
+    // The first exception thrown by `work` on a pool thread.
+    kj::Maybe<kj::Exception> exception;
+  };
+
+  // Jobs live on their callers' stacks, and are protected by the same lock as this.
+  struct State {
+    // One entry for each pool thread a Job has asked for that hasn't picked it up yet.
+    kj::Vector<Job*> queue;
+
+    bool shutdown = false;
+  };
+  kj::MutexGuarded<State> state;
+
+  // Declared after `state` so that the threads are joined before it is destroyed.
+  kj::MutexGuarded<kj::Vector<kj::Own<kj::Thread>>> threads;
+
+  void threadMain();
+};
+
+StripTypesPool::~StripTypesPool() noexcept(false) {
+  // Destroying `threads` joins them once they see this.
+  state.lockExclusive()->shutdown = true;
+}
+
+void StripTypesPool::run(uint helpers, kj::FunctionParam<void()> work) {
+  {
+    auto lock = threads.lockExclusive();
+    while (lock->size() < helpers) {
+      lock->add(kj::heap<kj::Thread>([this]() { threadMain(); }));
+    }
+  }
+
+  Job job{.work = work};
+  {
+    auto lock = state.lockExclusive();
+    for (auto i KJ_UNUSED: kj::zeroTo(helpers)) {
+      lock->queue.add(&job);
+    }
+  }
+
+  work();
+
+  // All of the work has been claimed by now, so withdraw the requests that no pool thread picked
+  // up, and wait for those that did.
+  {
+    auto lock = state.lockExclusive();
+    auto& queue = lock->queue;
+    size_t kept = 0;
+    for (auto i: kj::indices(queue)) {
+      if (queue[i] != &job) queue[kept++] = queue[i];
+    }
+    queue.resize(kept);
+  }
+  state.when([&](const State&) { return job.running == 0; }, [](State&) {});
+
+  KJ_IF_SOME(exception, job.exception) {
+    kj::throwFatalException(kj::mv(exception));
+  }
+}
+
+void StripTypesPool::threadMain() {
+  for (;;) {
+    auto maybeJob = state.when([](const State& s) { return !s.queue.empty() || s.shutdown; },
+        [](State& s) -> kj::Maybe<Job&> {
+      if (s.shutdown) return kj::none;
+      auto& job = *s.queue.back();
+      s.queue.removeLast();
+      ++job.running;
+      return job;
+    });
+    auto& job = KJ_UNWRAP_OR(maybeJob, return);
+
+    auto exception = kj::runCatchingExceptions([&]() { job.work(); });
+
+    auto lock = state.lockExclusive();
+    KJ_IF_SOME(e, exception) {
+      if (job.exception == kj::none) job.exception = kj::mv(e);
+    }
+    --job.running;
+  }
+}
+
+StripTypesPool& getStripTypesPool() {
+  static StripTypesPool pool;
+  return pool;
+}
+
+// Strips types from all of the ES modules in `modules` up front, spread over StripTypesPool.
+// Each module is stripped independently, so for large bundles this takes most of the time spent
+// reading the config off of the main thread. Returns an empty array if types aren't stripped or
+// the modules are too small to bother, in which case readModuleConf() strips them itself.
+kj::Array<kj::Maybe<rust::transpiler::Output>> stripTypesInParallel(
+    capnp::List<config::Worker::Module>::Reader modules, CompatibilityFlags::Reader featureFlags) {
+  if (!featureFlags.getTypescriptStripTypes()) return nullptr;
+
+  // Capnp readers aren't safe to share between threads, so collect the inputs first.
+  struct Input {
+    kj::StringPtr name;
+    kj::ArrayPtr<const kj::byte> body;
+  };
+  auto inputs = KJ_MAP(module, modules) -> kj::Maybe<Input> {
+    if (!module.isEsModule()) return kj::none;
+    return Input{.name = module.getName(), .body = module.getEsModule().asBytes()};
+  };
+
+  size_t count = 0;
+  size_t totalBytes = 0;
+  for (auto& input: inputs) {
+    KJ_IF_SOME(i, input) {
+      ++count;
+      totalBytes += i.body.size();
+    }
+  }
+  if (count < 2 || totalBytes < MIN_PARALLEL_STRIP_BYTES) return nullptr;
+
+  TRACE_EVENT("workerd", "stripTypesInParallel()", "modules", count, "bytes", totalBytes);
+
+  auto results = kj::heapArray<kj::Maybe<rust::transpiler::Output>>(inputs.size());
+  std::atomic<size_t> next = 0;
+  auto work = [&]() {
+    for (;;) {
+      auto i = next.fetch_add(1, std::memory_order_relaxed);
+      if (i >= inputs.size()) return;
+      KJ_IF_SOME(input, inputs[i]) {
+        results[i] = getStripTypesCache().strip(input.name, input.body);
+      }
+    }
+  };
+
+  // The calling thread takes a share of the work too.
+  auto threadCount = kj::min(
+      kj::max(std::thread::hardware_concurrency(), 1u), kj::min(count, MAX_STRIP_THREADS));
+  getStripTypesPool().run(threadCount - 1, work);
+
+  return results;
+}
+
+}  // namespace
+#endif  // defined(WORKERD_USE_TRANSPILER)
+
 Worker::Script::Source WorkerdApi::extractSource(kj::StringPtr name,
     config::Worker::Reader conf,
     CompatibilityFlags::Reader featureFlags,
@@ -374,10 +669,22 @@ Worker::Script::Source WorkerdApi::extractSource(kj::StringPtr name,
       }
 
       bool isPython = false;
-      auto moduleArray = KJ_MAP(module, modules) -> Worker::Script::Module {
+#ifdef WORKERD_USE_TRANSPILER
+      auto stripped = stripTypesInParallel(modules, featureFlags);
+#endif  // defined(WORKERD_USE_TRANSPILER)
+      auto moduleArray = KJ_MAP(i, kj::zeroTo(modules.size())) -> Worker::Script::Module {
+        auto module = modules[i];
         if (module.isPythonModule()) {
           isPython = true;
         }
+#ifdef WORKERD_USE_TRANSPILER
+        if (stripped.size() > 0) {
+          KJ_IF_SOME(output, stripped[i]) {
+            return {.name = module.getName(),
+              .content = fromStripOutput(module.getName(), kj::mv(output), errorReporter)};
+          }
+        }
+#endif  // defined(WORKERD_USE_TRANSPILER)
         return readModuleConf(module, featureFlags, errorReporter);
       };
 
@@ -464,25 +771,8 @@ Worker::Script::Module WorkerdApi::readModuleConf(config::Worker::Module::Reader
         // with a separate compat flag.
 #ifdef WORKERD_USE_TRANSPILER
         if (featureFlags.getTypescriptStripTypes()) {
-          auto output = rust::transpiler::ts_strip(
-              // value comes from capnp so it is a valid utf-8
-              conf.getName().as<RustUncheckedUtf8>(), conf.getEsModule().asBytes().as<Rust>());
-
-          if (output.success) {
-            return Worker::Script::EsModule{
-              .body = ::kj::from<Rust>(output.code), .ownBody = kj::mv(output.code)};
-          }
-
-          auto description = kj::str("Error transpiling ", conf.getName(), " : ", output.error);
-          for (auto& diag: output.diagnostics) {
-            description = kj::str(description, "\n    ", diag.message);
-          }
-          KJ_IF_SOME(reporter, errorReporter) {
-            reporter.addError(kj::mv(description));
-            return Worker::Script::TextModule{""};
-          } else {
-            KJ_FAIL_REQUIRE(description);
-          }
+          auto output = getStripTypesCache().strip(conf.getName(), conf.getEsModule().asBytes());
+          return fromStripOutput(conf.getName(), kj::mv(output), errorReporter);
         }
 #endif  // defined(WORKERD_USE_TRANSPILER)
         return Worker::Script::EsModule{static_cast<kj::StringPtr>(conf.getEsModule())};
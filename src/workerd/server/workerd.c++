@@ -804,6 +804,21 @@ class CliMain final: public SchemaFileImpl::ErrorReporter {
         // TraceConfig structure here rather than just the categories.
         .addOptionWithArg({"p", "perfetto-trace"}, CLI_METHOD(enablePerfetto),
             "<path>=<categories>", "Enable perfetto tracing output to the specified file.")
+        .addOptionWithArg({"perfetto-ring-buffer"}, CLI_METHOD(enablePerfettoRingBuffer),
+            "<dir>=<categories>",
+            "Continuously record perfetto tracing into an in-memory ring buffer, writing a "
+            "snapshot of it to a new file in <dir> whenever a slow request or lock wait is "
+            "detected, or when requested via the debug port.")
+        .addOptionWithArg({"perfetto-ring-buffer-kb"}, CLI_METHOD(setPerfettoRingBufferSize),
+            "<kb>", "Size of the --perfetto-ring-buffer buffer. Defaults to 4096.")
+        .addOptionWithArg({"perfetto-snapshot-slow-request-ms"},
+            CLI_METHOD(setPerfettoSlowRequestThreshold), "<ms>",
+            "With --perfetto-ring-buffer, snapshot the buffer after any request taking longer "
+            "than <ms> milliseconds.")
+        .addOptionWithArg({"perfetto-snapshot-slow-lock-ms"},
+            CLI_METHOD(setPerfettoSlowLockThreshold), "<ms>",
+            "With --perfetto-ring-buffer, snapshot the buffer after any isolate lock that takes "
+            "longer than <ms> milliseconds to acquire.")
 #endif
         .addOption({'w', "watch"}, CLI_METHOD(watch),
             "Watch configuration files (and server binary) and reload if they change. "
@@ -1099,6 +1114,45 @@ class CliMain final: public SchemaFileImpl::ErrorReporter {
     perfettoTraceDestination = kj::str(name);
     perfettoTraceCategories = kj::str(value);
   }
+
+  void enablePerfettoRingBuffer(kj::StringPtr param) {
+    auto [name, value] = parseOverride(param);
+    perfettoRingBufferDir = fs->getCurrentPath().evalNative(name);
+    perfettoTraceCategories = kj::str(value);
+  }
+
+  void setPerfettoRingBufferSize(kj::StringPtr param) {
+    perfettoRingBufferSizeKb = KJ_UNWRAP_OR(
+        param.tryParseAs<uint>(), CLI_ERROR("Ring buffer size must be a non-negative integer."));
+  }
+
+  void setPerfettoSlowRequestThreshold(kj::StringPtr param) {
+    perfettoSlowRequestThreshold = KJ_UNWRAP_OR(param.tryParseAs<uint>(),
+                                       CLI_ERROR("Threshold must be a non-negative integer.")) *
+        kj::MILLISECONDS;
+  }
+
+  void setPerfettoSlowLockThreshold(kj::StringPtr param) {
+    perfettoSlowLockThreshold = KJ_UNWRAP_OR(param.tryParseAs<uint>(),
+                                    CLI_ERROR("Threshold must be a non-negative integer.")) *
+        kj::MILLISECONDS;
+  }
+
+  // Returns the path to write a ring buffer snapshot to. `reason` may come from the debug port,
+  // so only a conservative set of characters from it ends up in the file name.
+  kj::String perfettoSnapshotPath(const kj::Path& dir, kj::StringPtr reason) {
+    auto millis = (kj::systemPreciseCalendarClock().now() - kj::UNIX_EPOCH) / kj::MILLISECONDS;
+    auto safeReason = kj::heapString(reason.first(kj::min(reason.size(), size_t(64))));
+    for (char& c: safeReason) {
+      bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+          c == '-' || c == '_';
+      if (!ok) {
+        c = '_';
+      }
+    }
+    return dir.append(kj::str("workerd-", millis, "-", safeReason, ".perfetto-trace"))
+        .toNativeString(true);
+  }
 #endif
 
   void enableInspector(kj::StringPtr param) {
@@ -1423,6 +1477,18 @@ class CliMain final: public SchemaFileImpl::ErrorReporter {
       KJ_IF_SOME(dest, perfettoTraceDestination) {
         maybePerfettoSession =
             PerfettoSession(dest, kj::mv(perfettoTraceCategories).orDefault(kj::String()));
+      } else KJ_IF_SOME(dir, perfettoRingBufferDir) {
+        auto& session = maybePerfettoSession.emplace(
+            PerfettoSession::RingBuffer{perfettoRingBufferSizeKb},
+            kj::mv(perfettoTraceCategories).orDefault(kj::String()));
+        server->enableTraceSnapshots({
+          .snapshot =
+              [this, &session, &dir](kj::StringPtr reason) {
+          session.snapshot(perfettoSnapshotPath(dir, reason));
+        },
+          .slowRequestThreshold = perfettoSlowRequestThreshold,
+          .slowLockWaitThreshold = perfettoSlowLockThreshold,
+        });
       }
 #endif
       TRACE_EVENT("workerd", "serveImpl()");
@@ -1587,6 +1653,10 @@ class CliMain final: public SchemaFileImpl::ErrorReporter {
 #ifdef WORKERD_USE_PERFETTO
   kj::Maybe<kj::String> perfettoTraceDestination;
   kj::Maybe<kj::String> perfettoTraceCategories;
+  kj::Maybe<kj::Path> perfettoRingBufferDir;
+  uint perfettoRingBufferSizeKb = 4096;
+  kj::Maybe<kj::Duration> perfettoSlowRequestThreshold;
+  kj::Maybe<kj::Duration> perfettoSlowLockThreshold;
 #endif
 
   kj::Own<Server> server;
@@ -0,0 +1,68 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include <workerd/io/actor-cache.h>
+#include <workerd/io/io-gate.h>
+#include <workerd/server/workerd-api.h>
+#include <workerd/tests/bench-tools.h>
+
+// Measures ActorCache hits when many actors, spread across threads, share one SharedLru, as all
+// of the actors in a process do.
+
+namespace workerd {
+namespace {
+
+constexpr uint ACTORS_PER_THREAD = 64;
+constexpr uint KEYS_PER_ACTOR = 16;
+
+const ActorCache::SharedLru& getSharedLru() {
+  // Large enough that nothing is evicted.
+  static const ActorCache::SharedLru lru({
+    .softLimit = 64 * 1024 * 1024,
+    .hardLimit = 128 * 1024 * 1024,
+    .staleTimeout = 30 * kj::SECONDS,
+    .dirtyListByteLimit = 8 * 1024 * 1024,
+    .maxKeysPerRpc = 128,
+  });
+  return lru;
+}
+
+static void ActorCache_CachedGets(benchmark::State& state) {
+  // Each thread has its own event loop and actors, like a workerd thread would.
+  kj::EventLoop loop;
+  kj::WaitScope ws(loop);
+  OutputGate gate;
+
+  auto caches = KJ_MAP(i, kj::zeroTo(ACTORS_PER_THREAD)) {
+    return kj::heap<ActorCache>(server::newEmptyReadOnlyActorStorage(), getSharedLru(), gate);
+  };
+  auto keys = KJ_MAP(i, kj::zeroTo(KEYS_PER_ACTOR)) { return kj::str("key", i); };
+
+  // Read each key once, so that the cache learns it's absent.
+  for (auto& cache: caches) {
+    for (auto& key: keys) {
+      auto result = cache->get(kj::str(key), {});
+      KJ_IF_SOME(promise, result.tryGet<kj::Promise<kj::Maybe<ActorCache::Value>>>()) {
+        promise.wait(ws);
+      }
+    }
+  }
+
+  for (auto _: state) {
+    for (auto& cache: caches) {
+      for (auto& key: keys) {
+        auto result = cache->get(kj::str(key), {});
+        KJ_ASSERT(result.is<kj::Maybe<ActorCache::Value>>());
+        benchmark::DoNotOptimize(result);
+      }
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * ACTORS_PER_THREAD * KEYS_PER_ACTOR);
+}
+
+WD_BENCHMARK(ActorCache_CachedGets)->ThreadRange(1, 16)->UseRealTime();
+
+}  // namespace
+}  // namespace workerd
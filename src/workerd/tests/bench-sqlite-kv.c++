@@ -0,0 +1,100 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include <workerd/tests/bench-tools.h>
+#include <workerd/util/sqlite-kv.h>
+
+#include <kj/filesystem.h>
+
+// Compares SqliteKv's multi-key operations against looping over the single-key ones, which is
+// what ActorSqlite used to do for get(), put() and delete() of an array of keys.
+
+namespace workerd {
+namespace {
+
+struct SqliteKvBenchmark: public benchmark::Fixture {
+  virtual ~SqliteKvBenchmark() noexcept(true) {}
+
+  void SetUp(benchmark::State& state) noexcept(true) override {
+    installSqliteCustomAllocator();
+    dir = kj::newInMemoryDirectory(kj::nullClock());
+    vfs = kj::heap<SqliteDatabase::Vfs>(*dir);
+    db = kj::heap<SqliteDatabase>(
+        *vfs, kj::Path({"foo"}), kj::WriteMode::CREATE | kj::WriteMode::MODIFY);
+    kv = kj::heap<SqliteKv>(*db);
+
+    keys = KJ_MAP(i, kj::zeroTo(KEY_COUNT)) { return kj::str("key", 1000 + i); };
+    keyPtrs = KJ_MAP(key, keys) -> SqliteKv::KeyPtr { return key; };
+    for (auto& key: keys) {
+      kv->put(key, VALUE.asBytes());
+    }
+  }
+
+  void TearDown(benchmark::State& state) noexcept(true) override {
+    kv = nullptr;
+    db = nullptr;
+    vfs = nullptr;
+    dir = nullptr;
+  }
+
+  // About the number of keys in a typical `storage.get([...])` call.
+  static constexpr uint KEY_COUNT = 100;
+  static constexpr kj::StringPtr VALUE = "some value that is a bit longer than the key"_kj;
+
+  kj::Own<const kj::Directory> dir;
+  kj::Own<SqliteDatabase::Vfs> vfs;
+  kj::Own<SqliteDatabase> db;
+  kj::Own<SqliteKv> kv;
+  kj::Array<kj::String> keys;
+  kj::Array<SqliteKv::KeyPtr> keyPtrs;
+};
+
+BENCHMARK_F(SqliteKvBenchmark, GetLoop)(benchmark::State& state) {
+  for (auto _: state) {
+    uint count = 0;
+    for (auto key: keyPtrs) {
+      kv->get(key, [&](SqliteKv::ValuePtr value) {
+        benchmark::DoNotOptimize(value);
+        ++count;
+      });
+    }
+    KJ_ASSERT(count == KEY_COUNT);
+  }
+}
+
+BENCHMARK_F(SqliteKvBenchmark, GetMulti)(benchmark::State& state) {
+  for (auto _: state) {
+    uint count = kv->get(keyPtrs, [&](SqliteKv::KeyPtr key, SqliteKv::ValuePtr value) {
+      benchmark::DoNotOptimize(value);
+    });
+    KJ_ASSERT(count == KEY_COUNT);
+  }
+}
+
+BENCHMARK_F(SqliteKvBenchmark, DeleteAndPutLoop)(benchmark::State& state) {
+  for (auto _: state) {
+    for (auto key: keyPtrs) {
+      kv->delete_(key);
+    }
+    for (auto key: keyPtrs) {
+      kv->put(key, VALUE.asBytes());
+    }
+  }
+}
+
+BENCHMARK_F(SqliteKvBenchmark, DeleteAndPutMulti)(benchmark::State& state) {
+  struct KeyValue {
+    kj::StringPtr key;
+    kj::ArrayPtr<const byte> value;
+  };
+  auto pairs = KJ_MAP(key, keyPtrs) { return KeyValue{key, VALUE.asBytes()}; };
+
+  for (auto _: state) {
+    KJ_ASSERT(kv->delete_(keyPtrs, {}) == KEY_COUNT);
+    kv->put(pairs, {});
+  }
+}
+
+}  // namespace
+}  // namespace workerd
@@ -0,0 +1,52 @@
+// Copyright (c) 2026 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include <workerd/io/worker-fs.h>
+#include <workerd/tests/bench-tools.h>
+#include <workerd/tests/test-fixture.h>
+
+// Benchmark for building up in-memory files from many small writes, as happens with repeated
+// `fs.appendFileSync()` calls or streaming writes to /tmp.
+
+namespace workerd {
+namespace {
+
+constexpr size_t FILE_SIZE = 4 * 1024 * 1024;
+
+struct WorkerFs: public benchmark::Fixture {
+  virtual ~WorkerFs() noexcept(true) {}
+
+  void SetUp(benchmark::State& state) noexcept(true) override {
+    fixture = kj::heap<TestFixture>();
+  }
+
+  void TearDown(benchmark::State& state) noexcept(true) override {
+    fixture = nullptr;
+  }
+
+  kj::Own<TestFixture> fixture;
+};
+
+// Appends to an initially empty file in writes of state.range(0) bytes until it reaches
+// FILE_SIZE.
+BENCHMARK_DEFINE_F(WorkerFs, append)(benchmark::State& state) {
+  auto chunk = kj::heapArray<kj::byte>(state.range(0));
+  chunk.asPtr().fill('x');
+  fixture->runInIoContext([&](const TestFixture::Environment& env) {
+    auto& js = env.js;
+    for (auto _: state) {
+      auto file = File::newWritable(js);
+      for (uint32_t offset = 0; offset < FILE_SIZE; offset += chunk.size()) {
+        benchmark::DoNotOptimize(file->write(js, offset, chunk));
+      }
+      benchmark::DoNotOptimize(file->stat(js).size);
+    }
+  });
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(FILE_SIZE));
+}
+
+BENCHMARK_REGISTER_F(WorkerFs, append)->Arg(64)->Arg(1024)->Arg(16 * 1024);
+
+}  // namespace
+}  // namespace workerd
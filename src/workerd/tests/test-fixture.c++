@@ -356,7 +356,7 @@ TestFixture::TestFixture(SetupParams&& params)
           defaultPythonConfig)),
       heapLimitFlag(kj::atomicRefcounted<HeapLimitFlag>()),
       workerIsolate(kj::atomicRefcounted<Worker::Isolate>(kj::mv(api),
-          kj::atomicRefcounted<IsolateObserver>(),
+          kj::mv(params.isolateObserver).orDefault(kj::atomicRefcounted<IsolateObserver>()),
           scriptId,
           kj::rc<MockIsolateLimitEnforcer>(kj::atomicAddRef(*heapLimitFlag)).toOwn(),
           Worker::Isolate::InspectorPolicy::DISALLOW)),
@@ -371,7 +371,8 @@ TestFixture::TestFixture(SetupParams&& params)
           kj::none,
           kj::none,
           SpanParent(nullptr),
-          newWorkerFileSystem(kj::heap<FsMap>(), getTmpDirectoryImpl()),
+          newWorkerFileSystem(kj::heap<FsMap>(), getTmpDirectoryImpl(),
+              kj::heap<VirtualFileSystem::Observer>(), kj::mv(params.fileSpillPolicy)),
           // TestFixture does not support the new module registry: no registry
           // is constructed here, and Worker::Script rejects feature flags that
           // enable it without one. A test that needs the new registry must
@@ -55,6 +55,11 @@ struct TestFixture {
     // no-op base RequestObserver. Lets tests observe metrics hooks (e.g. recording the values
     // passed to setNextSubrequestBodyRewindable()).
     kj::Maybe<kj::Function<kj::Own<RequestObserver>()>> requestObserverFactory;
+    // If set, the worker's writable files spill to disk according to this policy.
+    kj::Maybe<kj::Arc<FileSpillPolicy>> fileSpillPolicy;
+    // If set, used as the isolate's IsolateObserver instead of the no-op base class. Lets tests
+    // observe lock timing hooks.
+    kj::Maybe<kj::Own<IsolateObserver>> isolateObserver;
   };
 
   TestFixture(SetupParams&& params = {.useRealTimers = false});
@@ -115,7 +115,10 @@ namespace workerd::util {
      disabled, deserialization constructs legacy streams in place, exactly as before the gate      \
      existed; the typescript_implemented_streams compat flag requires this gate to receive         \
      streams over RPC (that combination is rejected, not degraded). */                             \
-  V(RPC_EXTERNALS_HYDRATION)
+  V(RPC_EXTERNALS_HYDRATION)                                                                       \
+  /* Deliver all JS RPC calls that arrive on the same target while waiting for the isolate lock    \
+     under a single lock acquisition, instead of one ctx.run() per call. */                        \
+  V(JS_RPC_BATCHED_DISPATCH)
 // clang-format on
 // --------------------------------------------------------------------------------------
 
@@ -0,0 +1,128 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "call-batcher.h"
+
+#include <kj/test.h>
+
+namespace workerd {
+namespace {
+
+// Drives a CallBatcher<kj::String> whose resource is acquired and released by hand, one
+// acquisition per batch.
+struct BatcherTest {
+  kj::EventLoop loop;
+  kj::WaitScope ws{loop};
+
+  struct Batch {
+    kj::Own<kj::PromiseFulfiller<void>> acquired;
+    kj::Own<kj::PromiseFulfiller<void>> released;
+  };
+  kj::Vector<Batch> batches;
+
+  // Calls passed to dispatch(), with a "*" appended to the first one of each drain.
+  kj::Vector<kj::String> dispatched;
+
+  CallBatcher<kj::String> batcher{[this]() -> kj::Promise<void> {
+    auto acquired = kj::newPromiseAndFulfiller<void>();
+    auto released = kj::newPromiseAndFulfiller<void>();
+    batches.add(Batch{kj::mv(acquired.fulfiller), kj::mv(released.fulfiller)});
+    return acquired.promise.then([this, released = kj::mv(released.promise)]() mutable {
+      batcher.drain([this](kj::String& call, bool first) { return dispatch(call, first); });
+      return kj::mv(released);
+    });
+  }};
+
+  kj::Promise<void> dispatch(kj::String& call, bool first) {
+    dispatched.add(first ? kj::str(call, "*") : kj::str(call));
+    if (call == "throw") {
+      KJ_FAIL_REQUIRE("dispatch threw");
+    } else if (call == "fail") {
+      return KJ_EXCEPTION(FAILED, "call failed");
+    }
+    return kj::READY_NOW;
+  }
+
+  void runBatch(uint i) {
+    batches[i].acquired->fulfill();
+    batches[i].released->fulfill();
+  }
+};
+
+KJ_TEST("CallBatcher delivers calls queued before the resource is acquired together") {
+  BatcherTest test;
+
+  auto a = test.batcher.run(kj::str("a"));
+  auto b = test.batcher.run(kj::str("fail"));
+  auto c = test.batcher.run(kj::str("c"));
+  KJ_ASSERT(test.batches.size() == 1);
+
+  test.runBatch(0);
+  a.wait(test.ws);
+  // A call's own failure doesn't affect the rest of its batch.
+  KJ_EXPECT_THROW_MESSAGE("call failed", b.wait(test.ws));
+  c.wait(test.ws);
+  KJ_EXPECT(test.dispatched.size() == 3);
+  KJ_EXPECT(test.dispatched[0] == "a*");
+  KJ_EXPECT(test.dispatched[1] == "fail");
+  KJ_EXPECT(test.dispatched[2] == "c");
+
+  // Once drained, the next call starts a new batch.
+  auto d = test.batcher.run(kj::str("d"));
+  KJ_ASSERT(test.batches.size() == 2);
+  test.runBatch(1);
+  d.wait(test.ws);
+  KJ_EXPECT(test.dispatched.back() == "d*");
+}
+
+KJ_TEST("CallBatcher rejects the rest of a batch when dispatch throws") {
+  BatcherTest test;
+
+  auto a = test.batcher.run(kj::str("throw"));
+  auto b = test.batcher.run(kj::str("b"));
+  test.runBatch(0);
+
+  KJ_EXPECT_THROW_MESSAGE("dispatch threw", a.wait(test.ws));
+  KJ_EXPECT_THROW_MESSAGE("dispatch threw", b.wait(test.ws));
+  KJ_EXPECT(test.dispatched.size() == 1);
+
+  auto c = test.batcher.run(kj::str("c"));
+  KJ_ASSERT(test.batches.size() == 2);
+  test.runBatch(1);
+  c.wait(test.ws);
+}
+
+KJ_TEST("CallBatcher only rejects calls belonging to the failed batch") {
+  BatcherTest test;
+
+  // The first batch is drained, but its task is still finishing up when the next call arrives and
+  // starts a second batch.
+  auto a = test.batcher.run(kj::str("a"));
+  test.batches[0].acquired->fulfill();
+  a.wait(test.ws);
+  auto b = test.batcher.run(kj::str("b"));
+  KJ_ASSERT(test.batches.size() == 2);
+
+  // The first batch's task then fails. That must not reject `b`, nor let the next call start a
+  // third batch while the second is still waiting.
+  test.batches[0].released->reject(KJ_EXCEPTION(FAILED, "first batch failed"));
+  KJ_EXPECT(!b.poll(test.ws));
+  auto c = test.batcher.run(kj::str("c"));
+  KJ_EXPECT(test.batches.size() == 2);
+
+  // The second batch never gets the resource. Everything queued for it is rejected.
+  test.batches[1].acquired->reject(KJ_EXCEPTION(FAILED, "never acquired"));
+  KJ_EXPECT_THROW_MESSAGE("never acquired", b.wait(test.ws));
+  KJ_EXPECT_THROW_MESSAGE("never acquired", c.wait(test.ws));
+  KJ_EXPECT(test.dispatched.size() == 1);
+
+  // And the next call gets a fresh batch.
+  auto d = test.batcher.run(kj::str("d"));
+  KJ_ASSERT(test.batches.size() == 3);
+  test.runBatch(2);
+  d.wait(test.ws);
+}
+
+}  // namespace
+}  // namespace workerd
@@ -0,0 +1,132 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#pragma once
+
+#include <kj/async.h>
+#include <kj/debug.h>
+#include <kj/function.h>
+#include <kj/list.h>
+#include <kj/vector.h>
+
+namespace workerd {
+
+// Gathers calls that arrive while waiting for some expensive resource, such as an isolate lock, so
+// that all of them can be delivered under a single acquisition.
+//
+// The first call queued since the last drain starts a new batch by invoking `acquire`, which
+// should obtain the resource and then call `drain()`. Calls queued before that happens join the
+// same batch. If the batch's `acquire` promise rejects, only calls belonging to that batch are
+// rejected; calls that started a newer batch in the meantime are left for it.
+template <typename T>
+class CallBatcher final: private kj::TaskSet::ErrorHandler {
+ public:
+  explicit CallBatcher(kj::Function<kj::Promise<void>()> acquire)
+      : acquire(kj::mv(acquire)),
+        tasks(*this) {}
+
+  ~CallBatcher() noexcept(false) {
+    // Nothing is left to drain the queue.
+    while (!queue.empty()) {
+      auto& queued = queue.front();
+      queue.remove(queued);
+      queued.dispatched->reject(KJ_EXCEPTION(DISCONNECTED, "call batcher was destroyed"));
+    }
+  }
+
+  KJ_DISALLOW_COPY_AND_MOVE(CallBatcher);
+
+  // Queues `call` and resolves (or rejects) with the promise that drain()'s `dispatch` returns for
+  // it.
+  kj::Promise<void> run(T call) {
+    bool startBatch = pendingBatch == kj::none;
+    uint64_t batch = startBatch ? nextBatch++ : KJ_ASSERT_NONNULL(pendingBatch);
+
+    auto paf = kj::newPromiseAndFulfiller<void>();
+    Queued queued{.call = kj::mv(call), .batch = batch, .dispatched = kj::mv(paf.fulfiller)};
+    queue.add(queued);
+    KJ_DEFER({
+      if (queued.link.isLinked()) {
+        queue.remove(queued);
+      }
+    });
+
+    if (startBatch) {
+      pendingBatch = batch;
+      tasks.add(acquire().catch_(
+          [this, batch](kj::Exception&& e) { failBatch(batch, kj::mv(e)); }));
+    }
+
+    co_await kj::mv(paf.promise);
+    co_await kj::mv(KJ_ASSERT_NONNULL(queued.result));
+  }
+
+  // Called by `acquire` while holding the resource. Passes each queued call to `dispatch` in
+  // order, along with whether it's the first one of this drain. Calls queued from here on start a
+  // new batch.
+  //
+  // A call stays queued until `dispatch` has returned for it. If `dispatch` throws, the exception
+  // propagates and the call is rejected along with the rest of its batch once `acquire`'s promise
+  // rejects.
+  void drain(kj::FunctionParam<kj::Promise<void>(T& call, bool first)> dispatch) {
+    pendingBatch = kj::none;
+
+    bool first = true;
+    while (!queue.empty()) {
+      auto& queued = queue.front();
+      queued.result = dispatch(queued.call, first);
+      first = false;
+      queue.remove(queued);
+      queued.dispatched->fulfill();
+    }
+  }
+
+ private:
+  // A call waiting for the resource. Lives in the frame of run().
+  struct Queued {
+    T call;
+    uint64_t batch;
+
+    // Fulfilled once `dispatch` has returned for this call and `result` has been filled in.
+    kj::Own<kj::PromiseFulfiller<void>> dispatched;
+    kj::Maybe<kj::Promise<void>> result;
+
+    kj::ListLink<Queued> link;
+  };
+
+  kj::Function<kj::Promise<void>()> acquire;
+  kj::List<Queued, &Queued::link> queue;
+
+  // The batch that newly queued calls join, if one is waiting for the resource.
+  kj::Maybe<uint64_t> pendingBatch;
+  uint64_t nextBatch = 0;
+
+  kj::TaskSet tasks;
+
+  void failBatch(uint64_t batch, kj::Exception&& exception) {
+    KJ_IF_SOME(pending, pendingBatch) {
+      if (pending == batch) {
+        pendingBatch = kj::none;
+      }
+    }
+
+    kj::Vector<Queued*> failed;
+    for (auto& queued: queue) {
+      if (queued.batch == batch) {
+        failed.add(&queued);
+      }
+    }
+    for (auto queued: failed) {
+      queue.remove(*queued);
+      queued->dispatched->reject(kj::cp(exception));
+    }
+  }
+
+  void taskFailed(kj::Exception&& exception) override {
+    // Each batch's task rejects its own calls, so this should not happen.
+    KJ_LOG(ERROR, "unexpected error in batched call dispatch", exception);
+  }
+};
+
+}  // namespace workerd
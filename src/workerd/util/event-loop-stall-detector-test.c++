@@ -0,0 +1,69 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "event-loop-stall-detector.h"
+
+#include <kj/async-io.h>
+#include <kj/test.h>
+
+#include <atomic>
+#include <unistd.h>
+
+namespace workerd {
+namespace {
+
+constexpr auto THRESHOLD = 50 * kj::MILLISECONDS;
+
+class TestActivity final: public EventLoopStallDetector::Activity {
+ public:
+  void stalled(kj::Duration duration) const override {
+    stallMillis = duration / kj::MILLISECONDS;
+  }
+
+  mutable std::atomic<int64_t> stallMillis = 0;
+};
+
+// Blocks the thread, and with it the event loop.
+void block(kj::Duration duration) {
+  usleep(duration / kj::MICROSECONDS);
+}
+
+KJ_TEST("EventLoopStallDetector reports stalls to the activity holding up the loop") {
+  auto io = kj::setupAsyncIo();
+  EventLoopStallDetector detector(io.provider->getTimer(), THRESHOLD);
+  auto task = detector.run().eagerlyEvaluate(nullptr);
+  io.provider->getTimer().afterDelay(THRESHOLD).wait(io.waitScope);
+
+  TestActivity outer;
+  TestActivity inner;
+  {
+    EventLoopStallDetector::ActivityScope outerScope(outer);
+    EventLoopStallDetector::ActivityScope innerScope(inner);
+    block(THRESHOLD * 4);
+  }
+
+  // Only the innermost activity is blamed.
+  KJ_EXPECT(detector.getStallCount() == 1);
+  KJ_EXPECT(inner.stallMillis >= THRESHOLD / kj::MILLISECONDS, inner.stallMillis.load());
+  KJ_EXPECT(outer.stallMillis == 0);
+
+  // Once the loop turns again, a new stall is reported separately, this time with no activity.
+  io.provider->getTimer().afterDelay(THRESHOLD).wait(io.waitScope);
+  block(THRESHOLD * 4);
+  KJ_EXPECT(detector.getStallCount() == 2);
+  KJ_EXPECT(outer.stallMillis == 0);
+}
+
+KJ_TEST("EventLoopStallDetector ignores an idle loop") {
+  auto io = kj::setupAsyncIo();
+  EventLoopStallDetector detector(io.provider->getTimer(), THRESHOLD);
+  auto task = detector.run().eagerlyEvaluate(nullptr);
+
+  // Waiting on the loop isn't a stall, however long it takes.
+  io.provider->getTimer().afterDelay(THRESHOLD * 6).wait(io.waitScope);
+  KJ_EXPECT(detector.getStallCount() == 0);
+}
+
+}  // namespace
+}  // namespace workerd
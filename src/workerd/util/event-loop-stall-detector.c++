@@ -0,0 +1,120 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "event-loop-stall-detector.h"
+
+#include <kj/debug.h>
+
+namespace workerd {
+
+namespace {
+
+// The detector watching this thread's event loop, if any.
+thread_local EventLoopStallDetector* threadDetector = nullptr;
+
+}  // namespace
+
+// =======================================================================================
+// ActivityScope
+
+EventLoopStallDetector::ActivityScope::ActivityScope(const Activity& activity) {
+  if (threadDetector == nullptr) return;
+
+  auto& d = *threadDetector;
+  detector = d;
+  auto lock = d.state.lockExclusive();
+  previous = lock->activity;
+  lock->activity = activity;
+}
+
+EventLoopStallDetector::ActivityScope::~ActivityScope() noexcept(false) {
+  KJ_IF_SOME(d, detector) {
+    d.state.lockExclusive()->activity = previous;
+  }
+}
+
+// =======================================================================================
+// EventLoopStallDetector
+
+EventLoopStallDetector::EventLoopStallDetector(kj::Timer& timer, kj::Duration threshold)
+    : timer(timer),
+      clock(kj::systemPreciseMonotonicClock()),
+      threshold(threshold),
+      interval(threshold / 2),
+      state(clock.now()),
+      thread([this]() { watch(); }) {
+  KJ_REQUIRE(threadDetector == nullptr, "this thread's event loop is already being watched");
+  threadDetector = this;
+}
+
+EventLoopStallDetector::~EventLoopStallDetector() noexcept(false) {
+  threadDetector = nullptr;
+
+  // The kj::Thread destructor (which runs after this body) will join the thread.
+  state.lockExclusive()->shutdown = true;
+}
+
+kj::Promise<void> EventLoopStallDetector::run() {
+  for (;;) {
+    beat();
+    co_await timer.afterDelay(interval);
+  }
+}
+
+uint EventLoopStallDetector::getStallCount() const {
+  return state.lockShared()->stallCount;
+}
+
+void EventLoopStallDetector::beat() {
+  auto now = clock.now();
+  auto lock = state.lockExclusive();
+  if (lock->stallReported) {
+    KJ_LOG(WARNING, "event loop stall ended", now - (lock->lastBeat + interval));
+    lock->stallReported = false;
+  }
+  lock->lastBeat = now;
+  ++lock->beats;
+}
+
+void EventLoopStallDetector::watch() {
+  uint64_t seenBeats = 0;
+  kj::Maybe<kj::Duration> timeout;
+  for (;;) {
+    // Without a timeout, we're waiting for the first heartbeat, or for a reported stall to end.
+    bool shutdown = state.when(
+        [&](const State& s) {
+      return s.shutdown || (timeout == kj::none && s.beats != seenBeats);
+    },
+        [&](State& s) {
+      if (s.shutdown) return true;
+      seenBeats = s.beats;
+      timeout = check(s);
+      return false;
+    },
+        timeout);
+    if (shutdown) return;
+  }
+}
+
+kj::Maybe<kj::Duration> EventLoopStallDetector::check(State& state) {
+  if (state.beats == 0 || state.stallReported) return kj::none;
+
+  // Were the loop idle, the heartbeat would have run again `interval` after the last one.
+  auto now = clock.now();
+  auto due = state.lastBeat + interval;
+  if (now < due + threshold) {
+    return due + threshold - now;
+  }
+
+  auto duration = now - due;
+  state.stallReported = true;
+  ++state.stallCount;
+  KJ_LOG(WARNING, "event loop stalled", duration);
+  KJ_IF_SOME(activity, state.activity) {
+    activity.stalled(duration);
+  }
+  return kj::none;
+}
+
+}  // namespace workerd
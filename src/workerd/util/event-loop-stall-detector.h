@@ -0,0 +1,96 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#pragma once
+
+#include <kj/async.h>
+#include <kj/mutex.h>
+#include <kj/thread.h>
+#include <kj/time.h>
+#include <kj/timer.h>
+
+namespace workerd {
+
+// Watches one thread's KJ event loop from a background thread, and reports when the loop goes
+// longer than a threshold without getting around to a heartbeat task. That means something on the
+// thread -- a long JavaScript execution, synchronous crypto, a large JSON parse, a blocking write
+// -- held up every other task on the loop.
+//
+// Code which may hold up the loop can register an Activity while it runs, so that a stall is
+// attributed to it. Isolate locks do this, reporting the isolate and request responsible.
+//
+// The cost on the watched thread is one timer event per half threshold, plus a mutex acquisition
+// for each ActivityScope. Threads without a detector pay only for a thread-local read.
+class EventLoopStallDetector {
+ public:
+  class Activity {
+   public:
+    // Called on the detector thread, at most once per stall, when the loop has been stalled for
+    // `duration` while this activity was registered. The activity stays registered until this
+    // returns. Must be thread-safe.
+    virtual void stalled(kj::Duration duration) const = 0;
+  };
+
+  // Registers `activity` with the detector watching the calling thread, if there is one, for the
+  // lifetime of the scope. Scopes may nest, in which case the innermost one is blamed.
+  class ActivityScope {
+   public:
+    explicit ActivityScope(const Activity& activity);
+    ~ActivityScope() noexcept(false);
+    KJ_DISALLOW_COPY_AND_MOVE(ActivityScope);
+
+   private:
+    kj::Maybe<EventLoopStallDetector&> detector;
+    kj::Maybe<const Activity&> previous;
+  };
+
+  // Must be constructed on the thread whose event loop is to be watched. `timer` must belong to
+  // that loop.
+  EventLoopStallDetector(kj::Timer& timer, kj::Duration threshold);
+  ~EventLoopStallDetector() noexcept(false);
+  KJ_DISALLOW_COPY_AND_MOVE(EventLoopStallDetector);
+
+  // Sends heartbeats. Never completes; stalls are only detected while this is running.
+  kj::Promise<void> run();
+
+  // Number of stalls detected so far.
+  uint getStallCount() const;
+
+ private:
+  struct State {
+    explicit State(kj::TimePoint lastBeat): lastBeat(lastBeat) {}
+
+    // When the heartbeat last ran, by `clock`.
+    kj::TimePoint lastBeat;
+
+    // Incremented on each heartbeat.
+    uint64_t beats = 0;
+
+    // True if the loop has been reported stalled since the last heartbeat.
+    bool stallReported = false;
+
+    kj::Maybe<const Activity&> activity;
+    uint stallCount = 0;
+    bool shutdown = false;
+  };
+
+  kj::Timer& timer;
+  const kj::MonotonicClock& clock;
+  kj::Duration threshold;
+  kj::Duration interval;
+  kj::MutexGuarded<State> state;
+
+  // Declared last so that it is joined before `state` is destroyed.
+  kj::Thread thread;
+
+  void watch();
+  void beat();
+
+  // Reports a stall if the loop has missed its heartbeat by at least the threshold. Returns how
+  // long the thread may sleep before it needs to check again, or kj::none if it should wait for
+  // the next heartbeat.
+  kj::Maybe<kj::Duration> check(State& state);
+};
+
+}  // namespace workerd
@@ -11,9 +11,13 @@
 
 #include <kj/debug.h>
 #include <kj/filesystem.h>
+#include <kj/io.h>
 #include <kj/memory.h>
+#include <kj/thread.h>
 #include <kj/vector.h>
 
+#include <atomic>
+
 PERFETTO_TRACK_EVENT_STATIC_STORAGE_IN_NAMESPACE(workerd::traces);
 
 namespace workerd {
@@ -32,7 +36,9 @@ void initializePerfettoOnce() {
   PerfettoSession::registerWorkerdTracks();
 }
 
-std::unique_ptr<perfetto::TracingSession> createTracingSession(int fd, kj::StringPtr categories) {
+// If `fd` is -1, the trace is kept in memory and must be read back with ReadTraceBlocking().
+std::unique_ptr<perfetto::TracingSession> createTracingSession(
+    int fd, kj::StringPtr categories, uint bufferSizeKb = 1024) {
   initializePerfettoOnce();
   perfetto::protos::gen::TrackEventConfig track_event_cfg;
   track_event_cfg.add_disabled_categories("*");
@@ -45,7 +51,9 @@ std::unique_ptr<perfetto::TracingSession> createTracingSession(int fd, kj::Strin
   }
 
   perfetto::TraceConfig cfg;
-  cfg.add_buffers()->set_size_kb(1024);  // Record up to 1 MiB.
+  // Record up to 1 MiB by default. The buffer uses perfetto's default RING_BUFFER fill policy,
+  // so once it's full the oldest events are overwritten.
+  cfg.add_buffers()->set_size_kb(bufferSizeKb);
   auto* ds_cfg = cfg.add_data_sources()->mutable_config();
   ds_cfg->set_name("track_event");
   ds_cfg->set_track_event_config_raw(track_event_cfg.SerializeAsString());
@@ -82,11 +90,27 @@ struct PerfettoSession::Impl {
   kj::OwnFd fd;
   std::unique_ptr<perfetto::TracingSession> session;
 
+  // Only set for ring buffer sessions, which need to start a new session after each snapshot.
+  kj::Maybe<RingBuffer> ringBuffer;
+  kj::String categories;
+
+  // Reads out and writes the previous session after a snapshot. Declared last so that it's joined
+  // before anything else is torn down.
+  std::atomic<bool> snapshotRunning = false;
+  kj::Maybe<kj::Own<kj::Thread>> snapshotThread;
+
   Impl(kj::OwnFd dest, kj::StringPtr categories)
       : fd(kj::mv(dest)),
         session(createTracingSession(fd.get(), categories)) {
     session->StartBlocking();
   }
+
+  Impl(RingBuffer ringBuffer, kj::StringPtr categories)
+      : session(createTracingSession(-1, categories, ringBuffer.sizeKb)),
+        ringBuffer(ringBuffer),
+        categories(kj::str(categories)) {
+    session->StartBlocking();
+  }
 };
 
 PerfettoSession::PerfettoSession(kj::StringPtr path, kj::StringPtr categories)
@@ -95,6 +119,9 @@ PerfettoSession::PerfettoSession(kj::StringPtr path, kj::StringPtr categories)
 PerfettoSession::PerfettoSession(int fd, kj::StringPtr categories)
     : impl(kj::heap<Impl>(kj::OwnFd(fd), categories)) {}
 
+PerfettoSession::PerfettoSession(RingBuffer ringBuffer, kj::StringPtr categories)
+    : impl(kj::heap<Impl>(ringBuffer, categories)) {}
+
 PerfettoSession::~PerfettoSession() noexcept(false) {
   if (impl) {
     impl->session->FlushBlocking();
@@ -108,6 +135,44 @@ void PerfettoSession::flush() {
   }
 }
 
+void PerfettoSession::snapshot(kj::StringPtr path) {
+  KJ_REQUIRE(impl.get() != nullptr, "PerfettoSession has been moved away");
+  auto ringBuffer =
+      KJ_REQUIRE_NONNULL(impl->ringBuffer, "only ring buffer sessions can be snapshotted");
+
+  if (impl->snapshotRunning.load(std::memory_order_acquire)) {
+    KJ_LOG(WARNING, "previous trace snapshot is still being written; skipping this one", path);
+    return;
+  }
+  // The previous thread has finished, so this doesn't block.
+  impl->snapshotThread = kj::none;
+
+  // An in-memory session can only be read once it has stopped. Start recording into a fresh one
+  // first, so that nothing emitted while the old one is read out is lost, then hand the old one
+  // to a thread of its own: stopping, reading and writing it all block.
+  auto next = createTracingSession(-1, impl->categories, ringBuffer.sizeKb);
+  next->Start();
+  auto previous = kj::mv(impl->session);
+  impl->session = kj::mv(next);
+
+  impl->snapshotRunning.store(true, std::memory_order_release);
+  impl->snapshotThread = kj::heap<kj::Thread>(
+      [&running = impl->snapshotRunning, session = kj::mv(previous), path = kj::str(path)]() {
+    KJ_DEFER(running.store(false, std::memory_order_release));
+    KJ_IF_SOME(exception, kj::runCatchingExceptions([&]() {
+      session->FlushBlocking();
+      session->StopBlocking();
+      std::vector<char> trace = session->ReadTraceBlocking();
+
+      auto fd = openTraceFile(path);
+      kj::FdOutputStream(fd.get()).write(
+          kj::arrayPtr(reinterpret_cast<const kj::byte*>(trace.data()), trace.size()));
+    })) {
+      KJ_LOG(ERROR, "failed to write trace snapshot", path, exception);
+    }
+  });
+}
+
 }  // namespace workerd
 
 #endif  // defined(WORKERD_USE_PERFETTO)
@@ -26,6 +26,14 @@ class PerfettoSession {
   // Create a PerfettoSession on an existing fd (the constructor will handle
   // wrapping the fd in kj::AutocloseFd)
   explicit PerfettoSession(int fd, kj::StringPtr categories);
+
+  // Create a PerfettoSession that records into an in-memory ring buffer of the given size rather
+  // than a file, so that it can be left running indefinitely. Once the buffer is full, the
+  // oldest events are overwritten. Use snapshot() to write out whatever is currently buffered.
+  struct RingBuffer {
+    uint sizeKb;
+  };
+  PerfettoSession(RingBuffer ringBuffer, kj::StringPtr categories);
   PerfettoSession(PerfettoSession&&) = default;
   PerfettoSession& operator=(PerfettoSession&&) = default;
   KJ_DISALLOW_COPY(PerfettoSession);
@@ -33,6 +41,11 @@ class PerfettoSession {
 
   void flush();
 
+  // Only valid for a RingBuffer session. Starts recording into a new, empty buffer, and writes
+  // the previous buffer's events to a new trace file at `path` from a background thread. If the
+  // previous snapshot is still being written, logs a warning and does nothing.
+  void snapshot(kj::StringPtr path);
+
   // Receives a comma-separated list of trace categories and returns an array.
   static kj::Array<kj::ArrayPtr<const char>> parseCategories(kj::StringPtr categories);
 
@@ -339,5 +339,141 @@ KJ_TEST("SQLite-KV multi-put with allowUnconfirmed") {
   KJ_EXPECT(called);
 }
 
+KJ_TEST("SQLite-KV multi-get and multi-delete") {
+  auto dir = kj::newInMemoryDirectory(kj::nullClock());
+  SqliteDatabase::Vfs vfs(*dir);
+  SqliteDatabase db(vfs, kj::Path({"foo"}), kj::WriteMode::CREATE | kj::WriteMode::MODIFY);
+  SqliteKv kv(db);
+
+  // Before the table exists, nothing is found and nothing is deleted.
+  {
+    SqliteKv::KeyPtr keys[] = {"foo"_kj, "bar"_kj};
+    KJ_EXPECT(kv.get(keys, [&](SqliteKv::KeyPtr key, kj::ArrayPtr<const byte> value) {
+      KJ_FAIL_EXPECT("should not call callback when no match", key);
+    }) == 0);
+    KJ_EXPECT(kv.delete_(keys, {}) == 0);
+  }
+
+  // Enough keys to need several batches. Every third key is left unwritten.
+  kj::Vector<kj::String> allKeys;
+  for (uint i = 0; i < SqliteKv::MAX_KEYS_PER_BATCH * 2 + 10; i++) {
+    // Offset the number so that keys sort numerically.
+    auto key = kj::str("key", 1000 + i);
+    if (i % 3 != 0) {
+      kv.put(key, key.asBytes());
+    }
+    allKeys.add(kj::mv(key));
+  }
+
+  // A key containing a NUL byte must be matched exactly, not truncated.
+  const char nulKeyChars[] = {'a', '\0', 'b', '\0'};
+  SqliteKv::KeyPtr nulKey(nulKeyChars, 3);
+  kv.put(nulKey, "nul"_kj.asBytes());
+  kv.put("a"_kj, "prefix"_kj.asBytes());
+
+  {
+    auto keys = KJ_MAP(key, allKeys) -> SqliteKv::KeyPtr { return key; };
+
+    kj::Vector<kj::String> found;
+    uint count = kv.get(keys, [&](SqliteKv::KeyPtr key, kj::ArrayPtr<const byte> value) {
+      KJ_EXPECT(kj::str(value.asChars()) == key);
+      found.add(kj::str(key));
+    });
+    KJ_EXPECT(count == found.size());
+
+    kj::Vector<kj::String> expected;
+    for (auto i: kj::indices(allKeys)) {
+      if (i % 3 != 0) expected.add(kj::str(allKeys[i]));
+    }
+    KJ_EXPECT(found.size() == expected.size(), found.size(), expected.size());
+    // Keys were requested in sorted order, so they are reported in sorted order.
+    for (auto i: kj::indices(found)) {
+      KJ_EXPECT(found[i] == expected[i]);
+    }
+  }
+
+  {
+    // Unsorted, duplicated and missing keys, plus the NUL-containing key.
+    SqliteKv::KeyPtr keys[] = {nulKey, "key1005"_kj, "missing"_kj, "key1001"_kj, "key1001"_kj};
+    kj::Vector<kj::String> found;
+    KJ_EXPECT(kv.get(keys, [&](SqliteKv::KeyPtr key, kj::ArrayPtr<const byte> value) {
+      found.add(kj::str(key.size(), ":", value.asChars()));
+    }) == 3);
+    KJ_ASSERT(found.size() == 3);
+    KJ_EXPECT(found[0] == "3:nul");
+    KJ_EXPECT(found[1] == "7:key1001");
+    KJ_EXPECT(found[2] == "7:key1005");
+  }
+
+  {
+    // Delete every key, present or not, across several batches. Only the ones that existed count.
+    auto keys = KJ_MAP(key, allKeys) -> SqliteKv::KeyPtr { return key; };
+    uint expectedCount = allKeys.size() - (allKeys.size() + 2) / 3;
+    KJ_EXPECT(kv.delete_(keys, {}) == expectedCount);
+    KJ_EXPECT(kv.delete_(keys, {}) == 0);
+
+    KJ_EXPECT(kv.get(keys, [&](SqliteKv::KeyPtr key, kj::ArrayPtr<const byte> value) {
+      KJ_FAIL_EXPECT("key should have been deleted", key);
+    }) == 0);
+
+    // The NUL-containing key and its prefix are untouched.
+    SqliteKv::KeyPtr remaining[] = {"a"_kj, nulKey};
+    KJ_EXPECT(kv.get(remaining, [](auto, auto) {}) == 2);
+  }
+}
+
+KJ_TEST("SQLite-KV multi-put in batches") {
+  class TestSqliteObserver: public SqliteObserver {
+   public:
+    void addQueryStats(uint64_t read, uint64_t written) override {
+      rowsWritten += written;
+    }
+
+    uint64_t rowsWritten = 0;
+  };
+
+  auto dir = kj::newInMemoryDirectory(kj::nullClock());
+  SqliteDatabase::Vfs vfs(*dir);
+  TestSqliteObserver sqliteObserver;
+  SqliteDatabase db(vfs, kj::Path({"foo"}), kj::WriteMode::CREATE | kj::WriteMode::MODIFY,
+      /*sqliteMaxMemoryBytes=*/kj::maxValue, /*sqliteMaxMemoryPerProcessBytes=*/kj::maxValue,
+      sqliteObserver);
+  SqliteKv kv(db);
+
+  struct KeyValue {
+    kj::String key;
+    kj::String value;
+  };
+
+  // More than two full batches, with a remainder, and with the same key written twice so that the
+  // later value must win.
+  uint count = SqliteKv::PUT_BATCH_SIZE * 2 + 5;
+  kj::Vector<KeyValue> pairs;
+  for (uint i = 0; i < count; i++) {
+    pairs.add(KeyValue{kj::str("key", i), kj::str("value", i)});
+  }
+  pairs.add(KeyValue{kj::str("key1"), kj::str("overwritten")});
+
+  struct KeyValuePtr {
+    kj::StringPtr key;
+    kj::ArrayPtr<const byte> value;
+  };
+  auto ptrs = KJ_MAP(pair, pairs) { return KeyValuePtr{pair.key, pair.value.asBytes()}; };
+  kv.put(ptrs, {});
+
+  // Batching must not change the number of rows billed as written.
+  KJ_EXPECT(sqliteObserver.rowsWritten == count + 1, sqliteObserver.rowsWritten);
+
+  auto keys = KJ_MAP(pair, pairs) -> SqliteKv::KeyPtr { return pair.key; };
+  uint found = kv.get(keys, [&](SqliteKv::KeyPtr key, kj::ArrayPtr<const byte> value) {
+    if (key == "key1") {
+      KJ_EXPECT(kj::str(value.asChars()) == "overwritten");
+    } else {
+      KJ_EXPECT(kj::str(value.asChars()) == kj::str("value", key.slice(3)));
+    }
+  });
+  KJ_EXPECT(found == count);
+}
+
 }  // namespace
 }  // namespace workerd
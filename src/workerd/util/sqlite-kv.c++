@@ -8,8 +8,23 @@
 
 #include <sqlite3.h>
 
+#include <kj/vector.h>
+
 namespace workerd {
 
+namespace {
+
+// Returns `count` copies of `item`, separated by commas. Used to build multi-key statements.
+kj::String repeatWithCommas(kj::StringPtr item, uint count) {
+  kj::Vector<kj::StringPtr> items(count);
+  while (items.size() < count) {
+    items.add(item);
+  }
+  return kj::strArray(items, ", ");
+}
+
+}  // namespace
+
 void SqliteKvRegulator::onError(kj::Maybe<int> sqliteErrorCode, kj::StringPtr message) const {
   KJ_IF_SOME(ec, sqliteErrorCode) {
     switch (ec) {
@@ -172,6 +187,69 @@ bool SqliteKv::delete_(KeyPtr key, WriteOptions options) {
   return result;
 }
 
+uint SqliteKv::delete_(kj::ArrayPtr<const KeyPtr> keys, WriteOptions options) {
+  if (keys.size() == 0) return 0;
+  auto& stmts = ensureInitialized(options.allowUnconfirmed);
+
+  uint count = 0;
+  for (auto remaining = keys; remaining.size() > 0;) {
+    auto batch = remaining.first(kj::min(remaining.size(), MAX_KEYS_PER_BATCH));
+    remaining = remaining.slice(batch.size(), remaining.size());
+    count += runMultiKey(stmts, batch, /*forDelete=*/true, options).changeCount();
+  }
+
+  for (auto key: keys) {
+    clearExternalsIfPresent(key);
+  }
+  return count;
+}
+
+SqliteDatabase::Query SqliteKv::runMultiKey(
+    Initialized& stmts, kj::ArrayPtr<const KeyPtr> batch, bool forDelete, WriteOptions options) {
+  KJ_REQUIRE(batch.size() > 0 && batch.size() <= MAX_KEYS_PER_BATCH);
+
+  uint bucket = 0;
+  while (MULTI_KEY_BUCKETS[bucket] < batch.size()) ++bucket;
+  uint placeholderCount = MULTI_KEY_BUCKETS[bucket];
+
+  auto& stmtSlot = forDelete ? stmts.stmtDeleteMulti[bucket] : stmts.stmtGetMulti[bucket];
+  if (stmtSlot == kj::none) {
+    auto placeholders = repeatWithCommas("?", placeholderCount);
+    auto sql = forDelete
+        ? kj::str("DELETE FROM _cf_KV WHERE key IN (", placeholders, ")")
+        : kj::str("SELECT key, value FROM _cf_KV WHERE key IN (", placeholders, ") ORDER BY key");
+    stmtSlot = stmts.db.prepare(Initialized::regulator, sql);
+  }
+  auto& stmt = KJ_ASSERT_NONNULL(stmtSlot);
+
+  SqliteDatabase::Query::ValuePtr bindings[MAX_KEYS_PER_BATCH];
+  for (auto i: kj::zeroTo(placeholderCount)) {
+    bindings[i] = batch[kj::min(i, batch.size() - 1)];
+  }
+
+  return stmt.run({.allowUnconfirmed = options.allowUnconfirmed},
+      kj::ArrayPtr<const SqliteDatabase::Query::ValuePtr>(bindings, placeholderCount));
+}
+
+void SqliteKv::putBatch(Initialized& stmts,
+    kj::ArrayPtr<const SqliteDatabase::Query::ValuePtr> bindings,
+    WriteOptions options) {
+  KJ_REQUIRE(bindings.size() == PUT_BATCH_SIZE * 2);
+
+  if (stmts.stmtPutMulti == kj::none) {
+    stmts.stmtPutMulti = stmts.db.prepare(Initialized::regulator,
+        kj::str("INSERT INTO _cf_KV VALUES ", repeatWithCommas("(?, ?)", PUT_BATCH_SIZE),
+            " ON CONFLICT DO UPDATE SET value = excluded.value"));
+  }
+  auto& stmt = KJ_ASSERT_NONNULL(stmts.stmtPutMulti);
+
+  stmt.run({.allowUnconfirmed = options.allowUnconfirmed}, bindings);
+
+  for (auto i: kj::zeroTo(PUT_BATCH_SIZE)) {
+    clearExternalsIfPresent(bindings[i * 2].get<KeyPtr>());
+  }
+}
+
 void SqliteKv::clearExternalsIfPresent(KeyPtr key) {
   // If the externals table hasn't been created yet, there's nothing to clear. We deliberately
   // avoid creating it here -- it should only be created when externals are actually being
@@ -44,6 +44,14 @@ class SqliteKv: private SqliteDatabase::ResetListener {
   template <typename Func>
   bool get(KeyPtr key, Func&& callback);
 
+  // Search for several keys at once, calling the callback (with KeyPtr and ValuePtr parameters)
+  // for each one found. Keys are looked up in batches of up to MAX_KEYS_PER_BATCH with a single
+  // statement per batch. Within a batch, matches are reported in key order and each key is
+  // reported at most once, so if `keys` is sorted, so is the output. Returns the number of
+  // matches.
+  template <typename Func>
+  uint get(kj::ArrayPtr<const KeyPtr> keys, Func&& callback);
+
   enum Order { FORWARD, REVERSE };
 
   // Search for all known keys and values in a range, calling the callback (with KeyPtr and
@@ -78,12 +86,21 @@ class SqliteKv: private SqliteDatabase::ResetListener {
   bool delete_(KeyPtr key);
   bool delete_(KeyPtr key, WriteOptions options);
 
+  // Delete several keys, in batches like the multi-key get(), and return how many were matched.
+  uint delete_(kj::ArrayPtr<const KeyPtr> keys, WriteOptions options);
+
   uint deleteAll();
 
-  // TODO(perf): Should we provide multi-get, multi-put, and multi-delete? It's a bit tricky to
-  //   implement them as single SQL queries, while still using prepared statements. The c-array
-  //   extension might help here, though it can only support arrays of NUL-terminated strings, not
-  //   byte blobs or strings containing NUL bytes.
+  // Multi-key get() and delete_() bind each batch of keys into an `IN (?, ?, ...)` list, which
+  // (unlike the carray extension) handles keys containing NUL bytes. To keep the number of
+  // prepared statements small, a batch uses the smallest of MULTI_KEY_BUCKETS placeholders that
+  // fits it, and fills the unused ones by repeating its last key; `IN` ignores the duplicates.
+  static constexpr uint MAX_KEYS_PER_BATCH = 128;
+
+  // Multi-put writes batches of this many rows with one multi-row `INSERT` each. Leftover rows
+  // are written one at a time, since padding an `INSERT` with duplicates would be billed as extra
+  // rows written.
+  static constexpr uint PUT_BATCH_SIZE = 32;
 
   // Get/put "externals", which are lists of tokens associated with keys. These are stored in a
   // separate table (_cf_EXTERNALS) which is lazily created.
@@ -96,6 +113,9 @@ class SqliteKv: private SqliteDatabase::ResetListener {
   void putExternals(kj::StringPtr key, kj::Array<kj::Array<byte>> tokens);
 
  private:
+  static constexpr uint MULTI_KEY_BUCKET_COUNT = 3;
+  static constexpr uint MULTI_KEY_BUCKETS[MULTI_KEY_BUCKET_COUNT] = {8, 32, MAX_KEYS_PER_BATCH};
+
   struct Uninitialized {};
 
   struct Initialized {
@@ -169,6 +189,12 @@ class SqliteKv: private SqliteDatabase::ResetListener {
       RELEASE _cf_put_multiple_savepoint
     )");
 
+    // Multi-key statements, indexed like MULTI_KEY_BUCKETS. Prepared on first use, since most
+    // databases never need most of them.
+    kj::Maybe<SqliteDatabase::Statement> stmtGetMulti[MULTI_KEY_BUCKET_COUNT];
+    kj::Maybe<SqliteDatabase::Statement> stmtDeleteMulti[MULTI_KEY_BUCKET_COUNT];
+    kj::Maybe<SqliteDatabase::Statement> stmtPutMulti;
+
     Initialized(SqliteDatabase& db): db(db) {}
   };
 
@@ -227,6 +253,18 @@ class SqliteKv: private SqliteDatabase::ResetListener {
   // Helper function that rolls back a multi-put statement and swallows any exceptions that may
   // occur during the rollback.
   void rollbackMultiPut(Initialized& stmts, WriteOptions options);
+
+  // Runs the multi-key SELECT (if `forDelete` is false) or DELETE statement on `batch`, which must
+  // contain between 1 and MAX_KEYS_PER_BATCH keys.
+  SqliteDatabase::Query runMultiKey(Initialized& stmts,
+      kj::ArrayPtr<const KeyPtr> batch,
+      bool forDelete,
+      WriteOptions options = {});
+
+  // Writes PUT_BATCH_SIZE rows with one statement. `bindings` alternates keys and values.
+  void putBatch(Initialized& stmts,
+      kj::ArrayPtr<const SqliteDatabase::Query::ValuePtr> bindings,
+      WriteOptions options);
 };
 
 // Iterator over list results.
@@ -310,6 +348,26 @@ bool SqliteKv::get(KeyPtr key, Func&& callback) {
   }
 }
 
+template <typename Func>
+uint SqliteKv::get(kj::ArrayPtr<const KeyPtr> keys, Func&& callback) {
+  if (!tableCreated) return 0;
+  auto& stmts = KJ_UNWRAP_OR(state.tryGet<Initialized>(), return 0);
+
+  uint count = 0;
+  while (keys.size() > 0) {
+    auto batch = keys.first(kj::min(keys.size(), MAX_KEYS_PER_BATCH));
+    keys = keys.slice(batch.size(), keys.size());
+
+    auto query = runMultiKey(stmts, batch, /*forDelete=*/false);
+    while (!query.isDone()) {
+      callback(query.getText(0), query.getBlob(1));
+      query.nextRow();
+      ++count;
+    }
+  }
+  return count;
+}
+
 template <typename Func>
 uint SqliteKv::list(
     KeyPtr begin, kj::Maybe<KeyPtr> end, kj::Maybe<uint> limit, Order order, Func&& callback) {
@@ -327,8 +385,22 @@ void SqliteKv::put(ArrayOfKeyValuePair& pairs, WriteOptions options) {
     // If any of the puts throw an exception, rollback the transaction and re-throw the exception
     // from the put that failed.
     KJ_ON_SCOPE_FAILURE(rollbackMultiPut(stmts, options));
+
+    // Accumulate full batches of rows and write each with one statement.
+    SqliteDatabase::Query::ValuePtr bindings[PUT_BATCH_SIZE * 2];
+    uint pending = 0;
     for (const auto& pair: pairs) {
-      put(pair.key, pair.value, {.allowUnconfirmed = options.allowUnconfirmed});
+      bindings[pending * 2] = KeyPtr(pair.key);
+      bindings[pending * 2 + 1] = ValuePtr(pair.value);
+      if (++pending == PUT_BATCH_SIZE) {
+        putBatch(stmts, bindings, options);
+        pending = 0;
+      }
+    }
+
+    for (auto i: kj::zeroTo(pending)) {
+      put(bindings[i * 2].get<KeyPtr>(), bindings[i * 2 + 1].get<ValuePtr>(),
+          {.allowUnconfirmed = options.allowUnconfirmed});
     }
   }
   stmts.stmtMultiPutRelease.run({.allowUnconfirmed = options.allowUnconfirmed});
@@ -0,0 +1,149 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "sqlite-page-cache.h"
+#include "sqlite.h"
+
+#include <kj/test.h>
+
+namespace workerd {
+namespace {
+
+// Room for a few dozen 4 KiB pages.
+constexpr size_t BUDGET = 128 * 1024;
+
+struct GlobalInit {
+  GlobalInit() {
+    KJ_ASSERT(installSqliteGlobalPageCache(BUDGET));
+  }
+};
+
+static GlobalInit init;
+
+class TestSqliteObserver: public SqliteObserver {
+ public:
+  void addPageCacheStats(uint64_t hits, uint64_t misses, uint64_t bytesUsed) override {
+    this->hits += hits;
+    this->misses += misses;
+    this->bytesUsed = bytesUsed;
+    ++calls;
+  }
+
+  uint calls = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t bytesUsed = 0;
+};
+
+// Fills `db` with enough data to span many more pages than fit in the budget.
+void fill(SqliteDatabase& db, kj::StringPtr tag) {
+  db.run("CREATE TABLE t (id INTEGER PRIMARY KEY, data TEXT)");
+  auto stmt = db.prepare("INSERT INTO t VALUES (?, ?)");
+  auto data = kj::heapString(1000);
+  for (auto& c: data) c = 'x';
+  for (auto i: kj::zeroTo(200)) {
+    stmt.run(static_cast<int64_t>(i), kj::str(tag, data));
+  }
+}
+
+void check(SqliteDatabase& db, kj::StringPtr tag) {
+  auto query = db.run("SELECT data FROM t ORDER BY id");
+  uint count = 0;
+  for (; !query.isDone(); query.nextRow()) {
+    KJ_EXPECT(query.getText(0).startsWith(tag));
+    ++count;
+  }
+  KJ_EXPECT(count == 200);
+}
+
+KJ_TEST("global page cache keeps all databases within one budget") {
+  auto dir = kj::newInMemoryDirectory(kj::nullClock());
+  SqliteDatabase::Vfs vfs(*dir);
+  TestSqliteObserver observerA;
+  TestSqliteObserver observerB;
+  SqliteDatabase dbA(vfs, kj::Path({"a"}), kj::WriteMode::CREATE | kj::WriteMode::MODIFY,
+      kj::maxValue, kj::maxValue, observerA);
+  SqliteDatabase dbB(vfs, kj::Path({"b"}), kj::WriteMode::CREATE | kj::WriteMode::MODIFY,
+      kj::maxValue, kj::maxValue, observerB);
+
+  auto before = getSqliteGlobalPageCacheStats();
+  KJ_EXPECT(before.budgetBytes == BUDGET);
+
+  fill(dbA, "a");
+  fill(dbB, "b");
+
+  // Pages were recycled between the databases, yet each still reads back its own data.
+  check(dbA, "a");
+  check(dbB, "b");
+  check(dbA, "a");
+
+  auto after = getSqliteGlobalPageCacheStats();
+  KJ_EXPECT(after.evictions > before.evictions);
+  KJ_EXPECT(after.usedBytes <= BUDGET, after.usedBytes);
+  KJ_EXPECT(after.hits > before.hits);
+  KJ_EXPECT(after.misses > before.misses);
+
+  // Each database's observer saw its own activity.
+  KJ_EXPECT(observerA.hits > 0);
+  KJ_EXPECT(observerA.misses > 0);
+  KJ_EXPECT(observerA.bytesUsed > 0);
+  KJ_EXPECT(observerA.bytesUsed < BUDGET * 2, observerA.bytesUsed);
+  KJ_EXPECT(observerB.hits > 0);
+  KJ_EXPECT(observerB.misses > 0);
+}
+
+KJ_TEST("page cache stats are reported once per transaction") {
+  auto dir = kj::newInMemoryDirectory(kj::nullClock());
+  SqliteDatabase::Vfs vfs(*dir);
+  TestSqliteObserver observer;
+  SqliteDatabase db(vfs, kj::Path({"d"}), kj::WriteMode::CREATE | kj::WriteMode::MODIFY,
+      kj::maxValue, kj::maxValue, observer);
+  fill(db, "d");
+
+  observer.calls = 0;
+  observer.hits = 0;
+  observer.misses = 0;
+  db.run("BEGIN TRANSACTION");
+  check(db, "d");
+  check(db, "d");
+  KJ_EXPECT(observer.calls == 0);
+
+  // The whole transaction's activity is reported when it commits.
+  db.run("COMMIT TRANSACTION");
+  KJ_EXPECT(observer.calls == 1);
+  KJ_EXPECT(observer.hits + observer.misses > 0);
+
+  // Outside of a transaction, each query is a transaction of its own.
+  check(db, "d");
+  KJ_EXPECT(observer.calls == 2);
+}
+
+KJ_TEST("global page cache releases pages when a database closes or the budget shrinks") {
+  auto dir = kj::newInMemoryDirectory(kj::nullClock());
+  SqliteDatabase::Vfs vfs(*dir);
+
+  {
+    SqliteDatabase db(vfs, kj::Path({"c"}), kj::WriteMode::CREATE | kj::WriteMode::MODIFY);
+    fill(db, "c");
+    KJ_EXPECT(getSqliteGlobalPageCacheStats().usedBytes > 0);
+  }
+  KJ_EXPECT(getSqliteGlobalPageCacheStats().usedBytes == 0);
+
+  SqliteDatabase db(vfs, kj::Path({"c"}), kj::WriteMode::MODIFY);
+  check(db, "c");
+  KJ_EXPECT(getSqliteGlobalPageCacheStats().usedBytes > 0);
+
+  // Nothing is pinned between queries, so shrinking the budget evicts everything.
+  KJ_ASSERT(installSqliteGlobalPageCache(0));
+  KJ_EXPECT(getSqliteGlobalPageCacheStats().usedBytes == 0);
+
+  // SQLite still makes progress with no budget at all, since it may always exceed the budget to
+  // hold the pages it has pinned.
+  check(db, "c");
+
+  KJ_ASSERT(installSqliteGlobalPageCache(BUDGET));
+}
+
+}  // namespace
+}  // namespace workerd
@@ -0,0 +1,334 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#include "sqlite-page-cache.h"
+
+#include <sqlite3.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kj/debug.h>
+#include <kj/map.h>
+#include <kj/mutex.h>
+#include <kj/vector.h>
+
+#include <new>
+
+namespace workerd {
+namespace {
+
+struct Cache;
+
+// A cached page. The page's content (`pageSize` bytes) and SQLite's extra data (`extraSize`
+// bytes) follow it in the same allocation.
+struct Page {
+  // Must be first, so that the sqlite3_pcache_page* handed to SQLite can be cast back to a Page*.
+  sqlite3_pcache_page handle;
+
+  Cache* cache;
+  unsigned key;
+  bool pinned;
+
+  // Neighbours on the global LRU list. Only used while the page is unpinned and belongs to a
+  // purgeable cache.
+  Page* lruPrev;
+  Page* lruNext;
+};
+
+// The cache for one database file, created by SQLite through xCreate().
+struct Cache {
+  size_t pageSize;
+  size_t extraSize;
+
+  // False for temporary and in-memory databases, whose pages SQLite doesn't keep anywhere else
+  // and which therefore must never be evicted.
+  bool purgeable;
+
+  // Protected by the global state's mutex.
+  kj::HashMap<unsigned, Page*> pages;
+
+  size_t allocSize() const {
+    return sizeof(Page) + pageSize + extraSize;
+  }
+};
+
+struct State {
+  bool installed = false;
+  size_t budgetBytes = 0;
+  size_t usedBytes = 0;
+  uint64_t pageCount = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+
+  // Unpinned pages of purgeable caches, from most to least recently unpinned.
+  Page* lruHead = nullptr;
+  Page* lruTail = nullptr;
+
+  void lruAdd(Page& page) {
+    page.lruPrev = nullptr;
+    page.lruNext = lruHead;
+    if (lruHead != nullptr) {
+      lruHead->lruPrev = &page;
+    } else {
+      lruTail = &page;
+    }
+    lruHead = &page;
+  }
+
+  void lruRemove(Page& page) {
+    if (page.lruPrev != nullptr) {
+      page.lruPrev->lruNext = page.lruNext;
+    } else {
+      lruHead = page.lruNext;
+    }
+    if (page.lruNext != nullptr) {
+      page.lruNext->lruPrev = page.lruPrev;
+    } else {
+      lruTail = page.lruPrev;
+    }
+    page.lruPrev = nullptr;
+    page.lruNext = nullptr;
+  }
+
+  // Removes `page` from its cache and from the LRU list, without freeing it.
+  void detach(Page& page) {
+    Cache& cache = *page.cache;
+    if (cache.purgeable) {
+      if (!page.pinned) lruRemove(page);
+      usedBytes -= cache.allocSize();
+    }
+    cache.pages.erase(page.key);
+    --pageCount;
+  }
+
+  void discard(Page& page) {
+    detach(page);
+    free(&page);
+  }
+
+  // Discards least-recently-used pages until at most `targetBytes` are in use or no unpinned
+  // pages remain. If `reuseSize` is non-zero, the first evicted page of that allocation size is
+  // returned rather than freed, so the caller can reuse its memory.
+  Page* evictDownTo(size_t targetBytes, size_t reuseSize = 0) {
+    Page* reused = nullptr;
+    while (usedBytes > targetBytes && lruTail != nullptr) {
+      Page& victim = *lruTail;
+      size_t victimSize = victim.cache->allocSize();
+      detach(victim);
+      ++evictions;
+      if (reused == nullptr && victimSize == reuseSize) {
+        reused = &victim;
+      } else {
+        free(&victim);
+      }
+    }
+    return reused;
+  }
+};
+
+kj::MutexGuarded<State>& getState() {
+  static kj::MutexGuarded<State> state;
+  return state;
+}
+
+Cache& getCache(sqlite3_pcache* cache) {
+  return *reinterpret_cast<Cache*>(cache);
+}
+
+Page& getPage(sqlite3_pcache_page* page) {
+  return *reinterpret_cast<Page*>(page);
+}
+
+int pageCacheInit(void*) {
+  return SQLITE_OK;
+}
+
+void pageCacheShutdown(void*) {}
+
+sqlite3_pcache* pageCacheCreate(int szPage, int szExtra, int bPurgeable) {
+  auto cache = new (std::nothrow) Cache{
+    .pageSize = static_cast<size_t>(szPage),
+    .extraSize = static_cast<size_t>(szExtra),
+    .purgeable = bPurgeable != 0,
+  };
+  return reinterpret_cast<sqlite3_pcache*>(cache);
+}
+
+void pageCacheCachesize(sqlite3_pcache*, int) {
+  // Ignored: the global budget decides how many pages each database gets.
+}
+
+int pageCachePagecount(sqlite3_pcache* p) {
+  auto lock = getState().lockExclusive();
+  return getCache(p).pages.size();
+}
+
+sqlite3_pcache_page* pageCacheFetch(sqlite3_pcache* p, unsigned key, int createFlag) {
+  Cache& cache = getCache(p);
+  auto lock = getState().lockExclusive();
+
+  KJ_IF_SOME(found, cache.pages.find(key)) {
+    Page& page = *found;
+    ++lock->hits;
+    if (!page.pinned) {
+      page.pinned = true;
+      if (cache.purgeable) lock->lruRemove(page);
+    }
+    return &page.handle;
+  }
+
+  // createFlag 0 means "don't allocate", 1 means "allocate if it's easy", and 2 means "allocate
+  // if at all possible". SQLite only passes 1 when it could instead free up pages by writing out
+  // dirty ones, so we return null if we'd have to exceed the budget.
+  if (createFlag == 0) return nullptr;
+
+  size_t size = cache.allocSize();
+  Page* page = nullptr;
+  if (cache.purgeable) {
+    if (lock->usedBytes + size > lock->budgetBytes) {
+      page = lock->evictDownTo(lock->budgetBytes > size ? lock->budgetBytes - size : 0, size);
+    }
+    if (page == nullptr && lock->usedBytes + size > lock->budgetBytes && createFlag == 1) {
+      return nullptr;
+    }
+  }
+  if (page == nullptr) {
+    page = static_cast<Page*>(malloc(size));
+    if (page == nullptr) return nullptr;
+  }
+
+  ++lock->misses;
+  ++lock->pageCount;
+  if (cache.purgeable) lock->usedBytes += size;
+
+  auto bytes = reinterpret_cast<kj::byte*>(page + 1);
+  page->handle.pBuf = bytes;
+  page->handle.pExtra = bytes + cache.pageSize;
+  page->cache = &cache;
+  page->key = key;
+  page->pinned = true;
+  page->lruPrev = nullptr;
+  page->lruNext = nullptr;
+
+  // SQLite relies on the extra data starting out zeroed, to recognize pages it hasn't
+  // initialized yet.
+  memset(page->handle.pExtra, 0, cache.extraSize);
+
+  cache.pages.insert(key, page);
+  return &page->handle;
+}
+
+void pageCacheUnpin(sqlite3_pcache* p, sqlite3_pcache_page* pg, int discard) {
+  Cache& cache = getCache(p);
+  Page& page = getPage(pg);
+  auto lock = getState().lockExclusive();
+
+  if (discard) {
+    lock->discard(page);
+  } else {
+    page.pinned = false;
+    if (cache.purgeable) lock->lruAdd(page);
+  }
+}
+
+void pageCacheRekey(
+    sqlite3_pcache* p, sqlite3_pcache_page* pg, unsigned oldKey, unsigned newKey) {
+  Cache& cache = getCache(p);
+  Page& page = getPage(pg);
+  auto lock = getState().lockExclusive();
+
+  KJ_IF_SOME(existing, cache.pages.find(newKey)) {
+    lock->discard(*existing);
+  }
+  cache.pages.erase(oldKey);
+  page.key = newKey;
+  cache.pages.insert(newKey, &page);
+}
+
+void pageCacheTruncate(sqlite3_pcache* p, unsigned limit) {
+  Cache& cache = getCache(p);
+  auto lock = getState().lockExclusive();
+
+  kj::Vector<Page*> toDiscard;
+  for (auto& entry: cache.pages) {
+    if (entry.key >= limit) toDiscard.add(entry.value);
+  }
+  for (auto page: toDiscard) {
+    lock->discard(*page);
+  }
+}
+
+void pageCacheDestroy(sqlite3_pcache* p) {
+  Cache& cache = getCache(p);
+  {
+    auto lock = getState().lockExclusive();
+    auto pages = KJ_MAP(entry, cache.pages) { return entry.value; };
+    for (auto page: pages) {
+      lock->discard(*page);
+    }
+  }
+  delete &cache;
+}
+
+void pageCacheShrink(sqlite3_pcache* p) {
+  Cache& cache = getCache(p);
+  auto lock = getState().lockExclusive();
+
+  kj::Vector<Page*> toDiscard;
+  for (auto& entry: cache.pages) {
+    if (!entry.value->pinned) toDiscard.add(entry.value);
+  }
+  for (auto page: toDiscard) {
+    lock->discard(*page);
+  }
+}
+
+const sqlite3_pcache_methods2 kPageCacheMethods = {
+  .iVersion = 1,
+  .pArg = nullptr,
+  .xInit = pageCacheInit,
+  .xShutdown = pageCacheShutdown,
+  .xCreate = pageCacheCreate,
+  .xCachesize = pageCacheCachesize,
+  .xPagecount = pageCachePagecount,
+  .xFetch = pageCacheFetch,
+  .xUnpin = pageCacheUnpin,
+  .xRekey = pageCacheRekey,
+  .xTruncate = pageCacheTruncate,
+  .xDestroy = pageCacheDestroy,
+  .xShrink = pageCacheShrink,
+};
+
+}  // namespace
+
+bool installSqliteGlobalPageCache(size_t budgetBytes) {
+  auto lock = getState().lockExclusive();
+
+  if (!lock->installed) {
+    // sqlite3_config() fails with SQLITE_MISUSE once SQLite is initialized.
+    int rc = sqlite3_config(SQLITE_CONFIG_PCACHE2, &kPageCacheMethods);
+    if (rc != SQLITE_OK) return false;
+    lock->installed = true;
+  }
+
+  lock->budgetBytes = budgetBytes;
+  lock->evictDownTo(budgetBytes);
+  return true;
+}
+
+SqliteGlobalPageCacheStats getSqliteGlobalPageCacheStats() {
+  auto lock = getState().lockShared();
+  if (!lock->installed) return {};
+  return {
+    .budgetBytes = lock->budgetBytes,
+    .usedBytes = lock->usedBytes,
+    .pageCount = lock->pageCount,
+    .hits = lock->hits,
+    .misses = lock->misses,
+    .evictions = lock->evictions,
+  };
+}
+
+}  // namespace workerd
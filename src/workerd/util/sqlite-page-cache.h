@@ -0,0 +1,62 @@
+// Copyright (c) 2017-2022 Cloudflare, Inc.
+// Licensed under the Apache 2.0 license found in the LICENSE file or at:
+//     https://opensource.org/licenses/Apache-2.0
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace workerd {
+
+// This module implements a process-wide SQLite page cache.
+//
+// By default, SQLite gives each open database its own page cache, sized by `PRAGMA cache_size`.
+// With many databases open -- e.g. one per Durable Object -- total memory then scales with the
+// number of databases rather than with how much data is actually hot, and an idle database holds
+// on to memory that a busy one could use.
+//
+// The global page cache replaces SQLite's default (via SQLITE_CONFIG_PCACHE2) with one that
+// stores every database's pages under a single memory budget. Unpinned pages from all databases
+// are kept on one LRU list, and when the budget is reached, the least-recently-used page is
+// recycled, whichever database it belongs to. Per-database `cache_size` settings are ignored.
+//
+// Page memory is allocated directly from the system allocator and is bounded by the budget
+// instead of being counted by SqliteMemoryScope, since a recycled page moves from one database
+// to another. Caches for temporary and in-memory databases, whose pages can't be discarded, are
+// not counted against the budget.
+//
+// Per-database cache hit rates are reported through SqliteObserver::addPageCacheStats(), which
+// works with either page cache.
+
+// Installs the global page cache with the given budget, in bytes. This must be called before the
+// first sqlite3_initialize(), sqlite3_open_v2(), or sqlite3_vfs_register() call in the process.
+// Once installed, further calls just change the budget, evicting unpinned pages if it shrank.
+//
+// Returns false, leaving SQLite's default page cache in place, if SQLite was already initialized
+// without the global page cache.
+bool installSqliteGlobalPageCache(size_t budgetBytes);
+
+struct SqliteGlobalPageCacheStats {
+  size_t budgetBytes = 0;
+
+  // Memory used by pages counted against the budget. This can briefly exceed the budget when
+  // SQLite needs more pages pinned at once than the budget allows.
+  size_t usedBytes = 0;
+
+  // Number of pages in all caches, including ones not counted against the budget.
+  uint64_t pageCount = 0;
+
+  // Lookups that found the page already cached, and pages that had to be added to the cache
+  // (typically by reading them from disk).
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+
+  // Pages discarded to stay within the budget.
+  uint64_t evictions = 0;
+};
+
+// Returns the global page cache's current statistics, or all zeros if it isn't installed.
+SqliteGlobalPageCacheStats getSqliteGlobalPageCacheStats();
+
+}  // namespace workerd
@@ -1011,6 +1011,27 @@ KJ_TEST("SQLite observer reportQueryEvent") {
   KJ_ASSERT(sqliteObserver.capturedEvents == 6);
 }
 
+KJ_TEST("reset database discards the WAL") {
+  auto dir = kj::newInMemoryDirectory(kj::nullClock());
+  SqliteDatabase::Vfs vfs(*dir);
+  SqliteDatabase db(vfs, kj::Path({"foo"}), kj::WriteMode::CREATE | kj::WriteMode::MODIFY);
+
+  db.run("PRAGMA journal_mode=WAL;");
+  db.run("CREATE TABLE things (id INTEGER PRIMARY KEY)");
+  db.run("INSERT INTO things VALUES (123)");
+  KJ_EXPECT(dir->exists(kj::Path({"foo-wal"})));
+
+  db.reset();
+
+  // The WAL wasn't checkpointed on close, and must not be recovered into the new database.
+  KJ_EXPECT(!dir->exists(kj::Path({"foo-wal"})));
+  KJ_EXPECT_THROW_MESSAGE("no such table: things", db.run("SELECT * FROM things"));
+
+  db.run("PRAGMA journal_mode=WAL;");
+  db.run("CREATE TABLE things (id INTEGER PRIMARY KEY)");
+  KJ_EXPECT(db.run("SELECT COUNT(*) FROM things").getInt(0) == 0);
+}
+
 KJ_TEST("SQLite failed statement reset") {
   auto dir = kj::newInMemoryDirectory(kj::nullClock());
   SqliteDatabase::Vfs vfs(*dir);
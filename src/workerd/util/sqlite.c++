@@ -645,6 +645,8 @@ SqliteDatabase::~SqliteDatabase() noexcept(false) {
 
   auto memoryScope = enterMemoryScope();
 
+  reportPageCacheStats(*db);
+
   auto err = sqlite3_close(db);
   if (err == SQLITE_BUSY) {
     KJ_LOG(ERROR, "sqlite database destroyed while dependent objects still exist");
@@ -1012,12 +1014,26 @@ void SqliteDatabase::reset() {
       listener.beforeSqliteReset();
     }
 
+    reportPageCacheStats(db);
+
+    // Closing the last connection normally checkpoints the WAL into the database file. Everything
+    // is about to be deleted, so that would only rewrite pages we're throwing away -- for a large
+    // WAL, most of the cost of reset().
+    SQLITE_CALL_NODB(sqlite3_db_config(&db, SQLITE_DBCONFIG_NO_CKPT_ON_CLOSE, 1, nullptr));
+
     auto err = sqlite3_close(&db);
     KJ_REQUIRE(err == SQLITE_OK, "can't reset() database because dependent objects still exist",
         sqlite3_errstr(err));
 
     maybeDb = kj::none;
     vfs.directory.remove(path);
+
+    // Without the checkpoint, the WAL is left behind, as is the -shm file when using native files.
+    // Neither may outlive the database, or the new one would try to recover from them.
+    auto dir = path.parent();
+    auto name = path.basename()[0].asPtr();
+    vfs.directory.tryRemove(dir.append(kj::Path(kj::str(name, "-wal"))));
+    vfs.directory.tryRemove(dir.append(kj::Path(kj::str(name, "-shm"))));
   }
 
   KJ_ON_SCOPE_FAILURE(maybeDb = kj::none);
@@ -1362,6 +1378,17 @@ bool SqliteDatabase::isAuthorizedTemp(int actionCode,
   }
 }
 
+void SqliteDatabase::reportPageCacheStats(sqlite3& db) {
+  // Reading the hit and miss counters resets them, so each page lookup is reported once.
+  int hits = 0, misses = 0, bytesUsed = 0, highwater = 0;
+  sqlite3_db_status(&db, SQLITE_DBSTATUS_CACHE_HIT, &hits, &highwater, /*resetFlg=*/1);
+  sqlite3_db_status(&db, SQLITE_DBSTATUS_CACHE_MISS, &misses, &highwater, /*resetFlg=*/1);
+  sqlite3_db_status(&db, SQLITE_DBSTATUS_CACHE_USED, &bytesUsed, &highwater, /*resetFlg=*/0);
+  if (hits != 0 || misses != 0) {
+    sqliteObserver.addPageCacheStats(hits, misses, bytesUsed);
+  }
+}
+
 // Set up security restrictions.
 // See: https://www.sqlite.org/security.html
 void SqliteDatabase::setupSecurity(sqlite3* db) {
@@ -1519,6 +1546,14 @@ void SqliteDatabase::Query::destroy() {
 
   queryEvent.setQueryEventStats(rowsRead, rowsWritten, !(regulator->shouldAddQueryStats()));
 
+  KJ_IF_SOME(sqlDb, db.maybeDb) {
+    // Queries inside a transaction leave their page cache activity to be reported along with the
+    // rest of the transaction's.
+    if (sqlite3_get_autocommit(&sqlDb) != 0) {
+      db.reportPageCacheStats(sqlDb);
+    }
+  }
+
   try {
     kj::StringPtr statement = sqlite3_sql(getStatementAndEffect().statement);
     queryEvent.setQueryStatement(
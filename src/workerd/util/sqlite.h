@@ -39,6 +39,11 @@ class SqliteObserver {
     return monotonicClock.now();
   }
   virtual void addQueryStats(uint64_t rowsRead, uint64_t rowsWritten) {}
+
+  // Called at the end of each transaction that used the page cache, with the database's page cache
+  // activity since the previous call: pages found in the cache, pages that had to be read in, and
+  // the cache's current size in bytes.
+  virtual void addPageCacheStats(uint64_t hits, uint64_t misses, uint64_t bytesUsed) {}
   // The method is not used by the SqliteDatabase, it is added here for convenience
   virtual void setSqliteStoredBytes(uint64_t sqliteStoredBytes) {}
 
@@ -468,6 +473,11 @@ class SqliteDatabase {
 
   void setupSecurity(sqlite3* db);
 
+  // Reports page cache activity since the last call to sqliteObserver.addPageCacheStats().
+  // Reading the counters costs a few mutex acquisitions, so this is only done when a transaction
+  // ends, and before the database is closed.
+  void reportPageCacheStats(sqlite3& db);
+
   struct ParseContext {
     // What kind of state change does this statement cause, if any?
     StateChange stateChange = NoChange();
@@ -709,6 +709,10 @@ interface DurableObjectState<Props = unknown> {
   blockConcurrencyWhile<T>(callback: () => Promise<T>): Promise<T>;
   acceptWebSocket(ws: WebSocket, tags?: string[]): void;
   getWebSockets(tag?: string): WebSocket[];
+  broadcast(
+    message: (ArrayBuffer | ArrayBufferView) | string,
+    options?: DurableObjectBroadcastOptions,
+  ): number;
   setWebSocketAutoResponse(maybeReqResp?: WebSocketRequestResponsePair): void;
   getWebSocketAutoResponse(): WebSocketRequestResponsePair | null;
   getWebSocketAutoResponseTimestamp(ws: WebSocket): Date | null;
@@ -805,6 +809,10 @@ interface DurableObjectAbortOptions {
 interface DurableObjectReadReplicationOptions {
   mode: "auto" | "disabled";
 }
+interface DurableObjectBroadcastOptions {
+  tag?: string;
+  except?: WebSocket[];
+}
 interface DurableObjectListOptions {
   start?: string;
   startAfter?: string;
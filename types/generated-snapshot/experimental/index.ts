@@ -712,6 +712,10 @@ export interface DurableObjectState<Props = unknown> {
   blockConcurrencyWhile<T>(callback: () => Promise<T>): Promise<T>;
   acceptWebSocket(ws: WebSocket, tags?: string[]): void;
   getWebSockets(tag?: string): WebSocket[];
+  broadcast(
+    message: (ArrayBuffer | ArrayBufferView) | string,
+    options?: DurableObjectBroadcastOptions,
+  ): number;
   setWebSocketAutoResponse(maybeReqResp?: WebSocketRequestResponsePair): void;
   getWebSocketAutoResponse(): WebSocketRequestResponsePair | null;
   getWebSocketAutoResponseTimestamp(ws: WebSocket): Date | null;
@@ -808,6 +812,10 @@ export interface DurableObjectAbortOptions {
 export interface DurableObjectReadReplicationOptions {
   mode: "auto" | "disabled";
 }
+export interface DurableObjectBroadcastOptions {
+  tag?: string;
+  except?: WebSocket[];
+}
 export interface DurableObjectListOptions {
   start?: string;
   startAfter?: string;